@@ -7,6 +7,8 @@
 
 #ifndef CAMERA_H
 #define CAMERA_H
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include <SDL3/SDL.h>
@@ -367,6 +369,29 @@ class Camera
         }
     }
 
+    /*
+     * Moves the camera back along its current view direction until the box
+     * [bounds_min, bounds_max] (world units) fills the view, and centres the
+     * rotation sphere on it. The far plane is pushed out if the box would be
+     * clipped.
+     */
+    void frameBounds(glm::vec3 bounds_min, glm::vec3 bounds_max)
+    {
+        const glm::vec3 center = (bounds_min + bounds_max) * 0.5f;
+        const float radius = std::max(glm::length(bounds_max - bounds_min) * 0.5f, nearPlane);
+        // projection[1][1] is 1 / tan(half vertical fov); projection[0][0] the same over the aspect ratio
+        const float tan_half_fov = 1.0f / std::max(std::fabs(projection[0][0]), std::fabs(projection[1][1]));
+        const float distance = radius / std::sin(std::atan(tan_half_fov));
+        cameraPos = center - cameraFront * distance;
+        spherePos = center;
+        sphereDistance = distance;
+        if (distance + radius > renderDistance) {
+            renderDistance = distance + 2.0f * radius;
+            const GLfloat aspect = std::fabs(projection[1][1] / projection[0][0]);
+            projection = glm::perspective(fov, aspect, nearPlane, renderDistance);
+        }
+    }
+
     /*
      * Cycle the rotation lock state (rotateState 0→1→2→0).
      * Mirrors the P key: 0 = free, 1 = point lock visible, 2 = orbit locked.
@@ -404,6 +429,15 @@ class Camera
         }
     }
 
+    /*
+     * Returns true when the orbit follows the center of mass, the only time
+     * it is needed.
+     */
+    bool isComLocked() const
+    {
+        return rotLock && comLock;
+    }
+
     /*
      * Returns true when rotation is locked (orbit mode active).
      */
@@ -0,0 +1,350 @@
+/*
+ * com_track.hpp
+ *
+ * Centre-of-mass track of a dataset. A run's COMFile (one vec4 per frame:
+ * x, y, z and the frame index in w) is read into memory once when the
+ * dataset is opened, so the per-frame lookup does no I/O. Frames the COMFile
+ * does not cover, or every frame of a dataset without one, get their centre
+ * of mass reduced from the frame's positions the first time it is asked for.
+ *
+ * The reduction sums each particle type on its own. The result can then be
+ * weighted by the mass each type carries (from RunSetup; without it every
+ * particle counts the same) and restricted to some of the types, e.g. the
+ * core and mantle of one body.
+ *
+ * Usage:
+ *   ComTrack track(com_path, source);
+ *   glm::dvec3 com;
+ *   if (track.at(frame, com)) {
+ *       // com is in the source's coordinates (see FrameSource::positionOrigin)
+ *   }
+ *
+ * The source must outlive the track. Not thread-safe; the reduction runs on
+ * the track's own pool and must not be started from inside another pool task.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_COM_TRACK_H
+#define PARTICLE_VIEWER_DATA_COM_TRACK_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#endif
+
+#include "data/frame_source.hpp"
+#include "data/frame_stats.hpp"
+#include "data/thread_pool.hpp"
+
+namespace com_track
+{
+
+// Types 0-3 as in frame_stats; the last slot holds every other w value
+constexpr int TYPE_SLOTS = frame_stats::TYPE_SLOTS;
+
+constexpr std::uint32_t ALL_TYPES = (1u << TYPE_SLOTS) - 1;
+
+// Frames with fewer particles are reduced on the calling thread
+constexpr std::int64_t PARALLEL_PARTICLES = 1 << 16;
+
+/*
+ * Per-type sums of the finite positions of one frame.
+ */
+struct TypeSums
+{
+    std::array<glm::dvec3, TYPE_SLOTS> sum;
+    std::array<std::int64_t, TYPE_SLOTS> count;
+
+    TypeSums()
+    {
+        sum.fill(glm::dvec3(0.0));
+        count.fill(0);
+    }
+
+    void add(const TypeSums& other)
+    {
+        for (int slot = 0; slot < TYPE_SLOTS; slot++) {
+            sum[slot] += other.sum[slot];
+            count[slot] += other.count[slot];
+        }
+    }
+};
+
+inline int typeSlot(float w)
+{
+    const bool known_type = w >= 0.0f && w < static_cast<float>(TYPE_SLOTS - 1); // false for NaN too
+    return known_type ? static_cast<int>(w) : TYPE_SLOTS - 1;
+}
+
+/*
+ * Adds positions [begin, end) to `sums`, skipping particles with a NaN or
+ * Inf coordinate. With AVX each particle is widened and summed as one
+ * four-double vector.
+ */
+inline void accumulate(const glm::vec4* positions, std::int64_t begin, std::int64_t end, TypeSums& sums)
+{
+#if defined(__AVX__)
+    __m256d lanes[TYPE_SLOTS];
+    for (__m256d& lane : lanes) {
+        lane = _mm256_setzero_pd();
+    }
+    for (std::int64_t i = begin; i < end; i++) {
+        const __m128 particle = _mm_loadu_ps(&positions[i].x);
+        // x - x is 0 for a finite x and NaN for NaN or Inf
+        const int finite = _mm_movemask_ps(_mm_cmpeq_ps(_mm_sub_ps(particle, particle), _mm_setzero_ps()));
+        if ((finite & 0x7) != 0x7) {
+            continue;
+        }
+        const int slot = typeSlot(positions[i].w);
+        lanes[slot] = _mm256_add_pd(lanes[slot], _mm256_cvtps_pd(particle));
+        sums.count[slot]++;
+    }
+    for (int slot = 0; slot < TYPE_SLOTS; slot++) {
+        alignas(32) double lane[4];
+        _mm256_store_pd(lane, lanes[slot]);
+        sums.sum[slot] += glm::dvec3(lane[0], lane[1], lane[2]);
+    }
+#else
+    for (std::int64_t i = begin; i < end; i++) {
+        const glm::vec4& p = positions[i];
+        if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+            continue;
+        }
+        const int slot = typeSlot(p.w);
+        sums.sum[slot] += glm::dvec3(p.x, p.y, p.z);
+        sums.count[slot]++;
+    }
+#endif
+}
+
+/*
+ * Per-type sums of `n` positions, split across `pool` when there is one and
+ * the frame is large enough. Chunks are merged in order, so the result does
+ * not depend on scheduling.
+ */
+inline TypeSums reduce(const glm::vec4* positions, std::int64_t n, ThreadPool* pool)
+{
+    TypeSums total;
+    if (pool == nullptr || n < PARALLEL_PARTICLES) {
+        accumulate(positions, 0, n, total);
+        return total;
+    }
+    const std::int64_t chunks = pool->size();
+    const std::int64_t chunk_size = (n + chunks - 1) / chunks;
+    std::vector<TypeSums> partial(static_cast<std::size_t>(chunks));
+    pool->parallelFor(0, chunks, [&](std::int64_t chunk) {
+        const std::int64_t begin = chunk * chunk_size;
+        accumulate(positions, begin, std::min(n, begin + chunk_size), partial[chunk]);
+    });
+    for (const TypeSums& sums : partial) {
+        total.add(sums);
+    }
+    return total;
+}
+
+/*
+ * Centre of mass of the types in `type_mask`. A type's particles share its
+ * `type_masses` entry equally; with no masses every particle weighs the
+ * same. False if no particle of a selected type (with mass) is finite.
+ */
+inline bool centreOfMass(const TypeSums& sums, const std::array<double, TYPE_SLOTS>* type_masses,
+                         std::uint32_t type_mask, glm::dvec3& com)
+{
+    glm::dvec3 weighted(0.0);
+    double total = 0.0;
+    for (int slot = 0; slot < TYPE_SLOTS; slot++) {
+        if ((type_mask & (1u << slot)) == 0 || sums.count[slot] == 0) {
+            continue;
+        }
+        const double count = static_cast<double>(sums.count[slot]);
+        const double mass = type_masses ? (*type_masses)[slot] : count;
+        if (!(mass > 0.0)) {
+            continue;
+        }
+        weighted += sums.sum[slot] * (mass / count);
+        total += mass;
+    }
+    if (total <= 0.0) {
+        return false;
+    }
+    com = weighted / total;
+    return true;
+}
+
+/*
+ * Parses a comma-separated list of particle types ("0,1") into a mask.
+ */
+inline bool parseTypeMask(const std::string& list, std::uint32_t& mask)
+{
+    std::uint32_t parsed = 0;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        char* end = nullptr;
+        const long type = std::strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || type < 0 || type >= TYPE_SLOTS - 1) {
+            return false;
+        }
+        parsed |= 1u << type;
+    }
+    if (parsed == 0) {
+        return false;
+    }
+    mask = parsed;
+    return true;
+}
+
+/*
+ * Reads a whole COMFile. False if it is missing or unreadable.
+ */
+inline bool loadFile(const std::string& path, std::vector<glm::vec4>& track)
+{
+    track.clear();
+    if (path.empty()) {
+        return false;
+    }
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    glm::vec4 block[1024];
+    std::size_t read;
+    while ((read = std::fread(block, sizeof(glm::vec4), 1024, file)) > 0) {
+        track.insert(track.end(), block, block + read);
+    }
+    const bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    if (!ok) {
+        track.clear();
+    }
+    return ok;
+}
+
+} // namespace com_track
+
+class ComTrack
+{
+  public:
+    /*
+     * Loads `com_path` if it exists. Reductions run on `thread_count`
+     * workers (0 = one per hardware thread), started on first use.
+     */
+    ComTrack(const std::string& com_path, const FrameSource* source, unsigned thread_count = 0)
+        : source_(source), thread_count_(thread_count)
+    {
+        stored_ = com_track::loadFile(com_path, track_);
+        if (source_) {
+            origin_ = source_->positionOrigin();
+        }
+    }
+
+    /*
+     * True if a COMFile was loaded.
+     */
+    bool isStored() const
+    {
+        return stored_;
+    }
+
+    /*
+     * Mass of each particle type, for weighting computed centres.
+     */
+    void setTypeMasses(const std::array<double, com_track::TYPE_SLOTS>& masses)
+    {
+        type_masses_ = masses;
+        has_masses_ = true;
+        cached_frame_ = -1;
+    }
+
+    /*
+     * Types computed centres are taken over (com_track::ALL_TYPES by default).
+     * A COMFile covers every type, so with a narrower mask it is not used.
+     */
+    void setTypeMask(std::uint32_t mask)
+    {
+        type_mask_ = mask;
+        cached_frame_ = -1;
+    }
+
+    /*
+     * Centre of mass of `frame` relative to the source's position origin.
+     * False if the frame is neither in the COMFile nor readable, or has no
+     * finite particle of the selected types.
+     */
+    bool at(std::int64_t frame, glm::dvec3& com)
+    {
+        return at(frame, nullptr, com);
+    }
+
+    /*
+     * Same as at(), but a frame the COMFile does not cover is reduced from
+     * `positions`, the frame's particleCount() positions the caller already
+     * holds (e.g. a prefetch slot), instead of being read from the source.
+     * With `positions` nullptr the frame is read as at() does.
+     */
+    bool at(std::int64_t frame, const glm::vec4* positions, glm::dvec3& com)
+    {
+        if (type_mask_ == com_track::ALL_TYPES && frame >= 0 && frame < static_cast<std::int64_t>(track_.size()) &&
+            static_cast<std::int64_t>(track_[frame].w) == frame) {
+            com = glm::dvec3(track_[frame].x, track_[frame].y, track_[frame].z) - origin_;
+            return true;
+        }
+        if (frame != cached_frame_) {
+            cached_ok_ = compute(frame, positions, cached_com_);
+            cached_frame_ = frame;
+        }
+        com = cached_com_;
+        return cached_ok_;
+    }
+
+  private:
+    bool compute(std::int64_t frame, const glm::vec4* positions, glm::dvec3& com)
+    {
+        if (source_ == nullptr || frame < 0 || frame >= source_->frameCount()) {
+            return false;
+        }
+        const std::int64_t n = source_->particleCount();
+        if (positions == nullptr) {
+            positions = source_->mappedPositions(frame);
+        }
+        if (positions == nullptr) {
+            buffer_.resize(static_cast<std::size_t>(n));
+            if (!source_->readPositions(frame, buffer_.data())) {
+                return false;
+            }
+            positions = buffer_.data();
+        }
+        if (!pool_ && n >= com_track::PARALLEL_PARTICLES) {
+            pool_ = std::make_unique<ThreadPool>(thread_count_);
+        }
+        const com_track::TypeSums sums = com_track::reduce(positions, n, pool_.get());
+        return com_track::centreOfMass(sums, has_masses_ ? &type_masses_ : nullptr, type_mask_, com);
+    }
+
+    const FrameSource* source_;
+    unsigned thread_count_;
+    std::vector<glm::vec4> track_; // the COMFile, one entry per frame
+    bool stored_ = false;
+    glm::dvec3 origin_{0.0};
+    std::array<double, com_track::TYPE_SLOTS> type_masses_{};
+    bool has_masses_ = false;
+    std::uint32_t type_mask_ = com_track::ALL_TYPES;
+    std::unique_ptr<ThreadPool> pool_;
+    std::vector<glm::vec4> buffer_; // positions of sources without mapped frames
+    std::int64_t cached_frame_ = -1;
+    glm::dvec3 cached_com_{0.0};
+    bool cached_ok_ = false;
+};
+
+#endif // PARTICLE_VIEWER_DATA_COM_TRACK_H
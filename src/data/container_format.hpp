@@ -0,0 +1,124 @@
+/*
+ * container_format.hpp
+ *
+ * On-disk layout of the v2 particle dataset container (".pv2").
+ *
+ *   [ContainerHeader, 64 bytes]
+ *   [frame 0][frame 1]...[frame F-1]   each frame starts on a 16-byte boundary
+ *   [ContainerIndexEntry x F]          located by header.index_offset
+ *
+ * With StreamLayout::SeparateStreams, a frame's positions and velocities
+ * live in two regions instead, so position-only playback reads no velocity
+ * bytes at all:
+ *
+ *   [ContainerHeader, 64 bytes]
+ *   [positions 0]...[positions F-1]
+ *   [velocities 0]...[velocities F-1]
+ *   [ContainerIndexEntry x 2F]         F position entries, then F velocity entries
+ *
+ * (without HAS_VELOCITIES both layouts are the same: F position blocks).
+ *
+ * Unlike the legacy PosAndVel blob, the container describes itself: particle
+ * count, frame count, element type, stream layout and encoding live in the
+ * header, and the index gives each frame's byte offset and stored size, so
+ * seeking is a table lookup and frames may differ in size (compression).
+ *
+ * All fields are little-endian, matching the raw float dumps the simulations
+ * produce.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_CONTAINER_FORMAT_H
+#define PARTICLE_VIEWER_DATA_CONTAINER_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace container
+{
+
+constexpr char MAGIC[8] = {'P', 'V', 'F', 'R', 'A', 'M', 'E', 'S'};
+constexpr std::uint32_t VERSION = 2;
+constexpr std::uint64_t FRAME_ALIGNMENT = 16;
+
+// File name the viewer looks for next to (and prefers over) a legacy PosAndVel file
+constexpr const char* DEFAULT_FILE_NAME = "/PosAndVel.pv2";
+
+// PredictiveResidual: a random seek decodes at most this many frames
+constexpr std::uint32_t DEFAULT_KEYFRAME_INTERVAL = 16;
+
+enum class ElementType : std::uint32_t
+{
+    Float32 = 0,
+};
+
+enum class StreamLayout : std::uint32_t
+{
+    // Per frame: N positions, then N velocities (the legacy PosAndVel order)
+    FrameInterleaved = 0,
+    // All position blocks, then all velocity blocks; not for PredictiveResidual, whose frames code both together
+    SeparateStreams = 1,
+};
+
+enum class Encoding : std::uint32_t
+{
+    // Frames are stored as plain vec4 arrays and can be used straight from the mapping
+    Raw = 0,
+    // 16-bit fixed-point xyz plus a type byte per particle (see quantized_codec.hpp)
+    Quantized16 = 1,
+    // Lossless residuals from a velocity-based prediction of the previous frame (see residual_codec.hpp)
+    PredictiveResidual = 2,
+};
+
+// ContainerHeader::flags bits
+constexpr std::uint32_t HAS_VELOCITIES = 1u << 0;
+
+struct ContainerHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_bytes;
+    std::uint64_t particle_count;
+    std::uint64_t frame_count;
+    std::uint32_t element_type;
+    std::uint32_t stream_layout;
+    std::uint32_t encoding;
+    std::uint32_t flags;
+    std::uint64_t index_offset;
+    float prediction_dt; // time between stored frames (Dt * RecordRate); PredictiveResidual only
+    // PredictiveResidual: every keyframe_interval-th frame is stored without prediction; 0 = only frame 0
+    std::uint32_t keyframe_interval;
+};
+static_assert(sizeof(ContainerHeader) == 64, "ContainerHeader must stay 64 bytes on disk");
+
+struct ContainerIndexEntry
+{
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+static_assert(sizeof(ContainerIndexEntry) == 16, "ContainerIndexEntry must stay 16 bytes on disk");
+
+/*
+ * Frame a PredictiveResidual decode of `frame` has to start from.
+ */
+inline std::int64_t keyframeAtOrBefore(std::int64_t frame, std::uint32_t keyframe_interval)
+{
+    return keyframe_interval == 0 ? 0 : frame - frame % static_cast<std::int64_t>(keyframe_interval);
+}
+
+/*
+ * True if the buffer starts with the container magic. Used to tell a v2
+ * container apart from a legacy blob regardless of file name.
+ */
+inline bool hasMagic(const unsigned char* bytes, std::uint64_t size)
+{
+    return bytes != nullptr && size >= sizeof(MAGIC) && std::memcmp(bytes, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+inline std::uint64_t alignUp(std::uint64_t value)
+{
+    return (value + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+}
+
+} // namespace container
+
+#endif // PARTICLE_VIEWER_DATA_CONTAINER_FORMAT_H
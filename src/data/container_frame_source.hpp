@@ -0,0 +1,501 @@
+/*
+ * container_frame_source.hpp
+ *
+ * FrameSource over a memory-mapped v2 container. The header and index are
+ * validated once on open; reading a frame is an index lookup followed by a
+ * copy (raw frames) or a decode (quantized frames).
+ *
+ * In the SeparateStreams layout positions and velocities have their own
+ * index entries, so readPositions(), mappedPositions() and the page-cache
+ * hints touch only the position region.
+ *
+ * Predictive frames depend on the frame before them, back to the nearest
+ * keyframe. The source keeps a few reconstructed frames warm in cursors, and
+ * each read continues from the cursor closest behind it, so every sequential
+ * reader (playback, previews, the statistics pass, an export) keeps its own
+ * and decodes one frame per read while the others read elsewhere. A seek
+ * decodes at most keyframe_interval frames. A cursor holds four frames (its
+ * velocities too when the dataset has them, since positions are predicted
+ * from them), so the pool is capped by WARM_CURSOR_BUDGET_BYTES: at large N
+ * fewer readers keep a cursor of their own and the rest share by recency.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_CONTAINER_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_CONTAINER_FRAME_SOURCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/container_format.hpp"
+#include "data/frame_source.hpp"
+#include "data/mapped_file.hpp"
+#include "data/quantized_codec.hpp"
+#include "data/residual_codec.hpp"
+#include "data/thread_pool.hpp"
+
+class ContainerFrameSource : public FrameSource
+{
+  public:
+    // Memory all warm cursors may hold; more readers than fit share by recency
+    static constexpr std::uint64_t WARM_CURSOR_BUDGET_BYTES = 256ull * 1024 * 1024;
+    // Playback and one background reader keep theirs even when that exceeds the budget
+    static constexpr std::size_t MIN_WARM_CURSORS = 2;
+    static constexpr std::size_t MAX_WARM_CURSORS = 8;
+
+    /*
+     * Takes ownership of a mapping that starts with the container magic.
+     * Check isValid() afterwards; an invalid container reports zero frames.
+     */
+    explicit ContainerFrameSource(MappedFile mapping) : mapping_(std::move(mapping))
+    {
+        valid_ = parseHeader();
+        if (valid_ && encoding() == container::Encoding::PredictiveResidual) {
+            decode_pool_ = std::make_unique<ThreadPool>();
+            const std::uint64_t frame_bytes = sizeof(glm::vec4) * header_.particle_count * (hasVelocities() ? 2 : 1);
+            max_cursors_ = warmCursorLimit(2 * frame_bytes);
+        }
+    }
+
+    bool isValid() const
+    {
+        return valid_;
+    }
+
+    std::int64_t particleCount() const override
+    {
+        return valid_ ? static_cast<std::int64_t>(header_.particle_count) : 0;
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return valid_ ? static_cast<std::int64_t>(header_.frame_count) : 0;
+    }
+
+    bool hasVelocities() const
+    {
+        return (header_.flags & container::HAS_VELOCITIES) != 0;
+    }
+
+    const container::ContainerHeader& header() const
+    {
+        return header_;
+    }
+
+    container::Encoding encoding() const
+    {
+        return static_cast<container::Encoding>(header_.encoding);
+    }
+
+    container::StreamLayout layout() const
+    {
+        return static_cast<container::StreamLayout>(header_.stream_layout);
+    }
+
+    bool readPositions(std::int64_t frame, glm::vec4* destination) const override
+    {
+        if (!inRange(frame)) {
+            return false;
+        }
+        const std::int64_t n = particleCount();
+        const container::ContainerIndexEntry entry = indexEntry(frame);
+        const unsigned char* bytes = mapping_.data() + entry.offset;
+        if (encoding() == container::Encoding::Quantized16) {
+            return quantized::decodeBlock(bytes, entry.size, n, true, destination);
+        }
+        if (encoding() == container::Encoding::PredictiveResidual) {
+            WarmCursor* cursor = acquireCursor(frame);
+            const bool ok = decodeUpTo(*cursor, frame);
+            if (ok) {
+                std::copy(cursor->positions.begin(), cursor->positions.end(), destination);
+            }
+            releaseCursor(cursor);
+            return ok;
+        }
+        const glm::vec4* positions = reinterpret_cast<const glm::vec4*>(bytes);
+        std::copy(positions, positions + n, destination);
+        return true;
+    }
+
+    /*
+     * Quantized frames decode only the range. Predictive frames still decode
+     * the whole frame into a warm cursor, but copy out only the range.
+     */
+    bool readPositionRange(std::int64_t frame, std::int64_t first, std::int64_t count,
+                           glm::vec4* destination) const override
+    {
+        if (!inRange(frame) || first < 0 || count < 0 || first + count > particleCount()) {
+            return false;
+        }
+        const container::ContainerIndexEntry entry = indexEntry(frame);
+        const unsigned char* bytes = mapping_.data() + entry.offset;
+        if (encoding() == container::Encoding::Quantized16) {
+            return quantized::decodeRange(bytes, entry.size, particleCount(), true, first, count, destination);
+        }
+        if (encoding() == container::Encoding::PredictiveResidual) {
+            WarmCursor* cursor = acquireCursor(frame);
+            const bool ok = decodeUpTo(*cursor, frame);
+            if (ok) {
+                std::copy(cursor->positions.begin() + first, cursor->positions.begin() + first + count, destination);
+            }
+            releaseCursor(cursor);
+            return ok;
+        }
+        const glm::vec4* positions = reinterpret_cast<const glm::vec4*>(bytes);
+        std::copy(positions + first, positions + first + count, destination);
+        return true;
+    }
+
+    /*
+     * Predictive previews take one warm cursor for all their runs.
+     */
+    bool readPreviewPositions(std::int64_t frame, int stride, glm::vec4* destination) const override
+    {
+        if (encoding() != container::Encoding::PredictiveResidual) {
+            return FrameSource::readPreviewPositions(frame, stride, destination);
+        }
+        if (!inRange(frame)) {
+            return false;
+        }
+        WarmCursor* cursor = acquireCursor(frame);
+        const bool ok = decodeUpTo(*cursor, frame);
+        if (ok) {
+            const glm::vec4* positions = cursor->positions.data();
+            forEachPreviewRun(particleCount(), stride,
+                              [&](std::int64_t first, std::int64_t count, std::int64_t packed) {
+                                  std::copy(positions + first, positions + first + count, destination + packed);
+                              });
+        }
+        releaseCursor(cursor);
+        return ok;
+    }
+
+    bool readVelocities(std::int64_t frame, glm::vec4* destination) const override
+    {
+        if (!inRange(frame) || !hasVelocities()) {
+            return false;
+        }
+        const std::int64_t n = particleCount();
+        const container::ContainerIndexEntry entry = velocityEntry(frame);
+        const unsigned char* bytes = mapping_.data() + entry.offset;
+        if (encoding() == container::Encoding::Quantized16) {
+            return quantized::decodeBlock(bytes, entry.size, n, false, destination);
+        }
+        if (encoding() == container::Encoding::PredictiveResidual) {
+            WarmCursor* cursor = acquireCursor(frame);
+            const bool ok = decodeUpTo(*cursor, frame);
+            if (ok) {
+                std::copy(cursor->velocities.begin(), cursor->velocities.end(), destination);
+            }
+            releaseCursor(cursor);
+            return ok;
+        }
+        const glm::vec4* velocities = reinterpret_cast<const glm::vec4*>(bytes);
+        std::copy(velocities, velocities + n, destination);
+        return true;
+    }
+
+    const glm::vec4* mappedPositions(std::int64_t frame) const override
+    {
+        if (!inRange(frame) || encoding() != container::Encoding::Raw) {
+            return nullptr;
+        }
+        return reinterpret_cast<const glm::vec4*>(mapping_.data() + indexEntry(frame).offset);
+    }
+
+    void adviseFrames(std::int64_t first, std::int64_t count, PageAdvice advice) const override
+    {
+        const std::int64_t begin = std::max<std::int64_t>(first, 0);
+        const std::int64_t end = std::min(first + count, frameCount());
+        if (begin >= end) {
+            return;
+        }
+        // Frames are written in order, but take the extremes rather than rely on it
+        std::uint64_t range_begin = UINT64_MAX;
+        std::uint64_t range_end = 0;
+        for (std::int64_t frame = begin; frame < end; frame++) {
+            const container::ContainerIndexEntry entry = indexEntry(frame);
+            range_begin = std::min(range_begin, entry.offset);
+            range_end = std::max(range_end, entry.offset + entry.size);
+        }
+        mapping_.advise(range_begin, range_end - range_begin, advice);
+    }
+
+    /*
+     * Predictive frames decoded so far, counting every frame a seek had to
+     * decode on the way to the one it was asked for.
+     */
+    std::uint64_t decodedFrameCount() const
+    {
+        return decoded_frames_.load();
+    }
+
+    /*
+     * Warm cursors that fit WARM_CURSOR_BUDGET_BYTES when each holds
+     * `cursor_bytes`, between MIN_WARM_CURSORS and MAX_WARM_CURSORS.
+     */
+    static std::size_t warmCursorLimit(std::uint64_t cursor_bytes)
+    {
+        const std::uint64_t fitting = (cursor_bytes > 0) ? WARM_CURSOR_BUDGET_BYTES / cursor_bytes : MAX_WARM_CURSORS;
+        return static_cast<std::size_t>(std::clamp<std::uint64_t>(fitting, MIN_WARM_CURSORS, MAX_WARM_CURSORS));
+    }
+
+    /*
+     * A container is finished with its index in one go (container_writer.hpp);
+     * frames are never appended to it.
+     */
+    bool canGrow() const override
+    {
+        return false;
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t frame) const override
+    {
+        if (!inRange(frame)) {
+            return 0;
+        }
+        return indexEntry(frame).size;
+    }
+
+  private:
+    bool inRange(std::int64_t frame) const
+    {
+        return valid_ && frame >= 0 && static_cast<std::uint64_t>(frame) < header_.frame_count;
+    }
+
+    /*
+     * A reconstructed predictive frame and a buffer for the next one. Owned
+     * by one reader at a time.
+     */
+    struct WarmCursor
+    {
+        std::int64_t frame = -1;
+        bool busy = false;
+        std::uint64_t last_used = 0;
+        std::vector<glm::vec4> positions;
+        std::vector<glm::vec4> velocities;
+        std::vector<glm::vec4> next_positions;
+        std::vector<glm::vec4> next_velocities;
+    };
+
+
+    /*
+     * Takes the idle cursor that reaches `frame` with the fewest decodes: the
+     * latest one between its keyframe and `frame`, else a new cursor, else
+     * the least recently used. Waits while every cursor is busy.
+     */
+    WarmCursor* acquireCursor(std::int64_t frame) const
+    {
+        const std::int64_t keyframe = container::keyframeAtOrBefore(frame, header_.keyframe_interval);
+        std::unique_lock<std::mutex> lock(warm_mutex_);
+        while (true) {
+            WarmCursor* closest = nullptr;
+            WarmCursor* oldest = nullptr;
+            for (const std::unique_ptr<WarmCursor>& cursor : cursors_) {
+                if (cursor->busy) {
+                    continue;
+                }
+                if (cursor->frame >= keyframe && cursor->frame <= frame &&
+                    (closest == nullptr || cursor->frame > closest->frame)) {
+                    closest = cursor.get();
+                }
+                if (oldest == nullptr || cursor->last_used < oldest->last_used) {
+                    oldest = cursor.get();
+                }
+            }
+            if (closest == nullptr && cursors_.size() < max_cursors_) {
+                cursors_.push_back(std::make_unique<WarmCursor>());
+                closest = cursors_.back().get();
+            }
+            WarmCursor* cursor = (closest != nullptr) ? closest : oldest;
+            if (cursor != nullptr) {
+                cursor->busy = true;
+                cursor->last_used = ++cursor_clock_;
+                return cursor;
+            }
+            cursor_released_.wait(lock);
+        }
+    }
+
+    void releaseCursor(WarmCursor* cursor) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(warm_mutex_);
+            cursor->busy = false;
+        }
+        cursor_released_.notify_one();
+    }
+
+    /*
+     * Advances `cursor` to `frame`, one predicted frame at a time, restarting
+     * from the keyframe when the cursor is behind it or past `frame`. The
+     * caller owns the cursor (acquireCursor()).
+     */
+    bool decodeUpTo(WarmCursor& cursor, std::int64_t frame) const
+    {
+        const std::int64_t n = particleCount();
+        const std::int64_t keyframe = container::keyframeAtOrBefore(frame, header_.keyframe_interval);
+        if (cursor.frame > frame || cursor.frame < keyframe) {
+            cursor.frame = keyframe - 1;
+        }
+        if (cursor.positions.empty()) {
+            cursor.positions.resize(n);
+            cursor.next_positions.resize(n);
+            if (hasVelocities()) {
+                cursor.velocities.resize(n);
+                cursor.next_velocities.resize(n);
+            }
+        }
+        for (std::int64_t f = cursor.frame + 1; f <= frame; f++) {
+            glm::vec4* next_velocities = hasVelocities() ? cursor.next_velocities.data() : nullptr;
+            residual::PredictionBase base;
+            base.dt = header_.prediction_dt;
+            if (f != container::keyframeAtOrBefore(f, header_.keyframe_interval)) {
+                base.positions = cursor.positions.data();
+                base.velocities = hasVelocities() ? cursor.velocities.data() : nullptr;
+            }
+            const container::ContainerIndexEntry entry = indexEntry(f);
+            if (!residual::decodeFrame(mapping_.data() + entry.offset, entry.size, base, n,
+                                       cursor.next_positions.data(), next_velocities, decode_pool_.get())) {
+                cursor.frame = -1;
+                return false;
+            }
+            decoded_frames_++;
+            cursor.positions.swap(cursor.next_positions);
+            cursor.velocities.swap(cursor.next_velocities);
+            cursor.frame = f;
+        }
+        return true;
+    }
+
+    bool separateStreams() const
+    {
+        return hasVelocities() && layout() == container::StreamLayout::SeparateStreams;
+    }
+
+    /*
+     * Stored size of one frame's positions and of its velocities for this
+     * header's encoding, or 0 when frames vary in size.
+     */
+    std::uint64_t positionBlockBytes() const
+    {
+        const std::int64_t n = static_cast<std::int64_t>(header_.particle_count);
+        if (encoding() == container::Encoding::Quantized16) {
+            return quantized::blockBytes(n, true);
+        }
+        if (encoding() == container::Encoding::PredictiveResidual) {
+            return 0;
+        }
+        return sizeof(glm::vec4) * header_.particle_count;
+    }
+
+    std::uint64_t velocityBlockBytes() const
+    {
+        const std::int64_t n = static_cast<std::int64_t>(header_.particle_count);
+        if (!hasVelocities() || encoding() == container::Encoding::PredictiveResidual) {
+            return 0;
+        }
+        if (encoding() == container::Encoding::Quantized16) {
+            return quantized::blockBytes(n, false);
+        }
+        return sizeof(glm::vec4) * header_.particle_count;
+    }
+
+    /*
+     * Index entry of frame `frame`: the whole frame when interleaved, its
+     * positions alone in the SeparateStreams layout.
+     */
+    container::ContainerIndexEntry indexEntry(std::int64_t frame) const
+    {
+        container::ContainerIndexEntry entry;
+        std::memcpy(&entry, index_ + frame * sizeof(entry), sizeof(entry));
+        return entry;
+    }
+
+    /*
+     * Where the velocities of `frame` are stored. Not for PredictiveResidual.
+     */
+    container::ContainerIndexEntry velocityEntry(std::int64_t frame) const
+    {
+        if (separateStreams()) {
+            return indexEntry(frameCount() + frame);
+        }
+        container::ContainerIndexEntry entry = indexEntry(frame);
+        const std::uint64_t position_bytes = positionBlockBytes();
+        return {entry.offset + position_bytes, entry.size - position_bytes};
+    }
+
+    /*
+     * Reads and sanity-checks the header and every index entry so that frame
+     * reads never need bounds checks against the file.
+     */
+    bool parseHeader()
+    {
+        const std::uint64_t file_size = mapping_.size();
+        if (!container::hasMagic(mapping_.data(), file_size) || file_size < sizeof(header_)) {
+            return false;
+        }
+        std::memcpy(&header_, mapping_.data(), sizeof(header_));
+        if (header_.version != container::VERSION || header_.header_bytes != sizeof(header_) ||
+            header_.particle_count == 0 ||
+            header_.element_type != static_cast<std::uint32_t>(container::ElementType::Float32) ||
+            header_.stream_layout > static_cast<std::uint32_t>(container::StreamLayout::SeparateStreams) ||
+            header_.encoding > static_cast<std::uint32_t>(container::Encoding::PredictiveResidual)) {
+            return false;
+        }
+        if (separateStreams() && encoding() == container::Encoding::PredictiveResidual) {
+            return false;
+        }
+        // Guards the multiplications below against a corrupt frame count
+        if (header_.frame_count > file_size / sizeof(container::ContainerIndexEntry)) {
+            return false;
+        }
+        const std::uint64_t entry_count = header_.frame_count * (separateStreams() ? 2 : 1);
+        const std::uint64_t index_bytes = entry_count * sizeof(container::ContainerIndexEntry);
+        if (header_.index_offset > file_size || index_bytes > file_size - header_.index_offset) {
+            return false;
+        }
+        index_ = mapping_.data() + header_.index_offset;
+
+        const std::uint64_t position_bytes = positionBlockBytes();
+        const std::uint64_t velocity_bytes = velocityBlockBytes();
+        for (std::uint64_t i = 0; i < entry_count; i++) {
+            container::ContainerIndexEntry entry = indexEntry(static_cast<std::int64_t>(i));
+            std::uint64_t expected_bytes = position_bytes + velocity_bytes;
+            if (separateStreams()) {
+                expected_bytes = (i < header_.frame_count) ? position_bytes : velocity_bytes;
+            }
+            const bool size_ok = (position_bytes == 0) || entry.size == expected_bytes;
+            if (entry.offset % container::FRAME_ALIGNMENT != 0 || !size_ok ||
+                entry.offset > file_size || entry.size > file_size - entry.offset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MappedFile mapping_;
+    container::ContainerHeader header_{};
+    const unsigned char* index_ = nullptr;
+    bool valid_ = false;
+
+    // Predictive decoding state: warm cursors, handed out under warm_mutex_
+    std::unique_ptr<ThreadPool> decode_pool_;
+    mutable std::mutex warm_mutex_;
+    mutable std::condition_variable cursor_released_;
+    mutable std::vector<std::unique_ptr<WarmCursor>> cursors_;
+    std::size_t max_cursors_ = MAX_WARM_CURSORS; // warmCursorLimit() for this header
+    mutable std::uint64_t cursor_clock_ = 0;
+    mutable std::atomic<std::uint64_t> decoded_frames_{0};
+};
+
+#endif // PARTICLE_VIEWER_DATA_CONTAINER_FRAME_SOURCE_H
@@ -0,0 +1,336 @@
+/*
+ * container_writer.hpp
+ *
+ * Streams frames into a v2 container file. Frames are appended one at a
+ * time; the index and final header are written by finish(), so a dataset
+ * never has to fit in memory.
+ *
+ * Frames go to "<path>.tmp", renamed to `path` by a successful finish().
+ * A writer that fails or is abandoned removes its temporary file, so an
+ * interrupted conversion never leaves a half-written container under the
+ * name readers look for.
+ *
+ * For StreamLayout::SeparateStreams, velocity blocks are spooled to
+ * "<path>.velocities" while frames arrive and copied behind the positions
+ * region by finish(); the spool file is removed afterwards.
+ *
+ * Usage:
+ *   ContainerWriter writer;
+ *   if (writer.open(path, n, true, container::Encoding::Quantized16)) {
+ *       for (...) writer.appendFrame(positions, velocities);
+ *       writer.finish();
+ *   }
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_CONTAINER_WRITER_H
+#define PARTICLE_VIEWER_DATA_CONTAINER_WRITER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/container_format.hpp"
+#include "data/quantized_codec.hpp"
+#include "data/residual_codec.hpp"
+
+class ContainerWriter
+{
+  public:
+    ContainerWriter() = default;
+
+    ~ContainerWriter()
+    {
+        if (file_ != nullptr) {
+            fclose(file_); // abandoned without finish()
+            std::remove(temp_path_.c_str());
+        }
+        closeSpool();
+    }
+
+    // Non-copyable: owns open FILE*s
+    ContainerWriter(const ContainerWriter&) = delete;
+    ContainerWriter& operator=(const ContainerWriter&) = delete;
+
+    // Suffix of the file written until finish() renames it into place
+    static constexpr const char* TEMP_SUFFIX = ".tmp";
+
+    /*
+     * Starts a container for `path` (replaced only once finish() succeeds)
+     * and writes a placeholder header.
+     * `prediction_dt` is the time between stored frames, used by
+     * PredictiveResidual to extrapolate positions along their velocities;
+     * every `keyframe_interval`-th frame is stored without prediction so
+     * readers can seek. PredictiveResidual holds at most
+     * residual::maxParticles() particles and only the FrameInterleaved
+     * layout.
+     */
+    bool open(const std::string& path, std::int64_t particle_count, bool has_velocities,
+              container::Encoding encoding = container::Encoding::Raw, float prediction_dt = 0.0f,
+              std::uint32_t keyframe_interval = container::DEFAULT_KEYFRAME_INTERVAL,
+              container::StreamLayout layout = container::StreamLayout::FrameInterleaved)
+    {
+        if (file_ != nullptr || particle_count <= 0) {
+            return false;
+        }
+        if (encoding == container::Encoding::PredictiveResidual &&
+            (particle_count > residual::maxParticles(has_velocities) ||
+             layout != container::StreamLayout::FrameInterleaved)) {
+            return false;
+        }
+        separate_ = has_velocities && layout == container::StreamLayout::SeparateStreams;
+        if (separate_) {
+            spool_path_ = path + ".velocities";
+            spool_ = fopen(spool_path_.c_str(), "w+b");
+            if (spool_ == nullptr) {
+                return false;
+            }
+        }
+        path_ = path;
+        temp_path_ = path + TEMP_SUFFIX;
+        file_ = fopen(temp_path_.c_str(), "wb");
+        if (file_ == nullptr) {
+            closeSpool();
+            return false;
+        }
+        std::memset(&header_, 0, sizeof(header_));
+        std::memcpy(header_.magic, container::MAGIC, sizeof(container::MAGIC));
+        header_.version = container::VERSION;
+        header_.header_bytes = sizeof(container::ContainerHeader);
+        header_.particle_count = static_cast<std::uint64_t>(particle_count);
+        header_.element_type = static_cast<std::uint32_t>(container::ElementType::Float32);
+        header_.stream_layout = static_cast<std::uint32_t>(layout);
+        header_.encoding = static_cast<std::uint32_t>(encoding);
+        header_.flags = has_velocities ? container::HAS_VELOCITIES : 0;
+        header_.prediction_dt = prediction_dt;
+        header_.keyframe_interval = keyframe_interval;
+        index_.clear();
+        velocity_index_.clear();
+        spool_offset_ = 0;
+        previous_positions_.clear();
+        previous_velocities_.clear();
+        // The real header goes in last; version 0 marks a file whose writer never finished
+        container::ContainerHeader placeholder{};
+        std::memcpy(placeholder.magic, container::MAGIC, sizeof(container::MAGIC));
+        offset_ = 0;
+        return writeBytes(&placeholder, sizeof(placeholder));
+    }
+
+    /*
+     * Appends one frame in the container's encoding. `velocities` is ignored
+     * when the container was opened without velocities. Fails for quantized
+     * containers if a w value is not a storable type code or a coordinate is
+     * NaN or infinite.
+     */
+    bool appendFrame(const glm::vec4* positions, const glm::vec4* velocities)
+    {
+        if (file_ == nullptr) {
+            return false;
+        }
+        const std::int64_t n = static_cast<std::int64_t>(header_.particle_count);
+        const bool with_velocities = (header_.flags & container::HAS_VELOCITIES) != 0;
+        if (header_.encoding == static_cast<std::uint32_t>(container::Encoding::Quantized16)) {
+            if (!quantized::canEncodeTypes(positions, n) || !quantized::allFinite(positions, n) ||
+                (with_velocities && !quantized::allFinite(velocities, n))) {
+                return false;
+            }
+            const std::uint64_t position_bytes = quantized::blockBytes(n, true);
+            const std::uint64_t velocity_bytes = with_velocities ? quantized::blockBytes(n, false) : 0;
+            encoded_.resize(position_bytes + velocity_bytes);
+            quantized::encodeBlock(positions, n, true, encoded_.data());
+            if (with_velocities) {
+                quantized::encodeBlock(velocities, n, false, encoded_.data() + position_bytes);
+            }
+            return appendBlocks(encoded_.data(), position_bytes, encoded_.data() + position_bytes, velocity_bytes);
+        }
+        if (header_.encoding == static_cast<std::uint32_t>(container::Encoding::PredictiveResidual)) {
+            return appendPredictedFrame(positions, with_velocities ? velocities : nullptr, n);
+        }
+
+        const std::uint64_t block_bytes = sizeof(glm::vec4) * header_.particle_count;
+        return appendBlocks(positions, block_bytes, velocities, with_velocities ? block_bytes : 0);
+    }
+
+    /*
+     * Appends a frame that is already in the container's encoding. Only for
+     * the FrameInterleaved layout, where a frame is a single block.
+     */
+    bool appendEncodedFrame(const unsigned char* bytes, std::uint64_t size)
+    {
+        if (file_ == nullptr || separate_ || !padToAlignment()) {
+            return false;
+        }
+        container::ContainerIndexEntry entry{offset_, size};
+        if (!writeBytes(bytes, size)) {
+            return false;
+        }
+        index_.push_back(entry);
+        return true;
+    }
+
+    /*
+     * Writes the frame index and the final header, closes the file and
+     * renames it over `path`. On failure the temporary file is removed and
+     * whatever was at `path` is left alone.
+     */
+    bool finish()
+    {
+        if (file_ == nullptr) {
+            return false;
+        }
+        bool ok = padToAlignment();
+        header_.frame_count = index_.size();
+        if (separate_) {
+            ok = ok && appendVelocityRegion();
+        }
+        header_.index_offset = offset_;
+        ok = ok && writeBytes(index_.data(), index_.size() * sizeof(container::ContainerIndexEntry));
+        ok = ok && fseek(file_, 0, SEEK_SET) == 0 && fwrite(&header_, sizeof(header_), 1, file_) == 1;
+        ok = (fclose(file_) == 0) && ok;
+        file_ = nullptr;
+        closeSpool();
+        ok = ok && std::rename(temp_path_.c_str(), path_.c_str()) == 0;
+        if (!ok) {
+            std::remove(temp_path_.c_str());
+        }
+        return ok;
+    }
+
+    std::int64_t framesWritten() const
+    {
+        return static_cast<std::int64_t>(index_.size());
+    }
+
+  private:
+    /*
+     * Writes one frame's position and velocity blocks (velocity_bytes is 0
+     * without velocities): back to back for FrameInterleaved, or the
+     * velocities to the spool for SeparateStreams.
+     */
+    bool appendBlocks(const void* positions, std::uint64_t position_bytes, const void* velocities,
+                      std::uint64_t velocity_bytes)
+    {
+        if (!padToAlignment()) {
+            return false;
+        }
+        if (!separate_) {
+            container::ContainerIndexEntry entry{offset_, position_bytes + velocity_bytes};
+            if (!writeBytes(positions, position_bytes) || !writeBytes(velocities, velocity_bytes)) {
+                return false;
+            }
+            index_.push_back(entry);
+            return true;
+        }
+        container::ContainerIndexEntry entry{offset_, position_bytes};
+        if (!writeBytes(positions, position_bytes)) {
+            return false;
+        }
+        // Spool offsets are relative to the start of the velocity region until finish()
+        const std::uint64_t padding = container::alignUp(spool_offset_) - spool_offset_;
+        static const unsigned char ZEROS[container::FRAME_ALIGNMENT] = {};
+        if ((padding > 0 && fwrite(ZEROS, 1, padding, spool_) != padding) ||
+            fwrite(velocities, 1, velocity_bytes, spool_) != velocity_bytes) {
+            return false;
+        }
+        velocity_index_.push_back({spool_offset_ + padding, velocity_bytes});
+        spool_offset_ += padding + velocity_bytes;
+        index_.push_back(entry);
+        return true;
+    }
+
+    /*
+     * Copies the spooled velocity blocks behind the positions region and
+     * appends their index entries after the position entries. Called by
+     * finish() at an aligned offset.
+     */
+    bool appendVelocityRegion()
+    {
+        const std::uint64_t region_offset = offset_;
+        if (fflush(spool_) != 0 || fseek(spool_, 0, SEEK_SET) != 0) {
+            return false;
+        }
+        std::vector<unsigned char> chunk(SPOOL_COPY_BYTES);
+        std::uint64_t remaining = spool_offset_;
+        while (remaining > 0) {
+            const std::size_t bytes = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, chunk.size()));
+            if (fread(chunk.data(), 1, bytes, spool_) != bytes || !writeBytes(chunk.data(), bytes)) {
+                return false;
+            }
+            remaining -= bytes;
+        }
+        for (container::ContainerIndexEntry entry : velocity_index_) {
+            entry.offset += region_offset;
+            index_.push_back(entry);
+        }
+        return true;
+    }
+
+    void closeSpool()
+    {
+        if (spool_ != nullptr) {
+            fclose(spool_);
+            spool_ = nullptr;
+            std::remove(spool_path_.c_str());
+        }
+    }
+
+    /*
+     * Encodes a frame against the previous original frame, or on its own at
+     * a keyframe. The codec is lossless, so the previous original frame is
+     * exactly the frame the decoder will predict from.
+     */
+    bool appendPredictedFrame(const glm::vec4* positions, const glm::vec4* velocities, std::int64_t n)
+    {
+        const std::int64_t frame_number = static_cast<std::int64_t>(index_.size());
+        residual::PredictionBase base;
+        base.dt = header_.prediction_dt;
+        if (container::keyframeAtOrBefore(frame_number, header_.keyframe_interval) != frame_number) {
+            base.positions = previous_positions_.data();
+            base.velocities = velocities != nullptr ? previous_velocities_.data() : nullptr;
+        }
+        const std::vector<unsigned char> frame = residual::encodeFrame(base, positions, velocities, n);
+        previous_positions_.assign(positions, positions + n);
+        if (velocities != nullptr) {
+            previous_velocities_.assign(velocities, velocities + n);
+        }
+        return appendEncodedFrame(frame.data(), frame.size());
+    }
+
+    bool writeBytes(const void* bytes, std::uint64_t size)
+    {
+        if (size > 0 && fwrite(bytes, 1, size, file_) != size) {
+            return false;
+        }
+        offset_ += size;
+        return true;
+    }
+
+    bool padToAlignment()
+    {
+        static const unsigned char ZEROS[container::FRAME_ALIGNMENT] = {};
+        return writeBytes(ZEROS, container::alignUp(offset_) - offset_);
+    }
+
+    static constexpr std::uint64_t SPOOL_COPY_BYTES = 8ull * 1024 * 1024;
+
+    FILE* file_ = nullptr;
+    std::string path_;      // final name, given to open()
+    std::string temp_path_; // what file_ writes until finish()
+    container::ContainerHeader header_{};
+    std::vector<container::ContainerIndexEntry> index_;
+    bool separate_ = false;                                      // SeparateStreams with velocities
+    FILE* spool_ = nullptr;                                      // velocity blocks until finish()
+    std::string spool_path_;
+    std::uint64_t spool_offset_ = 0;
+    std::vector<container::ContainerIndexEntry> velocity_index_; // offsets relative to the spool
+    std::vector<unsigned char> encoded_;
+    std::vector<glm::vec4> previous_positions_;
+    std::vector<glm::vec4> previous_velocities_;
+    std::uint64_t offset_ = 0;
+};
+
+#endif // PARTICLE_VIEWER_DATA_CONTAINER_WRITER_H
@@ -0,0 +1,152 @@
+/*
+ * dataset_converter.hpp
+ *
+ * Converts a legacy PosAndVel blob (of floats, doubles or half floats), or a
+ * series of text snapshots, into a v2 container. Shared by the pv-convert
+ * command-line tool and the tests.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_DATASET_CONVERTER_H
+#define PARTICLE_VIEWER_DATA_DATASET_CONVERTER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "data/container_format.hpp"
+#include "data/container_writer.hpp"
+#include "data/element_codec.hpp"
+#include "data/frame_source.hpp"
+#include "data/mapped_file.hpp"
+#include "data/raw_frame_source.hpp"
+#include "data/text_importer.hpp"
+#include "data/thread_pool.hpp"
+
+struct ConversionResult
+{
+    bool ok = false;
+    std::int64_t frames = 0;
+    std::string error;
+};
+
+/*
+ * Streams every frame of `legacy_path` (N = particle_count) into a container
+ * at `output_path`. Float frames are encoded straight out of the mapping and
+ * double or half frames (`element_type`) through one converted frame, so
+ * memory use does not grow with the dataset. Quantized16 fails on frames
+ * whose w lane holds something other than a particle type code, or with a
+ * NaN or infinite coordinate.
+ * `prediction_dt` (Dt * RecordRate) and `keyframe_interval` only matter for
+ * PredictiveResidual. `layout` SeparateStreams moves the velocities out of
+ * the way of position-only playback; it cannot be combined with
+ * PredictiveResidual.
+ */
+inline ConversionResult convertLegacyDataset(const std::string& legacy_path, std::int64_t particle_count,
+                                             const std::string& output_path,
+                                             container::Encoding encoding = container::Encoding::Raw,
+                                             float prediction_dt = 0.0f,
+                                             std::uint32_t keyframe_interval = container::DEFAULT_KEYFRAME_INTERVAL,
+                                             container::StreamLayout layout = container::StreamLayout::FrameInterleaved,
+                                             ElementType element_type = ElementType::Float32)
+{
+    ConversionResult result;
+    MappedFile mapping;
+    if (!mapping.open(legacy_path)) {
+        result.error = "cannot open " + legacy_path;
+        return result;
+    }
+    std::unique_ptr<FrameSource> source = makeRawFrameSource(std::move(mapping), particle_count, element_type);
+    if (source->frameCount() == 0) {
+        result.error = "no complete frames in " + legacy_path + " for N=" + std::to_string(particle_count);
+        return result;
+    }
+
+    ContainerWriter writer;
+    if (!writer.open(output_path, particle_count, true, encoding, prediction_dt, keyframe_interval, layout)) {
+        result.error = "cannot create " + output_path;
+        return result;
+    }
+    std::vector<glm::vec4> converted;
+    for (std::int64_t frame = 0; frame < source->frameCount(); frame++) {
+        const glm::vec4* positions = source->mappedPositions(frame);
+        if (positions == nullptr) {
+            converted.resize(2 * static_cast<std::size_t>(particle_count));
+            if (!source->readPositions(frame, converted.data()) ||
+                !source->readVelocities(frame, converted.data() + particle_count)) {
+                result.error = "cannot read frame " + std::to_string(frame);
+                return result;
+            }
+            positions = converted.data();
+        }
+        if (!writer.appendFrame(positions, positions + particle_count)) {
+            result.error = "cannot encode or write frame " + std::to_string(frame);
+            return result;
+        }
+    }
+    if (!writer.finish()) {
+        result.error = "cannot finalize " + output_path;
+        return result;
+    }
+    result.ok = true;
+    result.frames = source->frameCount();
+    return result;
+}
+
+/*
+ * Writes the text snapshots at `snapshot_paths` (see text_importer.hpp) into a
+ * container at `output_path`, one frame per snapshot in the order given.
+ * Every snapshot must hold the same number of particles. Each file is parsed
+ * on `pool` (serially when it is nullptr); only one is held in memory at a
+ * time. Velocities are stored when `columns` maps them.
+ */
+inline ConversionResult convertTextSnapshots(const std::vector<std::string>& snapshot_paths,
+                                             const std::vector<text_import::Column>& columns,
+                                             const std::string& output_path, ThreadPool* pool,
+                                             container::Encoding encoding = container::Encoding::Raw,
+                                             float prediction_dt = 0.0f,
+                                             std::uint32_t keyframe_interval = container::DEFAULT_KEYFRAME_INTERVAL,
+                                             container::StreamLayout layout = container::StreamLayout::FrameInterleaved)
+{
+    ConversionResult result;
+    const bool velocities = text_import::hasVelocities(columns);
+    ContainerWriter writer;
+    text_import::Snapshot snapshot;
+    std::int64_t particle_count = 0;
+    for (const std::string& path : snapshot_paths) {
+        if (!text_import::load(path, columns, pool, snapshot, result.error)) {
+            return result;
+        }
+        const std::int64_t count = static_cast<std::int64_t>(snapshot.positions.size());
+        if (result.frames == 0) {
+            particle_count = count;
+            if (!writer.open(output_path, particle_count, velocities, encoding, prediction_dt, keyframe_interval,
+                             layout)) {
+                result.error = "cannot create " + output_path;
+                return result;
+            }
+        } else if (count != particle_count) {
+            result.error = path + ": " + std::to_string(count) + " particles, the first snapshot has " +
+                           std::to_string(particle_count);
+            return result;
+        }
+        if (!writer.appendFrame(snapshot.positions.data(), velocities ? snapshot.velocities.data() : nullptr)) {
+            result.error = "cannot encode or write " + path;
+            return result;
+        }
+        result.frames++;
+    }
+    if (result.frames == 0) {
+        result.error = "no snapshots given";
+        return result;
+    }
+    if (!writer.finish()) {
+        result.error = "cannot finalize " + output_path;
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
+
+#endif // PARTICLE_VIEWER_DATA_DATASET_CONVERTER_H
@@ -0,0 +1,174 @@
+/*
+ * element_codec.hpp
+ *
+ * Element types a raw PosAndVel can be written in, and their conversion to
+ * the float32 vec4 layout the renderer uploads. Some simulations record
+ * doubles, and half floats make a compact archive; each particle is still
+ * stored as x, y, z, w of one element type.
+ *
+ * Conversion is vectorized where the compiler targets it: AVX (or SSE2)
+ * narrows four (two) doubles per instruction and F16C widens halves. Double
+ * positions can be shifted by an origin before narrowing, so data far from
+ * the coordinate origin keeps its precision relative to that point (see
+ * BasicRawFrameSource::recenter()).
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_ELEMENT_CODEC_H
+#define PARTICLE_VIEWER_DATA_ELEMENT_CODEC_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#if defined(__AVX__) || defined(__F16C__)
+    #include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define PARTICLE_VIEWER_ELEMENT_SSE2 1
+#endif
+
+enum class ElementType
+{
+    Float32,
+    Float64,
+    Float16
+};
+
+/*
+ * An IEEE 754 binary16 value as stored on disk.
+ */
+struct Half
+{
+    std::uint16_t bits;
+};
+static_assert(sizeof(Half) == 2, "Half must stay 2 bytes on disk");
+
+namespace element
+{
+
+/*
+ * Parses "f32", "f64" or "f16" (also "float", "double", "half").
+ */
+inline bool parseType(const std::string& name, ElementType& type)
+{
+    if (name == "f32" || name == "float") {
+        type = ElementType::Float32;
+    } else if (name == "f64" || name == "double") {
+        type = ElementType::Float64;
+    } else if (name == "f16" || name == "half") {
+        type = ElementType::Float16;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Scalar binary16 -> binary32, exact for every input including subnormals,
+ * infinities and NaNs.
+ */
+inline float halfToFloat(std::uint16_t half)
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+    std::uint32_t exponent = (half >> 10) & 0x1Fu;
+    std::uint32_t mantissa = half & 0x3FFu;
+    std::uint32_t bits;
+    if (exponent == 0x1Fu) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: shift the mantissa up until its leading bit is the implicit one
+        exponent = 113;
+        while ((mantissa & 0x400u) == 0) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*
+ * Converts `count` particles of four `Element`s each to vec4s. `origin` is
+ * subtracted from x, y and z before narrowing; it only matters for doubles,
+ * the other types carry no more precision than the result.
+ */
+template <typename Element>
+void toVec4(const Element* source, std::int64_t count, const glm::dvec3& origin, glm::vec4* destination);
+
+template <>
+inline void toVec4<float>(const float* source, std::int64_t count, const glm::dvec3& origin, glm::vec4* destination)
+{
+    (void)origin;
+    std::memcpy(destination, source, static_cast<std::size_t>(count) * sizeof(glm::vec4));
+}
+
+template <>
+inline void toVec4<double>(const double* source, std::int64_t count, const glm::dvec3& origin, glm::vec4* destination)
+{
+    std::int64_t i = 0;
+#if defined(__AVX__)
+    // One particle per iteration: four doubles narrow to one vec4
+    float* out = &destination[0].x;
+    const __m256d shift = _mm256_setr_pd(origin.x, origin.y, origin.z, 0.0);
+    for (; i < count; i++) {
+        const __m256d particle = _mm256_sub_pd(_mm256_loadu_pd(source + 4 * i), shift);
+        _mm_storeu_ps(out + 4 * i, _mm256_cvtpd_ps(particle));
+    }
+#elif defined(PARTICLE_VIEWER_ELEMENT_SSE2)
+    float* out = &destination[0].x;
+    const __m128d shift_xy = _mm_setr_pd(origin.x, origin.y);
+    const __m128d shift_zw = _mm_setr_pd(origin.z, 0.0);
+    for (; i < count; i++) {
+        const __m128 xy = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(source + 4 * i), shift_xy));
+        const __m128 zw = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(source + 4 * i + 2), shift_zw));
+        _mm_storeu_ps(out + 4 * i, _mm_movelh_ps(xy, zw));
+    }
+#endif
+    for (; i < count; i++) {
+        const double* particle = source + 4 * i;
+        destination[i] = glm::vec4(static_cast<float>(particle[0] - origin.x),
+                                   static_cast<float>(particle[1] - origin.y),
+                                   static_cast<float>(particle[2] - origin.z), static_cast<float>(particle[3]));
+    }
+}
+
+template <>
+inline void toVec4<Half>(const Half* source, std::int64_t count, const glm::dvec3& origin, glm::vec4* destination)
+{
+    (void)origin;
+    std::int64_t i = 0;
+#if defined(__F16C__)
+    float* out = &destination[0].x;
+#endif
+#if defined(__F16C__) && defined(__AVX__)
+    // Two particles per iteration: eight halves widen to two vec4s
+    for (; i + 2 <= count; i += 2) {
+        const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i));
+        _mm256_storeu_ps(out + 4 * i, _mm256_cvtph_ps(halves));
+    }
+#endif
+#if defined(__F16C__)
+    for (; i < count; i++) {
+        const __m128i halves = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + 4 * i));
+        _mm_storeu_ps(out + 4 * i, _mm_cvtph_ps(halves));
+    }
+#endif
+    for (; i < count; i++) {
+        const Half* particle = source + 4 * i;
+        destination[i] = glm::vec4(halfToFloat(particle[0].bits), halfToFloat(particle[1].bits),
+                                   halfToFloat(particle[2].bits), halfToFloat(particle[3].bits));
+    }
+}
+
+} // namespace element
+
+#endif // PARTICLE_VIEWER_DATA_ELEMENT_CODEC_H
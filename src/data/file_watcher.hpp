@@ -0,0 +1,84 @@
+/*
+ * file_watcher.hpp
+ *
+ * Non-blocking change notification for a single file, used by follow mode to
+ * notice a simulator appending frames to PosAndVel.
+ *
+ * On Linux this is an inotify watch, so polling every render frame costs one
+ * read() that returns immediately. Elsewhere poll() always reports a possible
+ * change and the caller re-checks the file size itself, which is cheap too.
+ *
+ * Usage:
+ *   FileWatcher watcher(path);
+ *   if (watcher.poll()) {
+ *       // the file may have grown
+ *   }
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_FILE_WATCHER_H
+#define PARTICLE_VIEWER_DATA_FILE_WATCHER_H
+
+#include <string>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+class FileWatcher
+{
+  public:
+    explicit FileWatcher(const std::string& path)
+    {
+#ifdef __linux__
+        fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_ >= 0 && inotify_add_watch(fd_, path.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB) < 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#else
+        (void)path;
+#endif
+    }
+
+    ~FileWatcher()
+    {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    // Non-copyable: owns an inotify descriptor
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /*
+     * True if the file may have changed since the last poll. Drains all
+     * pending events; never blocks.
+     */
+    bool poll()
+    {
+#ifdef __linux__
+        if (fd_ < 0) {
+            return true; // watch could not be set up: let the caller re-check every time
+        }
+        bool changed = false;
+        alignas(inotify_event) char buffer[4096];
+        while (::read(fd_, buffer, sizeof(buffer)) > 0) {
+            changed = true;
+        }
+        return changed;
+#else
+        return true;
+#endif
+    }
+
+  private:
+#ifdef __linux__
+    int fd_ = -1;
+#endif
+};
+
+#endif // PARTICLE_VIEWER_DATA_FILE_WATCHER_H
@@ -0,0 +1,201 @@
+/*
+ * frame_cache.hpp
+ *
+ * In-RAM cache of recently visited frames, held compressed, so scrubbing back
+ * and forth over the same stretch of a run stops going back to disk.
+ *
+ * Frames are stored as lossless residuals (residual_codec.hpp) against an
+ * anchor frame kept uncompressed. Nearby frames differ in few bits, so a
+ * cached frame typically costs a small fraction of its raw size and a hit is
+ * one block-wise decode. When a new frame no longer compresses well against
+ * the current anchor it becomes the next anchor; an anchor is freed once the
+ * last frame encoded against it is evicted.
+ *
+ * Eviction is least-recently-used, driven by a byte budget that counts both
+ * the residuals and the anchors. All methods are thread-safe: the prefetch
+ * loader thread fills the cache while the render thread reads the counters.
+ *
+ * Usage:
+ *   FrameCache cache(n, 256ull * 1024 * 1024);
+ *   if (!cache.lookup(frame, destination) && source.readPositions(frame, destination)) {
+ *       cache.insert(frame, destination);
+ *   }
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_FRAME_CACHE_H
+#define PARTICLE_VIEWER_DATA_FRAME_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/residual_codec.hpp"
+
+struct FrameCacheStats
+{
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t bytes_held = 0;
+    std::uint64_t budget_bytes = 0;
+    std::int64_t frames_held = 0;
+};
+
+class FrameCache
+{
+  public:
+    // A frame that compresses worse than this against the current anchor starts a new anchor
+    static constexpr std::uint64_t MIN_ANCHOR_RATIO = 4;
+
+    FrameCache(std::int64_t particle_count, std::uint64_t budget_bytes)
+        : particle_count_(particle_count), budget_bytes_(budget_bytes)
+    {
+    }
+
+    // Non-copyable: holds a mutex
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    /*
+     * Decodes a cached frame into `destination` (particle_count elements) and
+     * marks it most recently used. Returns false on a miss.
+     */
+    bool lookup(std::int64_t frame, glm::vec4* destination)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = entries_.find(frame);
+        if (found == entries_.end()) {
+            misses_++;
+            return false;
+        }
+        lru_.splice(lru_.begin(), lru_, found->second);
+        const Entry& entry = *found->second;
+        residual::PredictionBase base;
+        base.positions = entry.anchor->positions.data();
+        if (!residual::decodeFrame(entry.residuals.data(), entry.residuals.size(), base, particle_count_,
+                                   destination, nullptr)) {
+            misses_++;
+            return false;
+        }
+        hits_++;
+        return true;
+    }
+
+    /*
+     * Compresses and stores `positions` (particle_count elements) for
+     * `frame`, evicting least recently used frames to stay within budget.
+     */
+    void insert(std::int64_t frame, const glm::vec4* positions)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.count(frame) != 0) {
+            return;
+        }
+        // Worst case a frame needs a fresh anchor plus its own residuals, both about raw size
+        const std::uint64_t raw_bytes = rawFrameBytes();
+        if (2 * raw_bytes > budget_bytes_ || particle_count_ > residual::maxParticles(false)) {
+            return;
+        }
+
+        Entry entry;
+        entry.frame = frame;
+        if (current_anchor_) {
+            entry.residuals = encodeAgainst(*current_anchor_, positions);
+        }
+        if (!current_anchor_ || entry.residuals.size() * MIN_ANCHOR_RATIO > raw_bytes) {
+            setCurrentAnchor(positions);
+            entry.residuals = encodeAgainst(*current_anchor_, positions);
+        }
+        entry.anchor = current_anchor_;
+        entry.anchor->users++;
+        bytes_held_ += entry.residuals.size();
+
+        lru_.push_front(std::move(entry));
+        entries_[frame] = lru_.begin();
+        evictToBudget();
+    }
+
+    FrameCacheStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FrameCacheStats stats;
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.bytes_held = bytes_held_;
+        stats.budget_bytes = budget_bytes_;
+        stats.frames_held = static_cast<std::int64_t>(entries_.size());
+        return stats;
+    }
+
+  private:
+    struct Anchor
+    {
+        std::vector<glm::vec4> positions;
+        int users = 0; // cached frames encoded against this anchor
+    };
+
+    struct Entry
+    {
+        std::int64_t frame = 0;
+        std::shared_ptr<Anchor> anchor;
+        std::vector<unsigned char> residuals;
+    };
+
+    std::uint64_t rawFrameBytes() const
+    {
+        return sizeof(glm::vec4) * static_cast<std::uint64_t>(particle_count_);
+    }
+
+    std::vector<unsigned char> encodeAgainst(const Anchor& anchor, const glm::vec4* positions) const
+    {
+        residual::PredictionBase base;
+        base.positions = anchor.positions.data();
+        return residual::encodeFrame(base, positions, nullptr, particle_count_);
+    }
+
+    void setCurrentAnchor(const glm::vec4* positions)
+    {
+        if (current_anchor_ && current_anchor_->users == 0) {
+            bytes_held_ -= rawFrameBytes();
+        }
+        current_anchor_ = std::make_shared<Anchor>();
+        current_anchor_->positions.assign(positions, positions + particle_count_);
+        bytes_held_ += rawFrameBytes();
+    }
+
+    /*
+     * Drops least recently used frames until the budget holds. The newest
+     * frame is never dropped.
+     */
+    void evictToBudget()
+    {
+        while (bytes_held_ > budget_bytes_ && lru_.size() > 1) {
+            Entry& victim = lru_.back();
+            bytes_held_ -= victim.residuals.size();
+            victim.anchor->users--;
+            if (victim.anchor->users == 0 && victim.anchor != current_anchor_) {
+                bytes_held_ -= rawFrameBytes();
+            }
+            entries_.erase(victim.frame);
+            lru_.pop_back();
+        }
+    }
+
+    std::int64_t particle_count_;
+    std::uint64_t budget_bytes_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_; // most recently used first
+    std::unordered_map<std::int64_t, std::list<Entry>::iterator> entries_;
+    std::shared_ptr<Anchor> current_anchor_;
+    std::uint64_t bytes_held_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+#endif // PARTICLE_VIEWER_DATA_FRAME_CACHE_H
@@ -0,0 +1,476 @@
+/*
+ * frame_prefetcher.hpp
+ *
+ * Background loader that keeps a fixed-size ring of decoded frames around the
+ * playhead, so disk stalls happen on a worker thread instead of the render loop.
+ *
+ * The loader reads frames in the current playback direction (forward while
+ * playing or holding E, backward while rewinding with Q / left arrow). The
+ * render thread only ever takes frames that are already resident.
+ *
+ * Usage:
+ *   FramePrefetcher prefetcher(n, frames, [&](std::int64_t frame, glm::vec4* dst) { ... }, config);
+ *   prefetcher.setPlayhead(cur_frame, +1);
+ *   if (const glm::vec4* data = prefetcher.acquire(cur_frame)) {
+ *       part->viewTranslations(n, data); // valid until the next successful acquire()
+ *   }
+ *
+ * With a BatchReader and PrefetchConfig::batch_frames > 1, the loader hands
+ * several wanted frames to the reader at once, so a source that can keep
+ * many reads in flight (io_uring) loads them together.
+ *
+ * Scrubbing: when the playhead moves by the same few frames on consecutive
+ * setPlayhead() calls (Q / E move by 3), the loader reads along that stride
+ * instead of every frame the playhead skips. Loads that fall out of the
+ * window when the playhead moves are cancelled through FrameRead::cancelled,
+ * and so are all loads when the playhead lands on a frame the ring does not
+ * hold, so the frame on screen is always read next.
+ *
+ * A failed read is retried after a growing backoff, MAX_READ_ATTEMPTS times in
+ * all. After that the frame counts as unreadable (hasFailed()) until it drops
+ * out of the ring, so the render loop can skip it instead of waiting for it.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_FRAME_PREFETCHER_H
+#define PARTICLE_VIEWER_DATA_FRAME_PREFETCHER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+
+/*
+ * Ring sizing. The effective depth is ring_depth, reduced until the ring fits
+ * in memory_budget_bytes, but never below MIN_RING_DEPTH: a budget smaller
+ * than that many frames is exceeded (see FramePrefetcher::fitsBudget()).
+ */
+struct PrefetchConfig
+{
+    static constexpr int MIN_RING_DEPTH = 2; // one frame on screen, one loading
+
+    int ring_depth = 8;
+    std::uint64_t memory_budget_bytes = 512ull * 1024 * 1024;
+    int batch_frames = 1; // frames handed to a BatchReader at once
+
+    /*
+     * The same config with the budget cut to part / whole of it, for rings
+     * that share one budget in proportion to their frame sizes.
+     */
+    PrefetchConfig share(std::uint64_t part, std::uint64_t whole) const
+    {
+        PrefetchConfig config = *this;
+        if (whole > 0 && part < whole) {
+            config.memory_budget_bytes = static_cast<std::uint64_t>(static_cast<long double>(memory_budget_bytes) *
+                                                                    part / whole);
+        }
+        return config;
+    }
+};
+
+class FramePrefetcher
+{
+  public:
+    /*
+     * Copies the positions of `frame` into `destination` (particle_count
+     * elements). Called on the loader thread; returns false on read failure.
+     */
+    using FrameReader = std::function<bool(std::int64_t frame, glm::vec4* destination)>;
+
+    /*
+     * Loads up to PrefetchConfig::batch_frames frames at once, setting
+     * FrameRead::ok for each. Called on the loader thread.
+     */
+    using BatchReader = std::function<void(FrameRead* reads, int count)>;
+
+    FramePrefetcher(std::int64_t particle_count, std::int64_t frame_count, FrameReader reader,
+                    const PrefetchConfig& config = {})
+        : FramePrefetcher(particle_count, frame_count, oneAtATime(std::move(reader)), config)
+    {
+    }
+
+    FramePrefetcher(std::int64_t particle_count, std::int64_t frame_count, BatchReader reader,
+                    const PrefetchConfig& config = {})
+        : frame_count_(frame_count), reader_(std::move(reader)), batch_frames_(std::max(config.batch_frames, 1))
+    {
+        int capacity = ringCapacity(config, sizeof(glm::vec4) * static_cast<std::uint64_t>(particle_count));
+        slots_.resize(capacity);
+        cancelled_ = std::vector<std::atomic<bool>>(capacity);
+        for (auto& slot : slots_) {
+            slot.data.resize(particle_count);
+        }
+        loader_ = std::thread(&FramePrefetcher::loaderLoop, this);
+    }
+
+    ~FramePrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        loader_.join();
+    }
+
+    // Non-copyable: owns a worker thread that refers back to this object
+    FramePrefetcher(const FramePrefetcher&) = delete;
+    FramePrefetcher& operator=(const FramePrefetcher&) = delete;
+
+    /*
+     * Moves the prefetch window. direction > 0 reads ahead, < 0 reads behind.
+     * Call once per displayed frame: the step since the last call is the
+     * scrub speed the loader predicts from.
+     */
+    void setPlayhead(std::int64_t frame, int direction)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            int new_direction = (direction < 0) ? -1 : 1;
+            if (frame == playhead_ && new_direction == direction_ && stride_ == 1) {
+                return;
+            }
+            // A step as long as the one before it, in the same direction, is a steady scrub
+            const std::int64_t step = (frame - playhead_) * new_direction;
+            const bool steady = new_direction == direction_ && step > 0 && last_step_ > 0;
+            const std::int64_t stride = steady ? std::min(step, last_step_) : 1;
+            stride_ = (stride <= MAX_SCRUB_STRIDE) ? stride : 1;
+            last_step_ = std::max<std::int64_t>(step, 0);
+            playhead_ = frame;
+            direction_ = new_direction;
+            cancelStaleLoads();
+        }
+        wake_.notify_one();
+    }
+
+    /*
+     * Frames between the loads the loader currently queues: 1 during
+     * playback, the predicted step while scrubbing.
+     */
+    std::int64_t scrubStride() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stride_;
+    }
+
+    /*
+     * Extends the loadable range after frames were appended (follow mode).
+     */
+    void setFrameCount(std::int64_t frame_count)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frame_count_ = frame_count;
+        }
+        wake_.notify_one();
+    }
+
+    /*
+     * Returns the frame's positions if it is resident, otherwise nullptr.
+     * A returned frame stays valid (and is never evicted) until a later
+     * acquire() returns a different frame.
+     */
+    const glm::vec4* acquire(std::int64_t frame)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < static_cast<int>(slots_.size()); i++) {
+            if (slots_[i].frame == frame && slots_[i].ready) {
+                pinned_slot_ = i;
+                wake_.notify_one(); // the previously pinned slot may now be reusable
+                return slots_[i].data.data();
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+     * True once every attempt to read `frame` has failed. The render loop
+     * should skip it: acquire() will not return it until it is evicted and
+     * wanted again, which starts a fresh round of attempts.
+     */
+    bool hasFailed(std::int64_t frame) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::any_of(slots_.begin(), slots_.end(), [frame](const Slot& s) {
+            return s.frame == frame && !s.loading && s.failures >= MAX_READ_ATTEMPTS;
+        });
+    }
+
+    /*
+     * Reads that failed since construction, retries included. Cancelled
+     * reads are not failures.
+     */
+    std::uint64_t failedReads() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failed_reads_;
+    }
+
+    /*
+     * Number of slots in the ring.
+     */
+    int capacity() const
+    {
+        return static_cast<int>(slots_.size());
+    }
+
+    /*
+     * Number of slots currently holding a fully loaded frame.
+     */
+    int readyCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return static_cast<int>(std::count_if(slots_.begin(), slots_.end(), [](const Slot& s) { return s.ready; }));
+    }
+
+    /*
+     * Ring depth after applying the memory budget.
+     */
+    static int ringCapacity(const PrefetchConfig& config, std::uint64_t frame_bytes)
+    {
+        std::uint64_t depth = static_cast<std::uint64_t>(std::max(config.ring_depth, PrefetchConfig::MIN_RING_DEPTH));
+        if (frame_bytes > 0) {
+            depth = std::min(depth, config.memory_budget_bytes / frame_bytes);
+        }
+        return static_cast<int>(std::max<std::uint64_t>(depth, PrefetchConfig::MIN_RING_DEPTH));
+    }
+
+    /*
+     * False if the budget cannot hold MIN_RING_DEPTH frames, in which case
+     * ringCapacity() allocates more than the budget.
+     */
+    static bool fitsBudget(const PrefetchConfig& config, std::uint64_t frame_bytes)
+    {
+        return frame_bytes == 0 || config.memory_budget_bytes / frame_bytes >= PrefetchConfig::MIN_RING_DEPTH;
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    // Steps longer than this are jumps, not a scrub the loader can follow
+    static constexpr std::int64_t MAX_SCRUB_STRIDE = 64;
+    // Reads of one frame before it counts as unreadable; each retry waits twice as long as the last
+    static constexpr int MAX_READ_ATTEMPTS = 3;
+    static constexpr std::chrono::milliseconds RETRY_BACKOFF{20};
+
+    struct Slot
+    {
+        std::int64_t frame = -1;    // -1 = empty; a failed read keeps its frame with ready == false
+        bool ready = false;
+        bool loading = false;
+        int failures = 0;           // failed reads of `frame` in a row
+        Clock::time_point retry_at; // earliest time a failed read of `frame` is tried again
+        std::vector<glm::vec4> data;
+    };
+
+    /*
+     * Adapts a per-frame reader to the batch interface.
+     */
+    static BatchReader oneAtATime(FrameReader reader)
+    {
+        return [reader = std::move(reader)](FrameRead* reads, int count) {
+            for (int i = 0; i < count; i++) {
+                reads[i].ok = reader(reads[i].frame, reads[i].destination);
+            }
+        };
+    }
+
+    void loaderLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::vector<FrameRead> batch;
+        std::vector<int> batch_slots;
+        while (!stop_) {
+            batch.clear();
+            batch_slots.clear();
+            const Clock::time_point now = Clock::now();
+            while (static_cast<int>(batch.size()) < batch_frames_) {
+                std::int64_t frame = nextWantedFrame(now);
+                int slot = (frame >= 0) ? slotFor(frame) : -1;
+                if (slot < 0) {
+                    break;
+                }
+                if (slots_[slot].frame != frame) {
+                    slots_[slot].failures = 0;
+                }
+                slots_[slot].frame = frame;
+                slots_[slot].ready = false;
+                slots_[slot].loading = true;
+                cancelled_[slot] = false;
+                batch.push_back({frame, slots_[slot].data.data(), false, &cancelled_[slot]});
+                batch_slots.push_back(slot);
+            }
+            if (batch.empty()) {
+                const Clock::time_point retry_at = nextRetry();
+                if (retry_at == Clock::time_point::max()) {
+                    wake_.wait(lock);
+                } else {
+                    wake_.wait_until(lock, retry_at);
+                }
+                continue;
+            }
+
+            lock.unlock();
+            reader_(batch.data(), static_cast<int>(batch.size()));
+            lock.lock();
+
+            for (std::size_t i = 0; i < batch.size(); i++) {
+                Slot& slot = slots_[batch_slots[i]];
+                slot.loading = false;
+                slot.ready = batch[i].ok;
+                if (batch[i].ok) {
+                    slot.failures = 0;
+                } else if (cancelled_[batch_slots[i]]) {
+                    slot.frame = -1; // not a failed read: free to load again when wanted
+                } else {
+                    failed_reads_++;
+                    slot.failures++;
+                    slot.retry_at = Clock::now() + RETRY_BACKOFF * (1 << (slot.failures - 1));
+                }
+            }
+        }
+    }
+
+    /*
+     * True if `frame` lies inside the window the loader tries to keep
+     * resident: the next capacity() - 1 frames along the scrub stride.
+     */
+    bool isWanted(std::int64_t frame) const
+    {
+        std::int64_t distance = (frame - playhead_) * direction_;
+        return distance >= 0 && distance % stride_ == 0 && distance / stride_ < capacity() - 1;
+    }
+
+    /*
+     * Raises the cancel flag of every load that is no longer wanted, and of
+     * all loads if the playhead's own frame is neither resident nor loading.
+     */
+    void cancelStaleLoads()
+    {
+        const std::int64_t playhead = playhead_;
+        const bool playhead_held =
+            std::any_of(slots_.begin(), slots_.end(), [playhead](const Slot& s) { return s.frame == playhead; });
+        for (int i = 0; i < capacity(); i++) {
+            if (slots_[i].loading && (!playhead_held || !isWanted(slots_[i].frame))) {
+                cancelled_[i] = true;
+            }
+        }
+    }
+
+    /*
+     * The closest frame along the scrub stride in the playback direction
+     * that is not resident or loading yet, or whose failed read is due for
+     * another attempt at `now`. -1 if the window is covered.
+     */
+    std::int64_t nextWantedFrame(Clock::time_point now) const
+    {
+        for (int step = 0; step < capacity() - 1; step++) {
+            std::int64_t frame = playhead_ + static_cast<std::int64_t>(step) * stride_ * direction_;
+            if (frame < 0 || frame >= frame_count_) {
+                break;
+            }
+            int held = heldSlot(frame);
+            if (held < 0 || retryDue(slots_[held], now)) {
+                return frame;
+            }
+        }
+        return -1;
+    }
+
+    /*
+     * The slot holding `frame`, or -1.
+     */
+    int heldSlot(std::int64_t frame) const
+    {
+        for (int i = 0; i < capacity(); i++) {
+            if (slots_[i].frame == frame) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    static bool retryDue(const Slot& slot, Clock::time_point now)
+    {
+        return !slot.ready && !slot.loading && slot.failures > 0 && slot.failures < MAX_READ_ATTEMPTS &&
+               slot.retry_at <= now;
+    }
+
+    /*
+     * Earliest pending retry of a wanted frame, or time_point::max() if none.
+     */
+    Clock::time_point nextRetry() const
+    {
+        Clock::time_point earliest = Clock::time_point::max();
+        for (const Slot& slot : slots_) {
+            if (slot.frame >= 0 && !slot.ready && !slot.loading && slot.failures > 0 &&
+                slot.failures < MAX_READ_ATTEMPTS && isWanted(slot.frame)) {
+                earliest = std::min(earliest, slot.retry_at);
+            }
+        }
+        return earliest;
+    }
+
+    /*
+     * The slot to load `frame` into: the one a failed read left it in, or a victim.
+     */
+    int slotFor(std::int64_t frame) const
+    {
+        int held = heldSlot(frame);
+        return (held >= 0) ? held : pickVictimSlot();
+    }
+
+    /*
+     * Picks a slot to load into: an empty one if possible, otherwise the
+     * unwanted frame farthest from the playhead. Never the pinned slot.
+     */
+    int pickVictimSlot() const
+    {
+        int victim = -1;
+        std::int64_t victim_distance = -1;
+        for (int i = 0; i < capacity(); i++) {
+            const Slot& slot = slots_[i];
+            if (i == pinned_slot_ || slot.loading) {
+                continue;
+            }
+            if (slot.frame < 0) {
+                return i;
+            }
+            if (isWanted(slot.frame)) {
+                continue;
+            }
+            std::int64_t distance = std::llabs(slot.frame - playhead_);
+            if (distance > victim_distance) {
+                victim = i;
+                victim_distance = distance;
+            }
+        }
+        return victim;
+    }
+
+    std::int64_t frame_count_;
+    BatchReader reader_;
+    int batch_frames_;
+    std::vector<Slot> slots_;
+    std::vector<std::atomic<bool>> cancelled_; // per slot; raised under mutex_, read by the source mid-load
+    std::int64_t playhead_ = 0;
+    int direction_ = 1;
+    std::int64_t stride_ = 1;    // frames between loads along the predicted scrub path
+    std::int64_t last_step_ = 0; // playhead step of the previous setPlayhead(), in the playback direction
+    int pinned_slot_ = -1;
+    std::uint64_t failed_reads_ = 0;
+    bool stop_ = false;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread loader_;
+};
+
+#endif // PARTICLE_VIEWER_DATA_FRAME_PREFETCHER_H
@@ -0,0 +1,248 @@
+/*
+ * frame_source.hpp
+ *
+ * Abstract reader for a dataset's per-frame particle data.
+ *
+ * A FrameSource knows how many particles and frames a dataset has and can
+ * decode any frame into caller-owned memory. Implementations exist for the
+ * legacy raw PosAndVel blob, the indexed v2 container, the shared-memory
+ * live feed and a manifest of several such files.
+ *
+ * All read methods are const and safe to call from several threads at once,
+ * so loader threads can share one source with the render thread.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_FRAME_SOURCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "data/page_advice.hpp"
+
+/*
+ * One frame of a batched read: the caller sets frame and destination, the
+ * source sets ok. The caller may raise *cancelled while the batch is in
+ * flight once it no longer needs the frame; the source then skips it, or
+ * stops between chunks, and sets ok to false.
+ */
+struct FrameRead
+{
+    std::int64_t frame;
+    glm::vec4* destination;
+    bool ok = false;
+    const std::atomic<bool>* cancelled = nullptr;
+};
+
+inline bool isCancelled(const FrameRead& read)
+{
+    return read.cancelled != nullptr && read.cancelled->load(std::memory_order_relaxed);
+}
+
+// Particles copied out of a mapping between checks for cancellation (4 MB)
+constexpr std::int64_t CANCEL_CHECK_PARTICLES = 1 << 18;
+
+/*
+ * Scrub previews keep every stride-th run of PREVIEW_RUN_PARTICLES
+ * consecutive particles. A run is 64 KB of positions: one efficient read, yet
+ * short enough that the runs kept are spread over the whole dataset.
+ */
+constexpr std::int64_t PREVIEW_RUN_PARTICLES = 4096;
+
+/*
+ * Calls body(first, count, packed) for each run a preview with `stride`
+ * keeps: `count` particles from `first`, packed at `packed` in the preview.
+ */
+template <typename Body>
+void forEachPreviewRun(std::int64_t particle_count, int stride, Body&& body)
+{
+    const std::int64_t step = PREVIEW_RUN_PARTICLES * std::max(stride, 1);
+    std::int64_t packed = 0;
+    for (std::int64_t first = 0; first < particle_count; first += step) {
+        const std::int64_t count = std::min(PREVIEW_RUN_PARTICLES, particle_count - first);
+        body(first, count, packed);
+        packed += count;
+    }
+}
+
+/*
+ * Particles in a preview with `stride`; stride 1 keeps them all.
+ */
+inline std::int64_t previewParticleCount(std::int64_t particle_count, int stride)
+{
+    std::int64_t total = 0;
+    forEachPreviewRun(particle_count, stride, [&total](std::int64_t, std::int64_t count, std::int64_t) {
+        total += count;
+    });
+    return total;
+}
+
+class FrameSource
+{
+  public:
+    virtual ~FrameSource() = default;
+
+    virtual std::int64_t particleCount() const = 0;
+    virtual std::int64_t frameCount() const = 0;
+
+    /*
+     * Decodes the positions of `frame` into `destination` (particleCount()
+     * elements). Returns false if the frame is out of range or unreadable.
+     */
+    virtual bool readPositions(std::int64_t frame, glm::vec4* destination) const = 0;
+
+    /*
+     * Same as readPositions() for velocities. Returns false if the dataset
+     * carries no velocities.
+     */
+    virtual bool readVelocities(std::int64_t frame, glm::vec4* destination) const = 0;
+
+    /*
+     * Decodes the positions of several frames. Sources that can keep many
+     * reads in flight (see uring_frame_source.hpp) issue them together; the
+     * default reads one frame after another, copying mapped frames a few MB
+     * at a time so a cancelled read stops early.
+     */
+    virtual void readPositionsBatch(FrameRead* reads, int count) const
+    {
+        for (int i = 0; i < count; i++) {
+            reads[i].ok = false;
+            if (isCancelled(reads[i])) {
+                continue;
+            }
+            // A live feed's slots are only safe to copy under their sequence counters
+            const glm::vec4* positions = isLive() ? nullptr : mappedPositions(reads[i].frame);
+            if (positions == nullptr) {
+                reads[i].ok = readPositions(reads[i].frame, reads[i].destination);
+                continue;
+            }
+            const std::int64_t n = particleCount();
+            std::int64_t copied = 0;
+            while (copied < n && !isCancelled(reads[i])) {
+                const std::int64_t chunk = std::min(CANCEL_CHECK_PARTICLES, n - copied);
+                std::copy(positions + copied, positions + copied + chunk, reads[i].destination + copied);
+                copied += chunk;
+            }
+            reads[i].ok = copied == n;
+        }
+    }
+
+    /*
+     * Decodes positions [first, first + count) of `frame` into `destination`
+     * (count elements). The default copies them out of mapped frames; sources
+     * that decode or read from a file override it to touch only that range.
+     * Returns false for a range outside the frame, or a source that cannot
+     * read part of a frame (a live feed).
+     */
+    virtual bool readPositionRange(std::int64_t frame, std::int64_t first, std::int64_t count,
+                                   glm::vec4* destination) const
+    {
+        const glm::vec4* positions = isLive() ? nullptr : mappedPositions(frame);
+        if (positions == nullptr || first < 0 || count < 0 || first + count > particleCount()) {
+            return false;
+        }
+        std::copy(positions + first, positions + first + count, destination);
+        return true;
+    }
+
+    /*
+     * Decodes a scrub preview of `frame`: the runs forEachPreviewRun() keeps,
+     * packed into `destination` (previewParticleCount() elements). Particles
+     * keep their w, so type colours stay right. The default reads each kept
+     * run with readPositionRange(), so neither the read nor any scratch
+     * buffer is ever a whole frame.
+     */
+    virtual bool readPreviewPositions(std::int64_t frame, int stride, glm::vec4* destination) const
+    {
+        bool ok = true;
+        forEachPreviewRun(particleCount(), stride, [&](std::int64_t first, std::int64_t count, std::int64_t packed) {
+            ok = ok && readPositionRange(frame, first, count, destination + packed);
+        });
+        return ok;
+    }
+
+    /*
+     * Zero-copy access to a frame's positions when they are stored as plain
+     * vec4s in mapped memory; nullptr when the frame has to be decoded.
+     * Velocities may be stored elsewhere (see StreamLayout); read them with
+     * readVelocities().
+     */
+    virtual const glm::vec4* mappedPositions(std::int64_t frame) const
+    {
+        (void)frame;
+        return nullptr;
+    }
+
+    /*
+     * Point the positions read from this source are relative to: (0, 0, 0)
+     * unless a raw double dataset was recentred (raw_frame_source.hpp).
+     * Absolute coordinates from elsewhere, such as the COMFile, subtract it.
+     */
+    virtual glm::dvec3 positionOrigin() const
+    {
+        return glm::dvec3(0.0);
+    }
+
+    /*
+     * Re-checks the data file for frames appended since it was opened and
+     * returns the new frame count. Only complete frames are counted. Sources
+     * that cannot grow return frameCount() unchanged. Call from one thread.
+     */
+    virtual std::int64_t refreshFrameCount()
+    {
+        return frameCount();
+    }
+
+    /*
+     * False for data that is complete once written, such as a converted
+     * container, which follow mode would watch in vain.
+     */
+    virtual bool canGrow() const
+    {
+        return true;
+    }
+
+    /*
+     * File follow mode watches for appended frames. Sources spread over
+     * several files (sharded_frame_source.hpp) name the one that grows; an
+     * empty string means the data file that was opened.
+     */
+    virtual std::string followPath() const
+    {
+        return {};
+    }
+
+    /*
+     * True for a feed a running simulation publishes into memory (see
+     * shm_frame_source.hpp): old frames are overwritten as new ones arrive,
+     * so only the newest few can be read and nothing is worth prefetching.
+     */
+    virtual bool isLive() const
+    {
+        return false;
+    }
+
+    /*
+     * Page-cache hint for `count` frames starting at `first`, issued by the
+     * streaming policy (page_cache_policy.hpp). Frames outside the dataset are
+     * ignored. Sources that do not read from a file ignore the hint.
+     */
+    virtual void adviseFrames(std::int64_t first, std::int64_t count, PageAdvice advice) const
+    {
+        (void)first;
+        (void)count;
+        (void)advice;
+    }
+
+    /*
+     * Stored size of one frame in bytes, for throughput reporting. Only the
+     * positions count when velocities are stored in a separate region.
+     */
+    virtual std::uint64_t storedFrameBytes(std::int64_t frame) const = 0;
+};
+
+#endif // PARTICLE_VIEWER_DATA_FRAME_SOURCE_H
@@ -0,0 +1,194 @@
+/*
+ * frame_source_factory.hpp
+ *
+ * Opens the right FrameSource for a data file: a v2 container when the file
+ * starts with the container magic, otherwise the legacy raw blob. A path of
+ * the form "shm:<name>" opens the live feed <name> instead, and a shard
+ * manifest (shard_manifest.hpp) opens each of its shards this way and joins
+ * them into one ShardedFrameSource. A text snapshot (.csv, .txt, ...) is
+ * parsed into a one-frame TextFrameSource.
+ *
+ * With FrameReadOptions::follow, raw blobs and containers are mapped with
+ * GROWTH_RESERVE_BYTES of address space to grow into while a simulation
+ * appends to them; otherwise the mapping covers just the file.
+ *
+ * Raw blobs are memory-mapped by default. FrameReadOptions picks another
+ * backend at runtime: io_uring batches (when the kernel allows io_uring,
+ * otherwise the next choice applies), or read_threads threads of concurrent
+ * positional reads, which pays off once single frames are hundreds of MB.
+ * Raw blobs written as doubles or half floats are always mapped and
+ * converted as they are read.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_FRAME_SOURCE_FACTORY_H
+#define PARTICLE_VIEWER_DATA_FRAME_SOURCE_FACTORY_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "data/container_format.hpp"
+#include "data/container_frame_source.hpp"
+#include "data/element_codec.hpp"
+#include "data/frame_source.hpp"
+#include "data/mapped_file.hpp"
+#include "data/pread_frame_source.hpp"
+#include "data/raw_frame_source.hpp"
+#include "data/shard_manifest.hpp"
+#include "data/sharded_frame_source.hpp"
+#include "data/shm_feed_format.hpp"
+#include "data/shm_frame_source.hpp"
+#include "data/text_frame_source.hpp"
+#include "data/text_importer.hpp"
+#include "data/uring_frame_source.hpp"
+
+// Address space reserved past the end of a data file so it can grow in follow mode (64-bit only)
+constexpr std::uint64_t GROWTH_RESERVE_BYTES = sizeof(void*) >= 8 ? (1ull << 40) : 0;
+
+/*
+ * How raw PosAndVel frames are stored and read, and which field of a text
+ * snapshot holds what. Containers and live feeds ignore it.
+ */
+struct FrameReadOptions
+{
+    unsigned read_threads = 0;                               // 0 maps the file; otherwise threads of positional reads
+    bool io_uring = false;                                   // batched io_uring reads; else the above where unavailable
+    ElementType element_type = ElementType::Float32;         // element type of a raw PosAndVel's vec4s
+    bool recenter = false;                                   // read double positions relative to frame 0's centre
+    std::string text_columns = text_import::DEFAULT_COLUMNS; // column map of text snapshots (see parseColumns)
+    bool follow = false; // map the file growable so follow mode sees appended frames
+};
+
+inline std::unique_ptr<FrameSource> openShardedFrameSource(const std::string& manifest_path,
+                                                           std::int64_t legacy_particle_count,
+                                                           const FrameReadOptions& options);
+
+/*
+ * The raw PosAndVel that `path` was converted from, when `path` is a run
+ * folder's container (container::DEFAULT_FILE_NAME) and that file exists;
+ * empty otherwise.
+ */
+inline std::string rawFileBeside(const std::string& path)
+{
+    const std::string name = container::DEFAULT_FILE_NAME;
+    if (path.size() < name.size() || path.compare(path.size() - name.size(), name.size(), name) != 0) {
+        return {};
+    }
+    const std::string raw_path = path.substr(0, path.size() - name.size()) + "/PosAndVel";
+    return std::ifstream(raw_path, std::ios::binary).good() ? raw_path : std::string();
+}
+
+/*
+ * Returns nullptr if the file cannot be mapped, is a malformed container or
+ * is a text snapshot that does not parse. A run folder's PosAndVel.pv2 that
+ * is malformed (e.g. a conversion that never finished) falls back to the
+ * PosAndVel beside it.
+ * `legacy_particle_count` (N from RunSetup) is only used for raw files; a
+ * container carries its own particle count.
+ */
+inline std::unique_ptr<FrameSource> openFrameSource(const std::string& path, std::int64_t legacy_particle_count,
+                                                    const FrameReadOptions& options = {})
+{
+    if (shm_feed::hasPathPrefix(path)) {
+        auto source = std::make_unique<ShmFrameSource>();
+        if (!source->open(path.substr(std::strlen(shm_feed::PATH_PREFIX)))) {
+            return nullptr;
+        }
+        return source;
+    }
+    if (shard_manifest::isManifestFile(path)) {
+        return openShardedFrameSource(path, legacy_particle_count, options);
+    }
+    if (text_import::isTextFile(path)) {
+        std::vector<text_import::Column> columns;
+        std::string error;
+        if (!text_import::parseColumns(options.text_columns, columns, error)) {
+            return nullptr;
+        }
+        auto source = std::make_unique<TextFrameSource>(path, columns);
+        if (!source->isValid()) {
+            return nullptr;
+        }
+        return source;
+    }
+    MappedFile mapping;
+    if (!(options.follow ? mapping.openGrowable(path, GROWTH_RESERVE_BYTES) : mapping.open(path))) {
+        return nullptr;
+    }
+    if (container::hasMagic(mapping.data(), mapping.size())) {
+        auto source = std::make_unique<ContainerFrameSource>(std::move(mapping));
+        if (!source->isValid()) {
+            // A converted PosAndVel.pv2 that does not validate still has its PosAndVel beside it
+            const std::string raw_path = rawFileBeside(path);
+            if (!raw_path.empty()) {
+                return openFrameSource(raw_path, legacy_particle_count, options);
+            }
+            return nullptr;
+        }
+        return source;
+    }
+    if (options.element_type != ElementType::Float32) {
+        return makeRawFrameSource(std::move(mapping), legacy_particle_count, options.element_type, options.recenter);
+    }
+    if (options.io_uring) {
+        auto source = std::make_unique<UringFrameSource>(path, legacy_particle_count);
+        if (source->isOpen()) {
+            return source;
+        }
+    }
+    if (options.read_threads > 0) {
+        auto source = std::make_unique<PreadFrameSource>(path, legacy_particle_count, options.read_threads);
+        if (!source->isOpen()) {
+            return nullptr;
+        }
+        return source;
+    }
+    return std::make_unique<RawFrameSource>(std::move(mapping), legacy_particle_count);
+}
+
+/*
+ * Opens every shard a manifest lists. Returns nullptr if the manifest does
+ * not parse, a shard does not open, or the shards do not fit together.
+ * Shards must be data files: live feeds and nested manifests are refused.
+ */
+inline std::unique_ptr<FrameSource> openShardedFrameSource(const std::string& manifest_path,
+                                                           std::int64_t legacy_particle_count,
+                                                           const FrameReadOptions& options)
+{
+    shard_manifest::Manifest manifest;
+    std::string error;
+    if (!shard_manifest::load(manifest_path, manifest, error)) {
+        return nullptr;
+    }
+    // Each shard would pick the centre of its own first frame
+    FrameReadOptions shard_options = options;
+    shard_options.recenter = false;
+    std::vector<std::unique_ptr<FrameSource>> shards;
+    std::vector<std::string> paths;
+    for (const shard_manifest::Shard& shard : manifest.shards) {
+        if (shm_feed::hasPathPrefix(shard.path) || shard_manifest::isManifestFile(shard.path)) {
+            return nullptr;
+        }
+        // Over time only the last shard is still being written; particle slices all grow together
+        shard_options.follow = options.follow && (manifest.layout == shard_manifest::Layout::Particles ||
+                                                  &shard == &manifest.shards.back());
+        const std::int64_t particle_count = shard.particle_count > 0 ? shard.particle_count : legacy_particle_count;
+        std::unique_ptr<FrameSource> source = openFrameSource(shard.path, particle_count, shard_options);
+        if (!source) {
+            return nullptr;
+        }
+        shards.push_back(std::move(source));
+        paths.push_back(shard.path);
+    }
+    auto source = std::make_unique<ShardedFrameSource>(manifest.layout, std::move(shards), std::move(paths));
+    if (!source->isValid()) {
+        return nullptr;
+    }
+    return source;
+}
+
+#endif // PARTICLE_VIEWER_DATA_FRAME_SOURCE_FACTORY_H
@@ -0,0 +1,401 @@
+/*
+ * frame_stats.hpp
+ *
+ * Per-frame statistics of a dataset: bounding box, centroid, particle counts
+ * per type and the number of particles with a NaN or Inf coordinate.
+ * FrameStatsIndex computes them for every frame in a background pass on a
+ * thread pool and persists them in a sidecar next to the data file
+ * ("<data>.stats"), so the next open of the same file reads them back
+ * instead of touching the frame data again.
+ *
+ * Sidecar layout (little-endian):
+ *
+ *   [StatsSidecarHeader, 48 bytes][FrameStats x F]
+ *
+ * The header records the data file's size and modification time; a sidecar
+ * that does not match the file any more is ignored and rebuilt.
+ *
+ * Usage:
+ *   FrameStatsIndex stats(source, data_path);
+ *   if (stats.isReady()) {
+ *       const FrameStats* frame = stats.frame(shown_frame);
+ *   }
+ *
+ * The source must outlive the index.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_FRAME_STATS_H
+#define PARTICLE_VIEWER_DATA_FRAME_STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+#include "data/thread_pool.hpp"
+
+namespace frame_stats
+{
+
+constexpr char MAGIC[8] = {'P', 'V', 'S', 'T', 'A', 'T', 'S', '\0'};
+constexpr std::uint32_t VERSION = 1;
+constexpr const char* SIDECAR_SUFFIX = ".stats";
+
+// Types 0-3 are the ones sphereVertex.vs colours; the last slot counts every other w value
+constexpr int TYPE_SLOTS = 5;
+
+// Frames one pool task handles, reading them in order
+constexpr std::int64_t CHUNK_FRAMES = 16;
+
+} // namespace frame_stats
+
+struct FrameStats
+{
+    glm::vec3 bounds_min; // over particles with finite coordinates
+    glm::vec3 bounds_max;
+    glm::vec3 centroid;
+    std::uint32_t padding;
+    std::int64_t type_counts[frame_stats::TYPE_SLOTS];
+    std::int64_t non_finite; // particles with a NaN or Inf coordinate
+
+    bool hasBounds() const
+    {
+        return bounds_min.x <= bounds_max.x;
+    }
+};
+static_assert(sizeof(FrameStats) == 88, "FrameStats must stay 88 bytes on disk");
+
+struct StatsSidecarHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t type_slots;
+    std::uint64_t particle_count;
+    std::uint64_t frame_count;
+    std::uint64_t data_bytes; // size of the data file the statistics describe
+    std::int64_t data_mtime;  // its modification time, in file-clock ticks
+};
+static_assert(sizeof(StatsSidecarHeader) == 48, "StatsSidecarHeader must stay 48 bytes on disk");
+
+namespace frame_stats
+{
+
+/*
+ * Statistics of one frame of `n` particles.
+ */
+inline FrameStats compute(const glm::vec4* positions, std::int64_t n)
+{
+    FrameStats stats{};
+    stats.bounds_min = glm::vec3(std::numeric_limits<float>::max());
+    stats.bounds_max = glm::vec3(std::numeric_limits<float>::lowest());
+    glm::dvec3 sum(0.0);
+    std::int64_t finite = 0;
+    for (std::int64_t i = 0; i < n; i++) {
+        const glm::vec4& p = positions[i];
+        const bool known_type = p.w >= 0.0f && p.w < static_cast<float>(TYPE_SLOTS - 1); // false for NaN too
+        stats.type_counts[known_type ? static_cast<int>(p.w) : TYPE_SLOTS - 1]++;
+        if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+            stats.non_finite++;
+            continue;
+        }
+        const glm::vec3 xyz(p);
+        stats.bounds_min = glm::min(stats.bounds_min, xyz);
+        stats.bounds_max = glm::max(stats.bounds_max, xyz);
+        sum += glm::dvec3(xyz);
+        finite++;
+    }
+    if (finite > 0) {
+        stats.centroid = glm::vec3(sum / static_cast<double>(finite));
+    }
+    return stats;
+}
+
+/*
+ * How much changed from one frame to the next: how far the centroid moved
+ * plus how much the bounding box grew or shrank. 0 when either frame has no
+ * finite particles.
+ */
+inline float activity(const FrameStats& previous, const FrameStats& current)
+{
+    if (!previous.hasBounds() || !current.hasBounds()) {
+        return 0.0f;
+    }
+    const float extent_change = std::fabs(glm::length(current.bounds_max - current.bounds_min) -
+                                          glm::length(previous.bounds_max - previous.bounds_min));
+    return glm::length(current.centroid - previous.centroid) + extent_change;
+}
+
+/*
+ * Activity over the whole run in `buckets` equal spans of frames, each the
+ * largest activity() inside its span, so a single busy frame still shows up
+ * on a timeline narrower than the frame count.
+ */
+inline std::vector<float> activityProfile(const std::vector<FrameStats>& frames, int buckets)
+{
+    std::vector<float> profile;
+    const std::int64_t count = static_cast<std::int64_t>(frames.size());
+    if (count < 2 || buckets <= 0) {
+        return profile;
+    }
+    const std::int64_t bucket_count = std::min<std::int64_t>(buckets, count - 1);
+    profile.assign(static_cast<std::size_t>(bucket_count), 0.0f);
+    for (std::int64_t frame = 1; frame < count; frame++) {
+        const std::int64_t bucket = (frame - 1) * bucket_count / (count - 1);
+        profile[bucket] = std::max(profile[bucket], activity(frames[frame - 1], frames[frame]));
+    }
+    return profile;
+}
+
+/*
+ * Size and modification time of the data file, which identify the data a
+ * sidecar was computed from. False if the file cannot be inspected.
+ */
+inline bool dataFileKey(const std::string& path, std::uint64_t& bytes, std::int64_t& mtime)
+{
+    std::error_code error;
+    bytes = static_cast<std::uint64_t>(std::filesystem::file_size(path, error));
+    if (error) {
+        return false;
+    }
+    const auto modified = std::filesystem::last_write_time(path, error);
+    mtime = static_cast<std::int64_t>(modified.time_since_epoch().count());
+    return !error;
+}
+
+/*
+ * Reads a sidecar for `data_path`. Fails if it is missing, malformed or was
+ * written for other data.
+ */
+inline bool loadSidecar(const std::string& data_path, std::int64_t particle_count, std::vector<FrameStats>& frames)
+{
+    std::uint64_t data_bytes = 0;
+    std::int64_t data_mtime = 0;
+    if (!dataFileKey(data_path, data_bytes, data_mtime)) {
+        return false;
+    }
+    std::FILE* file = std::fopen((data_path + SIDECAR_SUFFIX).c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    StatsSidecarHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+              header.type_slots == TYPE_SLOTS && header.particle_count == static_cast<std::uint64_t>(particle_count) &&
+              header.data_bytes == data_bytes && header.data_mtime == data_mtime;
+    // The data file bounds the frame count, so a corrupt header cannot ask for a huge allocation
+    ok = ok && header.frame_count <= data_bytes;
+    if (ok) {
+        frames.resize(static_cast<std::size_t>(header.frame_count));
+        ok = frames.empty() || std::fread(frames.data(), sizeof(FrameStats), frames.size(), file) == frames.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+/*
+ * Writes the sidecar for `data_path` (data_bytes / data_mtime as taken
+ * before the frames were read). Goes through a temporary file, so a reader
+ * never sees a half-written sidecar.
+ */
+inline bool saveSidecar(const std::string& data_path, std::uint64_t data_bytes, std::int64_t data_mtime,
+                        std::int64_t particle_count, const std::vector<FrameStats>& frames)
+{
+    StatsSidecarHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.type_slots = TYPE_SLOTS;
+    header.particle_count = static_cast<std::uint64_t>(particle_count);
+    header.frame_count = frames.size();
+    header.data_bytes = data_bytes;
+    header.data_mtime = data_mtime;
+
+    const std::string path = data_path + SIDECAR_SUFFIX;
+    const std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (frames.empty() || std::fwrite(frames.data(), sizeof(FrameStats), frames.size(), file) == frames.size());
+    ok = (std::fclose(file) == 0) && ok;
+    std::error_code error;
+    if (ok) {
+        std::filesystem::rename(temporary, path, error);
+    }
+    if (!ok || error) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace frame_stats
+
+class FrameStatsIndex
+{
+  public:
+    /*
+     * Loads the sidecar of `data_path`, or starts computing the statistics
+     * of every frame `source` has now on `thread_count` workers (0 = one per
+     * hardware thread). Frames appended later are not covered. Without
+     * `compute_missing` the index stays empty unless a sidecar exists.
+     */
+    FrameStatsIndex(const FrameSource* source, const std::string& data_path, unsigned thread_count = 0,
+                    bool compute_missing = true)
+        : source_(source), data_path_(data_path)
+    {
+        if (source_ == nullptr) {
+            return;
+        }
+        if (frame_stats::loadSidecar(data_path_, source_->particleCount(), frames_) &&
+            static_cast<std::int64_t>(frames_.size()) == source_->frameCount()) {
+            frames_done_ = static_cast<std::int64_t>(frames_.size());
+            from_sidecar_ = true;
+            ready_ = true;
+            return;
+        }
+        frames_.clear();
+        if (!compute_missing) {
+            return;
+        }
+        const std::int64_t frame_count = source_->frameCount();
+        keyed_ = frame_stats::dataFileKey(data_path_, data_bytes_, data_mtime_);
+        frames_.assign(static_cast<std::size_t>(frame_count), FrameStats{});
+        if (frame_count == 0) {
+            ready_ = true;
+            return;
+        }
+        chunks_left_ = (frame_count + frame_stats::CHUNK_FRAMES - 1) / frame_stats::CHUNK_FRAMES;
+        pool_ = std::make_unique<ThreadPool>(thread_count);
+        for (std::int64_t first = 0; first < frame_count; first += frame_stats::CHUNK_FRAMES) {
+            const std::int64_t end = std::min(first + frame_stats::CHUNK_FRAMES, frame_count);
+            pool_->submit([this, first, end] { computeChunk(first, end); });
+        }
+    }
+
+    ~FrameStatsIndex()
+    {
+        cancelled_ = true;
+        pool_.reset(); // queued chunks see the flag and return at once
+    }
+
+    // Non-copyable: pool tasks refer back to this object
+    FrameStatsIndex(const FrameStatsIndex&) = delete;
+    FrameStatsIndex& operator=(const FrameStatsIndex&) = delete;
+
+    /*
+     * True once every frame's statistics are available.
+     */
+    bool isReady() const
+    {
+        return ready_.load(std::memory_order_acquire);
+    }
+
+    bool loadedFromSidecar() const
+    {
+        return from_sidecar_;
+    }
+
+    /*
+     * True while the background pass is running.
+     */
+    bool isComputing() const
+    {
+        return pool_ != nullptr && !isReady();
+    }
+
+    std::int64_t framesDone() const
+    {
+        return frames_done_.load();
+    }
+
+    std::int64_t frameCount() const
+    {
+        return static_cast<std::int64_t>(frames_.size());
+    }
+
+    /*
+     * Statistics of `frame`, or nullptr before isReady() or for a frame the
+     * index does not cover.
+     */
+    const FrameStats* frame(std::int64_t frame) const
+    {
+        if (!isReady() || frame < 0 || frame >= frameCount()) {
+            return nullptr;
+        }
+        return &frames_[static_cast<std::size_t>(frame)];
+    }
+
+    /*
+     * Every frame's statistics; empty before isReady().
+     */
+    const std::vector<FrameStats>& frames() const
+    {
+        static const std::vector<FrameStats> NONE;
+        return isReady() ? frames_ : NONE;
+    }
+
+    /*
+     * Number of frames with at least one NaN or Inf coordinate; 0 before
+     * isReady().
+     */
+    std::int64_t nonFiniteFrames() const
+    {
+        return std::count_if(frames().begin(), frames().end(), [](const FrameStats& s) { return s.non_finite > 0; });
+    }
+
+  private:
+    void computeChunk(std::int64_t first, std::int64_t end)
+    {
+        const std::int64_t n = source_->particleCount();
+        std::vector<glm::vec4> scratch;
+        for (std::int64_t frame = first; frame < end && !cancelled_; frame++) {
+            const glm::vec4* positions = source_->mappedPositions(frame);
+            if (positions == nullptr) {
+                scratch.resize(static_cast<std::size_t>(n));
+                positions = source_->readPositions(frame, scratch.data()) ? scratch.data() : nullptr;
+            }
+            if (positions != nullptr) {
+                frames_[static_cast<std::size_t>(frame)] = frame_stats::compute(positions, n);
+            } else {
+                failed_ = true;
+            }
+            frames_done_++;
+        }
+        if (--chunks_left_ > 0 || cancelled_) {
+            return;
+        }
+        // Last chunk: publish, and persist unless a frame could not be read
+        if (keyed_ && !failed_) {
+            frame_stats::saveSidecar(data_path_, data_bytes_, data_mtime_, n, frames_);
+        }
+        ready_.store(true, std::memory_order_release);
+    }
+
+    const FrameSource* source_;
+    std::string data_path_;
+    std::vector<FrameStats> frames_; // sized up front; each pool task writes its own frames
+    bool from_sidecar_ = false;
+    bool keyed_ = false;
+    std::uint64_t data_bytes_ = 0;
+    std::int64_t data_mtime_ = 0;
+    std::atomic<bool> ready_{false};
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<std::int64_t> frames_done_{0};
+    std::atomic<std::int64_t> chunks_left_{0};
+    std::unique_ptr<ThreadPool> pool_; // declared last: joins before the state its tasks use goes
+};
+
+#endif // PARTICLE_VIEWER_DATA_FRAME_STATS_H
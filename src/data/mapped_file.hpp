@@ -0,0 +1,275 @@
+/*
+ * mapped_file.hpp
+ *
+ * Read-only memory mapping of a file on disk.
+ *
+ * Used by SettingsIO to keep a dataset's PosAndVel file mapped for the whole
+ * session, so reading a frame is pointer arithmetic instead of an
+ * open/seek/read/close round-trip.
+ *
+ * Usage:
+ *   MappedFile file("/path/to/PosAndVel");
+ *   if (file.isOpen()) {
+ *       const unsigned char* bytes = file.data();
+ *       std::uint64_t size = file.size();
+ *   }
+ *
+ * A file that is still being appended to can be opened with openGrowable():
+ * the mapping reserves address space past the end of the file, so
+ * refreshSize() picks up appended bytes without remapping and pointers into
+ * the mapping stay valid.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_MAPPED_FILE_H
+#define PARTICLE_VIEWER_DATA_MAPPED_FILE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "data/page_advice.hpp"
+
+/*
+ * RAII wrapper around a read-only file mapping (mmap on POSIX,
+ * CreateFileMapping on Windows). Movable, not copyable.
+ */
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path)
+    {
+        open(path);
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // Non-copyable: owns an OS file handle and mapping
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other) {
+            close();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    /*
+     * Maps the whole file read-only. Closes any previous mapping first.
+     * Returns false if the file cannot be opened. An empty file opens
+     * successfully with size() == 0 and data() == nullptr.
+     */
+    bool open(const std::string& path)
+    {
+        return openMapping(path, 0);
+    }
+
+    /*
+     * Like open(), but maps `reserve_bytes` (or the file size, if larger) so
+     * the file can grow into the mapping. Only the first size() bytes may be
+     * read. Falls back to a plain mapping where reserving is not possible
+     * (Windows, or the address space is exhausted); refreshSize() then never
+     * grows past the original size.
+     */
+    bool openGrowable(const std::string& path, std::uint64_t reserve_bytes)
+    {
+        return openMapping(path, reserve_bytes);
+    }
+
+    /*
+     * Re-reads the file size, capped to the mapped range, and returns it.
+     * Other threads may read size() meanwhile; data() is unaffected. Call
+     * from one thread.
+     */
+    std::uint64_t refreshSize()
+    {
+#ifndef _WIN32
+        struct stat file_stat;
+        if (fd_ >= 0 && data_ != nullptr && fstat(fd_, &file_stat) == 0) {
+            size_ = std::min(static_cast<std::uint64_t>(file_stat.st_size), mapped_bytes_);
+        }
+#endif
+        return size_.load();
+    }
+
+    /*
+     * Unmaps the file and releases the OS handles. Safe to call repeatedly.
+     */
+    void close()
+    {
+#ifdef _WIN32
+        if (data_ != nullptr) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_ != NULL) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+        mapping_ = NULL;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_ != nullptr) {
+            munmap(const_cast<unsigned char*>(data_), mapped_bytes_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        mapped_bytes_ = 0;
+        is_open_ = false;
+    }
+
+    bool isOpen() const
+    {
+        return is_open_;
+    }
+
+    const unsigned char* data() const
+    {
+        return data_;
+    }
+
+    std::uint64_t size() const
+    {
+        return size_;
+    }
+
+    /*
+     * Page-cache hint for a byte range of the file (see page_advice.hpp).
+     * The range is clipped to size(). A no-op on Windows.
+     */
+    void advise(std::uint64_t offset, std::uint64_t bytes, PageAdvice advice) const
+    {
+        const std::uint64_t size = size_.load();
+        if (offset >= size) {
+            return;
+        }
+#ifndef _WIN32
+        page_advice::adviseMapping(data_, fd_, offset, std::min(bytes, size - offset), advice);
+#else
+        (void)bytes;
+        (void)advice;
+#endif
+    }
+
+  private:
+    bool openMapping(const std::string& path, std::uint64_t reserve_bytes)
+    {
+        close();
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_, &file_size)) {
+            close();
+            return false;
+        }
+        size_ = static_cast<std::uint64_t>(file_size.QuadPart);
+        mapped_bytes_ = size_; // a mapping larger than the file would extend it on Windows
+        (void)reserve_bytes;
+        if (size_ > 0) {
+            mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping_ == NULL) {
+                close();
+                return false;
+            }
+            data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            if (data_ == nullptr) {
+                close();
+                return false;
+            }
+        }
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return false;
+        }
+        struct stat file_stat;
+        if (fstat(fd_, &file_stat) != 0) {
+            close();
+            return false;
+        }
+        size_ = static_cast<std::uint64_t>(file_stat.st_size);
+        mapped_bytes_ = std::max(size_.load(), reserve_bytes);
+        if (mapped_bytes_ > 0) {
+            // Pages past EOF are never touched: readers stay below size()
+            void* addr = mmap(nullptr, mapped_bytes_, PROT_READ, MAP_SHARED, fd_, 0);
+            if (addr == MAP_FAILED && mapped_bytes_ > size_) {
+                mapped_bytes_ = size_;
+                addr = (size_ > 0) ? mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0) : nullptr;
+            }
+            if (addr == MAP_FAILED) {
+                close();
+                return false;
+            }
+            data_ = static_cast<const unsigned char*>(addr);
+        }
+#endif
+        is_open_ = true;
+        return true;
+    }
+
+    void moveFrom(MappedFile& other)
+    {
+        data_ = other.data_;
+        size_ = other.size_.load();
+        mapped_bytes_ = other.mapped_bytes_;
+        is_open_ = other.is_open_;
+#ifdef _WIN32
+        file_ = other.file_;
+        mapping_ = other.mapping_;
+        other.file_ = INVALID_HANDLE_VALUE;
+        other.mapping_ = NULL;
+#else
+        fd_ = other.fd_;
+        other.fd_ = -1;
+#endif
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_bytes_ = 0;
+        other.is_open_ = false;
+    }
+
+    const unsigned char* data_ = nullptr;
+    std::atomic<std::uint64_t> size_{0}; // grows in refreshSize() while loader threads read it
+    std::uint64_t mapped_bytes_ = 0;     // size_ plus any reserved growth room
+    bool is_open_ = false;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = NULL;
+#else
+    int fd_ = -1;
+#endif
+};
+
+#endif // PARTICLE_VIEWER_DATA_MAPPED_FILE_H
@@ -0,0 +1,99 @@
+/*
+ * page_advice.hpp
+ *
+ * Page-cache hints for byte ranges of a data file, used by the streaming
+ * policy in page_cache_policy.hpp. WillNeed starts asynchronous readahead;
+ * DontNeed lets the kernel drop the range from the page cache (and, for a
+ * mapping, from this process's resident set), so playing a run larger than
+ * RAM does not evict everything else on the machine.
+ *
+ * Hints never change what a later read returns: dropped pages are simply
+ * read from disk again. Where the OS has no matching call they are no-ops.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_PAGE_ADVICE_H
+#define PARTICLE_VIEWER_DATA_PAGE_ADVICE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+enum class PageAdvice
+{
+    WillNeed,
+    DontNeed,
+};
+
+namespace page_advice
+{
+
+/*
+ * Hints `bytes` bytes at `offset` of the open file `fd`. posix_fadvise is
+ * Linux-only among the supported platforms; macOS gets fcntl(F_RDADVISE)
+ * for readahead.
+ */
+inline void adviseFile(int fd, std::uint64_t offset, std::uint64_t bytes, PageAdvice advice)
+{
+    if (fd < 0 || bytes == 0) {
+        return;
+    }
+#if defined(__linux__)
+    const int flag = (advice == PageAdvice::WillNeed) ? POSIX_FADV_WILLNEED : POSIX_FADV_DONTNEED;
+    posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(bytes), flag);
+#elif defined(__APPLE__)
+    if (advice == PageAdvice::WillNeed) {
+        radvisory hint;
+        hint.ra_offset = static_cast<off_t>(offset);
+        hint.ra_count = static_cast<int>(bytes > 0x7fffffff ? 0x7fffffff : bytes);
+        fcntl(fd, F_RDADVISE, &hint);
+    }
+#else
+    (void)offset;
+    (void)advice;
+#endif
+}
+
+/*
+ * Hints a range of a read-only shared mapping of `fd` that starts at file
+ * offset 0. DontNeed unmaps the range from this process first: the page
+ * cache never drops pages that are still mapped.
+ */
+inline void adviseMapping(const unsigned char* base, int fd, std::uint64_t offset, std::uint64_t bytes,
+                          PageAdvice advice)
+{
+#ifndef _WIN32
+    if (base == nullptr || bytes == 0) {
+        return;
+    }
+    const std::uint64_t page = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    std::uint64_t begin = offset / page * page;
+    std::uint64_t end = offset + bytes;
+    if (advice == PageAdvice::DontNeed) {
+        // Only whole pages inside the range: a boundary page is shared with the neighbouring frame
+        begin = (offset + page - 1) / page * page;
+        end = end / page * page;
+        if (end <= begin) {
+            return;
+        }
+    }
+    void* address = const_cast<unsigned char*>(base) + begin;
+    madvise(address, static_cast<std::size_t>(end - begin),
+            advice == PageAdvice::WillNeed ? MADV_WILLNEED : MADV_DONTNEED);
+    adviseFile(fd, begin, end - begin, advice);
+#else
+    (void)base;
+    (void)fd;
+    (void)offset;
+    (void)bytes;
+    (void)advice;
+#endif
+}
+
+} // namespace page_advice
+
+#endif // PARTICLE_VIEWER_DATA_PAGE_ADVICE_H
@@ -0,0 +1,189 @@
+/*
+ * page_cache_policy.hpp
+ *
+ * Streaming policy for playing a run larger than RAM straight through.
+ * Left alone, the kernel keeps every played frame in the page cache until the
+ * cache has pushed out everything else on the workstation. While playback is
+ * sequential, this policy asks for readahead of the next frames (WillNeed)
+ * and lets go of frames already played (DontNeed), keeping a couple behind
+ * the playhead for a quick step back.
+ *
+ * It switches itself: any jump, or a change of direction, is scrubbing, and
+ * the OS default applies until playback has been sequential for a few steps
+ * again. Nothing is dropped while scrubbing, since the user may come back.
+ *
+ * Usage:
+ *   PageCachePolicy policy(source);
+ *   policy.update(shown_frame); // once per frame put on screen
+ *
+ * DontNeed on hundreds of MB can take milliseconds, so by default the hints
+ * run on a worker thread of the policy. The source must outlive the policy.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_PAGE_CACHE_POLICY_H
+#define PARTICLE_VIEWER_DATA_PAGE_CACHE_POLICY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "data/frame_source.hpp"
+#include "data/page_advice.hpp"
+#include "data/thread_pool.hpp"
+
+struct PageCachePolicyConfig
+{
+    std::uint64_t readahead_bytes = 256ull * 1024 * 1024; // hinted ahead of the playhead, at least one frame
+    int keep_behind_frames = 2; // played frames left cached for stepping back
+    int max_step = 3;           // steps up to this many frames count as sequential (Q / E move by 3)
+    int streaming_after = 3;    // sequential steps in a row before streaming starts
+    bool background = true;     // issue hints on a worker thread instead of the caller's
+};
+
+struct PageCacheStats
+{
+    bool streaming = false;
+    std::uint64_t readahead_bytes = 0; // total hinted WillNeed
+    std::uint64_t dropped_bytes = 0;   // total hinted DontNeed
+};
+
+class PageCachePolicy
+{
+  public:
+    explicit PageCachePolicy(const FrameSource* source, const PageCachePolicyConfig& config = {})
+        : source_(source), config_(config)
+    {
+        if (config_.background) {
+            worker_ = std::make_unique<ThreadPool>(1);
+        }
+    }
+
+    // Non-copyable: queued hints refer to the source
+    PageCachePolicy(const PageCachePolicy&) = delete;
+    PageCachePolicy& operator=(const PageCachePolicy&) = delete;
+
+    /*
+     * Reports the frame now on screen. Call from one thread.
+     */
+    void update(std::int64_t frame)
+    {
+        if (frame == last_frame_ || source_ == nullptr) {
+            return;
+        }
+        const std::int64_t step = frame - last_frame_;
+        const int direction = (step > 0) ? 1 : -1;
+        const bool same_direction = direction_ == 0 || direction == direction_;
+        const bool sequential = last_frame_ >= 0 && same_direction && std::llabs(step) <= config_.max_step;
+        last_frame_ = frame;
+        if (!sequential) {
+            // Scrubbing: leave the cache to the OS until playback settles again
+            stats_.streaming = false;
+            direction_ = 0;
+            run_start_ = frame;
+            sequential_steps_ = 0;
+            return;
+        }
+        direction_ = direction;
+        if (++sequential_steps_ < config_.streaming_after) {
+            return;
+        }
+        if (!stats_.streaming) {
+            stats_.streaming = true;
+            const std::uint64_t frame_bytes = std::max<std::uint64_t>(source_->storedFrameBytes(frame), 1);
+            const std::uint64_t readahead_frames = std::max<std::uint64_t>(config_.readahead_bytes / frame_bytes, 1);
+            readahead_frames_ = static_cast<std::int64_t>(readahead_frames);
+            next_readahead_ = frame + direction_;
+            next_drop_ = run_start_;
+        }
+        if (direction_ > 0) {
+            streamForward(frame);
+        } else {
+            streamBackward(frame);
+        }
+    }
+
+    bool isStreaming() const
+    {
+        return stats_.streaming;
+    }
+
+    PageCacheStats stats() const
+    {
+        return stats_;
+    }
+
+  private:
+    void streamForward(std::int64_t frame)
+    {
+        const std::int64_t readahead_begin = std::max(next_readahead_, frame + 1);
+        const std::int64_t readahead_end = frame + 1 + readahead_frames_;
+        if (readahead_begin < readahead_end) {
+            advise(readahead_begin, readahead_end - readahead_begin, PageAdvice::WillNeed);
+            next_readahead_ = readahead_end;
+        }
+        const std::int64_t drop_end = frame - config_.keep_behind_frames;
+        if (next_drop_ < drop_end) {
+            advise(next_drop_, drop_end - next_drop_, PageAdvice::DontNeed);
+            next_drop_ = drop_end;
+        }
+    }
+
+    /*
+     * Mirror image of streamForward(): next_readahead_ and next_drop_ are the
+     * highest frames not yet hinted.
+     */
+    void streamBackward(std::int64_t frame)
+    {
+        const std::int64_t readahead_last = std::min(next_readahead_, frame - 1);
+        const std::int64_t readahead_first = std::max<std::int64_t>(frame - readahead_frames_, 0);
+        if (readahead_first <= readahead_last) {
+            advise(readahead_first, readahead_last - readahead_first + 1, PageAdvice::WillNeed);
+            next_readahead_ = readahead_first - 1;
+        }
+        const std::int64_t drop_first = frame + config_.keep_behind_frames + 1;
+        if (drop_first <= next_drop_) {
+            advise(drop_first, next_drop_ - drop_first + 1, PageAdvice::DontNeed);
+            next_drop_ = drop_first - 1;
+        }
+    }
+
+    /*
+     * Issues one hint, clipped to the frames that exist, and counts it.
+     */
+    void advise(std::int64_t first, std::int64_t count, PageAdvice advice)
+    {
+        const std::int64_t end = std::min(first + count, source_->frameCount());
+        first = std::max<std::int64_t>(first, 0);
+        if (first >= end) {
+            return;
+        }
+        count = end - first;
+        const std::uint64_t bytes = source_->storedFrameBytes(first) * static_cast<std::uint64_t>(count);
+        if (advice == PageAdvice::WillNeed) {
+            stats_.readahead_bytes += bytes;
+        } else {
+            stats_.dropped_bytes += bytes;
+        }
+        const FrameSource* source = source_;
+        if (worker_) {
+            worker_->submit([source, first, count, advice] { source->adviseFrames(first, count, advice); });
+        } else {
+            source->adviseFrames(first, count, advice);
+        }
+    }
+
+    const FrameSource* source_;
+    PageCachePolicyConfig config_;
+    PageCacheStats stats_;
+    std::int64_t last_frame_ = -1;
+    int direction_ = 0;                  // 0 until the first step after a jump
+    std::int64_t run_start_ = 0;         // first frame of the current sequential run
+    int sequential_steps_ = 0;
+    std::int64_t readahead_frames_ = 1;  // readahead_bytes in whole frames
+    std::int64_t next_readahead_ = 0;    // next frame to hint WillNeed, in playback direction
+    std::int64_t next_drop_ = 0;         // next played frame to hint DontNeed, in playback direction
+    std::unique_ptr<ThreadPool> worker_; // declared last: finishes queued hints before anything else goes
+};
+
+#endif // PARTICLE_VIEWER_DATA_PAGE_CACHE_POLICY_H
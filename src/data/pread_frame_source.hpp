@@ -0,0 +1,192 @@
+/*
+ * pread_frame_source.hpp
+ *
+ * FrameSource over the legacy PosAndVel blob that reads each frame with
+ * concurrent positional reads (see parallel_file_reader.hpp) instead of
+ * copying it out of a memory mapping. With tens of millions of particles a
+ * frame is hundreds of MB, and faulting it in through the mapping runs on one
+ * thread; spreading the read over a few workers keeps a fast drive busy.
+ *
+ * Frames are not mapped, so mappedPositions() is always nullptr and the
+ * viewer decodes into its own buffers. The frame count is taken from the file
+ * size and, like RawFrameSource, grows in follow mode.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_PREAD_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_PREAD_FRAME_SOURCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+#include "data/parallel_file_reader.hpp"
+#include "data/thread_pool.hpp"
+
+class PreadFrameSource : public FrameSource
+{
+  public:
+    /*
+     * `read_threads` workers read each frame; 1 reads it on the calling
+     * thread. isOpen() is false if the file cannot be opened.
+     */
+    PreadFrameSource(const std::string& path, std::int64_t particle_count, unsigned read_threads,
+                     std::uint64_t chunk_bytes = ParallelFileReader::DEFAULT_CHUNK_BYTES)
+        : file_(chunk_bytes), particle_count_(particle_count)
+    {
+        if (!file_.open(path) || particle_count_ <= 0) {
+            file_.close();
+            return;
+        }
+        if (read_threads > 1) {
+            pool_ = std::make_unique<ThreadPool>(read_threads);
+        }
+        refreshFrameCount();
+    }
+
+    bool isOpen() const
+    {
+        return file_.isOpen();
+    }
+
+    unsigned readThreads() const
+    {
+        return pool_ ? pool_->size() : 1;
+    }
+
+    std::int64_t refreshFrameCount() override
+    {
+        if (file_.isOpen()) {
+            frame_count_ = static_cast<std::int64_t>(file_.size() / frameBytes());
+        }
+        return frame_count_;
+    }
+
+    std::int64_t particleCount() const override
+    {
+        return particle_count_;
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return frame_count_;
+    }
+
+    bool readPositions(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return readStream(frame, 0, destination);
+    }
+
+    bool readVelocities(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return readStream(frame, 1, destination);
+    }
+
+    bool readPositionRange(std::int64_t frame, std::int64_t first, std::int64_t count,
+                           glm::vec4* destination) const override
+    {
+        if (frame < 0 || frame >= frame_count_.load() || first < 0 || count < 0 || first + count > particle_count_) {
+            return false;
+        }
+        const std::uint64_t offset =
+            static_cast<std::uint64_t>(frame) * frameBytes() + sizeof(glm::vec4) * static_cast<std::uint64_t>(first);
+        return file_.read(offset, sizeof(glm::vec4) * static_cast<std::uint64_t>(count), destination, pool_.get());
+    }
+
+    /*
+     * Frames are read one after another, each spread over the read threads;
+     * a cancelled frame stops at the next chunk.
+     */
+    void readPositionsBatch(FrameRead* reads, int count) const override
+    {
+        for (int i = 0; i < count; i++) {
+            reads[i].ok =
+                !isCancelled(reads[i]) && readStream(reads[i].frame, 0, reads[i].destination, reads[i].cancelled);
+        }
+    }
+
+    /*
+     * One positional read per kept run, spread over the read threads, so a
+     * preview only reads the runs it keeps.
+     */
+    bool readPreviewPositions(std::int64_t frame, int stride, glm::vec4* destination) const override
+    {
+        if (frame < 0 || frame >= frame_count_.load()) {
+            return false;
+        }
+        const std::uint64_t positions = static_cast<std::uint64_t>(frame) * frameBytes();
+        std::vector<std::int64_t> runs;
+        forEachPreviewRun(particle_count_, stride, [&runs](std::int64_t first, std::int64_t, std::int64_t) {
+            runs.push_back(first);
+        });
+        std::atomic<bool> ok{true};
+        auto read_run = [&](std::int64_t r) {
+            const std::int64_t first = runs[r];
+            const std::int64_t count = std::min(PREVIEW_RUN_PARTICLES, particle_count_ - first);
+            const std::uint64_t offset = positions + sizeof(glm::vec4) * static_cast<std::uint64_t>(first);
+            if (!file_.read(offset, sizeof(glm::vec4) * count, destination + r * PREVIEW_RUN_PARTICLES, nullptr)) {
+                ok = false;
+            }
+        };
+        if (pool_) {
+            pool_->parallelFor(0, static_cast<std::int64_t>(runs.size()), read_run);
+        } else {
+            for (std::int64_t r = 0; r < static_cast<std::int64_t>(runs.size()); r++) {
+                read_run(r);
+            }
+        }
+        return ok;
+    }
+
+    void adviseFrames(std::int64_t first, std::int64_t count, PageAdvice advice) const override
+    {
+        const std::int64_t begin = std::max<std::int64_t>(first, 0);
+        const std::int64_t end = std::min(first + count, frame_count_.load());
+        if (begin < end) {
+            file_.advise(static_cast<std::uint64_t>(begin) * frameBytes(),
+                         static_cast<std::uint64_t>(end - begin) * frameBytes(), advice);
+        }
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t frame) const override
+    {
+        (void)frame;
+        return frameBytes();
+    }
+
+  private:
+    std::uint64_t streamBytes() const
+    {
+        return sizeof(glm::vec4) * static_cast<std::uint64_t>(particle_count_);
+    }
+
+    std::uint64_t frameBytes() const
+    {
+        return 2 * streamBytes();
+    }
+
+    /*
+     * Reads one stream (0 = positions, 1 = velocities) of `frame`.
+     */
+    bool readStream(std::int64_t frame, int stream, glm::vec4* destination,
+                    const std::atomic<bool>* cancelled = nullptr) const
+    {
+        if (frame < 0 || frame >= frame_count_.load()) {
+            return false;
+        }
+        const std::uint64_t offset = static_cast<std::uint64_t>(frame) * frameBytes() + stream * streamBytes();
+        return file_.read(offset, streamBytes(), destination, pool_.get(), cancelled);
+    }
+
+    ParallelFileReader file_;
+    std::int64_t particle_count_;
+    std::unique_ptr<ThreadPool> pool_; // null for single-threaded reads
+    std::atomic<std::int64_t> frame_count_{0}; // grows under readers on other threads in follow mode
+};
+
+#endif // PARTICLE_VIEWER_DATA_PREAD_FRAME_SOURCE_H
@@ -0,0 +1,60 @@
+/*
+ * process_memory.hpp
+ *
+ * Resident set size of the viewer process, shown in the debug overlay next
+ * to the streaming counters. Pages of a mapped data file count while they
+ * are mapped in, so this is where the page-cache policy's drops show up.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_PROCESS_MEMORY_H
+#define PARTICLE_VIEWER_DATA_PROCESS_MEMORY_H
+
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#elif defined(__APPLE__)
+    #include <mach/mach.h>
+#else
+    #include <unistd.h>
+#endif
+
+/*
+ * Bytes of this process currently resident in RAM, or 0 if unknown.
+ */
+inline std::uint64_t residentSetBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<std::uint64_t>(counters.WorkingSetSize);
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+        KERN_SUCCESS) {
+        return static_cast<std::uint64_t>(info.resident_size);
+    }
+    return 0;
+#else
+    // Second field of statm: resident pages
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return 0;
+    }
+    unsigned long long total_pages = 0;
+    unsigned long long resident_pages = 0;
+    const int fields = std::fscanf(statm, "%llu %llu", &total_pages, &resident_pages);
+    std::fclose(statm);
+    if (fields != 2) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(resident_pages) * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+#endif // PARTICLE_VIEWER_DATA_PROCESS_MEMORY_H
@@ -0,0 +1,269 @@
+/*
+ * quantized_codec.hpp
+ *
+ * 16-bit fixed-point encoding for particle frames (container Encoding::Quantized16).
+ *
+ * A block stores xyz relative to the frame's bounding box as three planes of
+ * uint16 and, for positions, the type code from the w lane as one byte per
+ * particle:
+ *
+ *   [QuantizedBlockHeader, 32 bytes][x: u16 * N][y: u16 * N][z: u16 * N][type: u8 * N]  (padded to 16)
+ *
+ * That is 7 bytes per particle instead of 16 (about 2.3x smaller) on disk, so
+ * a run takes that much less storage, page cache and read bandwidth. Frames
+ * are decoded to vec4 as they are read, straight into the prefetch slot, so
+ * the prefetch ring, the frame cache (which compresses on its own, see
+ * frame_cache.hpp) and the upload to the GPU still carry 16 bytes per
+ * particle: the vertex shader reads vec4 positions, and decoding at upload
+ * would move this work onto the render thread.
+ *
+ * Error bound: each axis is split into 65535 steps across the frame's extent,
+ * so quantizing moves a coordinate by at most half a step. On top of that the
+ * encoder and decoder round in float32 (unit roundoff u = 2^-24): a few
+ * roundings of values no larger than the extent while scaling, and one of
+ * origin + q * step, whose size is that of the coordinate itself. Per axis:
+ *
+ *   |error| <= extent / 131070 + 8u * extent + u * (|origin| + extent)
+ *
+ * For a frame 1000 units across around the origin that is 0.0082 units per
+ * axis (0.014 overall), about 1.4% of the radius of a particle with radius 1.
+ * The last term only matters for boxes far from the origin, where float32
+ * spacing rather than the 16-bit grid limits precision: for a box 100 units
+ * across centred at 3 * 10^4 it adds 0.0018 units to the 0.0008 of the grid.
+ * maxPositionError() returns the bound for an encoded block; divide it by the
+ * sphere radius (in data units) to get the relative error.
+ *
+ * Type codes 0-254 are stored exactly and 500 (the default-cube marker read by
+ * sphereVertex.vs) is stored as 255. Frames with other w values cannot be
+ * quantized; canEncodeTypes() checks this up front.
+ *
+ * The grid has no code for NaN or infinity: such a coordinate would decode as
+ * a point inside the box, and the frame statistics could no longer flag it.
+ * Frames with non-finite coordinates are refused instead (allFinite()).
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_QUANTIZED_CODEC_H
+#define PARTICLE_VIEWER_DATA_QUANTIZED_CODEC_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define PARTICLE_VIEWER_QUANTIZED_SSE2 1
+#endif
+
+namespace quantized
+{
+
+#ifdef PARTICLE_VIEWER_QUANTIZED_SSE2
+/*
+ * Loads four uint16 values and converts them to floats.
+ */
+inline __m128 widenFour(const std::uint16_t* values)
+{
+    const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, _mm_setzero_si128()));
+}
+#endif
+
+constexpr float STEPS = 65535.0f;
+constexpr std::uint8_t DEFAULT_CUBE_TYPE_BYTE = 255;
+constexpr float DEFAULT_CUBE_TYPE = 500.0f;
+
+struct QuantizedBlockHeader
+{
+    float origin[3];
+    float step[3]; // extent / STEPS per axis; 0 for a flat axis
+    std::uint32_t reserved[2];
+};
+static_assert(sizeof(QuantizedBlockHeader) == 32, "QuantizedBlockHeader must stay 32 bytes on disk");
+
+/*
+ * Encoded size of one block of n particles, padded to 16 bytes.
+ */
+inline std::uint64_t blockBytes(std::int64_t n, bool with_type)
+{
+    const std::uint64_t count = static_cast<std::uint64_t>(n);
+    const std::uint64_t payload = sizeof(QuantizedBlockHeader) + count * 3 * sizeof(std::uint16_t) +
+                                  (with_type ? count : 0);
+    return (payload + 15) / 16 * 16;
+}
+
+/*
+ * True if every w value survives the one-byte type encoding.
+ */
+inline bool canEncodeTypes(const glm::vec4* source, std::int64_t n)
+{
+    for (std::int64_t i = 0; i < n; i++) {
+        const float w = source[i].w;
+        const bool small_code = w >= 0.0f && w < 255.0f && w == std::floor(w);
+        if (!small_code && w != DEFAULT_CUBE_TYPE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * True if every x, y and z is finite, i.e. the frame can be quantized
+ * without hiding a blow-up.
+ */
+inline bool allFinite(const glm::vec4* source, std::int64_t n)
+{
+    for (std::int64_t i = 0; i < n; i++) {
+        if (!std::isfinite(source[i].x) || !std::isfinite(source[i].y) || !std::isfinite(source[i].z)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Encodes n particles into `destination` (blockBytes(n, with_type) bytes).
+ * With with_type == false the w lane is dropped (velocities).
+ */
+inline void encodeBlock(const glm::vec4* source, std::int64_t n, bool with_type, unsigned char* destination)
+{
+    QuantizedBlockHeader header{};
+    float inverse_step[3] = {0.0f, 0.0f, 0.0f};
+    for (int axis = 0; axis < 3; axis++) {
+        float low = 0.0f;
+        float high = 0.0f;
+        bool any = false;
+        for (std::int64_t i = 0; i < n; i++) {
+            const float v = source[i][axis];
+            if (std::isfinite(v)) {
+                low = any ? std::min(low, v) : v;
+                high = any ? std::max(high, v) : v;
+                any = true;
+            }
+        }
+        header.origin[axis] = low;
+        header.step[axis] = (high - low) / STEPS;
+        inverse_step[axis] = (high > low) ? STEPS / (high - low) : 0.0f;
+    }
+    std::memset(destination, 0, blockBytes(n, with_type));
+    std::memcpy(destination, &header, sizeof(header));
+
+    unsigned char* planes = destination + sizeof(header);
+    for (int axis = 0; axis < 3; axis++) {
+        std::uint16_t* plane = reinterpret_cast<std::uint16_t*>(planes) + static_cast<std::uint64_t>(axis) * n;
+        for (std::int64_t i = 0; i < n; i++) {
+            const float scaled = (source[i][axis] - header.origin[axis]) * inverse_step[axis];
+            // Non-finite inputs collapse to the box origin instead of wrapping
+            const float clamped = std::isfinite(scaled) ? std::min(std::max(scaled, 0.0f), STEPS) : 0.0f;
+            plane[i] = static_cast<std::uint16_t>(std::lround(clamped));
+        }
+    }
+    if (with_type) {
+        unsigned char* types = planes + static_cast<std::uint64_t>(n) * 3 * sizeof(std::uint16_t);
+        for (std::int64_t i = 0; i < n; i++) {
+            const float w = source[i].w;
+            types[i] = (w == DEFAULT_CUBE_TYPE) ? DEFAULT_CUBE_TYPE_BYTE : static_cast<std::uint8_t>(w);
+        }
+    }
+}
+
+/*
+ * Decodes particles [first, first + count) of a block of n particles into
+ * `destination` (count vec4s). Without a type plane w is 0. Returns false if
+ * `size` is too small for n particles or the range is outside the block.
+ */
+inline bool decodeRange(const unsigned char* source, std::uint64_t size, std::int64_t n, bool with_type,
+                        std::int64_t first, std::int64_t count, glm::vec4* destination)
+{
+    if (size < blockBytes(n, with_type) || first < 0 || count < 0 || first + count > n) {
+        return false;
+    }
+    QuantizedBlockHeader header;
+    std::memcpy(&header, source, sizeof(header));
+    const std::uint16_t* planes = reinterpret_cast<const std::uint16_t*>(source + sizeof(header));
+    const std::uint16_t* xs = planes + first;
+    const std::uint16_t* ys = planes + n + first;
+    const std::uint16_t* zs = planes + 2 * n + first;
+    const std::uint8_t* types = with_type ? reinterpret_cast<const std::uint8_t*>(planes + 3 * n) + first : nullptr;
+
+    std::int64_t i = 0;
+#ifdef PARTICLE_VIEWER_QUANTIZED_SSE2
+    // Four particles per iteration: widen u16 -> i32 -> float, scale and offset
+    // each plane, then transpose the xyzw planes into four vec4s
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 origin_x = _mm_set1_ps(header.origin[0]);
+    const __m128 origin_y = _mm_set1_ps(header.origin[1]);
+    const __m128 origin_z = _mm_set1_ps(header.origin[2]);
+    const __m128 step_x = _mm_set1_ps(header.step[0]);
+    const __m128 step_y = _mm_set1_ps(header.step[1]);
+    const __m128 step_z = _mm_set1_ps(header.step[2]);
+    const __m128 cube_byte = _mm_set1_ps(static_cast<float>(DEFAULT_CUBE_TYPE_BYTE));
+    const __m128 cube_type = _mm_set1_ps(DEFAULT_CUBE_TYPE);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_add_ps(origin_x, _mm_mul_ps(widenFour(xs + i), step_x));
+        __m128 y = _mm_add_ps(origin_y, _mm_mul_ps(widenFour(ys + i), step_y));
+        __m128 z = _mm_add_ps(origin_z, _mm_mul_ps(widenFour(zs + i), step_z));
+        __m128 w = _mm_setzero_ps();
+        if (types != nullptr) {
+            std::int32_t packed;
+            std::memcpy(&packed, types + i, sizeof(packed));
+            const __m128i bytes = _mm_cvtsi32_si128(packed);
+            w = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+            const __m128 is_cube = _mm_cmpeq_ps(w, cube_byte);
+            w = _mm_or_ps(_mm_and_ps(is_cube, cube_type), _mm_andnot_ps(is_cube, w));
+        }
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        float* out = &destination[i].x;
+        _mm_storeu_ps(out, x);
+        _mm_storeu_ps(out + 4, y);
+        _mm_storeu_ps(out + 8, z);
+        _mm_storeu_ps(out + 12, w);
+    }
+#endif
+    for (; i < count; i++) {
+        float w = 0.0f;
+        if (types != nullptr) {
+            w = (types[i] == DEFAULT_CUBE_TYPE_BYTE) ? DEFAULT_CUBE_TYPE : static_cast<float>(types[i]);
+        }
+        destination[i] = glm::vec4(header.origin[0] + xs[i] * header.step[0],
+                                   header.origin[1] + ys[i] * header.step[1],
+                                   header.origin[2] + zs[i] * header.step[2], w);
+    }
+    return true;
+}
+
+/*
+ * Decodes a whole block straight into `destination` (n vec4s), e.g. a
+ * prefetch slot or Particle's translation buffer.
+ */
+inline bool decodeBlock(const unsigned char* source, std::uint64_t size, std::int64_t n, bool with_type,
+                        glm::vec4* destination)
+{
+    return decodeRange(source, size, n, with_type, 0, n, destination);
+}
+
+/*
+ * Upper bound on the Euclidean distance between an original position and
+ * its decoded value for an encoded block, in data units (see the error bound
+ * above).
+ */
+inline float maxPositionError(const unsigned char* block)
+{
+    QuantizedBlockHeader header;
+    std::memcpy(&header, block, sizeof(header));
+    const double u = std::numeric_limits<float>::epsilon() * 0.5;
+    double sum = 0.0;
+    for (int axis = 0; axis < 3; axis++) {
+        const double extent = static_cast<double>(header.step[axis]) * STEPS;
+        const double error = header.step[axis] * 0.5 + 8.0 * u * extent + u * (std::fabs(header.origin[axis]) + extent);
+        sum += error * error;
+    }
+    return static_cast<float>(std::sqrt(sum));
+}
+
+} // namespace quantized
+
+#endif // PARTICLE_VIEWER_DATA_QUANTIZED_CODEC_H
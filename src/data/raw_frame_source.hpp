@@ -0,0 +1,239 @@
+/*
+ * raw_frame_source.hpp
+ *
+ * FrameSource over the legacy PosAndVel blob: headerless frames of N vec4
+ * positions followed by N vec4 velocities. N comes from the RunSetup file,
+ * the frame count from the file size.
+ *
+ * The element type of those vec4s is a template parameter (see
+ * element_codec.hpp). RawFrameSource, the float32 instance, hands out
+ * mapped frames as they are; double and half frames are converted into the
+ * caller's buffer as they are read.
+ *
+ * Over a growable mapping, refreshFrameCount() extends the frame count while a
+ * simulator appends to the file; a trailing frame that is only partly
+ * written is not counted until it is complete.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_RAW_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_RAW_FRAME_SOURCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "data/element_codec.hpp"
+#include "data/frame_source.hpp"
+#include "data/mapped_file.hpp"
+
+template <typename Element>
+class BasicRawFrameSource : public FrameSource
+{
+  public:
+    // Float frames are stored exactly as the vec4s the renderer uploads
+    static constexpr bool MAPPABLE = std::is_same_v<Element, float>;
+
+    BasicRawFrameSource(MappedFile mapping, std::int64_t particle_count)
+        : mapping_(std::move(mapping)), particle_count_(particle_count)
+    {
+        if (mapping_.isOpen() && particle_count_ > 0) {
+            frame_count_ = static_cast<std::int64_t>(mapping_.size() / frameBytes());
+        }
+    }
+
+    std::int64_t refreshFrameCount() override
+    {
+        if (mapping_.isOpen() && particle_count_ > 0) {
+            frame_count_ = static_cast<std::int64_t>(mapping_.refreshSize() / frameBytes());
+        }
+        return frame_count_;
+    }
+
+    std::int64_t particleCount() const override
+    {
+        return particle_count_;
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return frame_count_;
+    }
+
+    bool readPositions(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return convert(frame, 0, particle_count_, origin_, destination);
+    }
+
+    bool readVelocities(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return convert(frame, particle_count_, particle_count_, glm::dvec3(0.0), destination);
+    }
+
+    /*
+     * Converts each frame a few MB at a time, so a cancelled read stops early.
+     */
+    void readPositionsBatch(FrameRead* reads, int count) const override
+    {
+        for (int i = 0; i < count; i++) {
+            reads[i].ok = false;
+            if (isCancelled(reads[i]) || !inRange(reads[i].frame)) {
+                continue;
+            }
+            std::int64_t done = 0;
+            while (done < particle_count_ && !isCancelled(reads[i])) {
+                const std::int64_t chunk = std::min(CANCEL_CHECK_PARTICLES, particle_count_ - done);
+                convert(reads[i].frame, done, chunk, origin_, reads[i].destination + done);
+                done += chunk;
+            }
+            reads[i].ok = done == particle_count_;
+        }
+    }
+
+    /*
+     * Only the kept runs are read and converted.
+     */
+    bool readPreviewPositions(std::int64_t frame, int stride, glm::vec4* destination) const override
+    {
+        if (!inRange(frame)) {
+            return false;
+        }
+        forEachPreviewRun(particle_count_, stride, [&](std::int64_t first, std::int64_t count, std::int64_t packed) {
+            convert(frame, first, count, origin_, destination + packed);
+        });
+        return true;
+    }
+
+    const glm::vec4* mappedPositions(std::int64_t frame) const override
+    {
+        if constexpr (MAPPABLE) {
+            if (!inRange(frame)) {
+                return nullptr;
+            }
+            return reinterpret_cast<const glm::vec4*>(elements(frame));
+        } else {
+            (void)frame;
+            return nullptr;
+        }
+    }
+
+    void adviseFrames(std::int64_t first, std::int64_t count, PageAdvice advice) const override
+    {
+        const std::int64_t begin = std::max<std::int64_t>(first, 0);
+        const std::int64_t end = std::min(first + count, frame_count_.load());
+        if (begin < end) {
+            mapping_.advise(static_cast<std::uint64_t>(begin) * frameBytes(),
+                            static_cast<std::uint64_t>(end - begin) * frameBytes(), advice);
+        }
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t frame) const override
+    {
+        (void)frame;
+        return frameBytes();
+    }
+
+    /*
+     * Moves the coordinate origin to the centre of `frame`'s finite
+     * positions: every position read from here on is relative to it. Double
+     * data far from (0, 0, 0) then keeps its precision when narrowed to
+     * float; other element types have none to keep and return false. Call
+     * before the source is shared with other threads.
+     */
+    bool recenter(std::int64_t frame = 0)
+    {
+        if constexpr (std::is_same_v<Element, double>) {
+            if (!inRange(frame)) {
+                return false;
+            }
+            const double* particle = elements(frame);
+            glm::dvec3 sum(0.0);
+            std::int64_t finite = 0;
+            for (std::int64_t i = 0; i < particle_count_; i++, particle += 4) {
+                if (std::isfinite(particle[0]) && std::isfinite(particle[1]) && std::isfinite(particle[2])) {
+                    sum += glm::dvec3(particle[0], particle[1], particle[2]);
+                    finite++;
+                }
+            }
+            origin_ = finite > 0 ? sum / static_cast<double>(finite) : glm::dvec3(0.0);
+            return true;
+        } else {
+            (void)frame;
+            return false;
+        }
+    }
+
+    glm::dvec3 positionOrigin() const override
+    {
+        return origin_;
+    }
+
+  private:
+    bool inRange(std::int64_t frame) const
+    {
+        return frame >= 0 && frame < frame_count_.load();
+    }
+
+    const Element* elements(std::int64_t frame) const
+    {
+        const std::uint64_t offset = static_cast<std::uint64_t>(frame) * frameBytes();
+        return reinterpret_cast<const Element*>(mapping_.data() + offset);
+    }
+
+    /*
+     * Converts `count` vec4s starting `first` vec4s into `frame` (positions,
+     * then velocities).
+     */
+    bool convert(std::int64_t frame, std::int64_t first, std::int64_t count, const glm::dvec3& origin,
+                 glm::vec4* destination) const
+    {
+        if (!inRange(frame)) {
+            return false;
+        }
+        element::toVec4<Element>(elements(frame) + 4 * first, count, origin, destination);
+        return true;
+    }
+
+    std::uint64_t frameBytes() const
+    {
+        return sizeof(Element) * 4 * 2 * static_cast<std::uint64_t>(particle_count_);
+    }
+
+    MappedFile mapping_;
+    std::int64_t particle_count_;
+    std::atomic<std::int64_t> frame_count_{0}; // grows under readers on other threads in follow mode
+    glm::dvec3 origin_{0.0};
+};
+
+using RawFrameSource = BasicRawFrameSource<float>;
+
+/*
+ * Opens a raw blob whose vec4s are stored as `type`. With `recenter`,
+ * double data is read relative to the centre of its first frame.
+ */
+inline std::unique_ptr<FrameSource> makeRawFrameSource(MappedFile mapping, std::int64_t particle_count,
+                                                       ElementType type, bool recenter = false)
+{
+    switch (type) {
+        case ElementType::Float64: {
+            auto source = std::make_unique<BasicRawFrameSource<double>>(std::move(mapping), particle_count);
+            if (recenter) {
+                source->recenter();
+            }
+            return source;
+        }
+        case ElementType::Float16:
+            return std::make_unique<BasicRawFrameSource<Half>>(std::move(mapping), particle_count);
+        case ElementType::Float32:
+            break;
+    }
+    return std::make_unique<RawFrameSource>(std::move(mapping), particle_count);
+}
+
+#endif // PARTICLE_VIEWER_DATA_RAW_FRAME_SOURCE_H
@@ -0,0 +1,292 @@
+/*
+ * residual_codec.hpp
+ *
+ * Lossless velocity-predictive frame codec (container Encoding::PredictiveResidual).
+ *
+ * PosAndVel stores velocities next to positions, so a frame is well predicted
+ * from the previous one:
+ *
+ *   position' = position + velocity * dt     (dt = Dt * RecordRate, one record step)
+ *   velocity' = velocity,  type' = type
+ *
+ * Each float is mapped to an order-preserving 32-bit integer and only the
+ * difference between actual and predicted integer is stored, zigzag-encoded
+ * so small residuals of either sign have few significant bits. Residuals are
+ * bit-packed in blocks of 256 values, each block using the width of its
+ * largest residual. On smooth phases most residuals need a handful of bits
+ * instead of 32.
+ *
+ * There is no entropy coder behind the bit packing. Every value in a block
+ * costs the width of the block's largest residual, so frames stay larger than
+ * the residuals' entropy. On synthetic residuals that is about one bit per
+ * value for Gaussian ones (5 bits where an ideal order-0 coder needs 4 at
+ * sigma = 4, 15 vs 14 at sigma = 4096), and 1.4 to 2 times the entropy for
+ * heavy-tailed ones, where a few outliers widen their whole block. In
+ * exchange a block needs no tables or adaptive state and decodes
+ * independently of the others. An entropy stage (e.g. rANS over widths and
+ * low bits) would replace the packing in encodeFrame() and decodeBlock(),
+ * and would have to code blocks separately to keep the parallel decode.
+ *
+ * Frame layout (all little-endian):
+ *   [u32 value_count][u32 block_count][u8 width * block_count][pad to 4][block 0][block 1]...
+ * Block b holds 256 values in 32 * width[b] bytes (the last block is padded
+ * with zero residuals).
+ *
+ * Blocks decode independently once the previous frame is known, so decoding
+ * is spread over a ThreadPool. The prediction uses std::fma and canonicalizes
+ * NaN, so encoder and decoder agree bit for bit on every platform.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_RESIDUAL_CODEC_H
+#define PARTICLE_VIEWER_DATA_RESIDUAL_CODEC_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/thread_pool.hpp"
+
+namespace residual
+{
+
+constexpr std::int64_t BLOCK_VALUES = 256;
+constexpr std::uint64_t BLOCK_BYTES_PER_BIT = BLOCK_VALUES / 8;
+
+/*
+ * Maps float bits to an unsigned integer with the same ordering as the floats.
+ */
+inline std::uint32_t orderedBits(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline float fromOrderedBits(std::uint32_t ordered)
+{
+    const std::uint32_t bits = (ordered & 0x80000000u) ? (ordered & 0x7FFFFFFFu) : ~ordered;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t zigzag(std::uint32_t difference)
+{
+    const std::int32_t signed_difference = static_cast<std::int32_t>(difference);
+    return (difference << 1) ^ static_cast<std::uint32_t>(signed_difference >> 31);
+}
+
+inline std::uint32_t unzigzag(std::uint32_t encoded)
+{
+    return (encoded >> 1) ^ (0u - (encoded & 1u));
+}
+
+/*
+ * The previous frame a prediction is made from. Null velocities mean the
+ * dataset has none (positions are then predicted as unchanged); null
+ * positions mean there is no previous frame and everything predicts to zero.
+ */
+struct PredictionBase
+{
+    const glm::vec4* positions = nullptr;
+    const glm::vec4* velocities = nullptr;
+    float dt = 0.0f;
+};
+
+/*
+ * Predicted lanes of particle `i`, from the position block (velocity_block
+ * false) or the velocity block.
+ */
+inline glm::vec4 predictParticle(const PredictionBase& base, std::int64_t i, bool velocity_block)
+{
+    if (base.positions == nullptr) {
+        return glm::vec4(0.0f);
+    }
+    glm::vec4 predicted;
+    if (velocity_block) {
+        predicted = base.velocities[i];
+    } else {
+        predicted = base.positions[i];
+        if (base.velocities != nullptr) {
+            for (int lane = 0; lane < 3; lane++) {
+                predicted[lane] = std::fma(base.velocities[i][lane], base.dt, base.positions[i][lane]);
+            }
+        }
+    }
+    for (int lane = 0; lane < 4; lane++) {
+        if (std::isnan(predicted[lane])) {
+            predicted[lane] = 0.0f;
+        }
+    }
+    return predicted;
+}
+
+inline int bitWidth(std::uint32_t value)
+{
+    int width = 0;
+    while (value != 0) {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+/*
+ * Largest particle count a frame can hold, since value_count is stored as a u32.
+ */
+inline std::int64_t maxParticles(bool with_velocities)
+{
+    return static_cast<std::int64_t>(0xFFFFFFFFu / (with_velocities ? 8u : 4u));
+}
+
+inline std::uint64_t headerBytes(std::int64_t block_count)
+{
+    return (8 + static_cast<std::uint64_t>(block_count) + 3) / 4 * 4;
+}
+
+/*
+ * Encodes one frame against `base`. `velocities` may be null for
+ * position-only datasets. n must not exceed maxParticles().
+ */
+inline std::vector<unsigned char> encodeFrame(const PredictionBase& base, const glm::vec4* positions,
+                                              const glm::vec4* velocities, std::int64_t n)
+{
+    const std::int64_t value_count = 4 * n * (velocities != nullptr ? 2 : 1);
+    const std::int64_t block_count = (value_count + BLOCK_VALUES - 1) / BLOCK_VALUES;
+
+    std::vector<std::uint32_t> residuals(static_cast<std::uint64_t>(block_count) * BLOCK_VALUES, 0);
+    for (std::int64_t j = 0; j < value_count; j += 4) {
+        const bool velocity_block = j >= 4 * n;
+        const std::int64_t i = (velocity_block ? j - 4 * n : j) / 4;
+        const glm::vec4 actual = velocity_block ? velocities[i] : positions[i];
+        const glm::vec4 predicted = predictParticle(base, i, velocity_block);
+        for (int lane = 0; lane < 4; lane++) {
+            residuals[j + lane] = zigzag(orderedBits(actual[lane]) - orderedBits(predicted[lane]));
+        }
+    }
+
+    std::vector<unsigned char> widths(block_count);
+    std::uint64_t payload_bytes = 0;
+    for (std::int64_t b = 0; b < block_count; b++) {
+        std::uint32_t combined = 0;
+        for (std::int64_t k = 0; k < BLOCK_VALUES; k++) {
+            combined |= residuals[b * BLOCK_VALUES + k];
+        }
+        widths[b] = static_cast<unsigned char>(bitWidth(combined));
+        payload_bytes += BLOCK_BYTES_PER_BIT * widths[b];
+    }
+
+    std::vector<unsigned char> frame(headerBytes(block_count) + payload_bytes, 0);
+    const std::uint32_t counts[2] = {static_cast<std::uint32_t>(value_count), static_cast<std::uint32_t>(block_count)};
+    std::memcpy(frame.data(), counts, sizeof(counts));
+    std::memcpy(frame.data() + sizeof(counts), widths.data(), widths.size());
+
+    unsigned char* out = frame.data() + headerBytes(block_count);
+    for (std::int64_t b = 0; b < block_count; b++) {
+        const int width = widths[b];
+        std::uint64_t accumulator = 0;
+        int filled = 0;
+        for (std::int64_t k = 0; k < BLOCK_VALUES; k++) {
+            accumulator |= static_cast<std::uint64_t>(residuals[b * BLOCK_VALUES + k]) << filled;
+            filled += width;
+            while (filled >= 8) {
+                *out++ = static_cast<unsigned char>(accumulator);
+                accumulator >>= 8;
+                filled -= 8;
+            }
+        }
+    }
+    return frame;
+}
+
+/*
+ * Unpacks the block starting at flat index `first` (a multiple of
+ * BLOCK_VALUES) and writes the reconstructed floats.
+ */
+inline void decodeBlock(const unsigned char* packed, int width, std::int64_t first, std::int64_t value_count,
+                        const PredictionBase& base, std::int64_t n, glm::vec4* positions, glm::vec4* velocities)
+{
+    const std::int64_t count = std::min(BLOCK_VALUES, value_count - first);
+    std::uint32_t encoded[BLOCK_VALUES] = {};
+    if (width > 0) {
+        const std::uint64_t mask = (width == 32) ? 0xFFFFFFFFull : ((1ull << width) - 1);
+        std::uint64_t accumulator = 0;
+        int available = 0;
+        for (std::int64_t k = 0; k < count; k++) {
+            while (available < width) {
+                accumulator |= static_cast<std::uint64_t>(*packed++) << available;
+                available += 8;
+            }
+            encoded[k] = static_cast<std::uint32_t>(accumulator & mask);
+            accumulator >>= width;
+            available -= width;
+        }
+    }
+    // Blocks start on a particle boundary and 4n is the position/velocity split, so whole vec4s are rebuilt
+    for (std::int64_t k = 0; k < count; k += 4) {
+        const std::int64_t j = first + k;
+        const bool velocity_block = j >= 4 * n;
+        const std::int64_t i = (velocity_block ? j - 4 * n : j) / 4;
+        const glm::vec4 predicted = predictParticle(base, i, velocity_block);
+        glm::vec4& out = velocity_block ? velocities[i] : positions[i];
+        for (int lane = 0; lane < 4; lane++) {
+            out[lane] = fromOrderedBits(orderedBits(predicted[lane]) + unzigzag(encoded[k + lane]));
+        }
+    }
+}
+
+/*
+ * Decodes a frame into `positions` / `velocities` (n each; velocities may be
+ * null when the dataset has none). The output must not alias `base`. With a
+ * pool, blocks are decoded in parallel. Returns false on a malformed frame.
+ */
+inline bool decodeFrame(const unsigned char* frame, std::uint64_t size, const PredictionBase& base, std::int64_t n,
+                        glm::vec4* positions, glm::vec4* velocities, ThreadPool* pool = nullptr)
+{
+    std::uint32_t counts[2];
+    if (size < sizeof(counts)) {
+        return false;
+    }
+    std::memcpy(counts, frame, sizeof(counts));
+    const std::int64_t value_count = static_cast<std::int64_t>(counts[0]);
+    const std::int64_t block_count = static_cast<std::int64_t>(counts[1]);
+    if (value_count != 4 * n * (velocities != nullptr ? 2 : 1) ||
+        block_count != (value_count + BLOCK_VALUES - 1) / BLOCK_VALUES || headerBytes(block_count) > size) {
+        return false;
+    }
+
+    // Prefix sum of block sizes gives every block's offset, so blocks can be unpacked independently
+    std::vector<std::uint64_t> offsets(block_count + 1);
+    offsets[0] = headerBytes(block_count);
+    for (std::int64_t b = 0; b < block_count; b++) {
+        const int width = frame[sizeof(counts) + b];
+        if (width > 32) {
+            return false;
+        }
+        offsets[b + 1] = offsets[b] + BLOCK_BYTES_PER_BIT * width;
+    }
+    if (offsets[block_count] > size) {
+        return false;
+    }
+
+    auto decode = [&](std::int64_t b) {
+        decodeBlock(frame + offsets[b], frame[sizeof(counts) + b], b * BLOCK_VALUES, value_count, base, n, positions,
+                    velocities);
+    };
+    if (pool != nullptr && pool->size() > 1) {
+        pool->parallelFor(0, block_count, decode);
+    } else {
+        for (std::int64_t b = 0; b < block_count; b++) {
+            decode(b);
+        }
+    }
+    return true;
+}
+
+} // namespace residual
+
+#endif // PARTICLE_VIEWER_DATA_RESIDUAL_CODEC_H
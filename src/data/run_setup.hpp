@@ -0,0 +1,244 @@
+/*
+ * run_setup.hpp
+ *
+ * The RunSetup file a simulation writes next to its PosAndVel, and the files
+ * that make up a run folder. Free of GL and dialog code, so the command-line
+ * tools can open a run without the viewer's rendering side.
+ *
+ * RunSetup is a list of `name = value` lines in a fixed order; only the
+ * values are read, in that order:
+ *
+ *   RunSetup setup;
+ *   if (setup.load(folder + "/RunSetup")) {
+ *       float dt = setup.Dt;
+ *   }
+ *   run_setup::RunFiles files = run_setup::filesFor(path);
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_RUN_SETUP_H
+#define PARTICLE_VIEWER_DATA_RUN_SETUP_H
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include <glm/glm.hpp>
+
+#include "data/com_track.hpp"
+#include "data/container_format.hpp"
+#include "data/shard_manifest.hpp"
+
+/*
+ * Every value of a RunSetup. The placeholders (100, with N = 100) are what a
+ * run without a RunSetup gets, as the viewer always did.
+ */
+struct RunSetup
+{
+    glm::vec3 InitialPosition1 = glm::vec3(100);
+    glm::vec3 InitialPosition2 = glm::vec3(100);
+    glm::vec3 InitialVelocity1 = glm::vec3(100);
+    glm::vec3 InitialVelocity2 = glm::vec3(100);
+    glm::vec4 InitialSpin1 = glm::vec4(100);
+    glm::vec4 InitialSpin2 = glm::vec4(100);
+    double FractionEarthMassOfBody1 = 100;
+    double FractionEarthMassOfBody2 = 100;
+    double FractionFeBody1 = 100;
+    double FractionSiBody1 = 100;
+    double FractionFeBody2 = 100;
+    double FractionSiBody2 = 100;
+    float DampRateBody1 = 100;
+    float DampRateBody2 = 100;
+    float EnergyTargetBody1 = 100;
+    float EnergyTargetBody2 = 100;
+    std::int64_t N = 100;
+    float TotalRunTime = 100;
+    float DampTime = 100;
+    float DampRestTime = 100;
+    float EnergyAdjustmentTime = 100;
+    float EnergyAdjustmentRestTime = 100;
+    float SpinRestTime = 100;
+    float Dt = 100;
+    int WriteToFile = 100;
+    int RecordRate = 100;
+    double DensityFe = 100;
+    double DensitySi = 100;
+    double KFe = 100;
+    double KSi = 100;
+    double KRFe = 100;
+    double KRSi = 100;
+    double SDFe = 100;
+    double SDSi = 100;
+    int DrawRate = 100;
+    int DrawQuality = 100;
+    int UseMultipleGPU = 100;
+    double UniversalGravity = 100;
+    double MassOfEarth = 100;
+    double Pi = 100;
+
+    /*
+     * Reads the RunSetup at `path`. Returns false, leaving the values as they
+     * were, if the file cannot be opened.
+     */
+    bool load(const std::string& path)
+    {
+        std::ifstream data(path);
+        if (!data.good() || !data.is_open()) {
+            return false;
+        }
+        readValue(data, InitialPosition1.x);
+        readValue(data, InitialPosition1.y);
+        readValue(data, InitialPosition1.z);
+        readValue(data, InitialPosition2.x);
+        readValue(data, InitialPosition2.y);
+        readValue(data, InitialPosition2.z);
+
+        readValue(data, InitialVelocity1.x);
+        readValue(data, InitialVelocity1.y);
+        readValue(data, InitialVelocity1.z);
+        readValue(data, InitialVelocity2.x);
+        readValue(data, InitialVelocity2.y);
+        readValue(data, InitialVelocity2.z);
+
+        readValue(data, InitialSpin1.x);
+        readValue(data, InitialSpin1.y);
+        readValue(data, InitialSpin1.z);
+        readValue(data, InitialSpin1.w);
+        readValue(data, InitialSpin2.x);
+        readValue(data, InitialSpin2.y);
+        readValue(data, InitialSpin2.z);
+        readValue(data, InitialSpin2.w);
+
+        readValue(data, FractionEarthMassOfBody1);
+        readValue(data, FractionEarthMassOfBody2);
+        readValue(data, FractionFeBody1);
+        readValue(data, FractionSiBody1);
+        readValue(data, FractionFeBody2);
+        readValue(data, FractionSiBody2);
+
+        readValue(data, DampRateBody1);
+        readValue(data, DampRateBody2);
+        readValue(data, EnergyTargetBody1);
+        readValue(data, EnergyTargetBody2);
+
+        readValue(data, N);
+
+        readValue(data, TotalRunTime);
+        readValue(data, DampTime);
+        readValue(data, DampRestTime);
+        readValue(data, EnergyAdjustmentTime);
+        readValue(data, EnergyAdjustmentRestTime);
+        readValue(data, SpinRestTime);
+
+        readValue(data, Dt);
+        readValue(data, WriteToFile);
+        readValue(data, RecordRate);
+
+        readValue(data, DensityFe);
+        readValue(data, DensitySi);
+        readValue(data, KFe);
+        readValue(data, KSi);
+        readValue(data, KRFe);
+        readValue(data, KRSi);
+        readValue(data, SDFe);
+        readValue(data, SDSi);
+
+        readValue(data, DrawRate);
+        readValue(data, DrawQuality);
+        readValue(data, UseMultipleGPU);
+
+        readValue(data, UniversalGravity);
+        readValue(data, MassOfEarth);
+        readValue(data, Pi);
+        return true;
+    }
+
+    /*
+     * Mass each particle type carries: types 0 and 1 are the iron core and
+     * silicate mantle of body 1, types 2 and 3 those of body 2. Particles of
+     * any other type carry none.
+     */
+    std::array<double, com_track::TYPE_SLOTS> typeMasses() const
+    {
+        std::array<double, com_track::TYPE_SLOTS> masses{};
+        masses[0] = FractionEarthMassOfBody1 * FractionFeBody1;
+        masses[1] = FractionEarthMassOfBody1 * FractionSiBody1;
+        masses[2] = FractionEarthMassOfBody2 * FractionFeBody2;
+        masses[3] = FractionEarthMassOfBody2 * FractionSiBody2;
+        return masses;
+    }
+
+  private:
+    /*
+     * Skips the next `name =` and reads the value after it.
+     */
+    template <typename T>
+    static void readValue(std::ifstream& data, T& value)
+    {
+        std::string name;
+        std::getline(data, name, '=');
+        data >> value;
+    }
+};
+
+namespace run_setup
+{
+
+/*
+ * The files of one run: its data file, RunSetup and COMFile.
+ */
+struct RunFiles
+{
+    std::string data;
+    std::string setup;
+    std::string com;
+};
+
+/*
+ * Data file to open in a run folder: a shard manifest if there is one,
+ * else a container converted with pv-convert, else the raw PosAndVel.
+ * With `follow` a raw PosAndVel wins over the container: a simulation that
+ * is still running appends to the former, while the container never grows.
+ */
+inline std::string dataFileIn(const std::string& folder, bool follow = false)
+{
+    if (std::ifstream(folder + shard_manifest::DEFAULT_FILE_NAME, std::ios::binary).good()) {
+        return folder + shard_manifest::DEFAULT_FILE_NAME;
+    }
+    const bool has_raw = std::ifstream(folder + "/PosAndVel", std::ios::binary).good();
+    if (!(follow && has_raw) && std::ifstream(folder + container::DEFAULT_FILE_NAME, std::ios::binary).good()) {
+        return folder + container::DEFAULT_FILE_NAME;
+    }
+    return folder + "/PosAndVel";
+}
+
+/*
+ * The files of the run in a folder (see dataFileIn).
+ */
+inline RunFiles filesInFolder(const std::string& folder, bool follow = false)
+{
+    return {dataFileIn(folder, follow), folder + "/RunSetup", folder + "/COMFile"};
+}
+
+/*
+ * The files of a run folder, or of a single data file with the RunSetup and
+ * COMFile next to it. `follow` picks a folder's data file as in dataFileIn.
+ */
+inline RunFiles filesFor(const std::string& path, bool follow = false)
+{
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error)) {
+        return filesInFolder(path, follow);
+    }
+    std::string folder = std::filesystem::path(path).parent_path().string();
+    if (folder.empty()) {
+        folder = ".";
+    }
+    return {path, folder + "/RunSetup", folder + "/COMFile"};
+}
+
+} // namespace run_setup
+
+#endif // PARTICLE_VIEWER_DATA_RUN_SETUP_H
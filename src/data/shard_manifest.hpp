@@ -0,0 +1,179 @@
+/*
+ * shard_manifest.hpp
+ *
+ * Text manifest that ties several data files (shards) into one dataset, for
+ * runs the simulator wrote in pieces:
+ *
+ *   PVSHARDS 1
+ *   layout time                 # or: particles
+ *   shard PosAndVel.0           # path relative to the manifest
+ *   shard PosAndVel.1
+ *   shard gpu1/PosAndVel 250000 # optional particle count of a raw shard
+ *
+ * With `layout time` every shard holds the same particles and the frames of
+ * the shards follow one another, as after a restart writes a new segment.
+ * With `layout particles` every shard holds a slice of the particles for the
+ * same frames, as with UseMultipleGPU; the slices are concatenated in manifest
+ * order. Each shard is a legacy PosAndVel blob, a v2 container or a one-frame
+ * text snapshot (text_importer.hpp). A raw shard without a particle count
+ * uses N from RunSetup.
+ *
+ * Blank lines and anything after '#' are ignored.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_SHARD_MANIFEST_H
+#define PARTICLE_VIEWER_DATA_SHARD_MANIFEST_H
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace shard_manifest
+{
+
+constexpr char MAGIC[8] = {'P', 'V', 'S', 'H', 'A', 'R', 'D', 'S'};
+constexpr int VERSION = 1;
+
+// Looked for in a data folder before PosAndVel.pv2 and PosAndVel
+constexpr const char* DEFAULT_FILE_NAME = "/PosAndVel.shards";
+
+enum class Layout
+{
+    Time,     // shards follow one another in time
+    Particles // shards split the particles of every frame
+};
+
+struct Shard
+{
+    std::string path;                // resolved against the manifest's folder
+    std::int64_t particle_count = 0; // 0: not given in the manifest
+};
+
+struct Manifest
+{
+    Layout layout = Layout::Time;
+    std::vector<Shard> shards;
+};
+
+/*
+ * True if the buffer starts with the manifest magic. Used to tell a manifest
+ * apart from a data file regardless of file name.
+ */
+inline bool hasMagic(const unsigned char* bytes, std::uint64_t size)
+{
+    return bytes != nullptr && size >= sizeof(MAGIC) && std::memcmp(bytes, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/*
+ * True if the file at `path` starts with the manifest magic. Reads only the
+ * first few bytes, so it is cheap to ask of any data file.
+ */
+inline bool isManifestFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    unsigned char bytes[sizeof(MAGIC)] = {};
+    file.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+    return file && hasMagic(bytes, sizeof(bytes));
+}
+
+/*
+ * Parses manifest text. Relative shard paths are taken relative to
+ * `base_dir`. Returns false, with a message in `error`, if the text is not a
+ * manifest of a known version, a line is malformed, or no shard is listed.
+ */
+inline bool parse(const std::string& text, const std::string& base_dir, Manifest& manifest, std::string& error)
+{
+    manifest = Manifest{};
+    std::istringstream lines(text);
+    std::string line;
+    int line_number = 0;
+    bool seen_magic = false;
+    while (std::getline(lines, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string keyword;
+        if (!(words >> keyword)) {
+            continue;
+        }
+        const std::string where = "line " + std::to_string(line_number) + ": ";
+        if (!seen_magic) {
+            int version = 0;
+            if (keyword != std::string(MAGIC, sizeof(MAGIC)) || !(words >> version)) {
+                error = "not a shard manifest";
+                return false;
+            }
+            if (version != VERSION) {
+                error = "unsupported manifest version " + std::to_string(version);
+                return false;
+            }
+            seen_magic = true;
+        } else if (keyword == "layout") {
+            std::string layout;
+            words >> layout;
+            if (layout == "time") {
+                manifest.layout = Layout::Time;
+            } else if (layout == "particles") {
+                manifest.layout = Layout::Particles;
+            } else {
+                error = where + "unknown layout '" + layout + "'";
+                return false;
+            }
+        } else if (keyword == "shard") {
+            Shard shard;
+            if (!(words >> shard.path)) {
+                error = where + "shard without a path";
+                return false;
+            }
+            std::string count;
+            if (words >> count) {
+                std::istringstream number(count);
+                if (!(number >> shard.particle_count) || !number.eof() || shard.particle_count <= 0) {
+                    error = where + "bad particle count '" + count + "'";
+                    return false;
+                }
+            }
+            const std::filesystem::path path(shard.path);
+            if (path.is_relative() && !base_dir.empty()) {
+                shard.path = (std::filesystem::path(base_dir) / path).string();
+            }
+            manifest.shards.push_back(shard);
+        } else {
+            error = where + "unknown keyword '" + keyword + "'";
+            return false;
+        }
+    }
+    if (!seen_magic) {
+        error = "not a shard manifest";
+        return false;
+    }
+    if (manifest.shards.empty()) {
+        error = "manifest lists no shards";
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Reads and parses the manifest at `path`; shard paths are resolved against
+ * its folder.
+ */
+inline bool load(const std::string& path, Manifest& manifest, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return parse(text.str(), std::filesystem::path(path).parent_path().string(), manifest, error);
+}
+
+} // namespace shard_manifest
+
+#endif // PARTICLE_VIEWER_DATA_SHARD_MANIFEST_H
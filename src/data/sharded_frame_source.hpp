@@ -0,0 +1,350 @@
+/*
+ * sharded_frame_source.hpp
+ *
+ * FrameSource over several data files listed in a shard manifest
+ * (shard_manifest.hpp), presented as one dataset with one frame timeline.
+ *
+ * Time-sharded: frame f is read from the shard whose frames cover it. Only
+ * the last shard may still grow in follow mode; the frames of the ones before
+ * it are fixed when the source is opened.
+ *
+ * Particle-sharded: every shard holds a slice of the particles and a frame is
+ * read from all shards at once, on a pool with a thread per shard, each shard
+ * decoding straight into its slice of the caller's buffer. The frame count is
+ * that of the shortest shard. Frames span several files, so mappedPositions()
+ * is nullptr and callers go through readPositions().
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_SHARDED_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_SHARDED_FRAME_SOURCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+#include "data/shard_manifest.hpp"
+#include "data/thread_pool.hpp"
+
+class ShardedFrameSource : public FrameSource
+{
+  public:
+    /*
+     * `shards` and `paths` are in manifest order. Check isValid() afterwards.
+     */
+    ShardedFrameSource(shard_manifest::Layout layout, std::vector<std::unique_ptr<FrameSource>> shards,
+                       std::vector<std::string> paths)
+        : layout_(layout), shards_(std::move(shards)), paths_(std::move(paths))
+    {
+        if (shards_.empty() || paths_.size() != shards_.size()) {
+            return;
+        }
+        for (const auto& shard : shards_) {
+            if (!shard || shard->isLive() || shard->particleCount() <= 0) {
+                return;
+            }
+        }
+        // Stitched positions must all be relative to the same point
+        origin_ = shards_.front()->positionOrigin();
+        for (const auto& shard : shards_) {
+            if (shard->positionOrigin() != origin_) {
+                return;
+            }
+        }
+        if (layout_ == shard_manifest::Layout::Time) {
+            particle_count_ = shards_.front()->particleCount();
+            std::int64_t first = 0;
+            for (const auto& shard : shards_) {
+                if (shard->particleCount() != particle_count_) {
+                    return;
+                }
+                first_frames_.push_back(first);
+                first += shard->frameCount();
+            }
+            frame_count_ = first;
+        } else {
+            std::int64_t frames = shards_.front()->frameCount();
+            for (const auto& shard : shards_) {
+                particle_offsets_.push_back(particle_count_);
+                particle_count_ += shard->particleCount();
+                frames = std::min(frames, shard->frameCount());
+            }
+            frame_count_ = frames;
+            if (shards_.size() > 1) {
+                const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+                pool_ = std::make_unique<ThreadPool>(std::min(static_cast<unsigned>(shards_.size()), hardware));
+            }
+        }
+        valid_ = true;
+    }
+
+    /*
+     * False if a shard failed to open or the shards do not fit together: the
+     * particle counts of time shards differ, a shard is a live feed, or the
+     * shards' positions are relative to different origins.
+     */
+    bool isValid() const
+    {
+        return valid_;
+    }
+
+    shard_manifest::Layout layout() const
+    {
+        return layout_;
+    }
+
+    std::size_t shardCount() const
+    {
+        return shards_.size();
+    }
+
+    std::int64_t particleCount() const override
+    {
+        return particle_count_;
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return frame_count_;
+    }
+
+    glm::dvec3 positionOrigin() const override
+    {
+        return origin_;
+    }
+
+    std::int64_t refreshFrameCount() override
+    {
+        if (!valid_) {
+            return 0;
+        }
+        if (layout_ == shard_manifest::Layout::Time) {
+            frame_count_ = first_frames_.back() + shards_.back()->refreshFrameCount();
+        } else {
+            std::int64_t frames = shards_.front()->refreshFrameCount();
+            for (std::size_t i = 1; i < shards_.size(); i++) {
+                frames = std::min(frames, shards_[i]->refreshFrameCount());
+            }
+            frame_count_ = frames;
+        }
+        return frame_count_;
+    }
+
+    bool readPositions(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return read(frame, destination, false);
+    }
+
+    bool readVelocities(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return read(frame, destination, true);
+    }
+
+    /*
+     * Particle-sharded: hands every shard the whole batch, pointed at its
+     * slice, so a shard that batches its reads (io_uring) still does.
+     */
+    void readPositionsBatch(FrameRead* reads, int count) const override
+    {
+        if (layout_ == shard_manifest::Layout::Time || !valid_) {
+            FrameSource::readPositionsBatch(reads, count);
+            return;
+        }
+        std::vector<std::vector<FrameRead>> shard_reads(shards_.size());
+        for (std::size_t s = 0; s < shards_.size(); s++) {
+            shard_reads[s].reserve(count);
+            for (int i = 0; i < count; i++) {
+                const std::int64_t frame = inRange(reads[i].frame) ? reads[i].frame : -1;
+                glm::vec4* slice = reads[i].destination + particle_offsets_[s];
+                shard_reads[s].push_back({frame, slice, false, reads[i].cancelled});
+            }
+        }
+        forEachShard([&](std::size_t s) { shards_[s]->readPositionsBatch(shard_reads[s].data(), count); });
+        for (int i = 0; i < count; i++) {
+            reads[i].ok = true;
+            for (const auto& shard : shard_reads) {
+                reads[i].ok = reads[i].ok && shard[i].ok;
+            }
+        }
+    }
+
+    /*
+     * Time-sharded: read from the shard holding the frame. Particle-sharded:
+     * the part of the range in each shard's slice, read from that shard.
+     */
+    bool readPositionRange(std::int64_t frame, std::int64_t first, std::int64_t count,
+                           glm::vec4* destination) const override
+    {
+        if (!inRange(frame) || first < 0 || count < 0 || first + count > particle_count_) {
+            return false;
+        }
+        if (layout_ == shard_manifest::Layout::Time) {
+            const std::size_t s = shardOf(frame);
+            return shards_[s]->readPositionRange(frame - first_frames_[s], first, count, destination);
+        }
+        for (std::size_t s = 0; s < shards_.size(); s++) {
+            const std::int64_t slice_begin = particle_offsets_[s];
+            const std::int64_t slice_end = slice_begin + shards_[s]->particleCount();
+            const std::int64_t begin = std::max(first, slice_begin);
+            const std::int64_t stop = std::min(first + count, slice_end);
+            if (begin >= stop) {
+                continue;
+            }
+            if (!shards_[s]->readPositionRange(frame, begin - slice_begin, stop - begin, destination + begin - first)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Time-sharded: the shard's own preview read. Particle-sharded previews
+     * take the default path, whose runs may cross shard boundaries.
+     */
+    bool readPreviewPositions(std::int64_t frame, int stride, glm::vec4* destination) const override
+    {
+        if (layout_ != shard_manifest::Layout::Time) {
+            return FrameSource::readPreviewPositions(frame, stride, destination);
+        }
+        if (!inRange(frame)) {
+            return false;
+        }
+        const std::size_t s = shardOf(frame);
+        return shards_[s]->readPreviewPositions(frame - first_frames_[s], stride, destination);
+    }
+
+    const glm::vec4* mappedPositions(std::int64_t frame) const override
+    {
+        if (layout_ != shard_manifest::Layout::Time || !inRange(frame)) {
+            return nullptr;
+        }
+        const std::size_t s = shardOf(frame);
+        return shards_[s]->mappedPositions(frame - first_frames_[s]);
+    }
+
+    void adviseFrames(std::int64_t first, std::int64_t count, PageAdvice advice) const override
+    {
+        if (!valid_) {
+            return;
+        }
+        if (layout_ == shard_manifest::Layout::Particles) {
+            for (const auto& shard : shards_) {
+                shard->adviseFrames(first, count, advice);
+            }
+            return;
+        }
+        // Split the range at shard boundaries
+        const std::int64_t end = first + count;
+        for (std::size_t s = 0; s < shards_.size(); s++) {
+            const std::int64_t shard_begin = first_frames_[s];
+            const std::int64_t shard_end =
+                (s + 1 < shards_.size()) ? first_frames_[s + 1] : std::numeric_limits<std::int64_t>::max();
+            const std::int64_t begin = std::max(first, shard_begin);
+            const std::int64_t stop = std::min(end, shard_end);
+            if (begin < stop) {
+                shards_[s]->adviseFrames(begin - shard_begin, stop - begin, advice);
+            }
+        }
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t frame) const override
+    {
+        if (!valid_) {
+            return 0;
+        }
+        if (layout_ == shard_manifest::Layout::Time) {
+            const std::int64_t last = std::max<std::int64_t>(frame_count_.load() - 1, 0);
+            const std::size_t s = shardOf(std::clamp<std::int64_t>(frame, 0, last));
+            return shards_[s]->storedFrameBytes(frame - first_frames_[s]);
+        }
+        std::uint64_t bytes = 0;
+        for (const auto& shard : shards_) {
+            bytes += shard->storedFrameBytes(frame);
+        }
+        return bytes;
+    }
+
+    /*
+     * The last time shard is the one a restarted run appends to. Particle
+     * shards grow together, so the first stands in for all of them.
+     */
+    std::string followPath() const override
+    {
+        if (paths_.empty()) {
+            return {};
+        }
+        return layout_ == shard_manifest::Layout::Time ? paths_.back() : paths_.front();
+    }
+
+  private:
+    bool inRange(std::int64_t frame) const
+    {
+        return valid_ && frame >= 0 && frame < frame_count_.load();
+    }
+
+    /*
+     * Index of the time shard holding `frame`. Empty shards are skipped,
+     * since the next shard starts at the same frame.
+     */
+    std::size_t shardOf(std::int64_t frame) const
+    {
+        const auto next = std::upper_bound(first_frames_.begin(), first_frames_.end(), frame);
+        return static_cast<std::size_t>(std::max<std::ptrdiff_t>(next - first_frames_.begin() - 1, 0));
+    }
+
+    bool read(std::int64_t frame, glm::vec4* destination, bool velocities) const
+    {
+        if (!inRange(frame)) {
+            return false;
+        }
+        if (layout_ == shard_manifest::Layout::Time) {
+            const std::size_t s = shardOf(frame);
+            const std::int64_t local = frame - first_frames_[s];
+            return velocities ? shards_[s]->readVelocities(local, destination)
+                              : shards_[s]->readPositions(local, destination);
+        }
+        std::vector<char> ok(shards_.size(), 0);
+        forEachShard([&](std::size_t s) {
+            glm::vec4* slice = destination + particle_offsets_[s];
+            ok[s] = velocities ? shards_[s]->readVelocities(frame, slice) : shards_[s]->readPositions(frame, slice);
+        });
+        return std::all_of(ok.begin(), ok.end(), [](char shard_ok) { return shard_ok != 0; });
+    }
+
+    /*
+     * Runs body(s) for every shard, concurrently when there is a pool.
+     */
+    template <typename Body>
+    void forEachShard(Body&& body) const
+    {
+        if (pool_) {
+            pool_->parallelFor(0, static_cast<std::int64_t>(shards_.size()),
+                               [&](std::int64_t s) { body(static_cast<std::size_t>(s)); });
+            return;
+        }
+        for (std::size_t s = 0; s < shards_.size(); s++) {
+            body(s);
+        }
+    }
+
+    shard_manifest::Layout layout_;
+    std::vector<std::unique_ptr<FrameSource>> shards_;
+    std::vector<std::string> paths_;
+    std::vector<std::int64_t> first_frames_;     // time shards: first frame of each shard on the timeline
+    std::vector<std::int64_t> particle_offsets_; // particle shards: first particle of each shard's slice
+    std::int64_t particle_count_ = 0;
+    std::atomic<std::int64_t> frame_count_{0}; // grows under readers on other threads in follow mode
+    glm::dvec3 origin_ = glm::dvec3(0.0);
+    bool valid_ = false;
+    std::unique_ptr<ThreadPool> pool_; // particle shards only; declared last so reads finish before shards go
+};
+
+#endif // PARTICLE_VIEWER_DATA_SHARDED_FRAME_SOURCE_H
@@ -0,0 +1,119 @@
+/*
+ * shm_feed_format.hpp
+ *
+ * Layout of the live feed: a POSIX shared-memory ring of frames that a
+ * simulation running on the same machine publishes into and the viewer draws
+ * from directly (see shm_feed_writer.hpp and shm_frame_source.hpp).
+ *
+ *   [FeedHeader, 128 bytes]
+ *   [SlotState x slot_count, 64 bytes each]
+ *   padding to header_bytes (a multiple of PAGE_ALIGNMENT)
+ *   [slot 0 payload][slot 1 payload]...       each slot_bytes long, page aligned
+ *
+ * Frame f goes into slot f % slot_count. A payload is N vec4 positions,
+ * followed by N vec4 velocities when HAS_VELOCITIES is set (the legacy
+ * PosAndVel frame layout), so a slot can be handed to the renderer as is.
+ *
+ * Each slot is guarded by a sequence counter (a seqlock): the publisher sets
+ * it to writingSequence(f) before touching the payload and to
+ * completeSequence(f) afterwards, then bumps FeedHeader::published to f + 1.
+ * A reader that sees completeSequence(f) before and after using the payload
+ * knows it read frame f untorn. Counters never go backwards, so a stale slot
+ * is told apart from a fresh one without any lock shared with the publisher.
+ *
+ * Fields are native-endian; publisher and viewer run on the same machine.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_SHM_FEED_FORMAT_H
+#define PARTICLE_VIEWER_DATA_SHM_FEED_FORMAT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace shm_feed
+{
+
+constexpr char MAGIC[8] = {'P', 'V', 'L', 'I', 'V', 'E', '0', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint64_t PAGE_ALIGNMENT = 4096;
+
+// A data path of the form "shm:<name>" opens the live feed <name> instead of a file
+constexpr const char* PATH_PREFIX = "shm:";
+
+// Enough slots that a reader drawing straight from a slot is not overtaken by a publisher a few frames ahead
+constexpr std::uint32_t DEFAULT_SLOT_COUNT = 4;
+
+// FeedHeader::flags bits
+constexpr std::uint32_t HAS_VELOCITIES = 1u << 0;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "the feed's counters are shared between processes and must be lock-free");
+
+struct FeedHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_bytes; // offset of slot 0's payload
+    std::uint64_t particle_count;
+    std::uint32_t slot_count;
+    std::uint32_t flags;
+    std::uint64_t slot_bytes; // distance between consecutive slot payloads
+    char reserved[24];
+    // Frames published so far; the newest complete frame is published - 1. On its own cache line.
+    alignas(64) std::atomic<std::uint64_t> published;
+};
+static_assert(sizeof(FeedHeader) == 128, "FeedHeader must stay 128 bytes");
+
+struct SlotState
+{
+    alignas(64) std::atomic<std::uint64_t> sequence; // 0 = never written
+};
+static_assert(sizeof(SlotState) == 64, "SlotState must stay one cache line");
+
+inline std::uint64_t writingSequence(std::uint64_t frame)
+{
+    return 2 * frame + 1;
+}
+
+inline std::uint64_t completeSequence(std::uint64_t frame)
+{
+    return 2 * frame + 2;
+}
+
+inline std::uint64_t pageAlignUp(std::uint64_t value)
+{
+    return (value + PAGE_ALIGNMENT - 1) / PAGE_ALIGNMENT * PAGE_ALIGNMENT;
+}
+
+inline std::uint64_t headerBytes(std::uint32_t slot_count)
+{
+    return pageAlignUp(sizeof(FeedHeader) + sizeof(SlotState) * static_cast<std::uint64_t>(slot_count));
+}
+
+/*
+ * Bytes of one frame's payload: N vec4 positions, plus N vec4 velocities.
+ */
+inline std::uint64_t payloadBytes(std::uint64_t particle_count, std::uint32_t flags)
+{
+    const std::uint64_t streams = (flags & HAS_VELOCITIES) ? 2 : 1;
+    return streams * particle_count * 4 * sizeof(float);
+}
+
+inline bool hasPathPrefix(const std::string& path)
+{
+    return path.compare(0, std::strlen(PATH_PREFIX), PATH_PREFIX) == 0;
+}
+
+/*
+ * shm_open() name for a feed: "sim" and "/sim" both name "/sim".
+ */
+inline std::string objectName(const std::string& name)
+{
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+} // namespace shm_feed
+
+#endif // PARTICLE_VIEWER_DATA_SHM_FEED_FORMAT_H
@@ -0,0 +1,191 @@
+/*
+ * shm_feed_writer.hpp
+ *
+ * Publisher side of the live feed (layout in shm_feed_format.hpp). Creates
+ * the shared-memory ring and copies each new frame into the next slot. Used
+ * by the pv-publish stand-in simulator, tests and benchmarks; a simulation can
+ * include this header to publish its own frames.
+ *
+ * Usage:
+ *   ShmFeedWriter feed;
+ *   if (feed.create("sim", n, shm_feed::DEFAULT_SLOT_COUNT, true)) {
+ *       feed.publish(positions, velocities); // once per output step
+ *   }
+ *
+ * The feed is unlinked when the writer is closed; viewers that already mapped
+ * it keep their mapping and simply stop seeing new frames. POSIX only: on
+ * Windows create() always fails.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_SHM_FEED_WRITER_H
+#define PARTICLE_VIEWER_DATA_SHM_FEED_WRITER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "data/shm_feed_format.hpp"
+
+class ShmFeedWriter
+{
+  public:
+    ShmFeedWriter() = default;
+
+    ~ShmFeedWriter()
+    {
+        close();
+    }
+
+    // Non-copyable: owns a shared-memory object and its mapping
+    ShmFeedWriter(const ShmFeedWriter&) = delete;
+    ShmFeedWriter& operator=(const ShmFeedWriter&) = delete;
+
+    /*
+     * Creates (or replaces) the feed `name` for `particle_count` particles in
+     * `slot_count` slots. Returns false if the shared-memory object cannot be
+     * created or mapped.
+     */
+    bool create(const std::string& name, std::int64_t particle_count, std::uint32_t slot_count, bool with_velocities)
+    {
+        close();
+#ifdef _WIN32
+        (void)name;
+        (void)particle_count;
+        (void)slot_count;
+        (void)with_velocities;
+        return false;
+#else
+        if (particle_count <= 0 || slot_count == 0) {
+            return false;
+        }
+        const std::uint32_t flags = with_velocities ? shm_feed::HAS_VELOCITIES : 0;
+        const std::uint64_t header_bytes = shm_feed::headerBytes(slot_count);
+        const std::uint64_t slot_bytes =
+            shm_feed::pageAlignUp(shm_feed::payloadBytes(static_cast<std::uint64_t>(particle_count), flags));
+        const std::uint64_t total_bytes = header_bytes + slot_bytes * slot_count;
+
+        name_ = shm_feed::objectName(name);
+        shm_unlink(name_.c_str()); // a stale feed from a crashed run would keep its old size
+        fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd_ < 0) {
+            name_.clear();
+            return false;
+        }
+        if (ftruncate(fd_, static_cast<off_t>(total_bytes)) != 0) {
+            close();
+            return false;
+        }
+        void* data = mmap(nullptr, total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED) {
+            close();
+            return false;
+        }
+        data_ = static_cast<unsigned char*>(data);
+        mapped_bytes_ = total_bytes;
+
+        header_ = new (data_) shm_feed::FeedHeader();
+        header_->version = shm_feed::VERSION;
+        header_->header_bytes = static_cast<std::uint32_t>(header_bytes);
+        header_->particle_count = static_cast<std::uint64_t>(particle_count);
+        header_->slot_count = slot_count;
+        header_->flags = flags;
+        header_->slot_bytes = slot_bytes;
+        slots_ = reinterpret_cast<shm_feed::SlotState*>(data_ + sizeof(shm_feed::FeedHeader));
+        for (std::uint32_t slot = 0; slot < slot_count; slot++) {
+            new (&slots_[slot]) shm_feed::SlotState();
+        }
+        // Readers check the magic first, so it goes in once everything else is in place
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header_->magic, shm_feed::MAGIC, sizeof(shm_feed::MAGIC));
+        published_ = 0;
+        return true;
+#endif
+    }
+
+    /*
+     * Copies one frame into the ring and makes it visible to readers. Returns
+     * the new frame's number, or -1 if the feed is not open. `velocities` is
+     * ignored without HAS_VELOCITIES and may be null (stored as zeros).
+     */
+    std::int64_t publish(const glm::vec4* positions, const glm::vec4* velocities)
+    {
+        if (header_ == nullptr) {
+            return -1;
+        }
+        const std::uint64_t frame = published_;
+        const std::uint64_t n = header_->particle_count;
+        shm_feed::SlotState& slot = slots_[frame % header_->slot_count];
+        unsigned char* payload = data_ + header_->header_bytes + (frame % header_->slot_count) * header_->slot_bytes;
+
+        slot.sequence.store(shm_feed::writingSequence(frame), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(payload, positions, sizeof(glm::vec4) * n);
+        if (header_->flags & shm_feed::HAS_VELOCITIES) {
+            if (velocities != nullptr) {
+                std::memcpy(payload + sizeof(glm::vec4) * n, velocities, sizeof(glm::vec4) * n);
+            } else {
+                std::memset(payload + sizeof(glm::vec4) * n, 0, sizeof(glm::vec4) * n);
+            }
+        }
+        slot.sequence.store(shm_feed::completeSequence(frame), std::memory_order_release);
+        published_ = frame + 1;
+        header_->published.store(published_, std::memory_order_release);
+        return static_cast<std::int64_t>(frame);
+    }
+
+    /*
+     * Unmaps and unlinks the feed. Safe to call repeatedly.
+     */
+    void close()
+    {
+#ifndef _WIN32
+        if (data_ != nullptr) {
+            munmap(data_, mapped_bytes_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        if (!name_.empty()) {
+            shm_unlink(name_.c_str());
+        }
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        header_ = nullptr;
+        slots_ = nullptr;
+        mapped_bytes_ = 0;
+        published_ = 0;
+        name_.clear();
+    }
+
+    bool isOpen() const
+    {
+        return header_ != nullptr;
+    }
+
+    std::int64_t publishedFrames() const
+    {
+        return static_cast<std::int64_t>(published_);
+    }
+
+  private:
+    std::string name_;
+    int fd_ = -1;
+    unsigned char* data_ = nullptr;
+    std::uint64_t mapped_bytes_ = 0;
+    shm_feed::FeedHeader* header_ = nullptr;
+    shm_feed::SlotState* slots_ = nullptr;
+    std::uint64_t published_ = 0;
+};
+
+#endif // PARTICLE_VIEWER_DATA_SHM_FEED_WRITER_H
@@ -0,0 +1,234 @@
+/*
+ * shm_frame_source.hpp
+ *
+ * FrameSource over a live feed published by a running simulation (layout in
+ * shm_feed_format.hpp). Frame numbers are the publisher's: frameCount() is the
+ * number of frames published when refreshFrameCount() last ran, and only the
+ * newest slot_count of them are still in the ring.
+ *
+ * mappedPositions() hands out a pointer straight into the shared slot, so the
+ * renderer uploads from the publisher's pages without an intermediate copy.
+ * That pointer stays valid, but its contents are replaced once the publisher
+ * laps the ring; with the default slot count a publisher would have to run
+ * several frames ahead within a single rendered frame for a draw to tear.
+ * readPositions() and readVelocities() copy under the slot's sequence counter
+ * and fail rather than return a torn or overwritten frame.
+ *
+ * POSIX only: on Windows open() always fails.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_SHM_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_SHM_FRAME_SOURCE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+#include "data/shm_feed_format.hpp"
+
+class ShmFrameSource : public FrameSource
+{
+  public:
+    ShmFrameSource() = default;
+
+    ~ShmFrameSource() override
+    {
+        close();
+    }
+
+    // Non-copyable: owns a shared-memory mapping
+    ShmFrameSource(const ShmFrameSource&) = delete;
+    ShmFrameSource& operator=(const ShmFrameSource&) = delete;
+
+    /*
+     * Maps the feed `name` read-only. Returns false if it does not exist or
+     * its header is not a complete version-1 feed header.
+     */
+    bool open(const std::string& name)
+    {
+        close();
+#ifdef _WIN32
+        (void)name;
+        return false;
+#else
+        const int fd = shm_open(shm_feed::objectName(name).c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat feed_stat;
+        if (fstat(fd, &feed_stat) != 0) {
+            ::close(fd);
+            return false;
+        }
+        const std::uint64_t size = static_cast<std::uint64_t>(feed_stat.st_size);
+        if (size < sizeof(shm_feed::FeedHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping keeps the object alive
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const unsigned char*>(data);
+        mapped_bytes_ = size;
+        if (!validateHeader()) {
+            close();
+            return false;
+        }
+        refreshFrameCount();
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (data_ != nullptr) {
+            munmap(const_cast<unsigned char*>(data_), mapped_bytes_);
+        }
+#endif
+        data_ = nullptr;
+        header_ = nullptr;
+        slots_ = nullptr;
+        mapped_bytes_ = 0;
+        frame_count_ = 0;
+    }
+
+    bool isOpen() const
+    {
+        return header_ != nullptr;
+    }
+
+    std::int64_t particleCount() const override
+    {
+        return header_ ? static_cast<std::int64_t>(header_->particle_count) : 0;
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return frame_count_;
+    }
+
+    std::int64_t refreshFrameCount() override
+    {
+        if (header_ != nullptr) {
+            frame_count_ = static_cast<std::int64_t>(header_->published.load(std::memory_order_acquire));
+        }
+        return frame_count_;
+    }
+
+    bool isLive() const override
+    {
+        return true;
+    }
+
+    bool readPositions(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return copyStream(frame, 0, destination);
+    }
+
+    bool readVelocities(std::int64_t frame, glm::vec4* destination) const override
+    {
+        if (!header_ || !(header_->flags & shm_feed::HAS_VELOCITIES)) {
+            return false;
+        }
+        return copyStream(frame, 1, destination);
+    }
+
+    /*
+     * Pointer into the shared slot holding `frame`, or nullptr if the frame
+     * is not complete in the ring right now (not yet published, being
+     * rewritten, or overwritten).
+     */
+    const glm::vec4* mappedPositions(std::int64_t frame) const override
+    {
+        if (!holdsCompleteFrame(frame, std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return reinterpret_cast<const glm::vec4*>(payload(frame));
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t frame) const override
+    {
+        (void)frame;
+        return header_ ? shm_feed::payloadBytes(header_->particle_count, header_->flags) : 0;
+    }
+
+    std::uint32_t slotCount() const
+    {
+        return header_ ? header_->slot_count : 0;
+    }
+
+  private:
+    bool validateHeader()
+    {
+        const auto* header = reinterpret_cast<const shm_feed::FeedHeader*>(data_);
+        if (std::memcmp(header->magic, shm_feed::MAGIC, sizeof(shm_feed::MAGIC)) != 0) {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire); // pairs with the publisher's fence before the magic
+        if (header->version != shm_feed::VERSION || header->slot_count == 0 || header->particle_count == 0) {
+            return false;
+        }
+        const std::uint64_t payload_bytes = shm_feed::payloadBytes(header->particle_count, header->flags);
+        if (header->header_bytes < shm_feed::headerBytes(header->slot_count) || header->slot_bytes < payload_bytes ||
+            header->header_bytes % shm_feed::PAGE_ALIGNMENT != 0) {
+            return false;
+        }
+        if (header->header_bytes + header->slot_bytes * header->slot_count > mapped_bytes_) {
+            return false;
+        }
+        header_ = header;
+        slots_ = reinterpret_cast<const shm_feed::SlotState*>(data_ + sizeof(shm_feed::FeedHeader));
+        return true;
+    }
+
+    bool holdsCompleteFrame(std::int64_t frame, std::memory_order order) const
+    {
+        if (header_ == nullptr || frame < 0) {
+            return false;
+        }
+        const std::uint64_t wanted = shm_feed::completeSequence(static_cast<std::uint64_t>(frame));
+        return slots_[static_cast<std::uint64_t>(frame) % header_->slot_count].sequence.load(order) == wanted;
+    }
+
+    const unsigned char* payload(std::int64_t frame) const
+    {
+        const std::uint64_t slot = static_cast<std::uint64_t>(frame) % header_->slot_count;
+        return data_ + header_->header_bytes + slot * header_->slot_bytes;
+    }
+
+    /*
+     * Seqlock read of one stream (0 = positions, 1 = velocities) of `frame`.
+     */
+    bool copyStream(std::int64_t frame, int stream, glm::vec4* destination) const
+    {
+        if (!holdsCompleteFrame(frame, std::memory_order_acquire)) {
+            return false;
+        }
+        const std::uint64_t stream_bytes = sizeof(glm::vec4) * header_->particle_count;
+        std::memcpy(destination, payload(frame) + stream * stream_bytes, stream_bytes);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return holdsCompleteFrame(frame, std::memory_order_relaxed);
+    }
+
+    const unsigned char* data_ = nullptr;
+    std::uint64_t mapped_bytes_ = 0;
+    const shm_feed::FeedHeader* header_ = nullptr;
+    const shm_feed::SlotState* slots_ = nullptr;
+    std::atomic<std::int64_t> frame_count_{0}; // refreshed on the render thread, read by loader threads
+};
+
+#endif // PARTICLE_VIEWER_DATA_SHM_FRAME_SOURCE_H
@@ -0,0 +1,474 @@
+/*
+ * subset_exporter.hpp
+ *
+ * Exports part of a dataset as a new legacy run folder: a window of frames,
+ * the particles of some types, and optionally only those inside a box. The
+ * particle set is fixed by the first exported frame (a PosAndVel holds the
+ * same N particles in every frame), so particles leaving the box later stay
+ * in the export.
+ *
+ * Frames are streamed through in batches: the frames of a batch are read and
+ * filtered in parallel on a pool while the previous batch is written on its
+ * own thread, and only a batch's worth of frames is held at a time. The
+ * output folder gets a float PosAndVel, the source's RunSetup with N set to
+ * the exported particle count, and a COMFile with one entry per exported
+ * frame. Shared by the pv-export command-line tool, the viewer's export
+ * dialog and the tests.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_SUBSET_EXPORTER_H
+#define PARTICLE_VIEWER_DATA_SUBSET_EXPORTER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/com_track.hpp"
+#include "data/frame_source.hpp"
+#include "data/page_advice.hpp"
+#include "data/thread_pool.hpp"
+
+/*
+ * What to export. Frames are inclusive; a negative last_frame means the last
+ * frame of the dataset. The box is in the coordinates the source reads (see
+ * FrameSource::positionOrigin) and is tested against the first exported frame.
+ */
+struct ExportSelection
+{
+    std::int64_t first_frame = 0;
+    std::int64_t last_frame = -1;
+    std::uint32_t type_mask = com_track::ALL_TYPES;
+    bool use_box = false;
+    glm::vec3 box_min{0.0f};
+    glm::vec3 box_max{0.0f};
+};
+
+/*
+ * Shared with a running export: frames written so far, and a flag that
+ * stops it after the batch in flight.
+ */
+struct ExportProgress
+{
+    std::atomic<std::int64_t> frames_done{0};
+    std::atomic<std::int64_t> frames_total{0};
+    std::atomic<bool> cancel{false};
+};
+
+struct ExportResult
+{
+    bool ok = false;
+    std::int64_t frames = 0;
+    std::int64_t particles = 0;
+    std::uint64_t bytes = 0; // PosAndVel bytes written
+    std::string error;
+};
+
+namespace subset_export
+{
+
+// N is the 31st name=value entry of a RunSetup, in the order SettingsIO parses it
+constexpr int RUN_SETUP_N_ENTRY = 30;
+
+// Upper bound on the frames held by one batch (inputs and both output buffers)
+constexpr std::uint64_t BATCH_MEMORY_BYTES = std::uint64_t(1) << 30;
+
+// stdio buffer of the output files
+constexpr std::size_t WRITE_BUFFER_BYTES = std::size_t(8) << 20;
+
+/*
+ * Parses "first:last" (inclusive; either side may be empty for the start or
+ * the end of the dataset) or a single frame.
+ */
+inline bool parseFrameRange(const std::string& text, std::int64_t& first, std::int64_t& last)
+{
+    const std::size_t colon = text.find(':');
+    const std::string first_text = text.substr(0, colon);
+    const std::string last_text = colon == std::string::npos ? first_text : text.substr(colon + 1);
+    std::int64_t parsed_first = 0;
+    std::int64_t parsed_last = -1;
+    char* end = nullptr;
+    if (!first_text.empty()) {
+        parsed_first = std::strtoll(first_text.c_str(), &end, 10);
+        if (*end != '\0' || parsed_first < 0) {
+            return false;
+        }
+    }
+    if (!last_text.empty()) {
+        parsed_last = std::strtoll(last_text.c_str(), &end, 10);
+        if (*end != '\0' || parsed_last < parsed_first) {
+            return false;
+        }
+    }
+    if (text.empty() || text == ":") {
+        return false;
+    }
+    first = parsed_first;
+    last = parsed_last;
+    return true;
+}
+
+/*
+ * Parses "x0,y0,z0,x1,y1,z1", two opposite corners in any order.
+ */
+inline bool parseBox(const std::string& text, glm::vec3& box_min, glm::vec3& box_max)
+{
+    float values[6];
+    std::stringstream stream(text);
+    std::string item;
+    int count = 0;
+    while (std::getline(stream, item, ',')) {
+        char* end = nullptr;
+        const float value = std::strtof(item.c_str(), &end);
+        if (count == 6 || item.empty() || *end != '\0') {
+            return false;
+        }
+        values[count++] = value;
+    }
+    if (count != 6) {
+        return false;
+    }
+    const glm::vec3 a(values[0], values[1], values[2]);
+    const glm::vec3 b(values[3], values[4], values[5]);
+    box_min = glm::vec3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    box_max = glm::vec3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    return true;
+}
+
+/*
+ * Indices of the particles of `positions` that `selection` keeps. A particle
+ * whose w is not a type 0-3 code is only kept when every type is.
+ */
+inline std::vector<std::int64_t> selectParticles(const glm::vec4* positions, std::int64_t n,
+                                                 const ExportSelection& selection)
+{
+    std::vector<std::int64_t> selected;
+    for (std::int64_t i = 0; i < n; i++) {
+        const glm::vec4& p = positions[i];
+        if ((selection.type_mask & (1u << com_track::typeSlot(p.w))) == 0) {
+            continue;
+        }
+        if (selection.use_box && !(p.x >= selection.box_min.x && p.x <= selection.box_max.x &&
+                                   p.y >= selection.box_min.y && p.y <= selection.box_max.y &&
+                                   p.z >= selection.box_min.z && p.z <= selection.box_max.z)) {
+            continue;
+        }
+        selected.push_back(i);
+    }
+    return selected;
+}
+
+/*
+ * Copies the RunSetup at `source_path` to `output_path` with its N entry set
+ * to `particle_count`; every other entry is kept as written.
+ */
+inline bool writeRunSetup(const std::string& source_path, const std::string& output_path,
+                          std::int64_t particle_count, std::string& error)
+{
+    std::ifstream in(source_path, std::ios::binary);
+    if (!in.is_open()) {
+        error = "cannot read " + source_path;
+        return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    std::string text = contents.str();
+
+    std::size_t equals = std::string::npos;
+    for (int entry = 0; entry <= RUN_SETUP_N_ENTRY; entry++) {
+        equals = text.find('=', equals == std::string::npos ? 0 : equals + 1);
+        if (equals == std::string::npos) {
+            error = source_path + " has no N entry";
+            return false;
+        }
+    }
+    const std::size_t value_begin = std::min(text.find_first_not_of(" \t", equals + 1), text.size());
+    const std::size_t value_end = std::min(text.find_first_not_of("0123456789", value_begin), text.size());
+    text.replace(value_begin, value_end - value_begin, std::to_string(particle_count));
+
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    out << text;
+    if (!out.good()) {
+        error = "cannot write " + output_path;
+        return false;
+    }
+    return true;
+}
+
+// Suffix of the files an export writes before they are renamed into place
+constexpr const char* TEMP_SUFFIX = ".tmp";
+
+/*
+ * Renames each `path` + TEMP_SUFFIX over `path`, replacing what was there.
+ * Stops at the first rename that fails.
+ */
+inline bool renameIntoPlace(const std::vector<std::string>& paths, std::string& error)
+{
+    for (const std::string& path : paths) {
+        std::error_code ec;
+        std::filesystem::rename(path + TEMP_SUFFIX, path, ec);
+        if (ec) {
+            error = "cannot replace " + path + ": " + ec.message();
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * One batch of exported frames: positions then velocities of each frame, as
+ * they go into the PosAndVel, and the frames' COMFile entries.
+ */
+struct Batch
+{
+    std::vector<glm::vec4> frames;
+    std::vector<glm::vec4> com;
+    std::int64_t count = 0;
+};
+
+/*
+ * Scratch a batch slot reads a frame into.
+ */
+struct Scratch
+{
+    std::vector<glm::vec4> positions; // only for sources without mapped frames
+    std::vector<glm::vec4> velocities;
+};
+
+} // namespace subset_export
+
+/*
+ * Exports `selection` of `source` into `output_folder` (created if needed).
+ * `run_setup_path` is the source's RunSetup, which must exist; `com_path` its
+ * COMFile, if any. Entries the COMFile holds are carried over (renumbered);
+ * other frames get the centre of mass of the whole frame, weighted by
+ * `type_masses` when given. Batches are filtered on `pool` (serially when it
+ * is nullptr). The files are written under TEMP_SUFFIX names and only
+ * renamed over the PosAndVel, COMFile and RunSetup of the output folder once
+ * all of them are complete, so on failure or cancellation nothing is left in
+ * the output folder but what was there before.
+ */
+inline ExportResult exportSubset(const FrameSource& source, const std::string& run_setup_path,
+                                 const std::string& com_path, const std::string& output_folder,
+                                 const ExportSelection& selection, ThreadPool* pool,
+                                 const std::array<double, com_track::TYPE_SLOTS>* type_masses = nullptr,
+                                 ExportProgress* progress = nullptr)
+{
+    using subset_export::Batch;
+    using subset_export::Scratch;
+
+    ExportResult result;
+    const std::int64_t n = source.particleCount();
+    const std::int64_t first = selection.first_frame;
+    const std::int64_t last = selection.last_frame < 0 ? source.frameCount() - 1 : selection.last_frame;
+    if (first < 0 || first > last || last >= source.frameCount()) {
+        result.error = "frames " + std::to_string(first) + " to " + std::to_string(last) + " are not in the dataset (" +
+                       std::to_string(source.frameCount()) + " frames)";
+        return result;
+    }
+    if (!std::filesystem::exists(run_setup_path)) {
+        result.error = "the dataset has no RunSetup (" + run_setup_path + ") to write N into";
+        return result;
+    }
+    std::error_code ec;
+    const std::filesystem::path source_folder = std::filesystem::path(run_setup_path).parent_path();
+    if (std::filesystem::equivalent(output_folder, source_folder.empty() ? "." : source_folder, ec)) {
+        result.error = "the output folder is the dataset's own folder";
+        return result;
+    }
+
+    // The first exported frame decides which particles are kept
+    Scratch first_scratch;
+    first_scratch.positions.resize(static_cast<std::size_t>(n));
+    if (!source.readPositions(first, first_scratch.positions.data())) {
+        result.error = "cannot read frame " + std::to_string(first);
+        return result;
+    }
+    const std::vector<std::int64_t> selected =
+        subset_export::selectParticles(first_scratch.positions.data(), n, selection);
+    first_scratch = Scratch();
+    const std::int64_t m = static_cast<std::int64_t>(selected.size());
+    if (m == 0) {
+        result.error = "no particles match the selection in frame " + std::to_string(first);
+        return result;
+    }
+    const bool all_particles = m == n;
+
+    std::vector<glm::vec4> stored_com;
+    com_track::loadFile(com_path, stored_com);
+    const glm::dvec3 origin = source.positionOrigin();
+
+    const std::string pos_path = output_folder + "/PosAndVel";
+    const std::string com_out_path = output_folder + "/COMFile";
+    const std::string run_setup_out_path = output_folder + "/RunSetup";
+    const std::string pos_temp = pos_path + subset_export::TEMP_SUFFIX;
+    const std::string com_temp = com_out_path + subset_export::TEMP_SUFFIX;
+    const std::string run_setup_temp = run_setup_out_path + subset_export::TEMP_SUFFIX;
+    const bool created_folder = std::filesystem::create_directories(output_folder, ec);
+    auto discardOutput = [&] {
+        std::remove(pos_temp.c_str());
+        std::remove(com_temp.c_str());
+        std::remove(run_setup_temp.c_str());
+        if (created_folder) {
+            std::filesystem::remove(output_folder, ec); // only if still empty
+        }
+        result.frames = 0;
+        result.bytes = 0;
+    };
+    std::FILE* pos_file = std::fopen(pos_temp.c_str(), "wb");
+    std::FILE* com_file = std::fopen(com_temp.c_str(), "wb");
+    if (pos_file == nullptr || com_file == nullptr) {
+        result.error = "cannot create " + (pos_file == nullptr ? pos_temp : com_temp);
+        if (pos_file) {
+            std::fclose(pos_file);
+        }
+        if (com_file) {
+            std::fclose(com_file);
+        }
+        discardOutput();
+        return result;
+    }
+    std::setvbuf(pos_file, nullptr, _IOFBF, subset_export::WRITE_BUFFER_BYTES);
+
+    // A slot holds one frame's input scratch and its share of both output buffers
+    const std::uint64_t frame_out_bytes = 2 * static_cast<std::uint64_t>(m) * sizeof(glm::vec4);
+    const std::uint64_t slot_bytes = 2 * static_cast<std::uint64_t>(n) * sizeof(glm::vec4) + 2 * frame_out_bytes;
+    const std::int64_t total = last - first + 1;
+    const std::int64_t batch_frames = std::clamp<std::int64_t>(
+        static_cast<std::int64_t>(subset_export::BATCH_MEMORY_BYTES / slot_bytes), 1,
+        std::min<std::int64_t>(pool ? pool->size() : 1, total));
+    std::vector<Scratch> scratch(static_cast<std::size_t>(batch_frames));
+    Batch batches[2];
+    for (Batch& batch : batches) {
+        batch.frames.resize(static_cast<std::size_t>(batch_frames * 2 * m));
+        batch.com.resize(static_cast<std::size_t>(batch_frames));
+    }
+    if (progress) {
+        progress->frames_done.store(0, std::memory_order_relaxed);
+        progress->frames_total.store(total, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> read_failed{false};
+    bool write_failed = false;
+    std::thread writer;
+    auto waitForWriter = [&] {
+        if (writer.joinable()) {
+            writer.join();
+        }
+    };
+
+    auto exportFrame = [&](Batch& batch, std::int64_t slot, std::int64_t frame) {
+        Scratch& frame_scratch = scratch[slot];
+        const glm::vec4* positions = source.mappedPositions(frame);
+        if (positions == nullptr) {
+            frame_scratch.positions.resize(static_cast<std::size_t>(n));
+            if (!source.readPositions(frame, frame_scratch.positions.data())) {
+                read_failed = true;
+                return;
+            }
+            positions = frame_scratch.positions.data();
+        }
+        frame_scratch.velocities.resize(static_cast<std::size_t>(n));
+        if (!source.readVelocities(frame, frame_scratch.velocities.data())) {
+            read_failed = true;
+            return;
+        }
+        const glm::vec4* velocities = frame_scratch.velocities.data();
+        glm::vec4* out_positions = batch.frames.data() + slot * 2 * m;
+        glm::vec4* out_velocities = out_positions + m;
+        if (all_particles) {
+            std::memcpy(out_positions, positions, static_cast<std::size_t>(m) * sizeof(glm::vec4));
+            std::memcpy(out_velocities, velocities, static_cast<std::size_t>(m) * sizeof(glm::vec4));
+        } else {
+            for (std::int64_t j = 0; j < m; j++) {
+                out_positions[j] = positions[selected[j]];
+                out_velocities[j] = velocities[selected[j]];
+            }
+        }
+
+        glm::dvec3 com(0.0);
+        if (frame < static_cast<std::int64_t>(stored_com.size()) &&
+            static_cast<std::int64_t>(stored_com[frame].w) == frame) {
+            com = glm::dvec3(stored_com[frame].x, stored_com[frame].y, stored_com[frame].z) - origin;
+        } else {
+            const com_track::TypeSums sums = com_track::reduce(positions, n, nullptr);
+            com_track::centreOfMass(sums, type_masses, com_track::ALL_TYPES, com);
+        }
+        batch.com[slot] = glm::vec4(glm::vec3(com), static_cast<float>(frame - first));
+    };
+
+    int current = 0;
+    for (std::int64_t batch_first = first; batch_first <= last; batch_first += batch_frames) {
+        if (progress && progress->cancel.load(std::memory_order_relaxed)) {
+            result.error = "cancelled";
+            break;
+        }
+        Batch& batch = batches[current];
+        batch.count = std::min(batch_frames, last - batch_first + 1);
+        source.adviseFrames(batch_first + batch.count, batch_frames, PageAdvice::WillNeed);
+        if (pool) {
+            pool->parallelFor(0, batch.count,
+                              [&](std::int64_t slot) { exportFrame(batch, slot, batch_first + slot); });
+        } else {
+            for (std::int64_t slot = 0; slot < batch.count; slot++) {
+                exportFrame(batch, slot, batch_first + slot);
+            }
+        }
+        // Each frame is read once; keep the run from pushing everything else out of the page cache
+        source.adviseFrames(batch_first, batch.count, PageAdvice::DontNeed);
+        if (read_failed) {
+            result.error = "cannot read frames " + std::to_string(batch_first) + " to " +
+                           std::to_string(batch_first + batch.count - 1);
+            break;
+        }
+
+        waitForWriter();
+        if (write_failed) {
+            break;
+        }
+        writer = std::thread([&, batch_ptr = &batch] {
+            const std::size_t values = static_cast<std::size_t>(batch_ptr->count * 2 * m);
+            const std::size_t entries = static_cast<std::size_t>(batch_ptr->count);
+            if (std::fwrite(batch_ptr->frames.data(), sizeof(glm::vec4), values, pos_file) != values ||
+                std::fwrite(batch_ptr->com.data(), sizeof(glm::vec4), entries, com_file) != entries) {
+                write_failed = true;
+                return;
+            }
+            result.bytes += values * sizeof(glm::vec4);
+            result.frames += batch_ptr->count;
+            if (progress) {
+                progress->frames_done.store(result.frames, std::memory_order_relaxed);
+            }
+        });
+        current = 1 - current;
+    }
+    waitForWriter();
+
+    const bool pos_closed = std::fclose(pos_file) == 0;
+    const bool closed = std::fclose(com_file) == 0 && pos_closed;
+    if (result.error.empty() && (write_failed || !closed)) {
+        result.error = "cannot write " + pos_temp;
+    }
+    if (result.error.empty() && subset_export::writeRunSetup(run_setup_path, run_setup_temp, m, result.error) &&
+        subset_export::renameIntoPlace({pos_path, com_out_path, run_setup_out_path}, result.error)) {
+        result.ok = true;
+        result.particles = m;
+        return result;
+    }
+    discardOutput();
+    return result;
+}
+
+#endif // PARTICLE_VIEWER_DATA_SUBSET_EXPORTER_H
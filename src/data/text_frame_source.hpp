@@ -0,0 +1,103 @@
+/*
+ * text_frame_source.hpp
+ *
+ * FrameSource over a text snapshot (text_importer.hpp): the file is parsed
+ * once when the source is opened and held in memory as a single frame, so
+ * mappedPositions() hands the parsed positions to the Particle without a
+ * further copy. A shard manifest of snapshots turns a folder of them into a
+ * timeline.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_TEXT_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_TEXT_FRAME_SOURCE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+#include "data/text_importer.hpp"
+#include "data/thread_pool.hpp"
+
+class TextFrameSource : public FrameSource
+{
+  public:
+    /*
+     * Parses `path` with `columns` on `threads` threads (0: one per hardware
+     * thread). Check isValid() afterwards.
+     */
+    TextFrameSource(const std::string& path, const std::vector<text_import::Column>& columns, unsigned threads = 0)
+    {
+        ThreadPool pool(threads);
+        valid_ = text_import::load(path, columns, &pool, snapshot_, error_);
+        if (!valid_) {
+            snapshot_ = text_import::Snapshot{};
+        }
+    }
+
+    bool isValid() const
+    {
+        return valid_;
+    }
+
+    /*
+     * Why the file did not parse; empty when it did.
+     */
+    const std::string& error() const
+    {
+        return error_;
+    }
+
+    std::int64_t particleCount() const override
+    {
+        return static_cast<std::int64_t>(snapshot_.positions.size());
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return valid_ ? 1 : 0;
+    }
+
+    bool readPositions(std::int64_t frame, glm::vec4* destination) const override
+    {
+        const glm::vec4* positions = mappedPositions(frame);
+        if (positions == nullptr) {
+            return false;
+        }
+        std::copy(positions, positions + particleCount(), destination);
+        return true;
+    }
+
+    /*
+     * Fails when the column map had no velocity columns.
+     */
+    bool readVelocities(std::int64_t frame, glm::vec4* destination) const override
+    {
+        if (mappedPositions(frame) == nullptr || snapshot_.velocities.empty()) {
+            return false;
+        }
+        std::copy(snapshot_.velocities.begin(), snapshot_.velocities.end(), destination);
+        return true;
+    }
+
+    const glm::vec4* mappedPositions(std::int64_t frame) const override
+    {
+        return (valid_ && frame == 0) ? snapshot_.positions.data() : nullptr;
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t frame) const override
+    {
+        (void)frame;
+        return sizeof(glm::vec4) * (snapshot_.positions.size() + snapshot_.velocities.size());
+    }
+
+  private:
+    text_import::Snapshot snapshot_;
+    std::string error_;
+    bool valid_ = false;
+};
+
+#endif // PARTICLE_VIEWER_DATA_TEXT_FRAME_SOURCE_H
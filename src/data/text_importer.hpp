@@ -0,0 +1,361 @@
+/*
+ * text_importer.hpp
+ *
+ * Parses particle snapshots written as text, one particle per line:
+ *
+ *   # x y z type vx vy vz
+ *   1.25 -3.5 0.0 1 0.01 0.0 -0.2
+ *   1.50,-3.25,0.5,0,0.02,0.0,-0.1
+ *
+ * Fields are separated by any run of spaces, tabs and commas, so the same
+ * parser reads whitespace-separated and CSV files. The column map (see
+ * parseColumns()) says which field holds x, y, z, the particle type code and
+ * the velocity components; fields past the mapped ones are ignored. Lines that
+ * do not start with a number (blank lines, '#' comments, a CSV header) are
+ * skipped.
+ *
+ * The file is split into chunks at line boundaries and the chunks are parsed
+ * concurrently with std::from_chars, each straight into its rows of the
+ * output. A first pass over the chunks only counts rows, which is what lets
+ * every chunk know where its rows go before any of them is parsed.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_TEXT_IMPORTER_H
+#define PARTICLE_VIEWER_DATA_TEXT_IMPORTER_H
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/mapped_file.hpp"
+#include "data/thread_pool.hpp"
+
+namespace text_import
+{
+
+enum class Column
+{
+    Skip, // field is read past, whatever it holds
+    X,
+    Y,
+    Z,
+    Type, // particle type code, stored in the w lane of the position
+    VelocityX,
+    VelocityY,
+    VelocityZ
+};
+
+constexpr const char* DEFAULT_COLUMNS = "x,y,z,type";
+
+// Type code of every particle when the column map has no type column (sphereVertex.vs colour 0)
+constexpr float DEFAULT_TYPE = 0.0f;
+
+// Bytes of text per parse task; chunks end at the first line break past this size
+constexpr std::uint64_t CHUNK_BYTES = 8ull << 20;
+
+struct Snapshot
+{
+    std::vector<glm::vec4> positions;  // w holds the type code
+    std::vector<glm::vec4> velocities; // empty unless the column map has velocity columns
+};
+
+/*
+ * Parses a column map such as "x,y,z,type,vx,vy,vz": one name per field, in
+ * file order. "-" or "skip" reads past a field. x, y and z are required;
+ * velocity columns come as all three or none. Returns false, with a message
+ * in `error`, on an unknown or repeated name.
+ */
+inline bool parseColumns(const std::string& spec, std::vector<Column>& columns, std::string& error)
+{
+    columns.clear();
+    std::vector<std::string> seen;
+    std::size_t begin = 0;
+    while (begin <= spec.size()) {
+        std::size_t end = spec.find(',', begin);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string name = spec.substr(begin, end - begin);
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        begin = end + 1;
+
+        Column column;
+        if (name == "-" || name == "skip") {
+            columns.push_back(Column::Skip);
+            continue;
+        } else if (name == "x") {
+            column = Column::X;
+        } else if (name == "y") {
+            column = Column::Y;
+        } else if (name == "z") {
+            column = Column::Z;
+        } else if (name == "type") {
+            column = Column::Type;
+        } else if (name == "vx") {
+            column = Column::VelocityX;
+        } else if (name == "vy") {
+            column = Column::VelocityY;
+        } else if (name == "vz") {
+            column = Column::VelocityZ;
+        } else {
+            error = "unknown column '" + name + "'";
+            return false;
+        }
+        if (std::find(seen.begin(), seen.end(), name) != seen.end()) {
+            error = "column '" + name + "' given twice";
+            return false;
+        }
+        seen.push_back(name);
+        columns.push_back(column);
+    }
+
+    auto has = [&](Column column) { return std::find(columns.begin(), columns.end(), column) != columns.end(); };
+    if (!has(Column::X) || !has(Column::Y) || !has(Column::Z)) {
+        error = "columns must include x, y and z";
+        return false;
+    }
+    const int velocity_columns = has(Column::VelocityX) + has(Column::VelocityY) + has(Column::VelocityZ);
+    if (velocity_columns != 0 && velocity_columns != 3) {
+        error = "velocity columns need all of vx, vy and vz";
+        return false;
+    }
+    return true;
+}
+
+inline bool hasVelocities(const std::vector<Column>& columns)
+{
+    return std::find(columns.begin(), columns.end(), Column::VelocityX) != columns.end();
+}
+
+/*
+ * True for the file extensions taken to be text snapshots: .csv, .tsv,
+ * .txt and .xyz, in any case.
+ */
+inline bool isTextFile(const std::string& path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".csv" || extension == ".tsv" || extension == ".txt" || extension == ".xyz";
+}
+
+inline bool isSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+/*
+ * A line holds a particle if its first field starts like a number.
+ */
+inline bool isDataLine(const char* line, const char* end)
+{
+    while (line < end && isSeparator(*line)) {
+        line++;
+    }
+    return line < end && (std::isdigit(static_cast<unsigned char>(*line)) || *line == '-' || *line == '+' ||
+                          *line == '.');
+}
+
+/*
+ * Parses one particle line. Returns 0 on success, otherwise the 1-based
+ * number of the field that is missing or not a number.
+ */
+inline int parseRow(const char* line, const char* end, const std::vector<Column>& columns, glm::vec4& position,
+                    glm::vec4& velocity)
+{
+    position = glm::vec4(0.0f, 0.0f, 0.0f, DEFAULT_TYPE);
+    velocity = glm::vec4(0.0f);
+    int field = 0;
+    for (const Column column : columns) {
+        field++;
+        while (line < end && isSeparator(*line)) {
+            line++;
+        }
+        if (line == end) {
+            return field;
+        }
+        if (column == Column::Skip) {
+            while (line < end && !isSeparator(*line)) {
+                line++;
+            }
+            continue;
+        }
+        if (*line == '+') {
+            line++; // from_chars takes no leading plus
+        }
+        float value = 0.0f;
+        const std::from_chars_result parsed = std::from_chars(line, end, value);
+        if (parsed.ec != std::errc() || (parsed.ptr != end && !isSeparator(*parsed.ptr))) {
+            return field;
+        }
+        line = parsed.ptr;
+        switch (column) {
+            case Column::X:
+                position.x = value;
+                break;
+            case Column::Y:
+                position.y = value;
+                break;
+            case Column::Z:
+                position.z = value;
+                break;
+            case Column::Type:
+                position.w = value;
+                break;
+            case Column::VelocityX:
+                velocity.x = value;
+                break;
+            case Column::VelocityY:
+                velocity.y = value;
+                break;
+            case Column::VelocityZ:
+                velocity.z = value;
+                break;
+            case Column::Skip:
+                break;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Calls line(begin, end) for every line in [begin, end), without the '\n'.
+ */
+template <typename LineFn>
+void forEachLine(const char* begin, const char* end, LineFn&& line)
+{
+    while (begin < end) {
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+        const char* line_end = newline ? newline : end;
+        line(begin, line_end);
+        begin = line_end + 1;
+    }
+}
+
+/*
+ * Parses `size` bytes of snapshot text into `snapshot`, on `pool` when one is
+ * given. Returns false, with the first bad line in `error`, if a particle
+ * line is short of the mapped fields or one of them is not a number, or if
+ * the text holds no particles at all.
+ */
+inline bool parse(const char* text, std::uint64_t size, const std::vector<Column>& columns, ThreadPool* pool,
+                  Snapshot& snapshot, std::string& error, std::uint64_t chunk_bytes = CHUNK_BYTES)
+{
+    struct Chunk
+    {
+        const char* begin;
+        const char* end;
+        std::int64_t lines = 0;
+        std::int64_t rows = 0;
+        std::int64_t first_line = 0; // lines before this chunk
+        std::int64_t first_row = 0;  // particles before this chunk
+        std::int64_t bad_line = 0;   // 1-based line of the first parse error, 0 if none
+        int bad_field = 0;
+    };
+    std::vector<Chunk> chunks;
+    std::uint64_t begin = 0;
+    while (begin < size) {
+        std::uint64_t end = std::min(size, begin + std::max<std::uint64_t>(chunk_bytes, 1));
+        if (end < size) {
+            const void* newline = std::memchr(text + end, '\n', static_cast<std::size_t>(size - end));
+            end = newline ? static_cast<std::uint64_t>(static_cast<const char*>(newline) - text) + 1 : size;
+        }
+        chunks.push_back(Chunk{text + begin, text + end});
+        begin = end;
+    }
+    auto forEachChunk = [&](auto&& body) {
+        if (pool) {
+            pool->parallelFor(0, static_cast<std::int64_t>(chunks.size()), [&](std::int64_t i) { body(chunks[i]); });
+            return;
+        }
+        for (Chunk& chunk : chunks) {
+            body(chunk);
+        }
+    };
+
+    forEachChunk([](Chunk& chunk) {
+        forEachLine(chunk.begin, chunk.end, [&](const char* line, const char* line_end) {
+            chunk.lines++;
+            chunk.rows += isDataLine(line, line_end) ? 1 : 0;
+        });
+    });
+    std::int64_t rows = 0;
+    std::int64_t lines = 0;
+    for (Chunk& chunk : chunks) {
+        chunk.first_row = rows;
+        chunk.first_line = lines;
+        rows += chunk.rows;
+        lines += chunk.lines;
+    }
+    if (rows == 0) {
+        error = "no particle lines";
+        return false;
+    }
+
+    const bool velocities = hasVelocities(columns);
+    snapshot.positions.resize(static_cast<std::size_t>(rows));
+    snapshot.velocities.resize(velocities ? static_cast<std::size_t>(rows) : 0);
+    forEachChunk([&](Chunk& chunk) {
+        std::int64_t row = chunk.first_row;
+        std::int64_t line_number = chunk.first_line;
+        glm::vec4 velocity;
+        forEachLine(chunk.begin, chunk.end, [&](const char* line, const char* line_end) {
+            line_number++;
+            if (chunk.bad_line != 0 || !isDataLine(line, line_end)) {
+                return;
+            }
+            chunk.bad_field = parseRow(line, line_end, columns, snapshot.positions[row], velocity);
+            if (chunk.bad_field != 0) {
+                chunk.bad_line = line_number;
+                return;
+            }
+            if (velocities) {
+                snapshot.velocities[row] = velocity;
+            }
+            row++;
+        });
+    });
+    for (const Chunk& chunk : chunks) {
+        if (chunk.bad_line != 0) {
+            error = "line " + std::to_string(chunk.bad_line) + ": field " + std::to_string(chunk.bad_field) +
+                    " is missing or not a number";
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Maps the file at `path` and parses it (see parse()).
+ */
+inline bool load(const std::string& path, const std::vector<Column>& columns, ThreadPool* pool, Snapshot& snapshot,
+                 std::string& error)
+{
+    MappedFile mapping;
+    if (!mapping.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    // Every byte is read once, front to back
+    mapping.advise(0, mapping.size(), PageAdvice::WillNeed);
+    if (!parse(reinterpret_cast<const char*>(mapping.data()), mapping.size(), columns, pool, snapshot, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+} // namespace text_import
+
+#endif // PARTICLE_VIEWER_DATA_TEXT_IMPORTER_H
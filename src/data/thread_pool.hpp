@@ -0,0 +1,134 @@
+/*
+ * thread_pool.hpp
+ *
+ * Fixed-size pool of worker threads for CPU-bound data work (conversion,
+ * decoding, statistics). Tasks run in submission order; the destructor
+ * finishes queued work before joining.
+ *
+ * Usage:
+ *   ThreadPool pool(4);
+ *   std::future<void> done = pool.submit([] { ... });
+ *   pool.parallelFor(0, count, [&](std::int64_t i) { ... }); // blocks until all i ran
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_THREAD_POOL_H
+#define PARTICLE_VIEWER_DATA_THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+  public:
+    /*
+     * thread_count == 0 uses one thread per hardware thread.
+     */
+    explicit ThreadPool(unsigned thread_count = 0)
+    {
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < thread_count; i++) {
+            workers_.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // Non-copyable: workers refer back to this object
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const
+    {
+        return static_cast<unsigned>(workers_.size());
+    }
+
+    /*
+     * Queues a task. The returned future becomes ready when it has run and
+     * rethrows anything the task threw.
+     */
+    template <typename Task>
+    std::future<void> submit(Task&& task)
+    {
+        auto packaged = std::make_shared<std::packaged_task<void()>>(std::forward<Task>(task));
+        std::future<void> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([packaged] { (*packaged)(); });
+        }
+        wake_.notify_one();
+        return result;
+    }
+
+    /*
+     * Runs body(i) for every i in [begin, end), split into one contiguous
+     * chunk per worker, and waits for all of them. Must not be called from
+     * inside a pool task.
+     */
+    template <typename Body>
+    void parallelFor(std::int64_t begin, std::int64_t end, Body&& body)
+    {
+        if (end <= begin) {
+            return;
+        }
+        const std::int64_t chunks = std::min<std::int64_t>(size(), end - begin);
+        const std::int64_t chunk_size = (end - begin + chunks - 1) / chunks;
+        std::vector<std::future<void>> pending;
+        for (std::int64_t chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+            const std::int64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+            pending.push_back(submit([&body, chunk_begin, chunk_end] {
+                for (std::int64_t i = chunk_begin; i < chunk_end; i++) {
+                    body(i);
+                }
+            }));
+        }
+        for (auto& done : pending) {
+            done.get();
+        }
+    }
+
+  private:
+    void workerLoop()
+    {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return; // stop_ set and nothing left to drain
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+};
+
+#endif // PARTICLE_VIEWER_DATA_THREAD_POOL_H
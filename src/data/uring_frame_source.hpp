@@ -0,0 +1,175 @@
+/*
+ * uring_frame_source.hpp
+ *
+ * FrameSource over the legacy PosAndVel blob that reads through io_uring
+ * (see uring_file_reader.hpp). A batch of frames from the prefetcher goes out
+ * as one deep queue of chunk reads, so the loader does not block in a
+ * syscall per frame. A frame cancelled mid-batch stops between chunks.
+ *
+ * Frames are not mapped, so mappedPositions() is always nullptr. The frame
+ * count is taken from the file size and grows in follow mode. isOpen() is
+ * false when io_uring is unavailable; openFrameSource() then falls back to
+ * the synchronous sources.
+ */
+
+#ifndef PARTICLE_VIEWER_DATA_URING_FRAME_SOURCE_H
+#define PARTICLE_VIEWER_DATA_URING_FRAME_SOURCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+#include "data/parallel_file_reader.hpp"
+#include "data/uring_file_reader.hpp"
+
+class UringFrameSource : public FrameSource
+{
+  public:
+    UringFrameSource(const std::string& path, std::int64_t particle_count,
+                     std::uint64_t chunk_bytes = ParallelFileReader::DEFAULT_CHUNK_BYTES,
+                     unsigned queue_depth = UringFileReader::DEFAULT_QUEUE_DEPTH)
+        : file_(chunk_bytes, queue_depth), particle_count_(particle_count)
+    {
+        if (!file_.open(path) || particle_count_ <= 0) {
+            file_.close();
+            return;
+        }
+        refreshFrameCount();
+    }
+
+    bool isOpen() const
+    {
+        return file_.isOpen();
+    }
+
+    std::int64_t refreshFrameCount() override
+    {
+        if (file_.isOpen()) {
+            frame_count_ = static_cast<std::int64_t>(file_.size() / frameBytes());
+        }
+        return frame_count_;
+    }
+
+    std::int64_t particleCount() const override
+    {
+        return particle_count_;
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return frame_count_;
+    }
+
+    bool readPositions(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return readStream(frame, 0, destination);
+    }
+
+    bool readVelocities(std::int64_t frame, glm::vec4* destination) const override
+    {
+        return readStream(frame, 1, destination);
+    }
+
+    bool readPositionRange(std::int64_t frame, std::int64_t first, std::int64_t count,
+                           glm::vec4* destination) const override
+    {
+        if (frame < 0 || frame >= frame_count_.load() || first < 0 || count < 0 || first + count > particle_count_) {
+            return false;
+        }
+        return file_.read(streamOffset(frame, 0) + sizeof(glm::vec4) * static_cast<std::uint64_t>(first),
+                          sizeof(glm::vec4) * static_cast<std::uint64_t>(count), destination);
+    }
+
+    void readPositionsBatch(FrameRead* reads, int count) const override
+    {
+        std::vector<UringFileReader::Range> ranges;
+        std::vector<int> range_of_read(count, -1);
+        const std::int64_t frame_count = frame_count_;
+        for (int i = 0; i < count; i++) {
+            reads[i].ok = false;
+            if (reads[i].frame < 0 || reads[i].frame >= frame_count || isCancelled(reads[i])) {
+                continue;
+            }
+            range_of_read[i] = static_cast<int>(ranges.size());
+            ranges.push_back({streamOffset(reads[i].frame, 0), streamBytes(), reads[i].destination, false,
+                              reads[i].cancelled});
+        }
+        file_.readBatch(ranges.data(), static_cast<int>(ranges.size()));
+        for (int i = 0; i < count; i++) {
+            if (range_of_read[i] >= 0) {
+                reads[i].ok = ranges[range_of_read[i]].ok;
+            }
+        }
+    }
+
+    /*
+     * Queues one read per kept run, all in flight together.
+     */
+    bool readPreviewPositions(std::int64_t frame, int stride, glm::vec4* destination) const override
+    {
+        if (frame < 0 || frame >= frame_count_.load()) {
+            return false;
+        }
+        const std::uint64_t positions = streamOffset(frame, 0);
+        std::vector<UringFileReader::Range> ranges;
+        forEachPreviewRun(particle_count_, stride, [&](std::int64_t first, std::int64_t count, std::int64_t packed) {
+            ranges.push_back({positions + sizeof(glm::vec4) * static_cast<std::uint64_t>(first),
+                              sizeof(glm::vec4) * static_cast<std::uint64_t>(count), destination + packed});
+        });
+        return file_.readBatch(ranges.data(), static_cast<int>(ranges.size()));
+    }
+
+    void adviseFrames(std::int64_t first, std::int64_t count, PageAdvice advice) const override
+    {
+        const std::int64_t begin = std::max<std::int64_t>(first, 0);
+        const std::int64_t end = std::min(first + count, frame_count_.load());
+        if (begin < end) {
+            file_.advise(static_cast<std::uint64_t>(begin) * frameBytes(),
+                         static_cast<std::uint64_t>(end - begin) * frameBytes(), advice);
+        }
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t frame) const override
+    {
+        (void)frame;
+        return frameBytes();
+    }
+
+  private:
+    std::uint64_t streamBytes() const
+    {
+        return sizeof(glm::vec4) * static_cast<std::uint64_t>(particle_count_);
+    }
+
+    std::uint64_t frameBytes() const
+    {
+        return 2 * streamBytes();
+    }
+
+    std::uint64_t streamOffset(std::int64_t frame, int stream) const
+    {
+        return static_cast<std::uint64_t>(frame) * frameBytes() + stream * streamBytes();
+    }
+
+    /*
+     * Reads one stream (0 = positions, 1 = velocities) of `frame`.
+     */
+    bool readStream(std::int64_t frame, int stream, glm::vec4* destination) const
+    {
+        if (frame < 0 || frame >= frame_count_.load()) {
+            return false;
+        }
+        return file_.read(streamOffset(frame, stream), streamBytes(), destination);
+    }
+
+    UringFileReader file_;
+    std::int64_t particle_count_;
+    std::atomic<std::int64_t> frame_count_{0}; // grows under readers on other threads in follow mode
+};
+
+#endif // PARTICLE_VIEWER_DATA_URING_FRAME_SOURCE_H
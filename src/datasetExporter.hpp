@@ -0,0 +1,165 @@
+/*
+ * datasetExporter.hpp
+ *
+ * Runs a subset export (see data/subset_exporter.hpp) off the render thread.
+ * The worker asks for the output folder, opens its own copy of the dataset,
+ * so loading another one in the meantime does not pull the data out from
+ * under it, and streams the selection out on a pool of its own.
+ *
+ * Usage (render thread):
+ *   exporter.start(set->posName, selection, set->readOptions);
+ *   // every frame:
+ *   if (exporter.isBusy()) show(exporter.status(), exporter.progress());
+ *   if (exporter.isDone()) {
+ *       ExportResult result = exporter.take();
+ *   }
+ *
+ * The destructor cancels a running export and waits for the worker.
+ */
+
+#ifndef PARTICLE_VIEWER_DATASET_EXPORTER_H
+#define PARTICLE_VIEWER_DATASET_EXPORTER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "data/com_track.hpp"
+#include "data/subset_exporter.hpp"
+#include "data/thread_pool.hpp"
+#include "settingsIO.hpp"
+#include "tinyFileDialogs/tinyfiledialogs.h"
+
+class DatasetExporter
+{
+  public:
+    DatasetExporter() = default;
+
+    ~DatasetExporter()
+    {
+        cancel();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    DatasetExporter(const DatasetExporter&) = delete;
+    DatasetExporter& operator=(const DatasetExporter&) = delete;
+
+    /*
+     * Asks for an output folder and exports `selection` of the dataset in
+     * `data_path` (see SettingsIO::openPath) into it. False if an export is
+     * already under way.
+     */
+    bool start(const std::string& data_path, const ExportSelection& selection, const FrameReadOptions& options)
+    {
+        if (isBusy() || data_path.empty()) {
+            return false;
+        }
+        progress_.frames_done = 0;
+        progress_.frames_total = 0;
+        progress_.cancel = false;
+        busy_.store(true, std::memory_order_release);
+        worker_ = std::thread([this, data_path, selection, options] { run(data_path, selection, options); });
+        return true;
+    }
+
+    /*
+     * Stops a running export after the batch in flight; the result reports
+     * it as cancelled.
+     */
+    void cancel()
+    {
+        progress_.cancel = true;
+    }
+
+    /*
+     * True from start() until take().
+     */
+    bool isBusy() const
+    {
+        return busy_.load(std::memory_order_acquire);
+    }
+
+    /*
+     * True once the result is ready for take().
+     */
+    bool isDone() const
+    {
+        return done_.load(std::memory_order_acquire);
+    }
+
+    /*
+     * What the worker is doing, for a progress display.
+     */
+    std::string status() const
+    {
+        const std::int64_t total = progress_.frames_total.load(std::memory_order_relaxed);
+        if (total == 0) {
+            return "Preparing export...";
+        }
+        return "Exporting frame " + std::to_string(progress_.frames_done.load(std::memory_order_relaxed)) + " of " +
+               std::to_string(total);
+    }
+
+    /*
+     * Share of the frames written, 0 to 1.
+     */
+    float progress() const
+    {
+        const std::int64_t total = progress_.frames_total.load(std::memory_order_relaxed);
+        return total > 0 ? static_cast<float>(progress_.frames_done.load(std::memory_order_relaxed)) /
+                               static_cast<float>(total)
+                         : 0.0f;
+    }
+
+    /*
+     * Hands over the finished export and makes the exporter idle again.
+     * `folder` is where it went; empty if the dialog was cancelled. Only
+     * valid once isDone().
+     */
+    ExportResult take(std::string& folder)
+    {
+        worker_.join();
+        ExportResult result = std::move(result_);
+        folder = std::move(folder_);
+        result_ = ExportResult();
+        folder_.clear();
+        done_.store(false, std::memory_order_relaxed);
+        busy_.store(false, std::memory_order_release);
+        return result;
+    }
+
+  private:
+    void run(const std::string& data_path, const ExportSelection& selection, const FrameReadOptions& options)
+    {
+        const char* chosen = tinyfd_selectFolderDialog("Export To Folder", "");
+        if (chosen != nullptr) {
+            folder_ = chosen;
+            std::unique_ptr<SettingsIO> settings = SettingsIO::openPath(data_path, options);
+            const FrameSource* source = settings->getFrameSource();
+            if (source == nullptr) {
+                result_.error = "Could not open " + data_path;
+            } else {
+                const std::array<double, com_track::TYPE_SLOTS> masses = settings->typeMasses();
+                ThreadPool pool;
+                result_ = exportSubset(*source, settings->statsName, settings->comName, folder_, selection, &pool,
+                                       settings->hasSetup() ? &masses : nullptr, &progress_);
+            }
+        }
+        done_.store(true, std::memory_order_release);
+    }
+
+    std::thread worker_;
+    std::atomic<bool> busy_{false};
+    std::atomic<bool> done_{false}; // publishes result_ and folder_ to the render thread
+    ExportProgress progress_;
+    ExportResult result_;
+    std::string folder_;
+};
+
+#endif // PARTICLE_VIEWER_DATASET_EXPORTER_H
@@ -0,0 +1,204 @@
+/*
+ * datasetOpener.hpp
+ *
+ * Opens a dataset off the render thread. The folder dialog, RunSetup
+ * parsing, opening the data file (and its COMFile) and reading the first
+ * frame all run on a worker thread, so the dataset on screen stays
+ * interactive until the new one is ready to swap in. Started before the
+ * window exists (--data), the open overlaps context and GL setup.
+ *
+ * Usage (render thread):
+ *   opener.chooseFolder(options);     // or opener.open(path, options, frame)
+ *   // every frame:
+ *   if (opener.isDone()) {
+ *       DatasetOpener::Result result = opener.take();
+ *       // swap result.settings in, upload result.first_frame
+ *   }
+ *
+ * The destructor waits for the worker, and so for an open dialog.
+ */
+
+#ifndef PARTICLE_VIEWER_DATASET_OPENER_H
+#define PARTICLE_VIEWER_DATASET_OPENER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "data/page_advice.hpp"
+#include "glm/glm.hpp"
+#include "settingsIO.hpp"
+
+class DatasetOpener
+{
+  public:
+    // Frames after the first one paged in ahead of playback
+    static constexpr std::int64_t READAHEAD_FRAMES = 4;
+
+    enum class Stage
+    {
+        Idle,
+        ChoosingFolder,
+        Opening, // RunSetup, the data file and its COMFile
+        ReadingFirstFrame,
+        Done
+    };
+
+    struct Result
+    {
+        std::unique_ptr<SettingsIO> settings; // nullptr if nothing was opened
+        std::int64_t frame = 0;               // frame first_frame holds, clamped to the dataset
+        std::vector<glm::vec4> first_frame;   // its positions; empty if it could not be read
+        std::string error;                    // why nothing was opened; empty if the dialog was cancelled
+        double open_ms = 0.0;                 // from the start of the open (after the dialog) to now
+    };
+
+    DatasetOpener() = default;
+
+    ~DatasetOpener()
+    {
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    DatasetOpener(const DatasetOpener&) = delete;
+    DatasetOpener& operator=(const DatasetOpener&) = delete;
+
+    /*
+     * Asks for a run folder and opens it (see SettingsIO::openFolder).
+     * False if an open is already under way.
+     */
+    bool chooseFolder(const FrameReadOptions& options)
+    {
+        return start(std::string(), options, 0);
+    }
+
+    /*
+     * Opens a run folder or data file without asking (see
+     * SettingsIO::openPath), reading `frame` first. False if an open is
+     * already under way.
+     */
+    bool open(const std::string& path, const FrameReadOptions& options, std::int64_t frame = 0)
+    {
+        return !path.empty() && start(path, options, frame);
+    }
+
+    /*
+     * True from chooseFolder() / open() until take().
+     */
+    bool isBusy() const
+    {
+        return stage_.load(std::memory_order_acquire) != Stage::Idle;
+    }
+
+    /*
+     * True once the result is ready for take().
+     */
+    bool isDone() const
+    {
+        return stage_.load(std::memory_order_acquire) == Stage::Done;
+    }
+
+    Stage stage() const
+    {
+        return stage_.load(std::memory_order_acquire);
+    }
+
+    /*
+     * What the worker is doing, for a progress display.
+     */
+    const char* status() const
+    {
+        switch (stage()) {
+            case Stage::ChoosingFolder:
+                return "Choosing a folder...";
+            case Stage::Opening:
+                return "Opening dataset...";
+            case Stage::ReadingFirstFrame:
+                return "Reading the first frame...";
+            case Stage::Done:
+                return "Dataset ready";
+            case Stage::Idle:
+                break;
+        }
+        return "";
+    }
+
+    /*
+     * Share of the stages finished, 0 to 1.
+     */
+    float progress() const
+    {
+        return static_cast<float>(stage()) / static_cast<float>(Stage::Done);
+    }
+
+    /*
+     * Hands over the finished open and makes the opener idle again. Only
+     * valid once isDone().
+     */
+    Result take()
+    {
+        worker_.join();
+        Result result = std::move(result_);
+        result_ = Result();
+        stage_.store(Stage::Idle, std::memory_order_release);
+        return result;
+    }
+
+  private:
+    bool start(const std::string& path, const FrameReadOptions& options, std::int64_t frame)
+    {
+        if (isBusy()) {
+            return false;
+        }
+        stage_.store(path.empty() ? Stage::ChoosingFolder : Stage::Opening, std::memory_order_release);
+        worker_ = std::thread([this, path, options, frame] { run(path, options, frame); });
+        return true;
+    }
+
+    void run(std::string path, const FrameReadOptions& options, std::int64_t frame)
+    {
+        if (path.empty()) {
+            path = SettingsIO::chooseFolder();
+            if (path.empty()) {
+                stage_.store(Stage::Done, std::memory_order_release);
+                return;
+            }
+            stage_.store(Stage::Opening, std::memory_order_release);
+        }
+        const auto started = std::chrono::steady_clock::now();
+        std::unique_ptr<SettingsIO> settings = SettingsIO::openPath(path, options);
+        const FrameSource* source = settings->getFrameSource();
+        if (source == nullptr || settings->N <= 0) {
+            result_.error = "Could not open a dataset at " + path;
+            stage_.store(Stage::Done, std::memory_order_release);
+            return;
+        }
+
+        // Reading it here also pulls a mapped frame into the page cache; the next few follow in the background
+        stage_.store(Stage::ReadingFirstFrame, std::memory_order_release);
+        result_.frame = std::clamp<std::int64_t>(frame, 0, std::max<std::int64_t>(settings->frames - 1, 0));
+        source->adviseFrames(result_.frame + 1, READAHEAD_FRAMES, PageAdvice::WillNeed);
+        result_.first_frame.resize(static_cast<std::size_t>(settings->N));
+        if (!source->readPositions(result_.frame, result_.first_frame.data())) {
+            result_.first_frame.clear();
+        }
+        result_.settings = std::move(settings);
+        result_.open_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        stage_.store(Stage::Done, std::memory_order_release);
+    }
+
+    std::thread worker_;
+    std::atomic<Stage> stage_{Stage::Idle}; // Done publishes result_ to the render thread
+    Result result_;
+};
+
+#endif // PARTICLE_VIEWER_DATASET_OPENER_H
@@ -10,12 +10,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <sstream>
 #include <string>
 
 #include <glm/glm.hpp>
 
 #include "camera.hpp"
+#include "data/frame_cache.hpp"
+#include "data/page_cache_policy.hpp"
 #include "imgui.h"
 
 // FPS smoothing constants for exponential moving average
@@ -26,6 +29,24 @@ constexpr float FPS_INIT_THRESHOLD = 0.001f;
 // Debug overlay window padding from viewport edges
 constexpr float DEBUG_OVERLAY_PADDING = 10.0f;
 
+/*
+ * Dataset streaming counters shown in the debug overlay.
+ * Filled by ViewerApp each frame; the section is hidden for single-frame data.
+ */
+struct DataStreamStats
+{
+    std::int64_t current_frame = 0;
+    std::int64_t total_frames = 0;
+    int ring_ready = 0;
+    int ring_capacity = 0;
+    bool cache_enabled = false;
+    FrameCacheStats cache;
+    double read_mb_per_s = 0.0;       // frames read from the data file, averaged over about a second
+    std::uint64_t resident_bytes = 0; // 0 if unknown
+    bool page_cache_policy = false;
+    PageCacheStats page_cache;
+};
+
 /*
  * Renders debug camera information as an ImGui overlay window.
  * Displays FPS, build version, camera position, target, up vector,
@@ -38,9 +59,10 @@ constexpr float DEBUG_OVERLAY_PADDING = 10.0f;
  *   screenHeight - Viewport height
  *   fps - Current frames per second (0.0 if unavailable)
  *   build_version - Build version string (e.g. "0.6.0")
+ *   stream_stats - Optional dataset streaming counters (nullptr to hide)
  */
 inline void renderCameraDebugOverlay(Camera* cam, int screenWidth, int screenHeight, float fps = 0.0f,
-                                     const char* build_version = "")
+                                     const char* build_version = "", const DataStreamStats* stream_stats = nullptr)
 {
     if (cam == nullptr) {
         return;
@@ -142,6 +164,40 @@ inline void renderCameraDebugOverlay(Camera* cam, int screenWidth, int screenHei
         ImGui::Text("Proj: Perspective FOV=%.2f deg", fov);
         ImGui::Text("      Near=%.2f Far=%.2f", nearPlane, farPlane);
         ImGui::Text("View: %dx%d", screenWidth, screenHeight);
+
+        if (stream_stats != nullptr && stream_stats->total_frames > 1) {
+            ImGui::Separator();
+            ImGui::TextColored(ImVec4(0.6f, 0.8f, 1.0f, 1.0f), "--- Data Streaming ---");
+            ImGui::Text("Frame: %lld / %lld", static_cast<long long>(stream_stats->current_frame),
+                        static_cast<long long>(stream_stats->total_frames - 1));
+            if (stream_stats->ring_capacity > 0) {
+                float fill = static_cast<float>(stream_stats->ring_ready) / stream_stats->ring_capacity;
+                std::string label =
+                    std::to_string(stream_stats->ring_ready) + " / " + std::to_string(stream_stats->ring_capacity);
+                ImGui::Text("Prefetch ring:");
+                ImGui::SameLine();
+                ImGui::ProgressBar(fill, ImVec2(120.0f, 0.0f), label.c_str());
+            }
+            if (stream_stats->cache_enabled) {
+                const FrameCacheStats& cache = stream_stats->cache;
+                const std::uint64_t lookups = cache.hits + cache.misses;
+                const float hit_rate = lookups > 0 ? 100.0f * cache.hits / lookups : 0.0f;
+                ImGui::Text("Frame cache: %lld frames, %.1f / %.1f MB", static_cast<long long>(cache.frames_held),
+                            cache.bytes_held / (1024.0 * 1024.0), cache.budget_bytes / (1024.0 * 1024.0));
+                ImGui::Text("Cache hit rate: %.1f%% (%llu / %llu)", hit_rate,
+                            static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(lookups));
+            } else {
+                ImGui::Text("Frame cache: off");
+            }
+            ImGui::Text("Read: %.1f MB/s  RSS: %.1f MB", stream_stats->read_mb_per_s,
+                        stream_stats->resident_bytes / (1024.0 * 1024.0));
+            if (stream_stats->page_cache_policy) {
+                const PageCacheStats& page_cache = stream_stats->page_cache;
+                ImGui::Text("Page cache: %s", page_cache.streaming ? "streaming" : "scrubbing (OS default)");
+                ImGui::Text("  readahead %.1f MB, dropped %.1f MB", page_cache.readahead_bytes / (1024.0 * 1024.0),
+                            page_cache.dropped_bytes / (1024.0 * 1024.0));
+            }
+        }
     }
     ImGui::End();
 }
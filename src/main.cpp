@@ -3,13 +3,42 @@
  *
  * Application entry point.
  * Creates an SDL3Context and injects it into ViewerApp (dependency injection).
+ * Arguments are parsed first, so a --data dataset is already opening while
+ * the window and GL context are created.
  *
  * Command-line flags:
  *   --resolution, --res <resolution>  Set display resolution (4k, 1080, 720)
  *   --debug-camera, -d                Enable debug camera overlay showing position,
  *                                     target, up vector, projection info, and viewport
+ *   --prefetch-depth <frames>         Frames kept in the background prefetch ring (default 8)
+ *   --prefetch-mb <megabytes>         Memory cap shared by the prefetch and preview rings (default 512)
+ *   --frame-cache-mb <megabytes>      Budget for the compressed cache of visited frames (default 0, off)
+ *   --follow                          Watch a PosAndVel that is still being written and pick up new frames
+ *   --follow-latest                   Like --follow, and jump to the newest complete frame as it arrives
+ *   --read-threads <count>            Read each PosAndVel frame with this many threads instead of mapping it
+ *   --io-uring                        Read PosAndVel through batched io_uring requests (Linux; else as above)
+ *   --element-type <f32|f64|f16>      Element type a raw PosAndVel was written in (default f32); f64 and f16
+ *                                     frames are converted to float as they are read
+ *   --recenter                        Read f64 positions relative to the centre of the first frame, keeping
+ *                                     precision for data far from the origin
+ *   --no-page-cache-policy            Leave the page cache alone during playback (no readahead / drop hints)
+ *   --no-frame-stats                  Skip the background pass over all frames that feeds the timeline and
+ *                                     camera framing (a saved <data>.stats sidecar is still used)
+ *   --preview-stride <k>              While scrubbing, show every k-th run of particles until the full frame
+ *                                     is loaded (default 8; 1 always shows full frames)
+ *   --com-types <list>                Lock the camera onto the centre of mass of these particle types only,
+ *                                     e.g. 0,1 for body 1 (default all; ignores the COMFile)
+ *   --live <name>                     Show the shared-memory feed <name> a running simulation publishes into
+ *   --import <file>                   Show a text snapshot (.csv, .tsv, .txt, .xyz), one particle per line
+ *   --columns <map>                   Fields of a text snapshot, in order (default x,y,z,type; names x y z
+ *                                     type vx vy vz, '-' skips a field)
+ *   --data <folder|file>              Open this run folder, or this data file (RunSetup and COMFile are
+ *                                     taken from its folder), at startup
+ *   --frame <n>                       Frame the --data dataset opens at (default 0)
+ *   --play                            Start playing once the --data dataset is shown
  */
 
+#include <optional>
 #include <string>
 
 #include "graphics/SDL3Context.hpp"
@@ -60,16 +89,21 @@ int main(int argc, char* argv[])
     int height = 720;
     getWindowSize(resolution, width, height);
 
+    // Declared before the app so it outlives the app's GL cleanup
+    std::optional<SDL3Context> context;
+
+    // Starts opening --data on a worker before the window exists
+    ViewerApp app(nullptr);
+    app.parseArgs(argc, argv);
+
     // Create the OpenGL context (SDL3 window + GLAD initialization)
-    SDL3Context context(width, height, "Particle-Viewer");
-    if (!context.isValid()) {
+    context.emplace(width, height, "Particle-Viewer");
+    if (!context->isValid()) {
         return 1;
     }
 
     // Inject context into ViewerApp
-    ViewerApp app(&context);
-    app.parseArgs(argc, argv);
-    if (app.initialize()) {
+    if (app.initialize(&*context)) {
         app.run();
     }
     return 0;
@@ -3,12 +3,25 @@
  *
  * Particle data structure containing positions and velocities for N-body visualization.
  * Uses std::vector for safe memory management of particle data.
+ *
+ * The positions reach the GPU through one instance buffer, allocated once per
+ * particle count and uploaded once per change. Where buffer storage is
+ * available (GL 4.4 or ARB_buffer_storage) it is a persistently mapped ring of
+ * UPLOAD_REGIONS regions: each upload writes the region after the one being
+ * drawn, and a fence per region keeps it from overwriting one a queued draw
+ * still reads. Otherwise each upload orphans the storage, which leaves the
+ * renaming to the driver. A fence that fails or does not signal within
+ * FENCE_TIMEOUT_NS drops the ring for orphaning too, for good.
  */
 
 #ifndef PARTICLE_H
 #define PARTICLE_H
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include "glm/gtc/matrix_transform.hpp"
@@ -17,6 +30,15 @@
 class Particle
 {
   public:
+    // glDrawArraysInstanced takes a GLsizei instance count, so larger sets are drawn in several calls
+    static constexpr std::int64_t MAX_INSTANCES_PER_DRAW = std::numeric_limits<GLsizei>::max();
+    // Regions of the persistently mapped ring: one being written, the others still queued for drawing
+    static constexpr int UPLOAD_REGIONS = 3;
+    // Larger rings would pin too much memory; those particle counts stream through orphaned storage
+    static constexpr std::int64_t MAX_PERSISTENT_RING_BYTES = std::int64_t(1) << 30;
+    // Longest an upload waits for the draws still reading its region (1 s)
+    static constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+
     /*
      * Generates the default cube for graphics testing.
      * Creates a 40x40x40 grid of 64,000 particles.
@@ -27,30 +49,29 @@ class Particle
         instanceVBO = 0;
         translations.resize(n); // value-initialized to vec4(0) by std::vector
         velocities.resize(1);   // single placeholder; resized when data is loaded
-        for (int i = 0; i < n; i++) {
+        for (std::int64_t i = 0; i < n; i++) {
             translations[i] = glm::vec4(i % 40 * 1.25, i % 1600 / 40.0f * 1.25, i % 64000 / 1600.0f * 1.25, 500);
         }
-        setUpInstanceBuffer();
+        reserveInstances(n);
     }
 
     /*
      * Creates a new particle structure for the given number of bodies.
-     * Copies the provided position data into internal storage.
+     * Copies the provided position data into internal storage. Velocities
+     * stay empty until changeVelocities() loads them: playback only needs
+     * positions.
      */
-    Particle(long number_of_bodies, const glm::vec4* positions)
+    Particle(std::int64_t number_of_bodies, const glm::vec4* positions)
     {
         n = number_of_bodies;
         instanceVBO = 0;
         translations.assign(positions, positions + number_of_bodies);
-        velocities.resize(number_of_bodies); // value-initialized to vec4(0) by std::vector
-        setUpInstanceBuffer();
+        reserveInstances(n);
     }
 
     ~Particle()
     {
-        if (instanceVBO != 0) {
-            glDeleteBuffers(1, &instanceVBO);
-        }
+        releaseInstanceBuffer();
     }
 
     // Prevent copying (owns GL resources)
@@ -59,27 +80,85 @@ class Particle
 
     /*
      * Changes the translations in the particle structure.
-     * Copies data from the provided array.
+     * Copies data from the provided array; the next pushVBO() uploads it.
      */
-    void changeTranslations(long count, const glm::vec4* new_positions)
+    void changeTranslations(std::int64_t count, const glm::vec4* new_positions)
     {
         if (new_positions) {
             n = count;
+            external_translations = nullptr;
             translations.assign(new_positions, new_positions + count);
-            setUpInstanceBuffer();
+            dirty = true;
+            return;
+        }
+        std::cout << "Error Loading New Translations" << std::endl;
+    }
+
+    /*
+     * Points the particle structure at externally owned positions (e.g. a
+     * memory-mapped frame) instead of copying them. The data must stay valid
+     * until the next pushVBO(); changeTranslations() switches back to the
+     * internal copy.
+     */
+    void viewTranslations(std::int64_t count, const glm::vec4* positions)
+    {
+        if (positions) {
+            n = count;
+            external_translations = positions;
+            dirty = true;
             return;
         }
         std::cout << "Error Loading New Translations" << std::endl;
     }
 
     /*
-     * Pushes the translation data to OpenGL. Allows the translations to change.
+     * Copies an external view into internal storage so its owner can release it.
+     */
+    void detachTranslations()
+    {
+        if (external_translations) {
+            translations.assign(external_translations, external_translations + n);
+            external_translations = nullptr;
+        }
+    }
+
+    /*
+     * Returns the positions that will be uploaded: the external view if one
+     * is set, otherwise the internal copy.
+     */
+    const glm::vec4* translationData() const
+    {
+        return external_translations ? external_translations : translations.data();
+    }
+
+    /*
+     * Pushes the translation data to OpenGL if it changed since the last
+     * push; unchanged translations are not uploaded again. Grows the instance
+     * buffer if the particle count outgrew it.
      */
     void pushVBO()
     {
-        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4) * n, translations.data(), GL_DYNAMIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        if (!dirty) {
+            return;
+        }
+        reserveInstances(n);
+        const std::size_t bytes = sizeof(glm::vec4) * static_cast<std::size_t>(n);
+        if (persistent && !waitForRegion((region + 1) % UPLOAD_REGIONS)) {
+            std::cout << "Instance buffer fence failed; streaming through orphaned storage" << std::endl;
+            persistent_failed = true;
+            releaseInstanceBuffer();
+            reserveInstances(n);
+        }
+        if (persistent) {
+            region = (region + 1) % UPLOAD_REGIONS;
+            std::memcpy(mapped + region * capacity, translationData(), bytes);
+        } else {
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4) * capacity, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, translationData());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        dirty = false;
     }
 
     /*
@@ -88,14 +167,39 @@ class Particle
     void setUpInstanceArray()
     {
         glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), reinterpret_cast<GLvoid*>(regionOffset()));
         glVertexAttribDivisor(0, 1);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
+    /*
+     * Draws every particle as one instanced point, split into draws of at
+     * most `max_per_draw` instances. Each draw re-points attribute 0 at its
+     * slice of the instance buffer, since base-instance draws need GL 4.2
+     * and the context is 4.1. Expects the VAO and shader to be bound.
+     * Fences the region drawn from so a later upload waits for these draws.
+     */
+    void drawInstances(std::int64_t max_per_draw = MAX_INSTANCES_PER_DRAW)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (std::int64_t first = 0; first < n; first += max_per_draw) {
+            const std::int64_t count = std::min(max_per_draw, n - first);
+            const std::uintptr_t offset = regionOffset() + static_cast<std::uintptr_t>(first) * sizeof(glm::vec4);
+            glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), reinterpret_cast<GLvoid*>(offset));
+            glDrawArraysInstanced(GL_POINTS, 0, 1, static_cast<GLsizei>(count));
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        if (persistent) {
+            if (fences[region] != nullptr) {
+                glDeleteSync(fences[region]);
+            }
+            fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+
     /*
      * Changes the velocities in the particle structure.
-     * Copies data from the provided array.
+     * Copies data from the provided array, allocating on first use.
      */
     void changeVelocities(const glm::vec4* new_velocities)
     {
@@ -106,22 +210,113 @@ class Particle
         std::cout << "Error Loading New Velocities" << std::endl;
     }
 
-    long n;                              // number of objects
+    std::int64_t n;                      // number of objects
     GLuint instanceVBO;                  // the instance VBO for OpenGL rendering
     std::vector<glm::vec4> translations; // the positions of the particles
-    std::vector<glm::vec4> velocities;   // the velocity data
+    std::vector<glm::vec4> velocities;   // the velocity data, loaded on demand
 
   private:
+    const glm::vec4* external_translations = nullptr; // non-owning view set by viewTranslations()
+    std::int64_t capacity = 0;                        // particles per region; grows, never shrinks
+    bool persistent = false;                          // instance buffer is a persistently mapped ring
+    glm::vec4* mapped = nullptr;                      // the whole ring, when persistent
+    int region = 0;                                   // region holding the latest upload
+    GLsync fences[UPLOAD_REGIONS] = {};               // last draw reading each region
+    bool persistent_failed = false;                   // a fence wait failed; buffers orphan from then on
+    bool dirty = true;                                // translations changed since the last pushVBO()
+
+    /*
+     * True if the driver offers immutable buffer storage and fences, which a
+     * persistently mapped ring needs.
+     */
+    static bool persistentMappingAvailable()
+    {
+        return (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) && glBufferStorage && glMapBufferRange &&
+               glFenceSync && glClientWaitSync && glDeleteSync;
+    }
+
     /*
-     * Sets up the memory space (buffer) in OpenGL that streams the translations to the GPU.
+     * Sets up the memory space (buffer) in OpenGL that streams the
+     * translations to the GPU, unless the current one already holds `count`
+     * particles. The data itself goes up with the next pushVBO().
      */
-    void setUpInstanceBuffer()
+    void reserveInstances(std::int64_t count)
     {
-        glDeleteBuffers(1, &instanceVBO);
+        if (instanceVBO != 0 && count <= capacity) {
+            return;
+        }
+        releaseInstanceBuffer();
+        capacity = std::max<std::int64_t>(count, 1);
+        const GLsizeiptr region_bytes = static_cast<GLsizeiptr>(sizeof(glm::vec4) * capacity);
         glGenBuffers(1, &instanceVBO);
         glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4) * n, translations.data(), GL_DYNAMIC_DRAW);
+        if (!persistent_failed && persistentMappingAvailable() &&
+            region_bytes <= MAX_PERSISTENT_RING_BYTES / UPLOAD_REGIONS) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            const GLsizeiptr ring_bytes = region_bytes * UPLOAD_REGIONS;
+            glBufferStorage(GL_ARRAY_BUFFER, ring_bytes, nullptr, flags);
+            mapped = static_cast<glm::vec4*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, ring_bytes, flags));
+            persistent = mapped != nullptr;
+            if (!persistent) {
+                // Immutable storage cannot be respecified, so the fallback needs a buffer of its own
+                glDeleteBuffers(1, &instanceVBO);
+                glGenBuffers(1, &instanceVBO);
+                glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            }
+        }
+        if (!persistent) {
+            glBufferData(GL_ARRAY_BUFFER, region_bytes, nullptr, GL_STREAM_DRAW);
+        }
         glBindBuffer(GL_ARRAY_BUFFER, 0);
+        dirty = true;
+    }
+
+    /*
+     * Deletes the instance buffer and its fences; deleting a mapped buffer
+     * also unmaps it.
+     */
+    void releaseInstanceBuffer()
+    {
+        for (GLsync& fence : fences) {
+            if (fence != nullptr) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        if (instanceVBO != 0) {
+            glDeleteBuffers(1, &instanceVBO);
+            instanceVBO = 0;
+        }
+        persistent = false;
+        mapped = nullptr;
+        region = 0;
+    }
+
+    /*
+     * Blocks until the draws that read `index` have finished. Two uploads
+     * later they normally have, so this rarely waits at all. False if the
+     * wait failed or they did not finish within FENCE_TIMEOUT_NS.
+     */
+    bool waitForRegion(int index)
+    {
+        if (fences[index] == nullptr) {
+            return true;
+        }
+        const GLenum status = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return false;
+        }
+        glDeleteSync(fences[index]);
+        fences[index] = nullptr;
+        return true;
+    }
+
+    /*
+     * Byte offset of the latest upload in the instance buffer.
+     */
+    std::uintptr_t regionOffset() const
+    {
+        return persistent ? static_cast<std::uintptr_t>(region * capacity) * sizeof(glm::vec4) : 0;
     }
 };
 
@@ -2,15 +2,31 @@
  * settingsIO.hpp
  *
  * Loads position data from a binary file.
+ * The data file is opened once as a FrameSource: either a legacy PosAndVel
+ * blob (N from RunSetup), a self-describing v2 container, or a shard manifest
+ * joining several of them into one timeline. Raw frames are read straight out
+ * of the mapping.
  *
+ * In follow mode the data file is watched while a simulation is still
+ * writing it, and `frames` grows as complete frames are appended.
+ *
+ * The COMFile is read into memory once; frames it does not cover get their
+ * centre of mass reduced from their positions (see ComTrack).
  */
 
 #ifndef SETTINGSIO_H
 #define SETTINGSIO_H
-#include <fstream>
+#include <array>
+#include <cstdint>
 #include <iostream>
-#include <sstream>
-
+#include <memory>
+#include <vector>
+
+#include "data/com_track.hpp"
+#include "data/file_watcher.hpp"
+#include "data/frame_source.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/run_setup.hpp"
 #include "glm/glm.hpp"
 #include "particle.hpp"
 #include "tinyFileDialogs/tinyfiledialogs.h"
@@ -23,8 +39,9 @@ class SettingsIO
     std::string comName;
     bool isPlaying;
     int errorCount;
-    long N;
-    long frames;
+    std::int64_t N;
+    std::int64_t frames;
+    FrameReadOptions readOptions; // how a raw PosAndVel is read (see openFrameSource)
 
     /*
      * Default constructor for SettingsIO, used for the default cube
@@ -41,250 +58,180 @@ class SettingsIO
     }
 
     /*
-     * Loads a specific position file.
+     * Loads a specific position file. `readOptions` selects how a raw
+     * PosAndVel is read: mapped (the default), io_uring or parallel reads.
      */
-    SettingsIO(std::string posName, std::string statsName, std::string comName)
+    SettingsIO(std::string posName, std::string statsName, std::string comName,
+               const FrameReadOptions& readOptions = {})
     {
+        this->readOptions = readOptions;
         this->posName = posName;
         this->statsName = statsName;
         this->comName = comName;
-        std::ifstream data;
         posFile = "/PosAndVel";
         statsFile = "/RunSetup";
         comFile = "/COMFile";
-        std::string name;
-        std::string blank;
         errorCount = 0;
         isPlaying = false;
-        data.open(statsName.c_str());
-
-        if (data.good() && data.is_open()) {
-            getline(data, name, '=');
-            data >> this->InitialPosition1.x;
-            getline(data, name, '=');
-            data >> this->InitialPosition1.y;
-            getline(data, name, '=');
-            data >> this->InitialPosition1.z;
-            getline(data, name, '=');
-            data >> this->InitialPosition2.x;
-            getline(data, name, '=');
-            data >> this->InitialPosition2.y;
-            getline(data, name, '=');
-            data >> this->InitialPosition2.z;
-
-            getline(data, name, '=');
-            data >> this->InitialVelocity1.x;
-            getline(data, name, '=');
-            data >> this->InitialVelocity1.y;
-            getline(data, name, '=');
-            data >> this->InitialVelocity1.z;
-            getline(data, name, '=');
-            data >> this->InitialVelocity2.x;
-            getline(data, name, '=');
-            data >> this->InitialVelocity2.y;
-            getline(data, name, '=');
-            data >> this->InitialVelocity2.z;
-
-            getline(data, name, '=');
-            data >> this->InitialSpin1.x;
-            getline(data, name, '=');
-            data >> this->InitialSpin1.y;
-            getline(data, name, '=');
-            data >> this->InitialSpin1.z;
-            getline(data, name, '=');
-            data >> this->InitialSpin1.w;
-
-            getline(data, name, '=');
-            data >> this->InitialSpin2.x;
-            getline(data, name, '=');
-            data >> this->InitialSpin2.y;
-            getline(data, name, '=');
-            data >> this->InitialSpin2.z;
-            getline(data, name, '=');
-            data >> this->InitialSpin2.w;
-
-            getline(data, name, '=');
-            data >> this->FractionEarthMassOfBody1;
-            getline(data, name, '=');
-            data >> this->FractionEarthMassOfBody2;
-
-            getline(data, name, '=');
-            data >> this->FractionFeBody1;
-            getline(data, name, '=');
-            data >> this->FractionSiBody1;
-            getline(data, name, '=');
-            data >> this->FractionFeBody2;
-            getline(data, name, '=');
-            data >> this->FractionSiBody2;
-
-            getline(data, name, '=');
-            data >> this->DampRateBody1;
-            getline(data, name, '=');
-            data >> this->DampRateBody2;
-
-            getline(data, name, '=');
-            data >> this->EnergyTargetBody1;
-            getline(data, name, '=');
-            data >> this->EnergyTargetBody2;
-
-            getline(data, name, '=');
-            data >> N;
-
-            getline(data, name, '=');
-            data >> this->TotalRunTime;
-            getline(data, name, '=');
-            data >> this->DampTime;
-            getline(data, name, '=');
-            data >> this->DampRestTime;
-            getline(data, name, '=');
-            data >> this->EnergyAdjustmentTime;
-            getline(data, name, '=');
-            data >> this->EnergyAdjustmentRestTime;
-            getline(data, name, '=');
-            data >> this->SpinRestTime;
-
-            getline(data, name, '=');
-            data >> this->Dt;
-
-            getline(data, name, '=');
-            data >> this->WriteToFile;
-
-            getline(data, name, '=');
-            data >> this->RecordRate;
-
-            getline(data, name, '=');
-            data >> this->DensityFe;
-            getline(data, name, '=');
-            data >> this->DensitySi;
-
-            getline(data, name, '=');
-            data >> this->KFe;
-            getline(data, name, '=');
-            data >> this->KSi;
-            getline(data, name, '=');
-            data >> this->KRFe;
-            getline(data, name, '=');
-            data >> this->KRSi;
-            getline(data, name, '=');
-            data >> this->SDFe;
-            getline(data, name, '=');
-            data >> this->SDSi;
-
-            getline(data, name, '=');
-            data >> this->DrawRate;
-            getline(data, name, '=');
-            data >> this->DrawQuality;
-
-            getline(data, name, '=');
-            data >> this->UseMultipleGPU;
-
-            getline(data, name, '=');
-            data >> this->UniversalGravity;
-            getline(data, name, '=');
-            data >> this->MassOfEarth;
-            getline(data, name, '=');
-            data >> this->Pi;
-        } else {
-            this->InitialPosition1.x = 100;
-            this->InitialPosition1.y = 100;
-            this->InitialPosition1.z = 100;
-            this->InitialPosition2.x = 100;
-            this->InitialPosition2.y = 100;
-            this->InitialPosition2.z = 100;
-            this->InitialVelocity1.x = 100;
-            this->InitialVelocity1.y = 100;
-            this->InitialVelocity1.z = 100;
-            this->InitialVelocity2.x = 100;
-            this->InitialVelocity2.y = 100;
-            this->InitialVelocity2.z = 100;
-            this->InitialSpin1.x = 100;
-            this->InitialSpin1.y = 100;
-            this->InitialSpin1.z = 100;
-            this->InitialSpin1.w = 100;
-            this->InitialSpin2.x = 100;
-            this->InitialSpin2.y = 100;
-            this->InitialSpin2.z = 100;
-            this->InitialSpin2.w = 100;
-            this->FractionEarthMassOfBody1 = 100;
-            this->FractionEarthMassOfBody2 = 100;
-            this->FractionFeBody1 = 100;
-            this->FractionSiBody1 = 100;
-            this->FractionFeBody2 = 100;
-            this->FractionSiBody2 = 100;
-            this->DampRateBody1 = 100;
-            this->DampRateBody2 = 100;
-            this->EnergyTargetBody1 = 100;
-            this->EnergyTargetBody2 = 100;
-            this->N = 100;
-            this->TotalRunTime = 100;
-            this->DampTime = 100;
-            this->DampRestTime = 100;
-            this->EnergyAdjustmentTime = 100;
-            this->EnergyAdjustmentRestTime = 100;
-            this->SpinRestTime = 100;
-            this->Dt = 100;
-            this->WriteToFile = 100;
-            this->RecordRate = 100;
-            this->DensityFe = 100;
-            this->DensitySi = 100;
-            this->KFe = 100;
-            this->KSi = 100;
-            this->KRFe = 100;
-            this->KRSi = 100;
-            this->SDFe = 100;
-            this->SDSi = 100;
-            this->DrawRate = 100;
-            this->DrawQuality = 100;
-            this->UseMultipleGPU = 100;
-            this->UniversalGravity = 100;
-            this->MassOfEarth = 100;
-            this->Pi = 100;
+        hasRunSetup = setup.load(statsName);
+        N = setup.N;
+        posSource = openFrameSource(posName, N, readOptions);
+        if (posSource) {
+            N = posSource->particleCount(); // a container knows its own particle count
         }
-        data.close();
         frames = getFrames();
+        comTrack = std::make_unique<ComTrack>(comName, posSource.get());
+        if (hasRunSetup) {
+            comTrack->setTypeMasses(typeMasses());
+        }
     }
 
     ~SettingsIO() = default;
 
     /*
-     * Reads positions and velocities from a file at a specific frame
+     * Reads positions and velocities from a file at a specific frame.
+     * Velocities are only read, and allocated in `part`, when readVelocity is set.
      */
-    void readPosVelFile(long frame, Particle* part, bool readVelocity)
+    void readPosVelFile(std::int64_t frame, Particle* part, bool readVelocity)
     {
-        FILE* PosAndVelFile = fopen(posName.c_str(), "r");
-        if (PosAndVelFile) {
-            if (frame >= frames) {
-                frame = frames - 1;
-                isPlaying = false;
-            }
-            if (frame < 0) {
-                frame = 0;
-                isPlaying = false;
+        streamedFrame = -1; // replaces what part and scratch hold
+        if (!posSource || N <= 0) {
+            reportReadError();
+            return;
+        }
+        frame = clampFrame(frame);
+        const glm::vec4* pos = posSource->mappedPositions(frame);
+        if (!pos && decodeFrame(frame)) {
+            pos = scratch.data();
+        }
+        if (!pos) {
+            reportReadError();
+            return;
+        }
+        part->changeTranslations(N, pos);
+        if (readVelocity) {
+            scratch.resize(N);
+            if (posSource->readVelocities(frame, scratch.data())) {
+                part->changeVelocities(scratch.data());
             }
-            fseek(PosAndVelFile, frame * sizeof(glm::vec4) * 2 * N, SEEK_CUR);
-            glm::vec4* pos = new glm::vec4[N];
-            glm::vec4* vel;
-            fread(pos, sizeof(glm::vec4), (int)N, PosAndVelFile);
-            part->changeTranslations(N, pos);
-            if (readVelocity) {
-                vel = new glm::vec4[N];
-                fread(vel, sizeof(glm::vec4), N, PosAndVelFile);
-                part->changeVelocities(vel);
-                delete[] vel;
+        }
+    }
+
+    /*
+     * Points the particle structure straight at the mapped positions of a frame
+     * without copying them. The data stays valid while this SettingsIO is alive.
+     * Returns the positions handed over, or nullptr if the frame was unreadable.
+     * Streaming the frame `part` already shows again hands nothing over, so a
+     * paused viewer neither re-decodes nor re-uploads it.
+     */
+    const glm::vec4* streamPosFrame(std::int64_t frame, Particle* part)
+    {
+        frame = clampFrame(frame);
+        const glm::vec4* pos = getFramePositions(frame);
+        if (pos) {
+            if (frame != streamedFrame || part->translationData() != pos) {
+                part->viewTranslations(N, pos);
             }
-            delete[] pos;
-            fclose(PosAndVelFile);
+            streamedFrame = frame;
+            return pos;
+        }
+        if (frame == streamedFrame && streamedPart == part && part->translationData() == part->translations.data()) {
+            return scratch.data(); // decoded into scratch and copied into part by the previous call
+        }
+        streamedFrame = -1;
+        if (posSource && N > 0 && decodeFrame(frame)) {
+            part->changeTranslations(N, scratch.data());
+            streamedFrame = frame;
+            streamedPart = part;
+            return scratch.data();
+        }
+        reportReadError();
+        return nullptr;
+    }
+
+    /*
+     * Returns a pointer to the positions of a frame inside the mapped file.
+     * Out-of-range frames are clamped and stop playback. Returns nullptr if
+     * the frame cannot be read or is not stored as plain vec4s (see
+     * FrameSource::mappedPositions).
+     */
+    const glm::vec4* getFramePositions(std::int64_t frame)
+    {
+        if (!posSource || N <= 0) {
+            return nullptr;
+        }
+        return posSource->mappedPositions(clampFrame(frame));
+    }
+
+    /*
+     * Clamps a frame index to the available frames, stopping playback when
+     * it runs off either end.
+     */
+    std::int64_t clampFrame(std::int64_t frame)
+    {
+        if (frame >= frames) {
+            frame = frames - 1;
+            isPlaying = false;
+        }
+        if (frame < 0) {
+            frame = 0;
+            isPlaying = false;
+        }
+        return frame;
+    }
+
+    /*
+     * The reader behind this dataset, or nullptr if the data file could not
+     * be opened. Its read methods are safe to call from loader threads.
+     */
+    const FrameSource* getFrameSource() const
+    {
+        return posSource.get();
+    }
+
+    /*
+     * Starts or stops watching the data file for appended frames. The file
+     * stays mapped as it is; pollFollow() only re-checks its size, so a
+     * mapped file only grows if it was opened with FrameReadOptions::follow.
+     * For a shard manifest the shard that grows is watched (see followPath()).
+     * A converted container never grows, so following one only warns.
+     */
+    void setFollow(bool enabled)
+    {
+        watcher.reset();
+        if (enabled && posSource && !posSource->canGrow()) {
+            std::cerr << "Warning: " << posName << " is a converted container and never grows; "
+                      << "open the run folder or its PosAndVel to follow a running simulation" << std::endl;
             return;
         }
-        // fclose(PosAndVelFile);
-        errorCount++;
-        if (errorCount < 5) {
-            std::cout << "Error Reading File. Attempt: " << errorCount << std::endl;
-        } else if (errorCount == 5) {
-            std::cout << "Too many errors. stopping log here" << std::endl;
+        if (enabled && posSource) {
+            const std::string path = posSource->followPath();
+            watcher = std::make_unique<FileWatcher>(path.empty() ? posName : path);
         }
     }
 
+    bool isFollowing() const
+    {
+        return watcher != nullptr;
+    }
+
+    /*
+     * In follow mode, extends `frames` by the complete frames appended since
+     * the last call. Returns true if the frame count changed.
+     */
+    bool pollFollow()
+    {
+        if (!watcher || !watcher->poll()) {
+            return false;
+        }
+        const std::int64_t count = posSource->refreshFrameCount();
+        if (count == frames) {
+            return false;
+        }
+        frames = count;
+        return true;
+    }
+
     /*
      * Toggles playback.
      */
@@ -295,159 +242,159 @@ class SettingsIO
 
     glm::vec3 getInitialPosition1()
     {
-        return InitialPosition1;
+        return setup.InitialPosition1;
     }
     glm::vec3 getInitialPosition2()
     {
-        return InitialPosition2;
+        return setup.InitialPosition2;
     }
     glm::vec3 getInitialVelocity1()
     {
-        return InitialVelocity1;
+        return setup.InitialVelocity1;
     }
     glm::vec3 getInitialVelocity2()
     {
-        return InitialVelocity2;
+        return setup.InitialVelocity2;
     }
     glm::vec4 getInitialSpin1()
     {
-        return InitialSpin1;
+        return setup.InitialSpin1;
     }
     glm::vec4 getInitialSpin2()
     {
-        return InitialSpin2;
+        return setup.InitialSpin2;
     }
     double getFractionEarthMassOfBody1()
     {
-        return FractionEarthMassOfBody1;
+        return setup.FractionEarthMassOfBody1;
     }
     double getFractionEarthMassOfBody2()
     {
-        return FractionEarthMassOfBody2;
+        return setup.FractionEarthMassOfBody2;
     }
     double getFractionFeBody1()
     {
-        return FractionFeBody1;
+        return setup.FractionFeBody1;
     }
     double getFractionSiBody1()
     {
-        return FractionSiBody1;
+        return setup.FractionSiBody1;
     }
     double getFractionFeBody2()
     {
-        return FractionFeBody2;
+        return setup.FractionFeBody2;
     }
     double getFractionSiBody2()
     {
-        return FractionSiBody2;
+        return setup.FractionSiBody2;
     }
     float getDampRateBody1()
     {
-        return DampRateBody1;
+        return setup.DampRateBody1;
     }
     float getDampRateBody2()
     {
-        return DampRateBody2;
+        return setup.DampRateBody2;
     }
     float getEnergyTargetBody1()
     {
-        return EnergyTargetBody1;
+        return setup.EnergyTargetBody1;
     }
     float getEnergyTargetBody2()
     {
-        return EnergyTargetBody2;
+        return setup.EnergyTargetBody2;
     }
     float getTotalRunTime()
     {
-        return TotalRunTime;
+        return setup.TotalRunTime;
     }
     float getDampTime()
     {
-        return DampTime;
+        return setup.DampTime;
     }
     float getDampRestTime()
     {
-        return DampRestTime;
+        return setup.DampRestTime;
     }
     float getEnergyAdjustmentTime()
     {
-        return EnergyAdjustmentTime;
+        return setup.EnergyAdjustmentTime;
     }
     float getEnergyAdjustmentRestTime()
     {
-        return EnergyAdjustmentRestTime;
+        return setup.EnergyAdjustmentRestTime;
     }
     float getSpinRestTime()
     {
-        return SpinRestTime;
+        return setup.SpinRestTime;
     }
     float getDt()
     {
-        return Dt;
+        return setup.Dt;
     }
     int getWriteToFile()
     {
-        return WriteToFile;
+        return setup.WriteToFile;
     }
     int getRecordRate()
     {
-        return RecordRate;
+        return setup.RecordRate;
     }
     double getDensityFe()
     {
-        return DensityFe;
+        return setup.DensityFe;
     }
     double getDensitySi()
     {
-        return DensitySi;
+        return setup.DensitySi;
     }
     double getKFe()
     {
-        return KFe;
+        return setup.KFe;
     }
     double getKSi()
     {
-        return KSi;
+        return setup.KSi;
     }
     double getKRFe()
     {
-        return KRFe;
+        return setup.KRFe;
     }
     double getKRSi()
     {
-        return KRSi;
+        return setup.KRSi;
     }
     double getSDFe()
     {
-        return SDFe;
+        return setup.SDFe;
     }
     double getSDSi()
     {
-        return SDSi;
+        return setup.SDSi;
     }
     int getDrawRate()
     {
-        return DrawRate;
+        return setup.DrawRate;
     }
     int getDrawQuality()
     {
-        return DrawQuality;
+        return setup.DrawQuality;
     }
     int getUseMultipleGPU()
     {
-        return UseMultipleGPU;
+        return setup.UseMultipleGPU;
     }
     double getUniversalGravity()
     {
-        return UniversalGravity;
+        return setup.UniversalGravity;
     }
     double getMassOfEarth()
     {
-        return MassOfEarth;
+        return setup.MassOfEarth;
     }
     double getPi()
     {
-        return Pi;
+        return setup.Pi;
     }
 
     /*
@@ -455,21 +402,9 @@ class SettingsIO
      */
     SettingsIO* loadFile(Particle* part, bool readVelocity)
     {
-        std::string dialog = "Select Folder";
-        const char* fol = tinyfd_selectFolderDialog(dialog.c_str(), "");
-
-        std::string folder;
-        if (fol != NULL) {
-            folder = std::string(fol);
-        } else {
-            folder = "";
-        }
+        const std::string folder = chooseFolder();
         if (folder != "") {
-            std::string posVel = folder; // strcat(folder,posFile.c_str());
-            posVel = posVel + posFile;
-            std::string settings = folder + statsFile; // strcat(folder, settingsFile.c_str());
-            std::string comName = folder + comFile;
-            SettingsIO* set = new SettingsIO(posVel.c_str(), settings.c_str(), comName.c_str());
+            SettingsIO* set = openFolder(folder, readOptions).release();
             set->readPosVelFile(0, part, readVelocity);
             return set;
         }
@@ -477,108 +412,153 @@ class SettingsIO
         return this;
     }
 
+    /*
+     * Asks for a run folder with a dialog. Returns "" if none was selected.
+     * Blocks until the dialog closes.
+     */
+    static std::string chooseFolder()
+    {
+        std::string dialog = "Select Folder";
+        const char* fol = tinyfd_selectFolderDialog(dialog.c_str(), "");
+        return fol != NULL ? std::string(fol) : std::string();
+    }
+
+    /*
+     * Opens the run in a folder: its data file (see run_setup::dataFileIn), RunSetup
+     * and COMFile. With readOptions.follow a raw PosAndVel is opened even
+     * when a converted container sits next to it.
+     */
+    static std::unique_ptr<SettingsIO> openFolder(const std::string& folder, const FrameReadOptions& readOptions)
+    {
+        return open(run_setup::filesInFolder(folder, readOptions.follow), readOptions);
+    }
+
+    /*
+     * Opens a run folder (see openFolder) or a single data file, with the
+     * RunSetup and COMFile next to it.
+     */
+    static std::unique_ptr<SettingsIO> openPath(const std::string& path, const FrameReadOptions& readOptions)
+    {
+        return open(run_setup::filesFor(path, readOptions.follow), readOptions);
+    }
+
     /*
      * Gets the total number of frames in a file.
      */
-    long long int getFrames()
-    {
-        std::ifstream input;
-        input.open(posName, std::ios::in | std::ios::binary);
-        if (input) {
-            unsigned long long int size = 0;
-            input.seekg(0, std::ios::end);
-            size = input.tellg();
-            size = size / (sizeof(glm::vec4) * 2 * N);
-            input.seekg(0, std::ios::beg);
-            return size;
+    std::int64_t getFrames()
+    {
+        if (posSource && N > 0) {
+            return posSource->frameCount();
         }
         std::cout << "Error Getting File Size" << std::endl;
         return 1;
     }
 
     /*
-     * Checks to see if a COMFile exists.
+     * Checks to see if a COMFile was loaded.
      */
     bool checkCOM()
     {
-        std::ifstream input;
-        input.open(comName, std::ios::in | std::ios::binary);
-        if (input) {
-            input.close();
-            return true;
+        return comTrack && comTrack->isStored();
+    }
+
+    /*
+     * Grabs the center of mass of a frame: from the COMFile if it has the
+     * frame, else reduced from the frame's positions. `value` is left as it
+     * is when neither works.
+     */
+    void getCOM(std::int64_t frame, glm::vec3& value)
+    {
+        getCOM(frame, nullptr, value);
+    }
+
+    /*
+     * Same as getCOM(), but a computed center of mass is reduced from
+     * `positions`, the frame's N positions already in memory, so no frame is
+     * read twice.
+     */
+    void getCOM(std::int64_t frame, const glm::vec4* positions, glm::vec3& value)
+    {
+        glm::dvec3 com;
+        if (comTrack && comTrack->at(frame, positions, com)) {
+            value = glm::vec3(com * .25);
         }
-        // cout << "Error Loading Center Of Mass File" << endl;
-        return false;
     }
 
     /*
-     * Grabs the center of mass from the COMFile.
+     * Restricts the center of mass to some particle types (a
+     * com_track::parseTypeMask() mask). The COMFile covers all of them, so
+     * it is only used with com_track::ALL_TYPES.
      */
-    void getCOM(long frame, glm::vec3& value)
-    {
-        if (checkCOM()) {
-            FILE* COMFile = fopen(comName.c_str(), "rb");
-            if (COMFile) {
-                fseek(COMFile, frame * sizeof(glm::vec4), SEEK_CUR);
-                glm::vec4 read_val;
-                size_t items_read = fread(&read_val, sizeof(glm::vec4), 1, COMFile);
-                fclose(COMFile);
-                if (items_read == 1 && (long)read_val.w == frame) {
-                    value.x = read_val.x * .25;
-                    value.y = read_val.y * .25;
-                    value.z = read_val.z * .25;
-                }
-            }
+    void setCOMTypes(std::uint32_t mask)
+    {
+        if (comTrack) {
+            comTrack->setTypeMask(mask);
         }
     }
 
+    /*
+     * Mass each particle type carries, from RunSetup: types 0 and 1 are the
+     * iron core and silicate mantle of body 1, types 2 and 3 those of body 2.
+     * Particles of any other type carry none.
+     */
+    std::array<double, com_track::TYPE_SLOTS> typeMasses() const
+    {
+        return setup.typeMasses();
+    }
+
+    /*
+     * True if the RunSetup was read; without it typeMasses() is meaningless.
+     */
+    bool hasSetup() const
+    {
+        return hasRunSetup;
+    }
+
   private:
-    // Note: most of these aren't used, but kept for posterity's sake and/or if the actual slam programs want to use
-    // this to simplify reading in stuff
-    int RecordRate;
-    int DrawRate;
-    int DrawQuality;
-    int WriteToFile;
-    int UseMultipleGPU;
-    float DampRateBody1;
-    float DampRateBody2;
-    float EnergyTargetBody1;
-    float EnergyTargetBody2;
-    float TotalRunTime;
-    float DampTime;
-    float DampRestTime;
-    float EnergyAdjustmentTime;
-    float EnergyAdjustmentRestTime;
-    float SpinRestTime;
+    static std::unique_ptr<SettingsIO> open(const run_setup::RunFiles& files, const FrameReadOptions& readOptions)
+    {
+        return std::make_unique<SettingsIO>(files.data, files.setup, files.com, readOptions);
+    }
+
+    /*
+     * Decodes a frame's positions into the scratch buffer, for sources that
+     * cannot hand out a pointer into their mapping.
+     */
+    bool decodeFrame(std::int64_t frame)
+    {
+        scratch.resize(N);
+        return posSource->readPositions(frame, scratch.data());
+    }
+
+    /*
+     * Logs a failed frame read, capping the log after a few attempts.
+     */
+    void reportReadError()
+    {
+        errorCount++;
+        if (errorCount < 5) {
+            std::cout << "Error Reading File. Attempt: " << errorCount << std::endl;
+        } else if (errorCount == 5) {
+            std::cout << "Too many errors. stopping log here" << std::endl;
+        }
+    }
+
+    // Note: most of the RunSetup values aren't used, but kept for posterity's sake and/or if the actual slam
+    // programs want to use this to simplify reading in stuff
+    RunSetup setup;
     float SetupTime;
-    float Dt;
-    double FractionEarthMassOfBody1;
-    double FractionEarthMassOfBody2;
-    double FractionFeBody1;
-    double FractionSiBody1;
-    double FractionFeBody2;
-    double FractionSiBody2;
-    double DensityFe;
-    double DensitySi;
-    double KFe;
-    double KSi;
-    double KRFe;
-    double KRSi;
-    double SDFe;
-    double SDSi;
-    double UniversalGravity;
-    double MassOfEarth;
-    double Pi;
-    glm::vec3 InitialPosition1;
-    glm::vec3 InitialPosition2;
-    glm::vec3 InitialVelocity1;
-    glm::vec3 InitialVelocity2;
-    glm::vec4 InitialSpin1;
-    glm::vec4 InitialSpin2;
     glm::vec4 CenterOfMass;
     std::string posFile;
     std::string statsFile;
     std::string comFile;
+    std::unique_ptr<FrameSource> posSource;
+    std::unique_ptr<ComTrack> comTrack; // reads posSource, so declared after it
+    bool hasRunSetup = false;
+    std::unique_ptr<FileWatcher> watcher; // set in follow mode
+    std::vector<glm::vec4> scratch;
+    std::int64_t streamedFrame = -1;        // frame the last streamPosFrame() showed, -1 after anything else
+    const Particle* streamedPart = nullptr; // the particle structure it copied a decoded frame into
 };
 
 #endif /* SETTINGSIO_H */
@@ -0,0 +1,193 @@
+/*
+ * pv_convert.cpp
+ *
+ * pv-convert: converts legacy dataset folders (RunSetup + PosAndVel) into the
+ * indexed v2 container, written as PosAndVel.pv2 next to the original data.
+ * The viewer picks up the container automatically when a folder is loaded.
+ *
+ * Usage:
+ *   pv-convert [-j <threads>] [--encoding raw|q16|predictive] [--keyframe-interval <k>]
+ *              [--layout interleaved|separate] [--element-type f32|f64|f16] <folder> [<folder> ...]
+ *   pv-convert --text [--columns <map>] [-j <threads>] [--encoding ...] [--layout ...]
+ *              -o <folder> <snapshot> [<snapshot> ...]
+ *
+ * Folders are converted in parallel, one per worker thread. --encoding q16
+ * stores positions as 16-bit fixed point (see data/quantized_codec.hpp);
+ * predictive stores lossless residuals from a velocity-based prediction
+ * (see data/residual_codec.hpp), with a keyframe every k frames (default 16) so
+ * the viewer can seek; smaller k seeks faster, larger k compresses better.
+ * --layout separate stores all positions ahead of all velocities, so normal
+ * playback reads half the bytes (raw and q16 only). --element-type f64 or f16
+ * reads a PosAndVel written as doubles or half floats; the container holds
+ * floats either way.
+ *
+ * --text imports text snapshots (CSV or whitespace-separated, one particle
+ * per line; see data/text_importer.hpp) as the frames of <folder>, in the
+ * order given. Each snapshot is parsed on -j threads. --columns names the
+ * fields in file order (default x,y,z,type; vx,vy,vz add velocities, '-'
+ * skips a field). Predictive encoding has no RunSetup Dt to predict with
+ * here, so it stores frame-to-frame differences.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "data/container_format.hpp"
+#include "data/dataset_converter.hpp"
+#include "data/element_codec.hpp"
+#include "data/run_setup.hpp"
+#include "data/text_importer.hpp"
+#include "data/thread_pool.hpp"
+
+namespace
+{
+
+void printUsage()
+{
+    std::printf("Usage: pv-convert [-j <threads>] [--encoding raw|q16|predictive] [--keyframe-interval <k>] "
+                "[--layout interleaved|separate] [--element-type f32|f64|f16] <folder> [<folder> ...]\n");
+    std::printf("       pv-convert --text [--columns <map>] [options] -o <folder> <snapshot> [<snapshot> ...]\n");
+    std::printf("Writes <folder>%s from <folder>/PosAndVel and <folder>/RunSetup, or with --text from the\n"
+                "snapshots, one frame each (--columns default %s).\n",
+                container::DEFAULT_FILE_NAME, text_import::DEFAULT_COLUMNS);
+}
+
+/*
+ * Imports text snapshots as the frames of one container in `folder`.
+ */
+int importSnapshots(const std::vector<std::string>& snapshots, const std::string& column_map,
+                    const std::string& folder, unsigned jobs, container::Encoding encoding,
+                    std::uint32_t keyframe_interval, container::StreamLayout layout)
+{
+    std::vector<text_import::Column> columns;
+    std::string error;
+    if (!text_import::parseColumns(column_map, columns, error)) {
+        std::fprintf(stderr, "--columns: %s\n", error.c_str());
+        return 1;
+    }
+    ThreadPool pool(jobs);
+    const std::string output = folder + container::DEFAULT_FILE_NAME;
+    ConversionResult result =
+        convertTextSnapshots(snapshots, columns, output, &pool, encoding, 0.0f, keyframe_interval, layout);
+    if (!result.ok) {
+        std::fprintf(stderr, "%s\n", result.error.c_str());
+        return 1;
+    }
+    std::printf("%zu snapshots: %lld frames -> %s\n", snapshots.size(), static_cast<long long>(result.frames),
+                output.c_str());
+    return 0;
+}
+
+/*
+ * Converts one legacy folder. N, Dt and RecordRate are taken from the
+ * folder's RunSetup.
+ */
+ConversionResult convertFolder(const std::string& folder, container::Encoding encoding, std::uint32_t keyframe_interval,
+                               container::StreamLayout layout, ElementType element_type)
+{
+    RunSetup setup;
+    setup.load(folder + "/RunSetup");
+    const float prediction_dt = setup.Dt * static_cast<float>(setup.RecordRate);
+    return convertLegacyDataset(folder + "/PosAndVel", setup.N, folder + container::DEFAULT_FILE_NAME, encoding,
+                                prediction_dt, keyframe_interval, layout, element_type);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    unsigned jobs = 0;
+    container::Encoding encoding = container::Encoding::Raw;
+    std::uint32_t keyframe_interval = container::DEFAULT_KEYFRAME_INTERVAL;
+    container::StreamLayout layout = container::StreamLayout::FrameInterleaved;
+    ElementType element_type = ElementType::Float32;
+    bool text = false;
+    std::string column_map = text_import::DEFAULT_COLUMNS;
+    std::string output_folder;
+    std::vector<std::string> folders;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg(argv[i]);
+        if (arg == "--text") {
+            text = true;
+        } else if (arg == "--columns" && i + 1 < argc) {
+            column_map = argv[++i];
+        } else if (arg == "-o" && i + 1 < argc) {
+            output_folder = argv[++i];
+        } else if (arg == "-j" && i + 1 < argc) {
+            jobs = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--encoding" && i + 1 < argc) {
+            const std::string name(argv[++i]);
+            if (name == "q16") {
+                encoding = container::Encoding::Quantized16;
+            } else if (name == "predictive") {
+                encoding = container::Encoding::PredictiveResidual;
+            } else if (name != "raw") {
+                std::fprintf(stderr, "Unknown encoding: %s\n", name.c_str());
+                return 1;
+            }
+        } else if (arg == "--keyframe-interval" && i + 1 < argc) {
+            keyframe_interval = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+        } else if (arg == "--layout" && i + 1 < argc) {
+            const std::string name(argv[++i]);
+            if (name == "separate") {
+                layout = container::StreamLayout::SeparateStreams;
+            } else if (name != "interleaved") {
+                std::fprintf(stderr, "Unknown layout: %s\n", name.c_str());
+                return 1;
+            }
+        } else if (arg == "--element-type" && i + 1 < argc) {
+            const std::string name(argv[++i]);
+            if (!element::parseType(name, element_type)) {
+                std::fprintf(stderr, "Unknown element type: %s\n", name.c_str());
+                return 1;
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            folders.push_back(arg);
+        }
+    }
+    if (folders.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (layout == container::StreamLayout::SeparateStreams && encoding == container::Encoding::PredictiveResidual) {
+        std::fprintf(stderr, "--layout separate cannot be combined with --encoding predictive\n");
+        return 1;
+    }
+    if (text) {
+        if (output_folder.empty()) {
+            std::fprintf(stderr, "--text needs an output folder (-o <folder>)\n");
+            return 1;
+        }
+        return importSnapshots(folders, column_map, output_folder, jobs, encoding, keyframe_interval, layout);
+    }
+
+    ThreadPool pool(jobs);
+    std::mutex output_mutex;
+    std::vector<std::future<void>> pending;
+    int failures = 0;
+    for (const std::string& folder : folders) {
+        pending.push_back(pool.submit([&, folder] {
+            ConversionResult result = convertFolder(folder, encoding, keyframe_interval, layout, element_type);
+            std::lock_guard<std::mutex> lock(output_mutex);
+            if (result.ok) {
+                std::printf("%s: %lld frames -> %s%s\n", folder.c_str(), static_cast<long long>(result.frames),
+                            folder.c_str(), container::DEFAULT_FILE_NAME);
+            } else {
+                std::fprintf(stderr, "%s: %s\n", folder.c_str(), result.error.c_str());
+                failures++;
+            }
+        }));
+    }
+    for (auto& done : pending) {
+        done.get();
+    }
+    return failures == 0 ? 0 : 1;
+}
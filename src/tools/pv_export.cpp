@@ -0,0 +1,123 @@
+/*
+ * pv_export.cpp
+ *
+ * pv-export: writes part of a run as a new run folder (PosAndVel, RunSetup
+ * and COMFile), e.g. to hand someone frames 2000-3000 of one body's iron
+ * core around the impact.
+ *
+ * Usage:
+ *   pv-export [-j <threads>] [--frames <first>:<last>] [--types <list>] [--box <x0,y0,z0,x1,y1,z1>]
+ *             [--element-type f32|f64|f16] [--recenter] -o <folder> <run folder | data file>
+ *
+ * --frames is inclusive; either end may be left out (default every frame).
+ * --types keeps the particles of these types (0,1 for body 1's core and
+ * mantle; default all). --box keeps the particles inside the box in the first
+ * exported frame, in data units; they stay in the export when they leave it.
+ * The data is read as the viewer reads it (a raw PosAndVel of --element-type,
+ * a pv-convert container or a shard manifest) and always written as floats;
+ * --recenter writes f64 positions relative to the first frame's centre.
+ * Frames are filtered on -j threads (default one per hardware thread) while
+ * the previous ones are written, holding only a few frames in memory.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "data/com_track.hpp"
+#include "data/element_codec.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/run_setup.hpp"
+#include "data/subset_exporter.hpp"
+#include "data/thread_pool.hpp"
+
+namespace
+{
+
+void printUsage()
+{
+    std::printf("Usage: pv-export [-j <threads>] [--frames <first>:<last>] [--types <list>] "
+                "[--box <x0,y0,z0,x1,y1,z1>] [--element-type f32|f64|f16] [--recenter] -o <folder> <run>\n");
+    std::printf("Writes the selected frames and particles of <run> (a run folder or data file) to\n"
+                "<folder>/PosAndVel, with a RunSetup and COMFile to match.\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    unsigned jobs = 0;
+    FrameReadOptions options;
+    ExportSelection selection;
+    std::string output_folder;
+    std::string input;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg(argv[i]);
+        if (arg == "-j" && i + 1 < argc) {
+            jobs = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "-o" && i + 1 < argc) {
+            output_folder = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc) {
+            if (!subset_export::parseFrameRange(argv[++i], selection.first_frame, selection.last_frame)) {
+                std::fprintf(stderr, "--frames: expected <first>:<last>, got %s\n", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--types" && i + 1 < argc) {
+            if (!com_track::parseTypeMask(argv[++i], selection.type_mask)) {
+                std::fprintf(stderr, "--types: expected a list of types 0-3 such as 0,1, got %s\n", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--box" && i + 1 < argc) {
+            if (!subset_export::parseBox(argv[++i], selection.box_min, selection.box_max)) {
+                std::fprintf(stderr, "--box: expected six numbers x0,y0,z0,x1,y1,z1, got %s\n", argv[i]);
+                return 1;
+            }
+            selection.use_box = true;
+        } else if (arg == "--element-type" && i + 1 < argc) {
+            if (!element::parseType(argv[++i], options.element_type)) {
+                std::fprintf(stderr, "Unknown element type: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--recenter") {
+            options.recenter = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            input = arg;
+        }
+    }
+    if (input.empty() || output_folder.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    const run_setup::RunFiles files = run_setup::filesFor(input);
+    RunSetup setup;
+    const bool has_setup = setup.load(files.setup);
+    std::unique_ptr<FrameSource> source = openFrameSource(files.data, setup.N, options);
+    if (!source || source->particleCount() <= 0 || source->frameCount() == 0) {
+        std::fprintf(stderr, "%s: no frames to export\n", input.c_str());
+        return 1;
+    }
+    const std::array<double, com_track::TYPE_SLOTS> masses = setup.typeMasses();
+
+    ThreadPool pool(jobs);
+    const auto started = std::chrono::steady_clock::now();
+    ExportResult result = exportSubset(*source, files.setup, files.com, output_folder, selection, &pool,
+                                       has_setup ? &masses : nullptr);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (!result.ok) {
+        std::fprintf(stderr, "%s: %s\n", input.c_str(), result.error.c_str());
+        return 1;
+    }
+    std::printf("%s: %lld frames x %lld particles -> %s (%.1f MB in %.1f s, %.0f MB/s)\n", input.c_str(),
+                static_cast<long long>(result.frames), static_cast<long long>(result.particles), output_folder.c_str(),
+                result.bytes / 1e6, seconds,
+                seconds > 0.0 ? result.bytes / 1e6 / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * pv_publish.cpp
+ *
+ * pv-publish: stand-in for a running simulation. Publishes frames into a
+ * shared-memory live feed (see data/shm_feed_writer.hpp) that the viewer can
+ * show with --live <name>, for testing and benchmarking the live path without
+ * a real simulator.
+ *
+ * Usage:
+ *   pv-publish [--slots <k>] [--fps <f>] [--frames <m>] [--loop] <name> <folder>
+ *   pv-publish [--slots <k>] [--fps <f>] [--frames <m>] <name> --synthetic <n>
+ *
+ * With a folder, its frames (PosAndVel.shards or PosAndVel.pv2 if present,
+ * else PosAndVel) are replayed in order, from the start again with --loop.
+ * With --synthetic, n particles orbit on a disc. Frames are paced at --fps
+ * (default 30; 0 = as fast as possible) until --frames have been published or
+ * the process is interrupted, after which the feed is removed.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source_factory.hpp"
+#include "data/run_setup.hpp"
+#include "data/shm_feed_format.hpp"
+#include "data/shm_feed_writer.hpp"
+
+namespace
+{
+
+std::atomic<bool> interrupted{false};
+
+void onInterrupt(int)
+{
+    interrupted = true;
+}
+
+void printUsage()
+{
+    std::printf("Usage: pv-publish [--slots <k>] [--fps <f>] [--frames <m>] [--loop] <name> <folder>\n");
+    std::printf("       pv-publish [--slots <k>] [--fps <f>] [--frames <m>] <name> --synthetic <n>\n");
+    std::printf("Publishes frames into the shared-memory feed <name>; view it with Viewer --live <name>.\n");
+}
+
+/*
+ * Particles on circular orbits around the origin, each with its own radius
+ * and angular speed, so consecutive frames differ everywhere.
+ */
+void makeSyntheticFrame(std::int64_t frame, std::vector<glm::vec4>& positions, std::vector<glm::vec4>& velocities)
+{
+    const std::int64_t n = static_cast<std::int64_t>(positions.size());
+    for (std::int64_t i = 0; i < n; i++) {
+        const double radius = 1.0 + 9.0 * static_cast<double>(i) / static_cast<double>(n);
+        const double omega = 0.05 / std::sqrt(radius);
+        const double angle = omega * static_cast<double>(frame) + 0.618 * static_cast<double>(i);
+        const float type = static_cast<float>(i % 4);
+        positions[i] = glm::vec4(radius * std::cos(angle), radius * std::sin(angle), 0.02 * (i % 17), type);
+        velocities[i] = glm::vec4(-radius * omega * std::sin(angle), radius * omega * std::cos(angle), 0.0, type);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::uint32_t slots = shm_feed::DEFAULT_SLOT_COUNT;
+    double fps = 30.0;
+    std::int64_t max_frames = -1;
+    bool loop = false;
+    std::int64_t synthetic_particles = 0;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg(argv[i]);
+        if (arg == "--slots" && i + 1 < argc) {
+            slots = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+        } else if (arg == "--fps" && i + 1 < argc) {
+            fps = std::atof(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            max_frames = std::atoll(argv[++i]);
+        } else if (arg == "--loop") {
+            loop = true;
+        } else if (arg == "--synthetic" && i + 1 < argc) {
+            synthetic_particles = std::atoll(argv[++i]);
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    const bool synthetic = synthetic_particles > 0;
+    if (positional.size() != (synthetic ? 1u : 2u)) {
+        printUsage();
+        return 1;
+    }
+    const std::string& name = positional[0];
+
+    std::unique_ptr<FrameSource> source;
+    std::int64_t frames = 0;
+    std::int64_t particles = synthetic_particles;
+    if (!synthetic) {
+        const std::string& folder = positional[1];
+        const run_setup::RunFiles files = run_setup::filesInFolder(folder);
+        RunSetup setup;
+        setup.load(files.setup);
+        source = openFrameSource(files.data, setup.N);
+        if (!source || source->particleCount() <= 0 || source->frameCount() <= 0) {
+            std::fprintf(stderr, "%s: no frames to publish\n", folder.c_str());
+            return 1;
+        }
+        frames = source->frameCount();
+        particles = source->particleCount();
+    }
+
+    ShmFeedWriter feed;
+    if (!feed.create(name, particles, slots, true)) {
+        std::fprintf(stderr, "Could not create feed %s\n", name.c_str());
+        return 1;
+    }
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+    std::printf("Publishing %lld particles to %s (%u slots)\n", static_cast<long long>(particles), name.c_str(), slots);
+
+    std::vector<glm::vec4> positions(particles);
+    std::vector<glm::vec4> velocities(particles);
+    const auto frame_period = std::chrono::duration<double>(fps > 0.0 ? 1.0 / fps : 0.0);
+    auto next_deadline = std::chrono::steady_clock::now();
+    for (std::int64_t published = 0; !interrupted && (max_frames < 0 || published < max_frames); published++) {
+        if (synthetic) {
+            makeSyntheticFrame(published, positions, velocities);
+        } else {
+            const std::int64_t frame = published % frames;
+            if (!loop && published >= frames) {
+                break;
+            }
+            if (!source->readPositions(frame, positions.data())) {
+                std::fprintf(stderr, "Could not read frame %lld\n", static_cast<long long>(frame));
+                break;
+            }
+            if (!source->readVelocities(frame, velocities.data())) {
+                std::fill(velocities.begin(), velocities.end(), glm::vec4(0.0f));
+            }
+        }
+        feed.publish(positions.data(), velocities.data());
+
+        next_deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(frame_period);
+        std::this_thread::sleep_until(next_deadline);
+    }
+    std::printf("Published %lld frames\n", static_cast<long long>(feed.publishedFrames()));
+    return 0;
+}
@@ -6,6 +6,8 @@
 
 #include "imgui_menu.hpp"
 
+#include <algorithm>
+#include <cfloat>
 #include <string>
 
 #include <SDL3/SDL.h>
@@ -64,6 +66,16 @@ static bool clampResolutionToMonitor(int& width, int& height)
     return clamped;
 }
 
+// Height of the activity plot above the timeline's frame slider
+static const float TIMELINE_PLOT_HEIGHT = 40.0f;
+
+// Width of the progress window shown while a dataset opens
+static const float LOADING_STATUS_WIDTH = 320.0f;
+
+// Particle types the export dialog offers, as RunSetup lays them out
+static const char* const EXPORT_TYPE_LABELS[4] = {"Body 1 iron (0)", "Body 1 silicate (1)", "Body 2 iron (2)",
+                                                  "Body 2 silicate (3)"};
+
 /*
  * Common aspect ratios for display resolutions.
  */
@@ -88,6 +100,9 @@ MenuActions renderMainMenu(MenuState& state)
             if (ImGui::MenuItem("Load File...", "T")) {
                 actions.load_file = true;
             }
+            if (ImGui::MenuItem("Export Subset...")) {
+                actions.export_subset = true;
+            }
             ImGui::Separator();
             if (ImGui::MenuItem("Quit", "Esc")) {
                 actions.quit = true;
@@ -146,8 +161,12 @@ MenuActions renderMainMenu(MenuState& state)
             if (ImGui::MenuItem("Toggle Fullscreen", "Alt+Enter")) {
                 actions.toggle_fullscreen = true;
             }
+            if (ImGui::MenuItem("Frame Data", "F")) {
+                actions.frame_data = true;
+            }
             ImGui::Separator();
             ImGui::MenuItem("Debug Mode", "F3", &state.debug_mode);
+            ImGui::MenuItem("Timeline", nullptr, &state.show_timeline);
             ImGui::MenuItem("Show Menu", "F1", &state.visible);
             ImGui::EndMenu();
         }
@@ -156,3 +175,121 @@ MenuActions renderMainMenu(MenuState& state)
 
     return actions;
 }
+
+TimelineActions renderTimeline(const MenuState& state, const TimelineView& view)
+{
+    TimelineActions actions;
+
+    if (!state.visible || !state.show_timeline || view.frame_count < 2) {
+        return actions;
+    }
+
+    // Full width along the bottom edge of the window
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x, viewport->WorkPos.y + viewport->WorkSize.y), ImGuiCond_Always,
+                            ImVec2(0.0f, 1.0f));
+    ImGui::SetNextWindowSize(ImVec2(viewport->WorkSize.x, 0.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.7f);
+
+    ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                             ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+                             ImGuiWindowFlags_NoMove;
+
+    if (ImGui::Begin("##Timeline", nullptr, flags)) {
+        const float width = ImGui::GetContentRegionAvail().x;
+        if (view.activity != nullptr && view.activity_count > 0) {
+            ImGui::PlotHistogram("##Activity", view.activity, view.activity_count, 0, nullptr, 0.0f, FLT_MAX,
+                                 ImVec2(width, TIMELINE_PLOT_HEIGHT));
+        } else if (view.stats_total > 0) {
+            const float fraction = static_cast<float>(view.stats_done) / static_cast<float>(view.stats_total);
+            ImGui::ProgressBar(fraction, ImVec2(width, 0.0f), "Computing frame statistics...");
+        }
+
+        std::int64_t frame = view.current_frame;
+        const std::int64_t first = 0;
+        const std::int64_t last = view.frame_count - 1;
+        ImGui::SetNextItemWidth(width);
+        if (ImGui::SliderScalar("##Frame", ImGuiDataType_S64, &frame, &first, &last, "Frame %lld")) {
+            actions.seek = true;
+            actions.frame = frame;
+        }
+        actions.scrubbing = ImGui::IsItemActive();
+        if (view.non_finite_frames > 0) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%lld frames contain NaN or Inf positions",
+                               static_cast<long long>(view.non_finite_frames));
+        }
+    }
+    ImGui::End();
+
+    return actions;
+}
+
+void renderLoadingStatus(const char* status, float progress)
+{
+    // Centred just below the menu bar, over the scene that stays interactive
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x * 0.5f, viewport->WorkPos.y + 8.0f),
+                            ImGuiCond_Always, ImVec2(0.5f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(LOADING_STATUS_WIDTH, 0.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.7f);
+
+    ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                             ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+                             ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoInputs;
+
+    if (ImGui::Begin("##Loading", nullptr, flags)) {
+        ImGui::ProgressBar(progress, ImVec2(ImGui::GetContentRegionAvail().x, 0.0f), status);
+    }
+    ImGui::End();
+}
+
+ExportDialogActions renderExportDialog(ExportDialogState& state)
+{
+    ExportDialogActions actions;
+
+    if (!state.open) {
+        return actions;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+    if (ImGui::Begin("Export Subset", &state.open, ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoCollapse)) {
+        if (state.running) {
+            ImGui::ProgressBar(state.progress, ImVec2(LOADING_STATUS_WIDTH, 0.0f), state.status.c_str());
+            if (ImGui::Button("Cancel")) {
+                actions.cancel = true;
+            }
+        } else {
+            const std::int64_t first = 0;
+            const std::int64_t last = std::max<std::int64_t>(state.frame_count - 1, 0);
+            ImGui::SliderScalar("First frame", ImGuiDataType_S64, &state.first_frame, &first, &last);
+            ImGui::SliderScalar("Last frame", ImGuiDataType_S64, &state.last_frame, &first, &last);
+            state.last_frame = std::max(state.last_frame, state.first_frame);
+
+            ImGui::Separator();
+            for (int type = 0; type < 4; type++) {
+                ImGui::Checkbox(EXPORT_TYPE_LABELS[type], &state.types[type]);
+            }
+
+            ImGui::Separator();
+            ImGui::Checkbox("Only particles inside a box (at the first frame)", &state.use_box);
+            if (state.use_box) {
+                ImGui::InputFloat3("Box min", state.box_min);
+                ImGui::InputFloat3("Box max", state.box_max);
+            }
+
+            ImGui::Separator();
+            const bool any_type = state.types[0] || state.types[1] || state.types[2] || state.types[3];
+            ImGui::BeginDisabled(!any_type);
+            if (ImGui::Button("Export...")) {
+                actions.start = true;
+            }
+            ImGui::EndDisabled();
+        }
+        if (!state.message.empty()) {
+            ImGui::TextWrapped("%s", state.message.c_str());
+        }
+    }
+    ImGui::End();
+
+    return actions;
+}
@@ -2,7 +2,10 @@
  * imgui_menu.hpp
  *
  * ImGui-based menu system for Particle-Viewer.
- * Provides a main menu bar with File and View menus.
+ * Provides a main menu bar with File and View menus, the frame timeline
+ * shown along the bottom of the window while a dataset is loaded, the
+ * progress of a dataset opening in the background, and the dialog that
+ * exports part of a dataset.
  *
  * The menu communicates user actions back to the caller via MenuActions.
  * Menu visibility and debug mode state are tracked in MenuState.
@@ -11,15 +14,20 @@
 #ifndef PARTICLE_VIEWER_IMGUI_MENU_H
 #define PARTICLE_VIEWER_IMGUI_MENU_H
 
+#include <cstdint>
+#include <string>
+
 /*
  * Actions triggered by menu interactions, communicated back to ViewerApp.
  */
 struct MenuActions
 {
     bool load_file = false;
+    bool export_subset = false; // open the export dialog
     bool quit = false;
     bool change_resolution = false;
     bool toggle_fullscreen = false;
+    bool frame_data = false; // move the camera so the current frame's bounds fill the view
     int target_width = 0;
     int target_height = 0;
 };
@@ -31,6 +39,33 @@ struct MenuState
 {
     bool visible = true;
     bool debug_mode = false;
+    bool show_timeline = true;
+};
+
+/*
+ * What the timeline shows. `activity` is a per-span activity profile from
+ * the frame statistics (see frame_stats::activityProfile), or nullptr while
+ * they are still being computed.
+ */
+struct TimelineView
+{
+    std::int64_t current_frame = 0;
+    std::int64_t frame_count = 0;
+    const float* activity = nullptr;
+    int activity_count = 0;
+    std::int64_t stats_done = 0;  // frames whose statistics are computed
+    std::int64_t stats_total = 0; // 0 when no statistics are being computed
+    std::int64_t non_finite_frames = 0;
+};
+
+/*
+ * Actions triggered on the timeline.
+ */
+struct TimelineActions
+{
+    bool seek = false;
+    std::int64_t frame = 0;
+    bool scrubbing = false; // slider held down: show reduced previews until it is let go
 };
 
 /*
@@ -40,4 +75,54 @@ struct MenuState
  */
 MenuActions renderMainMenu(MenuState& state);
 
+/*
+ * Renders the frame timeline: an activity plot over the whole run above a
+ * frame slider. Hidden with the menu, or for datasets of a single frame.
+ * Call after ImGui::NewFrame() each frame.
+ */
+TimelineActions renderTimeline(const MenuState& state, const TimelineView& view);
+
+/*
+ * Renders a small progress window under the menu bar while a dataset opens
+ * in the background. `progress` runs from 0 to 1.
+ * Call after ImGui::NewFrame() each frame.
+ */
+void renderLoadingStatus(const char* status, float progress);
+
+/*
+ * What the export dialog edits: a frame window, the particle types and an
+ * optional box (in data units) to export. While an export runs the dialog
+ * shows its progress instead.
+ */
+struct ExportDialogState
+{
+    bool open = false;
+    std::int64_t first_frame = 0;
+    std::int64_t last_frame = 0;
+    std::int64_t frame_count = 0;
+    bool types[4] = {true, true, true, true};
+    bool use_box = false;
+    float box_min[3] = {0.0f, 0.0f, 0.0f};
+    float box_max[3] = {0.0f, 0.0f, 0.0f};
+    bool running = false;
+    std::string status;
+    float progress = 0.0f;
+    std::string message; // outcome of the last export
+};
+
+/*
+ * Actions triggered in the export dialog.
+ */
+struct ExportDialogActions
+{
+    bool start = false;
+    bool cancel = false;
+};
+
+/*
+ * Renders the export dialog while `state.open`.
+ * Call after ImGui::NewFrame() each frame.
+ */
+ExportDialogActions renderExportDialog(ExportDialogState& state);
+
 #endif // PARTICLE_VIEWER_IMGUI_MENU_H
@@ -7,15 +7,23 @@
 
 #include "viewer_app.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 // clang-format off
 #include <SDL3/SDL.h>          // NOLINT(llvm-include-order)
 // clang-format on
 
+#include "data/com_track.hpp"
+#include "data/element_codec.hpp"
+#include "data/process_memory.hpp"
+#include "data/text_importer.hpp"
 #include "debugOverlay.hpp"
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
@@ -44,13 +52,28 @@ static const std::array<QuadVertex, 6> QUAD_VERTICES = {{{-1.0f, 1.0f, 0.0f, 1.0
                                                          {1.0f, -1.0f, 1.0f, 0.0f},
                                                          {1.0f, 1.0f, 1.0f, 1.0f}}};
 
+// Frames the prefetcher hands to an io_uring source at once
+static const int URING_PREFETCH_BATCH = 4;
+
+// Positions are drawn scaled by sphereVertex.vs's transScale
+static const float POSITION_SCALE = 0.25f;
+
+// Spans of frames in the timeline's activity plot
+static const int TIMELINE_BUCKETS = 512;
+
 // ============================================================================
 // Construction / Destruction
 // ============================================================================
 
 ViewerApp::ViewerApp(IOpenGLContext* context)
     : context_(context), imgui_initialized_(false), delta_time_(0.0f), last_frame_(0.0f), cam_(nullptr), part_(nullptr),
-      set_(nullptr), view_(), com_(), cur_frame_(0), pixels_(nullptr)
+      set_(nullptr), view_(), com_(), cur_frame_(0), shown_frame_(0), playback_direction_(1), skipped_frame_(-1),
+      frame_cache_budget_bytes_(0), follow_mode_(false), follow_latest_(false), preview_stride_(8),
+      preview_particles_(0), scrubbing_(false), page_cache_policy_enabled_(true),
+      rate_bytes_(0), rate_time_(0.0f), read_mb_per_s_(0.0), frame_stats_enabled_(true), non_finite_frames_(0),
+      com_types_(com_track::ALL_TYPES), start_frame_(0), start_playing_(false), startup_open_(false),
+      launch_time_(std::chrono::steady_clock::now()), setup_ms_(0.0), open_ms_(0.0), first_frame_pending_(false),
+      pixels_(nullptr)
 {
     for (int i = 0; i < 1024; i++) {
         keys_[i] = false;
@@ -78,17 +101,105 @@ void ViewerApp::parseArgs(int argc, char* argv[])
             }
         } else if (arg == "--debug-camera" || arg == "-d") {
             window_.debug_camera = true;
+        } else if (arg == "--prefetch-depth") {
+            if (i + 1 < argc) {
+                prefetch_config_.ring_depth = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--prefetch-mb") {
+            if (i + 1 < argc) {
+                prefetch_config_.memory_budget_bytes = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+            }
+        } else if (arg == "--frame-cache-mb") {
+            if (i + 1 < argc) {
+                frame_cache_budget_bytes_ = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+            }
+        } else if (arg == "--follow") {
+            follow_mode_ = true;
+        } else if (arg == "--follow-latest") {
+            follow_mode_ = true;
+            follow_latest_ = true;
+        } else if (arg == "--read-threads") {
+            if (i + 1 < argc) {
+                read_options_.read_threads = static_cast<unsigned>(std::atoi(argv[++i]));
+            }
+        } else if (arg == "--io-uring") {
+            read_options_.io_uring = true;
+        } else if (arg == "--no-page-cache-policy") {
+            page_cache_policy_enabled_ = false;
+        } else if (arg == "--no-frame-stats") {
+            frame_stats_enabled_ = false;
+        } else if (arg == "--preview-stride") {
+            if (i + 1 < argc) {
+                preview_stride_ = std::max(std::atoi(argv[++i]), 1);
+            }
+        } else if (arg == "--element-type") {
+            if (i + 1 < argc && !element::parseType(argv[++i], read_options_.element_type)) {
+                std::cerr << "--element-type: expected f32, f64 or f16, got " << argv[i] << std::endl;
+            }
+        } else if (arg == "--recenter") {
+            read_options_.recenter = true;
+        } else if (arg == "--com-types") {
+            if (i + 1 < argc && !com_track::parseTypeMask(argv[++i], com_types_)) {
+                std::cerr << "--com-types: expected a list of types 0-3 such as 0,1, got " << argv[i] << std::endl;
+            }
+        } else if (arg == "--import") {
+            if (i + 1 < argc) {
+                import_path_ = argv[++i];
+            }
+        } else if (arg == "--columns") {
+            if (i + 1 < argc) {
+                std::vector<text_import::Column> columns;
+                std::string error;
+                if (text_import::parseColumns(argv[++i], columns, error)) {
+                    read_options_.text_columns = argv[i];
+                } else {
+                    std::cerr << "--columns: " << error << "; using " << read_options_.text_columns << std::endl;
+                }
+            }
+        } else if (arg == "--data") {
+            if (i + 1 < argc) {
+                data_path_ = argv[++i];
+            }
+        } else if (arg == "--frame") {
+            if (i + 1 < argc) {
+                start_frame_ = std::max<std::int64_t>(std::strtoll(argv[++i], nullptr, 10), 0);
+            }
+        } else if (arg == "--play") {
+            start_playing_ = true;
+        } else if (arg == "--live") {
+            if (i + 1 < argc) {
+                live_feed_ = argv[++i];
+                follow_mode_ = true;
+                follow_latest_ = true;
+            }
         }
     }
     setResolution(resolution);
+
+    if (read_options_.io_uring && !UringFileReader::isSupported()) {
+        std::cerr << "io_uring is not available here; reading PosAndVel synchronously" << std::endl;
+        read_options_.io_uring = false;
+    }
+    if (read_options_.io_uring) {
+        prefetch_config_.batch_frames = URING_PREFETCH_BATCH;
+    }
+    // Only a followed file needs address space reserved to grow into
+    read_options_.follow = follow_mode_;
+    // Opened on a worker while main() creates the window and initialize() sets up GL
+    if (!data_path_.empty() && live_feed_.empty() && import_path_.empty()) {
+        startup_open_ = opener_.open(data_path_, read_options_, start_frame_);
+    }
 }
 
 // ============================================================================
 // Initialization
 // ============================================================================
 
-bool ViewerApp::initialize()
+bool ViewerApp::initialize(IOpenGLContext* context)
 {
+    if (context) {
+        context_ = context;
+    }
     if (!context_) {
         std::cerr << "ViewerApp::initialize() called with null context" << std::endl;
         return false;
@@ -108,6 +219,14 @@ bool ViewerApp::initialize()
     gamepad_.openFirstGamepad();
 
     menu_state_.debug_mode = window_.debug_camera;
+    set_->readOptions = read_options_; // inherited by every dataset loaded from here
+
+    if (!live_feed_.empty()) {
+        openLiveFeed();
+    } else if (!import_path_.empty()) {
+        openImport();
+    }
+    setup_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launch_time_).count();
     return true;
 }
 
@@ -257,7 +376,26 @@ void ViewerApp::run()
         if (imgui_initialized_) {
             if (menu_state_.debug_mode) {
                 float fps = (delta_time_ > 0.0f) ? 1.0f / delta_time_ : 0.0f;
-                renderCameraDebugOverlay(cam_, window_.width, window_.height, fps, PARTICLE_VIEWER_VERSION);
+                DataStreamStats stream_stats;
+                stream_stats.current_frame = cur_frame_;
+                stream_stats.total_frames = set_->frames;
+                if (prefetcher_) {
+                    stream_stats.ring_ready = prefetcher_->readyCount();
+                    stream_stats.ring_capacity = prefetcher_->capacity();
+                }
+                if (frame_cache_) {
+                    stream_stats.cache_enabled = true;
+                    stream_stats.cache = frame_cache_->stats();
+                }
+                updateReadRate();
+                stream_stats.read_mb_per_s = read_mb_per_s_;
+                stream_stats.resident_bytes = residentSetBytes();
+                if (page_cache_policy_) {
+                    stream_stats.page_cache_policy = true;
+                    stream_stats.page_cache = page_cache_policy_->stats();
+                }
+                renderCameraDebugOverlay(cam_, window_.width, window_.height, fps, PARTICLE_VIEWER_VERSION,
+                                         &stream_stats);
             }
 
             // Render ImGui menu and process actions
@@ -265,6 +403,9 @@ void ViewerApp::run()
             if (actions.load_file) {
                 handleLoadFile();
             }
+            if (actions.export_subset) {
+                openExportDialog();
+            }
             if (actions.change_resolution) {
                 SDL_Window* native_window = static_cast<SDL_Window*>(context_->getNativeWindowHandle());
                 if (native_window) {
@@ -278,20 +419,36 @@ void ViewerApp::run()
             if (actions.toggle_fullscreen) {
                 toggleFullscreen();
             }
+            if (actions.frame_data) {
+                frameData();
+            }
             if (actions.quit) {
                 context_->setShouldClose(true);
             }
+            drawTimeline();
+            drawExportDialog();
+            if (opener_.isBusy()) {
+                renderLoadingStatus(opener_.status(), opener_.progress());
+            }
 
             ImGui::Render();
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         }
 
         context_->swapBuffers();
+        if (first_frame_pending_) {
+            reportFirstFrame();
+        }
 
-        if (set_->frames > 1) {
-            set_->readPosVelFile(cur_frame_, part_, false);
+        finishDatasetOpen();
+        finishExport();
+        if (set_->isFollowing()) {
+            followAppendedFrames();
         }
-        if (set_->isPlaying) {
+
+        // Playback only advances once the frame on screen actually arrived
+        bool frame_ready = updateFrameData();
+        if (set_->isPlaying && frame_ready) {
             cur_frame_++;
         }
         if (cur_frame_ > set_->frames) {
@@ -404,14 +561,10 @@ void ViewerApp::beforeDraw()
 
 void ViewerApp::drawScene()
 {
-    set_->getCOM(cur_frame_, com_);
-    cam_->setSphereCenter(com_);
+    cam_->setSphereCenter(com_); // updated by updateFrameData() from the frame it shows
     render_.sphere_shader.Use();
     part_->pushVBO();
     glBindVertexArray(render_.circle_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, part_->instanceVBO);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glUniformMatrix4fv(glGetUniformLocation(render_.sphere_shader.Program, "view"), 1, GL_FALSE, glm::value_ptr(view_));
     glUniformMatrix4fv(glGetUniformLocation(render_.sphere_shader.Program, "projection"), 1, GL_FALSE,
                        glm::value_ptr(cam_->getProjection()));
@@ -421,7 +574,7 @@ void ViewerApp::drawScene()
     glGetIntegerv(GL_VIEWPORT, viewport);
     glUniform1f(glGetUniformLocation(render_.sphere_shader.Program, "viewportHeight"),
                 static_cast<GLfloat>(viewport[3]));
-    glDrawArraysInstanced(GL_POINTS, 0, 1, part_->n);
+    part_->drawInstances();
     glBindVertexArray(0);
 
     if (set_->isPlaying && recording_.is_active) {
@@ -465,24 +618,421 @@ void ViewerApp::seekFrame(int frames, bool forward)
     }
 }
 
+bool ViewerApp::updateFrameData()
+{
+    const bool scrubbing = scrubbing_ && preview_prefetcher_;
+    scrubbing_ = false;
+    if (set_->frames <= 1) {
+        updateCOM(set_->clampFrame(cur_frame_), nullptr);
+        return true;
+    }
+    if (!prefetcher_) {
+        const glm::vec4* shown = set_->streamPosFrame(cur_frame_, part_);
+        if (shown != nullptr) {
+            updateCOM(set_->clampFrame(cur_frame_), shown);
+        }
+        return true;
+    }
+    std::int64_t frame = set_->clampFrame(cur_frame_);
+    if (frame != shown_frame_) {
+        playback_direction_ = (frame > shown_frame_) ? 1 : -1;
+    }
+    // While scrubbing the full ring keeps what it has; it only moves once the playhead settles
+    if (!scrubbing) {
+        prefetcher_->setPlayhead(frame, playback_direction_);
+    }
+    const glm::vec4* positions = prefetcher_->acquire(frame);
+    if (positions == nullptr && scrubbing) {
+        preview_prefetcher_->setPlayhead(frame, playback_direction_);
+        const glm::vec4* preview = preview_prefetcher_->acquire(frame);
+        if (preview == nullptr) {
+            return false;
+        }
+        part_->viewTranslations(preview_particles_, preview);
+        shown_frame_ = frame;
+        return true;
+    }
+    if (positions == nullptr && prefetcher_->hasFailed(frame)) {
+        if (frame != skipped_frame_) {
+            std::cerr << "Warning: frame " << frame << " could not be read; skipping it" << std::endl;
+            skipped_frame_ = frame;
+        }
+        return true; // playback moves past it instead of waiting for a frame that never arrives
+    }
+    if (positions == nullptr) {
+        return false; // keep showing the previous frame (or its preview) until the loader catches up
+    }
+    if (frame == shown_frame_ && part_->translationData() == positions && part_->n == set_->N) {
+        updateCOM(frame, positions); // cached per frame; picks up a COM lock taken while paused
+        return true;                 // paused: already uploaded, page-cache window already follows it
+    }
+    part_->viewTranslations(set_->N, positions);
+    shown_frame_ = frame;
+    updateCOM(frame, positions);
+    if (page_cache_policy_) {
+        page_cache_policy_->update(frame);
+    }
+    return true;
+}
+
+void ViewerApp::updateCOM(std::int64_t frame, const glm::vec4* positions)
+{
+    // Nothing but the COM lock looks at it, and a computed one costs a pass over the frame
+    if (!cam_->isComLocked()) {
+        return;
+    }
+    set_->getCOM(frame, positions, com_);
+}
+
+void ViewerApp::updateReadRate()
+{
+    const GLfloat elapsed = last_frame_ - rate_time_;
+    if (elapsed < 1.0f) {
+        return;
+    }
+    const std::uint64_t bytes = bytes_read_.load();
+    read_mb_per_s_ = (bytes - rate_bytes_) / (1024.0 * 1024.0) / elapsed;
+    rate_bytes_ = bytes;
+    rate_time_ = last_frame_;
+}
+
+void ViewerApp::restartPrefetcher()
+{
+    preview_prefetcher_.reset();
+    prefetcher_.reset();
+    page_cache_policy_.reset();
+    frame_cache_.reset();
+    shown_frame_ = 0;
+    playback_direction_ = 1;
+    skipped_frame_ = -1;
+    if (set_->frames <= 1) {
+        return;
+    }
+    const FrameSource* source = set_->getFrameSource();
+    if (source == nullptr || source->isLive()) {
+        return; // a live feed is drawn straight from its shared slots
+    }
+    FrameCache* cache = nullptr;
+    if (frame_cache_budget_bytes_ > 0) {
+        frame_cache_ = std::make_unique<FrameCache>(set_->N, frame_cache_budget_bytes_);
+        cache = frame_cache_.get();
+    }
+    // The full and preview rings split one budget in proportion to their frame sizes
+    preview_particles_ = previewParticleCount(set_->N, preview_stride_);
+    const std::uint64_t frame_bytes = sizeof(glm::vec4) * static_cast<std::uint64_t>(set_->N);
+    const std::uint64_t preview_bytes =
+        (preview_particles_ < set_->N) ? sizeof(glm::vec4) * static_cast<std::uint64_t>(preview_particles_) : 0;
+    const PrefetchConfig full_config = prefetch_config_.share(frame_bytes, frame_bytes + preview_bytes);
+    if (!FramePrefetcher::fitsBudget(full_config, frame_bytes)) {
+        std::cerr << "Warning: the prefetch budget of " << (prefetch_config_.memory_budget_bytes >> 20)
+                  << " MB holds fewer than " << PrefetchConfig::MIN_RING_DEPTH << " frames of "
+                  << (frame_bytes >> 20) << " MB; the prefetch rings use "
+                  << ((PrefetchConfig::MIN_RING_DEPTH * (frame_bytes + preview_bytes)) >> 20) << " MB" << std::endl;
+    }
+    prefetcher_ = std::make_unique<FramePrefetcher>(
+        set_->N, set_->frames,
+        FramePrefetcher::BatchReader([source, cache, bytes_read = &bytes_read_](FrameRead* reads, int count) {
+            std::vector<FrameRead> misses;
+            std::vector<int> miss_index;
+            for (int i = 0; i < count; i++) {
+                reads[i].ok = cache != nullptr && cache->lookup(reads[i].frame, reads[i].destination);
+                if (!reads[i].ok) {
+                    misses.push_back(reads[i]);
+                    miss_index.push_back(i);
+                }
+            }
+            source->readPositionsBatch(misses.data(), static_cast<int>(misses.size()));
+            for (std::size_t m = 0; m < misses.size(); m++) {
+                reads[miss_index[m]].ok = misses[m].ok;
+                if (!misses[m].ok) {
+                    continue;
+                }
+                *bytes_read += sizeof(glm::vec4) * static_cast<std::uint64_t>(source->particleCount());
+                if (cache != nullptr) {
+                    cache->insert(misses[m].frame, misses[m].destination);
+                }
+            }
+        }),
+        full_config);
+    // Scrub previews: a fraction of each frame, loaded only while the playhead is being dragged
+    if (preview_bytes > 0) {
+        const int stride = preview_stride_;
+        preview_prefetcher_ = std::make_unique<FramePrefetcher>(
+            preview_particles_, set_->frames,
+            FramePrefetcher::FrameReader([source, stride, bytes_read = &bytes_read_, count = preview_particles_](
+                                             std::int64_t frame, glm::vec4* destination) {
+                if (!source->readPreviewPositions(frame, stride, destination)) {
+                    return false;
+                }
+                *bytes_read += sizeof(glm::vec4) * static_cast<std::uint64_t>(count);
+                return true;
+            }),
+            prefetch_config_.share(preview_bytes, frame_bytes + preview_bytes));
+    }
+    if (page_cache_policy_enabled_) {
+        page_cache_policy_ = std::make_unique<PageCachePolicy>(source);
+    }
+}
+
+void ViewerApp::startFrameStats()
+{
+    frame_stats_.reset();
+    activity_profile_.clear();
+    non_finite_frames_ = 0;
+    const FrameSource* source = set_->getFrameSource();
+    if (source == nullptr || source->isLive() || set_->frames <= 1) {
+        return;
+    }
+    // Half the cores, so the pass does not starve rendering and the prefetcher
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    frame_stats_ = std::make_unique<FrameStatsIndex>(source, set_->posName, threads, frame_stats_enabled_);
+}
+
+void ViewerApp::frameData()
+{
+    const FrameStats* stats = frame_stats_ ? frame_stats_->frame(cur_frame_) : nullptr;
+    if (stats == nullptr || !stats->hasBounds()) {
+        return;
+    }
+    cam_->frameBounds(stats->bounds_min * POSITION_SCALE, stats->bounds_max * POSITION_SCALE);
+}
+
+void ViewerApp::openExportDialog()
+{
+    if (set_->getFrameSource() == nullptr || set_->frames == 0) {
+        std::cout << "No dataset to export" << std::endl;
+        return;
+    }
+    export_dialog_.open = true;
+    if (export_dialog_.running) {
+        return;
+    }
+    // Start from the frame on screen to the end of the run, boxed around the frame's particles
+    export_dialog_.frame_count = set_->frames;
+    export_dialog_.first_frame = cur_frame_;
+    export_dialog_.last_frame = set_->frames - 1;
+    const FrameStats* stats = frame_stats_ ? frame_stats_->frame(cur_frame_) : nullptr;
+    if (stats != nullptr && stats->hasBounds()) {
+        for (int axis = 0; axis < 3; axis++) {
+            export_dialog_.box_min[axis] = stats->bounds_min[axis];
+            export_dialog_.box_max[axis] = stats->bounds_max[axis];
+        }
+    }
+    export_dialog_.message.clear();
+}
+
+void ViewerApp::drawExportDialog()
+{
+    export_dialog_.running = exporter_.isBusy();
+    if (export_dialog_.running) {
+        export_dialog_.status = exporter_.status();
+        export_dialog_.progress = exporter_.progress();
+        if (!export_dialog_.open) {
+            renderLoadingStatus(export_dialog_.status.c_str(), export_dialog_.progress);
+        }
+    } else {
+        // The dataset may have been replaced since the dialog was opened
+        export_dialog_.frame_count = set_->frames;
+    }
+
+    ExportDialogActions actions = renderExportDialog(export_dialog_);
+    if (actions.cancel) {
+        exporter_.cancel();
+    }
+    if (actions.start) {
+        ExportSelection selection;
+        selection.first_frame = export_dialog_.first_frame;
+        selection.last_frame = std::min(export_dialog_.last_frame, set_->frames - 1);
+        selection.type_mask = 0;
+        for (int type = 0; type < 4; type++) {
+            if (export_dialog_.types[type]) {
+                selection.type_mask |= 1u << type;
+            }
+        }
+        // Particles outside types 0-3 only go along when every type does
+        if (selection.type_mask == 0xFu) {
+            selection.type_mask = com_track::ALL_TYPES;
+        }
+        selection.use_box = export_dialog_.use_box;
+        selection.box_min = glm::vec3(export_dialog_.box_min[0], export_dialog_.box_min[1], export_dialog_.box_min[2]);
+        selection.box_max = glm::vec3(export_dialog_.box_max[0], export_dialog_.box_max[1], export_dialog_.box_max[2]);
+        export_dialog_.message.clear();
+        exporter_.start(set_->posName, selection, set_->readOptions);
+    }
+}
+
+void ViewerApp::finishExport()
+{
+    if (!exporter_.isDone()) {
+        return;
+    }
+    std::string folder;
+    ExportResult result = exporter_.take(folder);
+    if (folder.empty()) {
+        export_dialog_.message = "Folder not selected";
+    } else if (!result.ok) {
+        export_dialog_.message = "Export failed: " + result.error;
+    } else {
+        export_dialog_.message = "Exported " + std::to_string(result.frames) + " frames of " +
+                                 std::to_string(result.particles) + " particles to " + folder;
+    }
+    std::cout << export_dialog_.message << std::endl;
+}
+
+void ViewerApp::drawTimeline()
+{
+    TimelineView view;
+    view.current_frame = cur_frame_;
+    view.frame_count = set_->frames;
+    if (frame_stats_) {
+        if (frame_stats_->isReady() && activity_profile_.empty()) {
+            activity_profile_ = frame_stats::activityProfile(frame_stats_->frames(), TIMELINE_BUCKETS);
+            non_finite_frames_ = frame_stats_->nonFiniteFrames();
+        }
+        if (frame_stats_->isComputing()) {
+            view.stats_done = frame_stats_->framesDone();
+            view.stats_total = frame_stats_->frameCount();
+        }
+        // In follow mode the run outgrows the statistics; the plot would no longer line up with the slider
+        if (!activity_profile_.empty() && frame_stats_->frameCount() == set_->frames) {
+            view.activity = activity_profile_.data();
+            view.activity_count = static_cast<int>(activity_profile_.size());
+        }
+    }
+    view.non_finite_frames = non_finite_frames_;
+    TimelineActions actions = renderTimeline(menu_state_, view);
+    if (actions.seek) {
+        cur_frame_ = actions.frame;
+    }
+    if (actions.scrubbing) {
+        scrubbing_ = true;
+    }
+}
+
+void ViewerApp::followAppendedFrames()
+{
+    const std::int64_t previous_frames = set_->frames;
+    if (!set_->pollFollow()) {
+        return;
+    }
+    if (prefetcher_) {
+        prefetcher_->setFrameCount(set_->frames);
+        if (preview_prefetcher_) {
+            preview_prefetcher_->setFrameCount(set_->frames);
+        }
+    } else {
+        restartPrefetcher(); // the run had at most one frame so far, so nothing was prefetched
+    }
+    if (follow_latest_ && set_->frames > previous_frames) {
+        cur_frame_ = set_->frames - 1;
+    }
+}
+
 void ViewerApp::processMinorKeys()
 {
     if (keys_[SDL_SCANCODE_Q]) {
         seekFrame(3, false);
+        scrubbing_ = true;
     }
     if (keys_[SDL_SCANCODE_E]) {
         seekFrame(3, true);
+        scrubbing_ = true;
     }
 }
 
 void ViewerApp::handleLoadFile()
 {
-    SettingsIO* new_set = set_->loadFile(part_, false);
-    if (new_set && new_set != set_) {
-        delete set_;
-        set_ = new_set;
+    // The current dataset stays on screen until finishDatasetOpen() swaps the new one in
+    opener_.chooseFolder(set_->readOptions);
+}
+
+void ViewerApp::finishDatasetOpen()
+{
+    if (!opener_.isDone()) {
+        return;
+    }
+    DatasetOpener::Result result = opener_.take();
+    const bool startup = startup_open_;
+    startup_open_ = false;
+    if (!result.settings) {
+        if (result.error.empty()) {
+            std::cout << "Folder not selected" << std::endl;
+        } else {
+            std::cerr << result.error << std::endl;
+        }
+        return;
+    }
+    replaceDataset(result.settings.release());
+    set_->setFollow(follow_mode_);
+    cur_frame_ = result.frame;
+    if (!result.first_frame.empty()) {
+        part_->changeTranslations(set_->N, result.first_frame.data());
+    }
+    restartPrefetcher();
+    shown_frame_ = result.frame;
+    startFrameStats();
+    if (startup) {
+        set_->isPlaying = start_playing_;
+        open_ms_ = result.open_ms;
+        first_frame_pending_ = true; // drawn next iteration, reported after its swapBuffers()
+    }
+}
+
+void ViewerApp::reportFirstFrame()
+{
+    first_frame_pending_ = false;
+    const double first_frame_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launch_time_).count();
+    std::cout << "First frame of " << data_path_ << " after " << std::lround(first_frame_ms)
+              << " ms (window and GL setup " << std::lround(setup_ms_) << " ms, dataset open "
+              << std::lround(open_ms_) << " ms, overlapped)" << std::endl;
+}
+
+void ViewerApp::openLiveFeed()
+{
+    auto* live_set = new SettingsIO(shm_feed::PATH_PREFIX + live_feed_, "", "");
+    if (live_set->getFrameSource() == nullptr) {
+        std::cerr << "Could not open live feed '" << live_feed_ << "'" << std::endl;
+        delete live_set;
+        return;
+    }
+    replaceDataset(live_set);
+    set_->setFollow(true);
+    if (set_->frames > 0) {
+        cur_frame_ = set_->frames - 1;
+        set_->readPosVelFile(cur_frame_, part_, false);
     }
+    restartPrefetcher();
+    startFrameStats(); // clears the previous dataset's timeline; a live feed has no statistics
+}
+
+void ViewerApp::openImport()
+{
+    auto* import_set = new SettingsIO(import_path_, "", "", read_options_);
+    if (import_set->getFrameSource() == nullptr) {
+        std::cerr << "Could not import '" << import_path_ << "' with columns " << read_options_.text_columns
+                  << std::endl;
+        delete import_set;
+        return;
+    }
+    replaceDataset(import_set);
     cur_frame_ = 0;
+    set_->readPosVelFile(cur_frame_, part_, false);
+    restartPrefetcher();
+    startFrameStats();
+}
+
+void ViewerApp::replaceDataset(SettingsIO* new_set)
+{
+    // part_ may still point into the old dataset's mapping or prefetch ring
+    part_->detachTranslations();
+    preview_prefetcher_.reset(); // its loader reads through the old dataset's source
+    prefetcher_.reset();
+    page_cache_policy_.reset();
+    frame_stats_.reset();
+    delete set_;
+    set_ = new_set;
+    set_->setCOMTypes(com_types_);
 }
 
 // ============================================================================
@@ -527,6 +1077,9 @@ void ViewerApp::handleKeyEvent(unsigned int scancode, bool is_pressed, unsigned
     if (scancode == SDL_SCANCODE_T && is_pressed) {
         handleLoadFile();
     }
+    if (scancode == SDL_SCANCODE_F && is_pressed) {
+        frameData();
+    }
     if (scancode == SDL_SCANCODE_RIGHT && is_pressed) {
         seekFrame(1, true);
     }
@@ -624,9 +1177,11 @@ void ViewerApp::processGamepadInput()
     // Triggers: fast-forward / rewind (continuous, mirrors Q/E keys)
     if (right_trigger > TRIGGER_THRESHOLD) {
         seekFrame(3, true);
+        scrubbing_ = true;
     }
     if (left_trigger > TRIGGER_THRESHOLD) {
         seekFrame(3, false);
+        scrubbing_ = true;
     }
 
     // Bumpers: single-frame advance / rewind (mirrors arrow keys)
@@ -702,6 +1257,10 @@ void ViewerApp::cleanup()
         render_.circle_vao = 0;
     }
 
+    preview_prefetcher_.reset();
+    prefetcher_.reset();
+    page_cache_policy_.reset();
+    frame_stats_.reset();
     delete set_;
     set_ = nullptr;
     delete cam_;
@@ -14,7 +14,12 @@
 #ifndef PARTICLE_VIEWER_VIEWER_APP_H
 #define PARTICLE_VIEWER_VIEWER_APP_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 // clang-format off
 // GLAD must come before other OpenGL-related headers
@@ -22,6 +27,12 @@
 // clang-format on
 
 #include "camera.hpp"
+#include "data/frame_cache.hpp"
+#include "data/frame_prefetcher.hpp"
+#include "data/frame_stats.hpp"
+#include "data/page_cache_policy.hpp"
+#include "datasetExporter.hpp"
+#include "datasetOpener.hpp"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
@@ -102,17 +113,19 @@ struct ShaderPaths
  * ViewerApp owns all application state and manages the main loop.
  *
  * Replaces the global state previously in clutter.hpp with proper encapsulation.
- * Requires a non-null IOpenGLContext* passed to the constructor for testability.
- * Production code typically uses SDL3Context; tests use MockOpenGLContext.
- * ViewerApp does not create or own the OpenGL context itself.
+ * Requires a non-null IOpenGLContext*, passed to the constructor or to
+ * initialize(), for testability. Production code typically uses SDL3Context;
+ * tests use MockOpenGLContext. ViewerApp does not create or own the OpenGL
+ * context itself.
  *
  * SDL3 events are polled directly in run() via SDL_PollEvent().
  *
  * Usage (production):
- *   SDL3Context context(1280, 720, "Particle-Viewer");
- *   ViewerApp app(&context);
- *   app.parseArgs(argc, argv);
- *   if (app.initialize()) {
+ *   std::optional<SDL3Context> context; // declared first: outlives the app
+ *   ViewerApp app(nullptr);
+ *   app.parseArgs(argc, argv);          // starts opening --data in the background
+ *   context.emplace(1280, 720, "Particle-Viewer");
+ *   if (app.initialize(&*context)) {
  *       app.run();
  *   }
  *
@@ -125,8 +138,8 @@ class ViewerApp
   public:
     /*
      * Construct with an injected OpenGL context (dependency injection).
-     * The context must be non-null and must outlive the ViewerApp.
-     * ViewerApp does not own the context.
+     * The context must outlive the ViewerApp; it may be null here if it is
+     * passed to initialize() instead. ViewerApp does not own the context.
      */
     explicit ViewerApp(IOpenGLContext* context);
 
@@ -137,16 +150,21 @@ class ViewerApp
     ViewerApp& operator=(const ViewerApp&) = delete;
 
     /*
-     * Parse command-line arguments (--resolution, --debug-camera).
-     * Must be called before initialize().
+     * Parse command-line arguments (--resolution, --debug-camera,
+     * --prefetch-depth, --prefetch-mb, --frame-cache-mb, --follow, --follow-latest,
+     * --live, --read-threads, --io-uring, --no-page-cache-policy, --no-frame-stats,
+     * --preview-stride, --import, --columns, --element-type, --recenter, --com-types,
+     * --data, --frame, --play). Must be called before initialize(); --data
+     * starts opening its dataset on a worker thread right away.
      */
     void parseArgs(int argc, char* argv[]);
 
     /*
      * Initialize SDL3 context, OpenGL, camera, particles, shaders, and FBO.
+     * A non-null `context` replaces the one given to the constructor.
      * Returns true on success, false if initialization fails.
      */
-    bool initialize();
+    bool initialize(IOpenGLContext* context = nullptr);
 
     /*
      * Run the main rendering loop. Blocks until the window is closed.
@@ -190,7 +208,45 @@ class ViewerApp
     // ============================================
     // Frame Playback State
     // ============================================
-    GLint cur_frame_;
+    std::int64_t cur_frame_;
+    std::int64_t shown_frame_; // frame whose positions part_ currently displays
+    int playback_direction_;   // +1 forward, -1 rewinding; steers the prefetcher
+    std::int64_t skipped_frame_; // last frame skipped because the prefetcher could not read it; -1 for none
+    std::uint64_t frame_cache_budget_bytes_; // 0 disables the frame cache
+    bool follow_mode_;   // watch the data file for frames a running simulation appends
+    bool follow_latest_; // in follow mode, jump to each newly appended frame
+    std::string live_feed_; // shared-memory feed to open at startup (--live); empty for none
+    std::string import_path_; // text snapshot to open at startup (--import); empty for none
+    DatasetOpener opener_;    // File > Load: opens the next dataset while this one stays on screen
+    DatasetExporter exporter_; // File > Export Subset: writes part of the dataset in the background
+    ExportDialogState export_dialog_;
+    FrameReadOptions read_options_; // --read-threads, --io-uring, --element-type, ...: how data files are read
+    PrefetchConfig prefetch_config_;
+    std::unique_ptr<FrameCache> frame_cache_; // filled by the prefetcher's loader thread, so declared before it
+    std::unique_ptr<FramePrefetcher> prefetcher_;
+    int preview_stride_; // --preview-stride: runs of particles skipped per run shown while scrubbing
+    std::int64_t preview_particles_;
+    std::unique_ptr<FramePrefetcher> preview_prefetcher_; // reduced frames shown while scrubbing
+    bool scrubbing_; // timeline dragged or Q / E held since the last updateFrameData()
+    bool page_cache_policy_enabled_; // --no-page-cache-policy turns off readahead / drop hints
+    std::unique_ptr<PageCachePolicy> page_cache_policy_;
+    std::atomic<std::uint64_t> bytes_read_{0}; // position bytes the loader read from the data file
+    std::uint64_t rate_bytes_;                 // bytes_read_ at the last rate sample
+    GLfloat rate_time_;                        // time of the last rate sample
+    double read_mb_per_s_;
+    bool frame_stats_enabled_; // --no-frame-stats: only use a sidecar that already exists
+    std::unique_ptr<FrameStatsIndex> frame_stats_;
+    std::vector<float> activity_profile_; // timeline plot, filled once frame_stats_ is ready
+    std::int64_t non_finite_frames_;
+    std::uint32_t com_types_; // --com-types: particle types the COM lock follows (com_track type mask)
+    std::string data_path_;   // run folder or data file to open at startup (--data); empty for none
+    std::int64_t start_frame_; // --frame: frame the --data dataset opens at
+    bool start_playing_;       // --play: start playback once the --data dataset is shown
+    bool startup_open_;        // opener_ is opening --data
+    std::chrono::steady_clock::time_point launch_time_; // construction, i.e. process start
+    double setup_ms_;          // launch to the end of initialize(): window, GL, shaders and ImGui
+    double open_ms_;           // the --data open on the worker, overlapping setup_ms_
+    bool first_frame_pending_; // the --data dataset is swapped in but not presented yet
 
     // ============================================
     // Pixel Buffer (for recording)
@@ -233,6 +289,22 @@ class ViewerApp
     void seekFrame(int frames, bool forward);
     void processMinorKeys();
     void handleLoadFile();
+    void finishDatasetOpen();
+    void reportFirstFrame();
+    void openLiveFeed();
+    void openImport();
+    void replaceDataset(SettingsIO* new_set);
+    void restartPrefetcher();
+    void followAppendedFrames();
+    bool updateFrameData();
+    void updateCOM(std::int64_t frame, const glm::vec4* positions);
+    void updateReadRate();
+    void startFrameStats();
+    void frameData();
+    void drawTimeline();
+    void openExportDialog();
+    void drawExportDialog();
+    void finishExport();
 
     // ============================================
     // Input Handling
@@ -0,0 +1,73 @@
+/*
+ * BenchmarkHarness.hpp
+ *
+ * Minimal benchmark registry for the ParticleViewerBenchmarks executable.
+ * Benchmarks are not run by CTest; run the executable directly, optionally
+ * passing a substring to select benchmarks by name:
+ *
+ *   ./build/tests/ParticleViewerBenchmarks FrameRead
+ */
+
+#ifndef PARTICLE_VIEWER_BENCHMARK_HARNESS_H
+#define PARTICLE_VIEWER_BENCHMARK_HARNESS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Outcome of one benchmark: how many iterations ran, how long they took in
+ * total and how many payload bytes they moved (0 if not meaningful).
+ */
+struct BenchmarkResult
+{
+    int iterations = 0;
+    double seconds = 0.0;
+    std::uint64_t bytes = 0;
+};
+
+struct BenchmarkCase
+{
+    std::string name;
+    std::function<BenchmarkResult()> run;
+};
+
+inline std::vector<BenchmarkCase>& benchmarkRegistry()
+{
+    static std::vector<BenchmarkCase> registry;
+    return registry;
+}
+
+/*
+ * Registers a benchmark at static-initialization time.
+ */
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const std::string& name, std::function<BenchmarkResult()> run)
+    {
+        benchmarkRegistry().push_back({name, std::move(run)});
+    }
+};
+
+/*
+ * Times `iterations` calls of `body` with a steady clock.
+ */
+inline BenchmarkResult timeIterations(int iterations, std::uint64_t bytes_per_iteration,
+                                      const std::function<void(int)>& body)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    BenchmarkResult result;
+    result.iterations = iterations;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.bytes = bytes_per_iteration * static_cast<std::uint64_t>(iterations);
+    return result;
+}
+
+#endif // PARTICLE_VIEWER_BENCHMARK_HARNESS_H
@@ -0,0 +1,33 @@
+/*
+ * BenchmarkMain.cpp
+ *
+ * Entry point for ParticleViewerBenchmarks. Runs every registered benchmark
+ * whose name contains argv[1] (or all of them) and prints per-iteration time
+ * and throughput.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "BenchmarkHarness.hpp"
+#include "MockOpenGL.hpp"
+
+int main(int argc, char* argv[])
+{
+    // Particle uploads go through the GL mocks so benchmarks measure CPU-side cost only
+    MockOpenGL::reset();
+    MockOpenGL::initGLAD();
+
+    const std::string filter = (argc > 1) ? argv[1] : "";
+    std::printf("%-48s %10s %12s %12s\n", "Benchmark", "Iters", "ms/iter", "MB/s");
+    for (const auto& bench : benchmarkRegistry()) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        BenchmarkResult result = bench.run();
+        double ms_per_iter = (result.iterations > 0) ? result.seconds * 1000.0 / result.iterations : 0.0;
+        double mb_per_s = (result.seconds > 0.0) ? (result.bytes / (1024.0 * 1024.0)) / result.seconds : 0.0;
+        std::printf("%-48s %10d %12.4f %12.1f\n", bench.name.c_str(), result.iterations, ms_per_iter, mb_per_s);
+    }
+    return 0;
+}
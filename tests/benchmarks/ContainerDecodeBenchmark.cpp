@@ -0,0 +1,68 @@
+/*
+ * ContainerDecodeBenchmark.cpp
+ *
+ * Per-frame read cost of the v2 container encodings: raw frames copied out of
+ * the mapping versus 16-bit quantized frames decoded into the same buffer,
+ * and predictive residual frames decoded in playback order and under random
+ * seeks (which decode from the nearest keyframe).
+ */
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BenchmarkHarness.hpp"
+#include "SyntheticDataset.hpp"
+#include "data/container_frame_source.hpp"
+#include "data/dataset_converter.hpp"
+
+namespace
+{
+
+constexpr long BENCH_PARTICLES = 200000;
+constexpr int BENCH_FRAMES = 24;
+constexpr int BENCH_PASSES = 4;
+
+const std::string BENCH_POS_AND_VEL = "/tmp/bench_container_PosAndVel";
+const std::string BENCH_RAW = "/tmp/bench_container_raw.pv2";
+const std::string BENCH_Q16 = "/tmp/bench_container_q16.pv2";
+const std::string BENCH_PREDICTIVE = "/tmp/bench_container_predictive.pv2";
+
+void ensureContainers()
+{
+    static bool written = false;
+    if (!written) {
+        writeSyntheticPosAndVel(BENCH_POS_AND_VEL, BENCH_PARTICLES, BENCH_FRAMES);
+        convertLegacyDataset(BENCH_POS_AND_VEL, BENCH_PARTICLES, BENCH_RAW, container::Encoding::Raw);
+        convertLegacyDataset(BENCH_POS_AND_VEL, BENCH_PARTICLES, BENCH_Q16, container::Encoding::Quantized16);
+        // The synthetic data moves by exactly one velocity step per frame
+        convertLegacyDataset(BENCH_POS_AND_VEL, BENCH_PARTICLES, BENCH_PREDICTIVE,
+                             container::Encoding::PredictiveResidual, 1.0f);
+        written = true;
+    }
+}
+
+BenchmarkResult readAllFrames(const std::string& path, int frame_stride = 1)
+{
+    ensureContainers();
+    ContainerFrameSource source{MappedFile(path)};
+    std::vector<glm::vec4> destination(BENCH_PARTICLES);
+    // Throughput is reported against the stored bytes, i.e. what crosses the disk/bus
+    return timeIterations(BENCH_FRAMES * BENCH_PASSES, source.storedFrameBytes(0), [&](int i) {
+        source.readPositions((i * frame_stride) % BENCH_FRAMES, destination.data());
+    });
+}
+
+BenchmarkRegistrar raw_read("ContainerDecode/raw_readPositions", [] { return readAllFrames(BENCH_RAW); });
+
+BenchmarkRegistrar q16_read("ContainerDecode/q16_readPositions", [] { return readAllFrames(BENCH_Q16); });
+
+BenchmarkRegistrar predictive_read("ContainerDecode/predictive_readPositions",
+                                   [] { return readAllFrames(BENCH_PREDICTIVE); });
+
+// A stride coprime to the frame count visits every frame, never sequentially
+BenchmarkRegistrar predictive_seek("ContainerDecode/predictive_seekPositions",
+                                   [] { return readAllFrames(BENCH_PREDICTIVE, 7); });
+
+} // namespace
@@ -0,0 +1,104 @@
+/*
+ * FrameReadBenchmark.cpp
+ *
+ * Compares the original per-frame fopen/new[]/fread/copy path against the
+ * memory-mapped SettingsIO reader (copying and zero-copy variants).
+ * Each iteration ends with one copy of the positions, standing in for the
+ * glBufferData upload that follows every frame read in the viewer.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "BenchmarkHarness.hpp"
+#include "SyntheticDataset.hpp"
+#include "particle.hpp"
+#include "settingsIO.hpp"
+
+namespace
+{
+
+constexpr long BENCH_PARTICLES = 200000;
+constexpr int BENCH_FRAMES = 24;
+constexpr int BENCH_PASSES = 4;
+
+const std::string BENCH_RUN_SETUP = "/tmp/bench_frame_read_RunSetup";
+const std::string BENCH_POS_AND_VEL = "/tmp/bench_frame_read_PosAndVel";
+
+void ensureDataset()
+{
+    static bool written = false;
+    if (!written) {
+        writeSyntheticRunSetup(BENCH_RUN_SETUP, BENCH_PARTICLES);
+        writeSyntheticPosAndVel(BENCH_POS_AND_VEL, BENCH_PARTICLES, BENCH_FRAMES);
+        written = true;
+    }
+}
+
+/*
+ * The reader as it was before the mapping was introduced: reopen the file,
+ * allocate, fread and copy into the Particle on every frame.
+ */
+void legacyReadPosVelFile(const std::string& pos_name, long n, long frame, Particle* part)
+{
+    FILE* pos_and_vel = fopen(pos_name.c_str(), "r");
+    if (pos_and_vel) {
+        fseek(pos_and_vel, frame * sizeof(glm::vec4) * 2 * n, SEEK_CUR);
+        glm::vec4* pos = new glm::vec4[n];
+        size_t read = fread(pos, sizeof(glm::vec4), (int)n, pos_and_vel);
+        (void)read;
+        part->changeTranslations(n, pos);
+        delete[] pos;
+        fclose(pos_and_vel);
+    }
+}
+
+/*
+ * The GL calls are mocked, so model the driver's copy of the instance data
+ * explicitly; otherwise the zero-copy path would never touch the frame.
+ */
+void simulateUpload(const Particle& part)
+{
+    static std::vector<glm::vec4> gpu_buffer;
+    gpu_buffer.resize(part.n);
+    std::memcpy(gpu_buffer.data(), part.translationData(), sizeof(glm::vec4) * part.n);
+}
+
+const std::uint64_t FRAME_POSITION_BYTES = sizeof(glm::vec4) * BENCH_PARTICLES;
+
+BenchmarkRegistrar legacy_read("FrameRead/legacy_fopen_fread", [] {
+    ensureDataset();
+    Particle part;
+    return timeIterations(BENCH_FRAMES * BENCH_PASSES, FRAME_POSITION_BYTES, [&](int i) {
+        legacyReadPosVelFile(BENCH_POS_AND_VEL, BENCH_PARTICLES, i % BENCH_FRAMES, &part);
+        simulateUpload(part);
+    });
+});
+
+BenchmarkRegistrar mapped_read("FrameRead/mapped_readPosVelFile", [] {
+    ensureDataset();
+    SettingsIO settings(BENCH_POS_AND_VEL, BENCH_RUN_SETUP, "/tmp/bench_frame_read_COMFile");
+    Particle part;
+    return timeIterations(BENCH_FRAMES * BENCH_PASSES, FRAME_POSITION_BYTES, [&](int i) {
+        settings.readPosVelFile(i % BENCH_FRAMES, &part, false);
+        simulateUpload(part);
+    });
+});
+
+BenchmarkRegistrar mapped_stream("FrameRead/mapped_streamPosFrame", [] {
+    ensureDataset();
+    SettingsIO settings(BENCH_POS_AND_VEL, BENCH_RUN_SETUP, "/tmp/bench_frame_read_COMFile");
+    Particle part;
+    return timeIterations(BENCH_FRAMES * BENCH_PASSES, FRAME_POSITION_BYTES, [&](int i) {
+        settings.streamPosFrame(i % BENCH_FRAMES, &part);
+        simulateUpload(part);
+    });
+});
+
+} // namespace
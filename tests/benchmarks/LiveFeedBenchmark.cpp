@@ -0,0 +1,90 @@
+/*
+ * LiveFeedBenchmark.cpp
+ *
+ * Per-frame cost of the shared-memory live feed: publishing a frame into the
+ * ring, and the viewer side either copying it out under the slot's sequence
+ * counter or uploading straight from the shared slot. Each viewer-side
+ * iteration ends with one copy standing in for the instance buffer upload.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <glm/glm.hpp>
+
+#include "BenchmarkHarness.hpp"
+#include "data/shm_feed_writer.hpp"
+#include "data/shm_frame_source.hpp"
+
+namespace
+{
+
+constexpr long BENCH_PARTICLES = 200000;
+constexpr int BENCH_ITERATIONS = 96;
+constexpr std::uint32_t BENCH_SLOTS = 4;
+
+const std::uint64_t FRAME_POSITION_BYTES = sizeof(glm::vec4) * BENCH_PARTICLES;
+
+std::string benchFeedName()
+{
+    return "pv_bench_live_" + std::to_string(getpid());
+}
+
+std::vector<glm::vec4> makePositions()
+{
+    std::vector<glm::vec4> positions(BENCH_PARTICLES);
+    for (long i = 0; i < BENCH_PARTICLES; i++) {
+        positions[i] = glm::vec4(i % 97, i % 89, i % 83, i % 4);
+    }
+    return positions;
+}
+
+void uploadFrom(const glm::vec4* positions)
+{
+    static std::vector<glm::vec4> gpu_buffer(BENCH_PARTICLES);
+    std::memcpy(gpu_buffer.data(), positions, FRAME_POSITION_BYTES);
+}
+
+BenchmarkRegistrar publish("LiveFeed/publish", [] {
+    ShmFeedWriter feed;
+    feed.create(benchFeedName(), BENCH_PARTICLES, BENCH_SLOTS, true);
+    const std::vector<glm::vec4> positions = makePositions();
+    return timeIterations(BENCH_ITERATIONS, 2 * FRAME_POSITION_BYTES,
+                          [&](int) { feed.publish(positions.data(), positions.data()); });
+});
+
+BenchmarkRegistrar copy_read("LiveFeed/readPositions_upload", [] {
+    ShmFeedWriter feed;
+    feed.create(benchFeedName(), BENCH_PARTICLES, BENCH_SLOTS, true);
+    const std::vector<glm::vec4> positions = makePositions();
+    for (std::uint32_t slot = 0; slot < BENCH_SLOTS; slot++) {
+        feed.publish(positions.data(), positions.data());
+    }
+    ShmFrameSource source;
+    source.open(benchFeedName());
+    const long newest = source.refreshFrameCount() - 1;
+    std::vector<glm::vec4> destination(BENCH_PARTICLES);
+    return timeIterations(BENCH_ITERATIONS, FRAME_POSITION_BYTES, [&](int i) {
+        source.readPositions(newest - i % BENCH_SLOTS, destination.data());
+        uploadFrom(destination.data());
+    });
+});
+
+BenchmarkRegistrar zero_copy("LiveFeed/mappedPositions_upload", [] {
+    ShmFeedWriter feed;
+    feed.create(benchFeedName(), BENCH_PARTICLES, BENCH_SLOTS, true);
+    const std::vector<glm::vec4> positions = makePositions();
+    for (std::uint32_t slot = 0; slot < BENCH_SLOTS; slot++) {
+        feed.publish(positions.data(), positions.data());
+    }
+    ShmFrameSource source;
+    source.open(benchFeedName());
+    const long newest = source.refreshFrameCount() - 1;
+    return timeIterations(BENCH_ITERATIONS, FRAME_POSITION_BYTES,
+                          [&](int i) { uploadFrom(source.mappedPositions(newest - i % BENCH_SLOTS)); });
+});
+
+} // namespace
@@ -0,0 +1,112 @@
+/*
+ * ParallelReadBenchmark.cpp
+ *
+ * Read throughput for very large frames: the memory-mapped RawFrameSource
+ * copy (one thread) against PreadFrameSource with one and several reader
+ * threads, and UringFrameSource reading one frame or a prefetcher-sized batch
+ * per call. The "cold" cases drop the file from the page cache before every
+ * read (Linux), so they measure the drive rather than memcpy.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "BenchmarkHarness.hpp"
+#include "SyntheticDataset.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/uring_file_reader.hpp"
+
+namespace
+{
+
+constexpr std::int64_t BENCH_PARTICLES = 8 * 1024 * 1024; // 128 MiB of positions per frame
+constexpr int BENCH_FRAMES = 4;
+constexpr int BENCH_ITERATIONS = 8;
+constexpr int URING_BATCH = 4; // frames per call, as the viewer's prefetcher hands them over
+
+const std::string BENCH_POS_AND_VEL = "/tmp/bench_parallel_read_PosAndVel";
+const std::uint64_t FRAME_POSITION_BYTES = sizeof(glm::vec4) * BENCH_PARTICLES;
+
+void ensureDataset()
+{
+    static bool written = false;
+    if (!written) {
+        writeSyntheticPosAndVel(BENCH_POS_AND_VEL, BENCH_PARTICLES, BENCH_FRAMES);
+        written = true;
+    }
+}
+
+/*
+ * Drops the dataset from the page cache. Only possible on Linux; elsewhere
+ * the cold cases read from cache like the warm ones.
+ */
+void evictFromPageCache()
+{
+#ifdef __linux__
+    const int fd = open(BENCH_POS_AND_VEL.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#endif
+}
+
+/*
+ * Reads `batch` frames per iteration with the backend `options` selects.
+ * Cold runs reopen the source each time, so a mapping does not keep evicted
+ * pages resident.
+ */
+BenchmarkResult readFrames(const FrameReadOptions& options, bool cold, int batch = 1)
+{
+    ensureDataset();
+    std::vector<glm::vec4> destination(BENCH_PARTICLES * batch);
+    std::unique_ptr<FrameSource> source = openFrameSource(BENCH_POS_AND_VEL, BENCH_PARTICLES, options);
+    return timeIterations(BENCH_ITERATIONS, FRAME_POSITION_BYTES * batch, [&](int i) {
+        if (cold) {
+            source.reset();
+            evictFromPageCache();
+            source = openFrameSource(BENCH_POS_AND_VEL, BENCH_PARTICLES, options);
+        }
+        std::vector<FrameRead> reads;
+        for (int b = 0; b < batch; b++) {
+            reads.push_back({(i * batch + b) % BENCH_FRAMES, destination.data() + b * BENCH_PARTICLES});
+        }
+        source->readPositionsBatch(reads.data(), batch);
+    });
+}
+
+/*
+ * io_uring cases report the synchronous fallback when the kernel refuses a ring.
+ */
+BenchmarkResult readFramesUring(bool cold, int batch)
+{
+    if (!UringFileReader::isSupported()) {
+        std::printf("io_uring unavailable; measuring the mapped fallback\n");
+    }
+    return readFrames({0, true}, cold, batch);
+}
+
+BenchmarkRegistrar mapped_warm("ParallelRead/mapped_copy_warm", [] { return readFrames({0}, false); });
+BenchmarkRegistrar pread1_warm("ParallelRead/pread_1_thread_warm", [] { return readFrames({1}, false); });
+BenchmarkRegistrar pread4_warm("ParallelRead/pread_4_threads_warm", [] { return readFrames({4}, false); });
+BenchmarkRegistrar uring_warm("ParallelRead/uring_1_frame_warm", [] { return readFramesUring(false, 1); });
+BenchmarkRegistrar mapped_cold("ParallelRead/mapped_copy_cold", [] { return readFrames({0}, true); });
+BenchmarkRegistrar pread1_cold("ParallelRead/pread_1_thread_cold", [] { return readFrames({1}, true); });
+BenchmarkRegistrar pread4_cold("ParallelRead/pread_4_threads_cold", [] { return readFrames({4}, true); });
+BenchmarkRegistrar pread8_cold("ParallelRead/pread_8_threads_cold", [] { return readFrames({8}, true); });
+BenchmarkRegistrar uring1_cold("ParallelRead/uring_1_frame_cold", [] { return readFramesUring(true, 1); });
+BenchmarkRegistrar uring4_cold("ParallelRead/uring_4_frame_batch_cold",
+                               [] { return readFramesUring(true, URING_BATCH); });
+
+} // namespace
@@ -0,0 +1,69 @@
+/*
+ * SyntheticDataset.hpp
+ *
+ * Writes throwaway RunSetup / PosAndVel files for benchmarks.
+ */
+
+#ifndef PARTICLE_VIEWER_SYNTHETIC_DATASET_H
+#define PARTICLE_VIEWER_SYNTHETIC_DATASET_H
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/*
+ * Writes a RunSetup file in the order SettingsIO parses it. Every value
+ * except N is a placeholder.
+ */
+inline void writeSyntheticRunSetup(const std::string& path, long n)
+{
+    static const char* const KEYS_BEFORE_N[] = {"InitialPosition1.x", "InitialPosition1.y", "InitialPosition1.z",
+        "InitialPosition2.x", "InitialPosition2.y", "InitialPosition2.z", "InitialVelocity1.x", "InitialVelocity1.y",
+        "InitialVelocity1.z", "InitialVelocity2.x", "InitialVelocity2.y", "InitialVelocity2.z", "InitialSpin1.x",
+        "InitialSpin1.y", "InitialSpin1.z", "InitialSpin1.w", "InitialSpin2.x", "InitialSpin2.y", "InitialSpin2.z",
+        "InitialSpin2.w", "FractionEarthMassOfBody1", "FractionEarthMassOfBody2", "FractionFeBody1", "FractionSiBody1",
+        "FractionFeBody2", "FractionSiBody2", "DampRateBody1", "DampRateBody2", "EnergyTargetBody1",
+        "EnergyTargetBody2"};
+    static const char* const KEYS_AFTER_N[] = {"TotalRunTime", "DampTime", "DampRestTime", "EnergyAdjustmentTime",
+        "EnergyAdjustmentRestTime", "SpinRestTime", "Dt", "WriteToFile", "RecordRate", "DensityFe", "DensitySi", "KFe",
+        "KSi", "KRFe", "KRSi", "SDFe", "SDSi", "DrawRate", "DrawQuality", "UseMultipleGPU", "UniversalGravity",
+        "MassOfEarth", "Pi"};
+
+    std::ofstream out(path);
+    for (const char* key : KEYS_BEFORE_N) {
+        out << key << "=1\n";
+    }
+    out << "N=" << n << "\n";
+    for (const char* key : KEYS_AFTER_N) {
+        out << key << "=1\n";
+    }
+}
+
+/*
+ * Writes `frames` frames of n positions followed by n velocities. Positions
+ * drift with the frame index so consecutive frames differ.
+ */
+inline void writeSyntheticPosAndVel(const std::string& path, long n, int frames)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    std::vector<glm::vec4> block(n);
+    for (int frame = 0; frame < frames; frame++) {
+        for (long i = 0; i < n; i++) {
+            block[i] = glm::vec4(i % 97 + frame * 0.01f, i % 89 - frame * 0.02f, i % 83 + frame * 0.03f, i % 4);
+        }
+        fwrite(block.data(), sizeof(glm::vec4), n, file);
+        for (long i = 0; i < n; i++) {
+            block[i] = glm::vec4(0.01f, -0.02f, 0.03f, 0.0f);
+        }
+        fwrite(block.data(), sizeof(glm::vec4), n, file);
+    }
+    fclose(file);
+}
+
+#endif // PARTICLE_VIEWER_SYNTHETIC_DATASET_H
@@ -6,6 +6,8 @@
  */
 
 // Include glad first to avoid OpenGL header conflicts
+#include <cmath>
+
 #include <glad/glad.h>
 #include <gtest/gtest.h>
 
@@ -666,3 +668,40 @@ TEST_F(CameraTest, UpdateProjection_PreservesFarPlane_AfterUpdate)
     // Assert
     EXPECT_FLOAT_EQ(camera.getFarPlane(), original_far);
 }
+
+TEST_F(CameraTest, FrameBounds_BoxCorners_ProjectInsideView)
+{
+    // Arrange
+    Camera camera(SCREEN_WIDTH, SCREEN_HEIGHT);
+    camera.update(0.0f);
+    const glm::vec3 bounds_min(-40.0f, 10.0f, -5.0f);
+    const glm::vec3 bounds_max(60.0f, 30.0f, 15.0f);
+
+    // Act
+    camera.frameBounds(bounds_min, bounds_max);
+
+    // Assert - every corner lands inside normalized device coordinates
+    const glm::mat4 clip = camera.getProjection() * camera.setupCam();
+    for (int corner = 0; corner < 8; corner++) {
+        const glm::vec3 point((corner & 1) ? bounds_max.x : bounds_min.x, (corner & 2) ? bounds_max.y : bounds_min.y,
+                              (corner & 4) ? bounds_max.z : bounds_min.z);
+        const glm::vec4 projected = clip * glm::vec4(point, 1.0f);
+        ASSERT_GT(projected.w, 0.0f);
+        EXPECT_LE(std::fabs(projected.x / projected.w), 1.0f);
+        EXPECT_LE(std::fabs(projected.y / projected.w), 1.0f);
+        EXPECT_LE(std::fabs(projected.z / projected.w), 1.0f);
+    }
+}
+
+TEST_F(CameraTest, FrameBounds_LargeBox_PushesOutFarPlane)
+{
+    // Arrange
+    Camera camera(SCREEN_WIDTH, SCREEN_HEIGHT);
+    camera.update(0.0f);
+
+    // Act
+    camera.frameBounds(glm::vec3(-5000.0f), glm::vec3(5000.0f));
+
+    // Assert
+    EXPECT_GT(camera.getFarPlane(), 3000.0f);
+}
@@ -0,0 +1,224 @@
+/*
+ * ComTrackTests.cpp
+ *
+ * Unit tests for the centre-of-mass track: the per-type reduction, mass
+ * weighting and type masks, and ComTrack's choice between the COMFile and
+ * the frame's positions.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/com_track.hpp"
+#include "data/mapped_file.hpp"
+#include "data/raw_frame_source.hpp"
+#include "data/thread_pool.hpp"
+
+class ComTrackTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override
+    {
+        std::remove(dataPath.c_str());
+        std::remove(comPath.c_str());
+    }
+
+    /*
+     * Frame f: particle i at (i + f, 2f, -i), type i % 2; velocities zero.
+     */
+    void writeData(long frames)
+    {
+        FILE* file = fopen(dataPath.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        for (long frame = 0; frame < frames; frame++) {
+            for (long i = 0; i < PARTICLES; i++) {
+                glm::vec4 pos(static_cast<float>(i + frame), 2.0f * frame, -static_cast<float>(i),
+                              static_cast<float>(i % 2));
+                fwrite(&pos, sizeof(pos), 1, file);
+            }
+            const glm::vec4 zero(0.0f);
+            for (long i = 0; i < PARTICLES; i++) {
+                fwrite(&zero, sizeof(zero), 1, file);
+            }
+        }
+        fclose(file);
+    }
+
+    void writeComFile(const std::vector<glm::vec4>& entries)
+    {
+        FILE* file = fopen(comPath.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(entries.data(), sizeof(glm::vec4), entries.size(), file);
+        fclose(file);
+    }
+
+    static constexpr long PARTICLES = 4;
+    const std::string dataPath = "/tmp/test_ComTrack_PosAndVel";
+    const std::string comPath = "/tmp/test_ComTrack_COMFile";
+};
+
+TEST_F(ComTrackTest, Reduce_OnPool_MatchesSerialReduction)
+{
+    // Arrange - large enough to be split, and not a multiple of the worker count
+    const std::int64_t n = 3 * com_track::PARALLEL_PARTICLES + 5;
+    std::vector<glm::vec4> positions(n);
+    for (std::int64_t i = 0; i < n; i++) {
+        positions[i] = glm::vec4(static_cast<float>(i % 1000), 1.0f, -0.5f, static_cast<float>(i % 3));
+    }
+    ThreadPool pool(4);
+
+    // Act
+    const com_track::TypeSums serial = com_track::reduce(positions.data(), n, nullptr);
+    const com_track::TypeSums parallel = com_track::reduce(positions.data(), n, &pool);
+
+    // Assert
+    EXPECT_EQ(parallel.count, serial.count);
+    EXPECT_EQ(parallel.count[0] + parallel.count[1] + parallel.count[2], n);
+    for (int slot = 0; slot < com_track::TYPE_SLOTS; slot++) {
+        EXPECT_DOUBLE_EQ(parallel.sum[slot].x, serial.sum[slot].x);
+        EXPECT_DOUBLE_EQ(parallel.sum[slot].z, serial.sum[slot].z);
+    }
+}
+
+TEST_F(ComTrackTest, Reduce_NonFiniteParticles_AreSkipped)
+{
+    // Arrange
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const std::vector<glm::vec4> positions = {
+        {1.0f, 2.0f, 3.0f, 0.0f}, {nan, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, inf, 0.0f}, {3.0f, 2.0f, 1.0f, 500.0f}};
+
+    // Act
+    const com_track::TypeSums sums = com_track::reduce(positions.data(), 4, nullptr);
+
+    // Assert - a NaN type is fine; only coordinates decide
+    EXPECT_EQ(sums.count[0], 1);
+    EXPECT_EQ(sums.sum[0], glm::dvec3(1.0, 2.0, 3.0));
+    EXPECT_EQ(sums.count[com_track::TYPE_SLOTS - 1], 1);
+}
+
+TEST_F(ComTrackTest, CentreOfMass_TypeMasses_WeightEachType)
+{
+    // Arrange - three type 0 particles at x = 0, one type 1 particle at x = 10
+    const std::vector<glm::vec4> positions = {
+        {0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f, 1.0f}};
+    const com_track::TypeSums sums = com_track::reduce(positions.data(), 4, nullptr);
+    const std::array<double, com_track::TYPE_SLOTS> masses = {1.0, 3.0, 0.0, 0.0, 0.0};
+    glm::dvec3 unweighted;
+    glm::dvec3 weighted;
+
+    // Act
+    ASSERT_TRUE(com_track::centreOfMass(sums, nullptr, com_track::ALL_TYPES, unweighted));
+    ASSERT_TRUE(com_track::centreOfMass(sums, &masses, com_track::ALL_TYPES, weighted));
+
+    // Assert
+    EXPECT_DOUBLE_EQ(unweighted.x, 2.5);
+    EXPECT_DOUBLE_EQ(weighted.x, 7.5);
+}
+
+TEST_F(ComTrackTest, CentreOfMass_TypeMask_OnlyCountsSelectedTypes)
+{
+    // Arrange
+    const std::vector<glm::vec4> positions = {{0.0f, 0.0f, 0.0f, 0.0f}, {10.0f, 4.0f, 0.0f, 1.0f}};
+    const com_track::TypeSums sums = com_track::reduce(positions.data(), 2, nullptr);
+    glm::dvec3 com;
+
+    // Act / Assert
+    ASSERT_TRUE(com_track::centreOfMass(sums, nullptr, 1u << 1, com));
+    EXPECT_EQ(com, glm::dvec3(10.0, 4.0, 0.0));
+    EXPECT_FALSE(com_track::centreOfMass(sums, nullptr, 1u << 2, com));
+}
+
+TEST_F(ComTrackTest, ParseTypeMask_Lists_AreCheckedAndMapped)
+{
+    // Arrange
+    std::uint32_t mask = com_track::ALL_TYPES;
+
+    // Act / Assert
+    EXPECT_TRUE(com_track::parseTypeMask("0,1", mask));
+    EXPECT_EQ(mask, 0x3u);
+    EXPECT_TRUE(com_track::parseTypeMask("3", mask));
+    EXPECT_EQ(mask, 0x8u);
+    EXPECT_FALSE(com_track::parseTypeMask("4", mask));
+    EXPECT_FALSE(com_track::parseTypeMask("0,,1", mask));
+    EXPECT_FALSE(com_track::parseTypeMask("body1", mask));
+    EXPECT_FALSE(com_track::parseTypeMask("", mask));
+    EXPECT_EQ(mask, 0x8u);
+}
+
+TEST_F(ComTrackTest, At_ComFileFrames_AreReadFromMemory)
+{
+    // Arrange - the COMFile covers frame 0 only, and frame 1's entry is for another frame
+    writeData(3);
+    writeComFile({{5.0f, 6.0f, 7.0f, 0.0f}, {9.0f, 9.0f, 9.0f, 7.0f}});
+    RawFrameSource source(MappedFile(dataPath), PARTICLES);
+    ComTrack track(comPath, &source);
+    glm::dvec3 stored;
+    glm::dvec3 computed;
+    glm::dvec3 beyond;
+
+    // Act
+    std::remove(comPath.c_str()); // loaded once: later lookups do not need the file
+    ASSERT_TRUE(track.at(0, stored));
+    ASSERT_TRUE(track.at(1, computed));
+    ASSERT_TRUE(track.at(2, beyond));
+
+    // Assert - frame f's particles average (1.5 + f, 2f, -1.5)
+    EXPECT_TRUE(track.isStored());
+    EXPECT_EQ(stored, glm::dvec3(5.0, 6.0, 7.0));
+    EXPECT_EQ(computed, glm::dvec3(2.5, 2.0, -1.5));
+    EXPECT_EQ(beyond, glm::dvec3(3.5, 4.0, -1.5));
+}
+
+TEST_F(ComTrackTest, At_NoComFile_ComputesWithMassesAndMask)
+{
+    // Arrange - in frame 1, type 0 (particles 0 and 2) averages x = 2 and type 1 x = 3
+    writeData(2);
+    RawFrameSource source(MappedFile(dataPath), PARTICLES);
+    ComTrack track(comPath, &source);
+    glm::dvec3 weighted;
+    glm::dvec3 masked;
+
+    // Act
+    track.setTypeMasses({1.0, 3.0, 0.0, 0.0, 0.0});
+    ASSERT_TRUE(track.at(1, weighted));
+    track.setTypeMask(1u << 0);
+    ASSERT_TRUE(track.at(1, masked));
+
+    // Assert
+    EXPECT_FALSE(track.isStored());
+    EXPECT_DOUBLE_EQ(weighted.x, 0.25 * 2.0 + 0.75 * 3.0);
+    EXPECT_DOUBLE_EQ(masked.x, 2.0);
+    EXPECT_DOUBLE_EQ(masked.z, -1.0);
+    EXPECT_FALSE(track.at(2, masked));
+}
+
+TEST_F(ComTrackTest, At_PositionsHeldByCaller_AreReducedInsteadOfTheSource)
+{
+    // Arrange - the caller's copy of frame 1 is shifted by 10 in x from what the source holds
+    writeData(2);
+    RawFrameSource source(MappedFile(dataPath), PARTICLES);
+    ComTrack track(comPath, &source);
+    std::vector<glm::vec4> held(PARTICLES);
+    ASSERT_TRUE(source.readPositions(1, held.data()));
+    for (glm::vec4& position : held) {
+        position.x += 10.0f;
+    }
+    glm::dvec3 com;
+    glm::dvec3 cached;
+
+    // Act
+    ASSERT_TRUE(track.at(1, held.data(), com));
+    ASSERT_TRUE(track.at(1, cached));
+
+    // Assert - the second lookup reuses the first frame's result
+    EXPECT_EQ(com, glm::dvec3(12.5, 2.0, -1.5));
+    EXPECT_EQ(cached, com);
+}
@@ -0,0 +1,696 @@
+/*
+ * ContainerFormatTests.cpp
+ *
+ * Unit tests for the v2 dataset container: ContainerWriter, ContainerFrameSource,
+ * RawFrameSource and the openFrameSource() factory.
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/container_format.hpp"
+#include "data/container_frame_source.hpp"
+#include "data/container_writer.hpp"
+#include "data/dataset_converter.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/raw_frame_source.hpp"
+
+class ContainerFormatTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override
+    {
+        std::remove(containerPath.c_str());
+        std::remove(legacyPath.c_str());
+    }
+
+    static glm::vec4 position(long frame, long i)
+    {
+        return glm::vec4(static_cast<float>(i), static_cast<float>(frame), 0.5f, 1.0f);
+    }
+
+    static glm::vec4 velocity(long frame, long i)
+    {
+        return glm::vec4(-static_cast<float>(i), static_cast<float>(frame) * 0.1f, 0.0f, 0.0f);
+    }
+
+    void writeContainer(long frames, bool with_velocities,
+                        container::Encoding encoding = container::Encoding::Raw,
+                        std::uint32_t keyframe_interval = container::DEFAULT_KEYFRAME_INTERVAL,
+                        container::StreamLayout layout = container::StreamLayout::FrameInterleaved)
+    {
+        std::vector<glm::vec4> positions(PARTICLES);
+        std::vector<glm::vec4> velocities(PARTICLES);
+        ContainerWriter writer;
+        ASSERT_TRUE(
+            writer.open(containerPath, PARTICLES, with_velocities, encoding, 0.0f, keyframe_interval, layout));
+        for (long frame = 0; frame < frames; frame++) {
+            for (long i = 0; i < PARTICLES; i++) {
+                positions[i] = position(frame, i);
+                velocities[i] = velocity(frame, i);
+            }
+            ASSERT_TRUE(writer.appendFrame(positions.data(), velocities.data()));
+        }
+        ASSERT_TRUE(writer.finish());
+    }
+
+    void writeLegacy(long frames)
+    {
+        FILE* file = fopen(legacyPath.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        for (long frame = 0; frame < frames; frame++) {
+            for (long i = 0; i < PARTICLES; i++) {
+                glm::vec4 pos = position(frame, i);
+                fwrite(&pos, sizeof(pos), 1, file);
+            }
+            for (long i = 0; i < PARTICLES; i++) {
+                glm::vec4 vel = velocity(frame, i);
+                fwrite(&vel, sizeof(vel), 1, file);
+            }
+        }
+        fclose(file);
+    }
+
+    static constexpr long PARTICLES = 7;
+    const std::string containerPath = "/tmp/test_Container.pv2";
+    const std::string legacyPath = "/tmp/test_Container_PosAndVel";
+};
+
+TEST_F(ContainerFormatTest, Header_IsSixtyFourBytes)
+{
+    // Assert
+    EXPECT_EQ(sizeof(container::ContainerHeader), 64u);
+}
+
+TEST_F(ContainerFormatTest, WriteThenOpen_ReportsCounts)
+{
+    // Arrange
+    writeContainer(5, true);
+
+    // Act
+    ContainerFrameSource source{MappedFile(containerPath)};
+
+    // Assert
+    ASSERT_TRUE(source.isValid());
+    EXPECT_EQ(source.particleCount(), PARTICLES);
+    EXPECT_EQ(source.frameCount(), 5);
+    EXPECT_TRUE(source.hasVelocities());
+}
+
+TEST_F(ContainerFormatTest, ReadPositions_AnyFrame_ReturnsWrittenData)
+{
+    // Arrange
+    writeContainer(5, true);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readPositions(3, destination.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(destination[4], position(3, 4));
+}
+
+TEST_F(ContainerFormatTest, ReadVelocities_AnyFrame_ReturnsWrittenData)
+{
+    // Arrange
+    writeContainer(3, true);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readVelocities(2, destination.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(destination[6], velocity(2, 6));
+}
+
+TEST_F(ContainerFormatTest, ReadVelocities_PositionsOnly_ReturnsFalse)
+{
+    // Arrange
+    writeContainer(2, false);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readVelocities(0, destination.data());
+
+    // Assert
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(source.storedFrameBytes(0), sizeof(glm::vec4) * PARTICLES);
+}
+
+TEST_F(ContainerFormatTest, MappedPositions_FramesAreAligned)
+{
+    // Arrange
+    writeContainer(4, true);
+    ContainerFrameSource source{MappedFile(containerPath)};
+
+    // Act & Assert
+    for (long frame = 0; frame < 4; frame++) {
+        const glm::vec4* positions = source.mappedPositions(frame);
+        ASSERT_NE(positions, nullptr);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(positions) % container::FRAME_ALIGNMENT, 0u);
+    }
+}
+
+TEST_F(ContainerFormatTest, ReadPositions_OutOfRange_ReturnsFalse)
+{
+    // Arrange
+    writeContainer(2, true);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act & Assert
+    EXPECT_FALSE(source.readPositions(2, destination.data()));
+    EXPECT_FALSE(source.readPositions(-1, destination.data()));
+}
+
+TEST_F(ContainerFormatTest, Open_UnfinishedWriter_IsRejected)
+{
+    // Arrange
+    std::vector<glm::vec4> frame(PARTICLES);
+    {
+        ContainerWriter writer;
+        ASSERT_TRUE(writer.open(containerPath, PARTICLES, false));
+        ASSERT_TRUE(writer.appendFrame(frame.data(), nullptr));
+    }
+
+    // Act
+    auto source = openFrameSource(containerPath, PARTICLES);
+
+    // Assert - nothing was ever written under the container's own name
+    EXPECT_EQ(source, nullptr);
+    EXPECT_FALSE(std::filesystem::exists(containerPath));
+    EXPECT_FALSE(std::filesystem::exists(containerPath + ContainerWriter::TEMP_SUFFIX));
+}
+
+TEST_F(ContainerFormatTest, ConvertLegacyDataset_FailsMidway_KeepsEarlierContainer)
+{
+    // Arrange - frame 1 holds a w that is not a type code, so Quantized16 stops there
+    writeContainer(2, false);
+    FILE* file = fopen(legacyPath.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    for (long frame = 0; frame < 3; frame++) {
+        for (long i = 0; i < 2 * PARTICLES; i++) {
+            const glm::vec4 value(static_cast<float>(i), 0.0f, 0.0f, frame == 1 ? 0.5f : 1.0f);
+            fwrite(&value, sizeof(value), 1, file);
+        }
+    }
+    fclose(file);
+
+    // Act
+    ConversionResult result = convertLegacyDataset(legacyPath, PARTICLES, containerPath,
+                                                   container::Encoding::Quantized16);
+
+    // Assert
+    EXPECT_FALSE(result.ok);
+    EXPECT_FALSE(std::filesystem::exists(containerPath + ContainerWriter::TEMP_SUFFIX));
+    ContainerFrameSource earlier{MappedFile(containerPath)};
+    EXPECT_TRUE(earlier.isValid());
+    EXPECT_EQ(earlier.frameCount(), 2);
+}
+
+TEST_F(ContainerFormatTest, OpenFrameSource_InvalidContainerInRunFolder_FallsBackToPosAndVel)
+{
+    // Arrange - a run folder left with the placeholder header of a conversion that was killed
+    const std::string folder = "/tmp/test_Container_run";
+    std::filesystem::create_directories(folder);
+    writeLegacy(3);
+    std::filesystem::copy_file(legacyPath, folder + "/PosAndVel", std::filesystem::copy_options::overwrite_existing);
+    container::ContainerHeader placeholder{};
+    std::memcpy(placeholder.magic, container::MAGIC, sizeof(container::MAGIC));
+    for (const std::string& path : {folder + container::DEFAULT_FILE_NAME, containerPath}) {
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+    }
+
+    // Act - only a run folder's own container has a PosAndVel to fall back to
+    auto source = openFrameSource(folder + container::DEFAULT_FILE_NAME, PARTICLES);
+    auto elsewhere = openFrameSource(containerPath, PARTICLES);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->frameCount(), 3);
+    EXPECT_EQ(elsewhere, nullptr);
+    std::filesystem::remove_all(folder);
+}
+
+TEST_F(ContainerFormatTest, Open_TruncatedIndex_IsRejected)
+{
+    // Arrange
+    writeContainer(3, true);
+    MappedFile full(containerPath);
+    std::string bytes(reinterpret_cast<const char*>(full.data()), full.size() - 8);
+    full.close();
+    FILE* file = fopen(containerPath.c_str(), "wb");
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+
+    // Act
+    ContainerFrameSource source{MappedFile(containerPath)};
+
+    // Assert
+    EXPECT_FALSE(source.isValid());
+    EXPECT_EQ(source.frameCount(), 0);
+}
+
+TEST_F(ContainerFormatTest, RawFrameSource_CountsFramesFromFileSize)
+{
+    // Arrange
+    writeLegacy(6);
+
+    // Act
+    RawFrameSource source{MappedFile(legacyPath), PARTICLES};
+
+    // Assert
+    EXPECT_EQ(source.frameCount(), 6);
+    EXPECT_EQ(source.mappedPositions(6), nullptr);
+}
+
+TEST_F(ContainerFormatTest, OpenFrameSource_LegacyFile_UsesGivenParticleCount)
+{
+    // Arrange
+    writeLegacy(3);
+
+    // Act
+    auto source = openFrameSource(legacyPath, PARTICLES);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->particleCount(), PARTICLES);
+    EXPECT_EQ(source->frameCount(), 3);
+}
+
+TEST_F(ContainerFormatTest, OpenFrameSource_Follow_PicksUpAppendedFrames)
+{
+    // Arrange
+    writeLegacy(2);
+    FrameReadOptions follow;
+    follow.follow = true;
+    std::unique_ptr<FrameSource> followed = openFrameSource(legacyPath, PARTICLES, follow);
+    std::unique_ptr<FrameSource> fixed = openFrameSource(legacyPath, PARTICLES);
+    ASSERT_NE(followed, nullptr);
+    ASSERT_NE(fixed, nullptr);
+    writeLegacy(3);
+
+    // Act & Assert - without follow the mapping covers only the file as it was opened
+    EXPECT_EQ(followed->refreshFrameCount(), 3);
+    EXPECT_EQ(fixed->refreshFrameCount(), 2);
+}
+
+TEST_F(ContainerFormatTest, OpenFrameSource_Container_IgnoresLegacyParticleCount)
+{
+    // Arrange
+    writeContainer(2, true);
+
+    // Act
+    auto source = openFrameSource(containerPath, 12345);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->particleCount(), PARTICLES);
+}
+
+TEST_F(ContainerFormatTest, ConvertLegacyDataset_PreservesEveryFrame)
+{
+    // Arrange
+    writeLegacy(4);
+    RawFrameSource legacy{MappedFile(legacyPath), PARTICLES};
+    std::vector<glm::vec4> expected(PARTICLES);
+    std::vector<glm::vec4> actual(PARTICLES);
+
+    // Act
+    ConversionResult result = convertLegacyDataset(legacyPath, PARTICLES, containerPath);
+    ContainerFrameSource converted{MappedFile(containerPath)};
+
+    // Assert
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.frames, 4);
+    ASSERT_EQ(converted.frameCount(), 4);
+    for (long frame = 0; frame < 4; frame++) {
+        ASSERT_TRUE(legacy.readVelocities(frame, expected.data()));
+        ASSERT_TRUE(converted.readVelocities(frame, actual.data()));
+        EXPECT_EQ(expected, actual);
+    }
+}
+
+TEST_F(ContainerFormatTest, ConvertLegacyDataset_MissingInput_ReportsError)
+{
+    // Act
+    ConversionResult result = convertLegacyDataset("/tmp/nonexistent_PosAndVel", PARTICLES, containerPath);
+
+    // Assert
+    EXPECT_FALSE(result.ok);
+    EXPECT_FALSE(result.error.empty());
+}
+
+TEST_F(ContainerFormatTest, Quantized_ReadPositions_DecodesWithinBound)
+{
+    // Arrange
+    writeContainer(3, true, container::Encoding::Quantized16);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readPositions(2, destination.data());
+
+    // Assert
+    ASSERT_TRUE(source.isValid());
+    ASSERT_TRUE(ok);
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_NEAR(destination[i].x, position(2, i).x, 1e-3f);
+        EXPECT_NEAR(destination[i].y, position(2, i).y, 1e-3f);
+        EXPECT_EQ(destination[i].w, position(2, i).w);
+    }
+}
+
+TEST_F(ContainerFormatTest, Quantized_ReadVelocities_DecodesWithinBound)
+{
+    // Arrange
+    writeContainer(2, true, container::Encoding::Quantized16);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readVelocities(1, destination.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_NEAR(destination[5].x, velocity(1, 5).x, 1e-3f);
+    EXPECT_NEAR(destination[5].y, velocity(1, 5).y, 1e-3f);
+}
+
+TEST_F(ContainerFormatTest, Quantized_MappedPositions_IsUnavailable)
+{
+    // Arrange
+    writeContainer(1, false, container::Encoding::Quantized16);
+    ContainerFrameSource source{MappedFile(containerPath)};
+
+    // Act & Assert
+    EXPECT_EQ(source.mappedPositions(0), nullptr);
+    EXPECT_LT(source.storedFrameBytes(0), sizeof(glm::vec4) * PARTICLES);
+}
+
+TEST_F(ContainerFormatTest, Quantized_NonTypeW_RejectsFrame)
+{
+    // Arrange
+    std::vector<glm::vec4> frame(PARTICLES, glm::vec4(1.0f, 2.0f, 3.0f, 0.25f));
+    ContainerWriter writer;
+    ASSERT_TRUE(writer.open(containerPath, PARTICLES, false, container::Encoding::Quantized16));
+
+    // Act
+    bool appended = writer.appendFrame(frame.data(), nullptr);
+
+    // Assert
+    EXPECT_FALSE(appended);
+}
+
+TEST_F(ContainerFormatTest, Quantized_NonFinitePosition_RejectsFrame)
+{
+    // Arrange - quantizing would turn the NaN into a point inside the box
+    std::vector<glm::vec4> frame(PARTICLES, glm::vec4(1.0f, 2.0f, 3.0f, 0.0f));
+    frame[3].y = std::numeric_limits<float>::quiet_NaN();
+    ContainerWriter writer;
+    ASSERT_TRUE(writer.open(containerPath, PARTICLES, false, container::Encoding::Quantized16));
+
+    // Act
+    bool appended = writer.appendFrame(frame.data(), nullptr);
+
+    // Assert
+    EXPECT_FALSE(appended);
+}
+
+TEST_F(ContainerFormatTest, Predictive_ReadPositions_IsBitExact)
+{
+    // Arrange
+    writeContainer(4, true, container::Encoding::PredictiveResidual);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readPositions(3, destination.data());
+
+    // Assert
+    ASSERT_TRUE(source.isValid());
+    ASSERT_TRUE(ok);
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_EQ(destination[i], position(3, i)) << "particle " << i;
+    }
+}
+
+TEST_F(ContainerFormatTest, Predictive_ReadBackwards_RedecodesFromStart)
+{
+    // Arrange
+    writeContainer(5, true, container::Encoding::PredictiveResidual);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+    ASSERT_TRUE(source.readPositions(4, destination.data()));
+
+    // Act
+    bool ok = source.readVelocities(1, destination.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_EQ(destination[i], velocity(1, i)) << "particle " << i;
+    }
+}
+
+TEST_F(ContainerFormatTest, Predictive_PositionsOnly_RoundTrips)
+{
+    // Arrange
+    writeContainer(3, false, container::Encoding::PredictiveResidual);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readPositions(2, destination.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(source.mappedPositions(2), nullptr);
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_EQ(destination[i], position(2, i)) << "particle " << i;
+    }
+}
+
+TEST_F(ContainerFormatTest, Predictive_RandomSeeks_AreBitExact)
+{
+    // Arrange
+    writeContainer(10, true, container::Encoding::PredictiveResidual, 3);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+    const long seeks[] = {8, 2, 7, 9, 0, 4, 3};
+
+    // Act & Assert
+    for (long frame : seeks) {
+        ASSERT_TRUE(source.readPositions(frame, destination.data())) << "frame " << frame;
+        for (long i = 0; i < PARTICLES; i++) {
+            EXPECT_EQ(destination[i], position(frame, i)) << "frame " << frame << " particle " << i;
+        }
+    }
+}
+
+TEST_F(ContainerFormatTest, Predictive_Keyframes_AreStoredWithoutPrediction)
+{
+    // Arrange
+    writeContainer(5, true, container::Encoding::PredictiveResidual, 3);
+    ContainerFrameSource source{MappedFile(containerPath)};
+
+    // Act & Assert
+    EXPECT_EQ(source.header().keyframe_interval, 3u);
+    EXPECT_GT(source.storedFrameBytes(3), source.storedFrameBytes(2));
+    EXPECT_GT(source.storedFrameBytes(3), source.storedFrameBytes(4));
+}
+
+TEST_F(ContainerFormatTest, Predictive_InterleavedSequentialReaders_DecodeOneFramePerRead)
+{
+    // Arrange - e.g. playback at frame 0 while the statistics pass works from frame 20
+    writeContainer(40, true, container::Encoding::PredictiveResidual, 64);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    for (long step = 0; step < 10; step++) {
+        ASSERT_TRUE(source.readPositions(step, destination.data()));
+        ASSERT_TRUE(source.readPositions(20 + step, destination.data()));
+    }
+
+    // Assert - frames 0-9, then 0-20 once to reach frame 20, then 21-29
+    EXPECT_EQ(source.decodedFrameCount(), 10u + 21u + 9u);
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_EQ(destination[i], position(29, i)) << "particle " << i;
+    }
+}
+
+TEST_F(ContainerFormatTest, Predictive_ConcurrentReaders_AreBitExact)
+{
+    // Arrange
+    writeContainer(30, true, container::Encoding::PredictiveResidual, 8);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<int> mismatches(4, 0);
+
+    // Act - each thread plays its own stretch of the run
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&, r] {
+            std::vector<glm::vec4> positions(PARTICLES);
+            for (long frame = r * 7; frame < r * 7 + 9; frame++) {
+                const bool ok = source.readPositions(frame, positions.data());
+                if (!ok || positions[PARTICLES - 1] != position(frame, PARTICLES - 1)) {
+                    mismatches[r]++;
+                }
+            }
+        });
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    // Assert
+    for (int r = 0; r < 4; r++) {
+        EXPECT_EQ(mismatches[r], 0) << "reader " << r;
+    }
+}
+
+TEST_F(ContainerFormatTest, WarmCursorLimit_LargeFrames_ShrinksPoolToBudget)
+{
+    // Arrange - at N = 10M with velocities a cursor holds 640 MB
+    const std::uint64_t small_cursor = 4 * sizeof(glm::vec4) * 1000;
+    const std::uint64_t budget_quarter = ContainerFrameSource::WARM_CURSOR_BUDGET_BYTES / 4;
+    const std::uint64_t huge_cursor = 4 * sizeof(glm::vec4) * 10000000ull;
+
+    // Act & Assert
+    EXPECT_EQ(ContainerFrameSource::warmCursorLimit(small_cursor), ContainerFrameSource::MAX_WARM_CURSORS);
+    EXPECT_EQ(ContainerFrameSource::warmCursorLimit(budget_quarter), 4u);
+    EXPECT_EQ(ContainerFrameSource::warmCursorLimit(huge_cursor), ContainerFrameSource::MIN_WARM_CURSORS);
+}
+
+TEST_F(ContainerFormatTest, KeyframeAtOrBefore_ZeroInterval_IsFirstFrame)
+{
+    // Act & Assert
+    EXPECT_EQ(container::keyframeAtOrBefore(41, 0), 0);
+    EXPECT_EQ(container::keyframeAtOrBefore(41, 16), 32);
+    EXPECT_EQ(container::keyframeAtOrBefore(32, 16), 32);
+}
+
+TEST_F(ContainerFormatTest, Separate_ReadPositionsAndVelocities_ReturnWrittenData)
+{
+    // Arrange
+    writeContainer(4, true, container::Encoding::Raw, 0, container::StreamLayout::SeparateStreams);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> positions(PARTICLES);
+    std::vector<glm::vec4> velocities(PARTICLES);
+
+    // Act
+    bool positions_ok = source.readPositions(3, positions.data());
+    bool velocities_ok = source.readVelocities(1, velocities.data());
+
+    // Assert
+    ASSERT_TRUE(source.isValid());
+    EXPECT_EQ(source.layout(), container::StreamLayout::SeparateStreams);
+    ASSERT_TRUE(positions_ok);
+    ASSERT_TRUE(velocities_ok);
+    EXPECT_EQ(positions[4], position(3, 4));
+    EXPECT_EQ(velocities[6], velocity(1, 6));
+}
+
+TEST_F(ContainerFormatTest, Separate_PositionFrames_AreContiguousAndHalfTheBytes)
+{
+    // Arrange
+    writeContainer(3, true, container::Encoding::Raw, 0, container::StreamLayout::SeparateStreams);
+    ContainerFrameSource source{MappedFile(containerPath)};
+
+    // Act
+    const glm::vec4* first = source.mappedPositions(0);
+    const glm::vec4* second = source.mappedPositions(1);
+
+    // Assert - playback walks the positions region without skipping velocities
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(reinterpret_cast<const unsigned char*>(second) - reinterpret_cast<const unsigned char*>(first),
+              static_cast<std::ptrdiff_t>(container::alignUp(sizeof(glm::vec4) * PARTICLES)));
+    EXPECT_EQ(second[2], position(1, 2));
+    EXPECT_EQ(source.storedFrameBytes(0), sizeof(glm::vec4) * PARTICLES);
+}
+
+TEST_F(ContainerFormatTest, Separate_Quantized_ReadVelocities_DecodesWithinBound)
+{
+    // Arrange
+    writeContainer(3, true, container::Encoding::Quantized16, 0, container::StreamLayout::SeparateStreams);
+    ContainerFrameSource source{MappedFile(containerPath)};
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = source.readVelocities(2, destination.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_NEAR(destination[5].x, velocity(2, 5).x, 1e-3f);
+    EXPECT_NEAR(destination[5].y, velocity(2, 5).y, 1e-3f);
+}
+
+TEST_F(ContainerFormatTest, Separate_Finish_RemovesVelocitySpool)
+{
+    // Act
+    writeContainer(2, true, container::Encoding::Raw, 0, container::StreamLayout::SeparateStreams);
+
+    // Assert
+    FILE* spool = fopen((containerPath + ".velocities").c_str(), "rb");
+    EXPECT_EQ(spool, nullptr);
+    if (spool != nullptr) {
+        fclose(spool);
+    }
+}
+
+TEST_F(ContainerFormatTest, Separate_Predictive_IsRefused)
+{
+    // Arrange
+    ContainerWriter writer;
+
+    // Act
+    bool opened = writer.open(containerPath, PARTICLES, true, container::Encoding::PredictiveResidual, 0.0f,
+                              container::DEFAULT_KEYFRAME_INTERVAL, container::StreamLayout::SeparateStreams);
+
+    // Assert
+    EXPECT_FALSE(opened);
+}
+
+TEST_F(ContainerFormatTest, ConvertLegacyDataset_SeparateLayout_PreservesEveryFrame)
+{
+    // Arrange
+    writeLegacy(3);
+    RawFrameSource legacy{MappedFile(legacyPath), PARTICLES};
+    std::vector<glm::vec4> expected(PARTICLES);
+    std::vector<glm::vec4> actual(PARTICLES);
+
+    // Act
+    ConversionResult result = convertLegacyDataset(legacyPath, PARTICLES, containerPath, container::Encoding::Raw,
+                                                   0.0f, 0, container::StreamLayout::SeparateStreams);
+    ContainerFrameSource converted{MappedFile(containerPath)};
+
+    // Assert
+    ASSERT_TRUE(result.ok) << result.error;
+    ASSERT_EQ(converted.frameCount(), 3);
+    for (long frame = 0; frame < 3; frame++) {
+        ASSERT_TRUE(legacy.readPositions(frame, expected.data()));
+        ASSERT_TRUE(converted.readPositions(frame, actual.data()));
+        EXPECT_EQ(expected, actual);
+        ASSERT_TRUE(legacy.readVelocities(frame, expected.data()));
+        ASSERT_TRUE(converted.readVelocities(frame, actual.data()));
+        EXPECT_EQ(expected, actual);
+    }
+}
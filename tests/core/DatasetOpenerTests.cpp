@@ -0,0 +1,150 @@
+/*
+ * DatasetOpenerTests.cpp
+ *
+ * Unit tests for DatasetOpener: opening a run folder or data file on its
+ * worker thread at a chosen frame, handing the result over, and refusing a
+ * second open while one is under way.
+ */
+
+// Include glad first to avoid OpenGL header conflicts
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "datasetOpener.hpp"
+
+class DatasetOpenerTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    /*
+     * A run folder with a PosAndVel of `frames` frames: particle i at
+     * (i, frame, 0). Without a RunSetup, SettingsIO assumes 100 particles.
+     */
+    void writeRun(int frames)
+    {
+        FILE* file = fopen((dir + "/PosAndVel").c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        for (int frame = 0; frame < frames; frame++) {
+            for (int i = 0; i < PARTICLES; i++) {
+                const glm::vec4 pos(static_cast<float>(i), static_cast<float>(frame), 0.0f, 1.0f);
+                fwrite(&pos, sizeof(pos), 1, file);
+            }
+            const glm::vec4 zero(0.0f);
+            for (int i = 0; i < PARTICLES; i++) {
+                fwrite(&zero, sizeof(zero), 1, file);
+            }
+        }
+        fclose(file);
+    }
+
+    static void waitDone(const DatasetOpener& opener)
+    {
+        while (!opener.isDone()) {
+            std::this_thread::yield();
+        }
+    }
+
+    static constexpr int PARTICLES = 100;
+    const std::string dir = "/tmp/test_DatasetOpener";
+};
+
+TEST_F(DatasetOpenerTest, OpenFolder_Run_HandsOverSettingsAndFirstFrame)
+{
+    // Arrange
+    writeRun(3);
+    DatasetOpener opener;
+    FrameReadOptions options;
+
+    // Act
+    ASSERT_TRUE(opener.open(dir, options));
+    waitDone(opener);
+    DatasetOpener::Result result = opener.take();
+
+    // Assert
+    ASSERT_NE(result.settings, nullptr) << result.error;
+    EXPECT_EQ(result.settings->N, PARTICLES);
+    EXPECT_EQ(result.settings->frames, 3);
+    ASSERT_EQ(result.first_frame.size(), static_cast<std::size_t>(PARTICLES));
+    EXPECT_EQ(result.first_frame[5], glm::vec4(5.0f, 0.0f, 0.0f, 1.0f));
+    EXPECT_FALSE(opener.isBusy());
+}
+
+TEST_F(DatasetOpenerTest, OpenFolder_NoData_ReportsError)
+{
+    // Arrange
+    DatasetOpener opener;
+    FrameReadOptions options;
+
+    // Act
+    ASSERT_TRUE(opener.open(dir, options));
+    waitDone(opener);
+    DatasetOpener::Result result = opener.take();
+
+    // Assert
+    EXPECT_EQ(result.settings, nullptr);
+    EXPECT_NE(result.error.find(dir), std::string::npos);
+}
+
+TEST_F(DatasetOpenerTest, OpenFolder_WhileBusy_IsRefusedUntilTaken)
+{
+    // Arrange
+    writeRun(1);
+    DatasetOpener opener;
+    FrameReadOptions options;
+    ASSERT_TRUE(opener.open(dir, options));
+
+    // Act
+    const bool second = opener.open(dir, options);
+    waitDone(opener);
+    opener.take();
+    const bool after_take = opener.open(dir, options);
+    waitDone(opener);
+
+    // Assert
+    EXPECT_FALSE(second);
+    EXPECT_TRUE(after_take);
+    EXPECT_FLOAT_EQ(opener.progress(), 1.0f);
+    EXPECT_NE(opener.take().settings, nullptr);
+}
+
+TEST_F(DatasetOpenerTest, Open_DataFileAtFrame_ReadsClampedFrame)
+{
+    // Arrange
+    writeRun(3);
+    DatasetOpener opener;
+    FrameReadOptions options;
+
+    // Act
+    ASSERT_TRUE(opener.open(dir + "/PosAndVel", options, 1));
+    waitDone(opener);
+    DatasetOpener::Result at_one = opener.take();
+    ASSERT_TRUE(opener.open(dir + "/PosAndVel", options, 99));
+    waitDone(opener);
+    DatasetOpener::Result past_end = opener.take();
+
+    // Assert
+    ASSERT_NE(at_one.settings, nullptr) << at_one.error;
+    EXPECT_EQ(at_one.frame, 1);
+    ASSERT_EQ(at_one.first_frame.size(), static_cast<std::size_t>(PARTICLES));
+    EXPECT_EQ(at_one.first_frame[5], glm::vec4(5.0f, 1.0f, 0.0f, 1.0f));
+    ASSERT_NE(past_end.settings, nullptr) << past_end.error;
+    EXPECT_EQ(past_end.frame, 2);
+    EXPECT_EQ(past_end.first_frame[5], glm::vec4(5.0f, 2.0f, 0.0f, 1.0f));
+}
@@ -0,0 +1,236 @@
+/*
+ * ElementCodecTests.cpp
+ *
+ * Unit tests for raw datasets stored as doubles or half floats: element
+ * conversion to vec4s, BasicRawFrameSource reads and recentring, and the
+ * factory and converter paths that select them.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/dataset_converter.hpp"
+#include "data/element_codec.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/raw_frame_source.hpp"
+
+namespace
+{
+
+constexpr std::int64_t PARTICLES = 4099; // not a multiple of any vector width
+constexpr std::int64_t FRAMES = 3;
+
+// Far from the origin, where floats are 1 apart and the offsets below would be lost
+constexpr double FAR = 1.0e7;
+
+glm::dvec4 position(std::int64_t frame, std::int64_t i)
+{
+    return glm::dvec4(FAR + 0.125 * static_cast<double>(i), -FAR, static_cast<double>(frame) + 0.25,
+                      static_cast<double>(i % 4));
+}
+
+glm::dvec4 velocity(std::int64_t frame, std::int64_t i)
+{
+    return glm::dvec4(static_cast<double>(i), static_cast<double>(frame), -1.5, 0.0);
+}
+
+} // namespace
+
+class ElementCodecTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override
+    {
+        std::remove(doublePath.c_str());
+        std::remove(containerPath.c_str());
+    }
+
+    /*
+     * Writes a PosAndVel of doubles: positions then velocities per frame.
+     */
+    void writeDoubleDataset()
+    {
+        FILE* file = std::fopen(doublePath.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        for (std::int64_t frame = 0; frame < FRAMES; frame++) {
+            for (std::int64_t i = 0; i < PARTICLES; i++) {
+                const glm::dvec4 p = position(frame, i);
+                std::fwrite(&p, sizeof(p), 1, file);
+            }
+            for (std::int64_t i = 0; i < PARTICLES; i++) {
+                const glm::dvec4 v = velocity(frame, i);
+                std::fwrite(&v, sizeof(v), 1, file);
+            }
+        }
+        std::fclose(file);
+    }
+
+    const std::string doublePath = "/tmp/test_ElementCodec_PosAndVel";
+    const std::string containerPath = "/tmp/test_ElementCodec.pv2";
+};
+
+TEST_F(ElementCodecTest, HalfToFloat_SpecialValues_AreExact)
+{
+    // Act / Assert
+    EXPECT_EQ(element::halfToFloat(0x3C00), 1.0f);
+    EXPECT_EQ(element::halfToFloat(0xC000), -2.0f);
+    EXPECT_EQ(element::halfToFloat(0x7BFF), 65504.0f);
+    EXPECT_EQ(element::halfToFloat(0x0001), std::ldexp(1.0f, -24)); // smallest subnormal
+    EXPECT_EQ(element::halfToFloat(0x03FF), std::ldexp(1023.0f, -24));
+    EXPECT_TRUE(std::signbit(element::halfToFloat(0x8000)));
+    EXPECT_EQ(element::halfToFloat(0x7C00), std::numeric_limits<float>::infinity());
+    EXPECT_TRUE(std::isnan(element::halfToFloat(0x7E00)));
+}
+
+TEST_F(ElementCodecTest, ToVec4_Halves_MatchScalarConversion)
+{
+    // Arrange - every exponent and a spread of mantissas; 169 particles, so the vector loop leaves a tail
+    std::vector<Half> halves;
+    for (std::uint32_t bits = 0; bits < 0x10000; bits += 97) {
+        halves.push_back(Half{static_cast<std::uint16_t>(bits)});
+    }
+    halves.resize(halves.size() / 4 * 4);
+    const std::int64_t count = static_cast<std::int64_t>(halves.size() / 4);
+    std::vector<glm::vec4> converted(count);
+
+    // Act
+    element::toVec4<Half>(halves.data(), count, glm::dvec3(0.0), converted.data());
+
+    // Assert
+    for (std::int64_t i = 0; i < count; i++) {
+        for (int lane = 0; lane < 4; lane++) {
+            const float expected = element::halfToFloat(halves[4 * i + lane].bits);
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(converted[i][lane]));
+            } else {
+                EXPECT_EQ(converted[i][lane], expected) << "particle " << i << " lane " << lane;
+            }
+        }
+    }
+}
+
+TEST_F(ElementCodecTest, ToVec4_DoublesWithOrigin_ShiftsBeforeNarrowing)
+{
+    // Arrange
+    const std::vector<double> doubles = {FAR + 0.125, -FAR, 0.25, 3.0, FAR + 0.375, -FAR + 0.5, 1.0, 2.0};
+    std::vector<glm::vec4> converted(2);
+
+    // Act
+    element::toVec4<double>(doubles.data(), 2, glm::dvec3(FAR, -FAR, 0.0), converted.data());
+
+    // Assert - w is never shifted
+    EXPECT_EQ(converted[0], glm::vec4(0.125f, 0.0f, 0.25f, 3.0f));
+    EXPECT_EQ(converted[1], glm::vec4(0.375f, 0.5f, 1.0f, 2.0f));
+}
+
+TEST_F(ElementCodecTest, DoubleSource_ReadsConvertedFramesAndVelocities)
+{
+    // Arrange
+    writeDoubleDataset();
+    BasicRawFrameSource<double> source(MappedFile(doublePath), PARTICLES);
+    std::vector<glm::vec4> positions(PARTICLES);
+    std::vector<glm::vec4> velocities(PARTICLES);
+
+    // Act
+    ASSERT_EQ(source.frameCount(), FRAMES);
+    ASSERT_TRUE(source.readPositions(2, positions.data()));
+    ASSERT_TRUE(source.readVelocities(2, velocities.data()));
+
+    // Assert - no mapped frames, since the stored layout is not the upload layout
+    EXPECT_EQ(source.mappedPositions(0), nullptr);
+    EXPECT_EQ(positions[7], glm::vec4(position(2, 7)));
+    EXPECT_EQ(velocities[PARTICLES - 1], glm::vec4(velocity(2, PARTICLES - 1)));
+    EXPECT_FALSE(source.readPositions(FRAMES, positions.data()));
+}
+
+TEST_F(ElementCodecTest, DoubleSource_Recentered_KeepsSubFloatOffsets)
+{
+    // Arrange
+    writeDoubleDataset();
+    BasicRawFrameSource<double> source(MappedFile(doublePath), PARTICLES);
+    std::vector<glm::vec4> positions(PARTICLES);
+
+    // Act
+    ASSERT_TRUE(source.recenter());
+    ASSERT_TRUE(source.readPositions(1, positions.data()));
+
+    // Assert - 0.125 apart, which float spacing at 1e7 cannot hold
+    const glm::dvec3 origin = source.positionOrigin();
+    EXPECT_NEAR(origin.y, -FAR, 1e-6);
+    EXPECT_FLOAT_EQ(positions[1].x - positions[0].x, 0.125f);
+    EXPECT_FLOAT_EQ(positions[0].x, static_cast<float>(FAR - origin.x));
+    EXPECT_FLOAT_EQ(positions[0].z, static_cast<float>(1.25 - origin.z));
+    EXPECT_EQ(positions[5].w, 1.0f);
+}
+
+TEST_F(ElementCodecTest, DoubleSource_BatchAndPreview_MatchWholeFrameReads)
+{
+    // Arrange
+    writeDoubleDataset();
+    BasicRawFrameSource<double> source(MappedFile(doublePath), PARTICLES);
+    std::vector<glm::vec4> whole(PARTICLES);
+    std::vector<glm::vec4> batched(PARTICLES);
+    std::vector<glm::vec4> preview(previewParticleCount(PARTICLES, 2));
+    ASSERT_TRUE(source.readPositions(1, whole.data()));
+
+    // Act
+    FrameRead read{1, batched.data()};
+    source.readPositionsBatch(&read, 1);
+    ASSERT_TRUE(source.readPreviewPositions(1, 2, preview.data()));
+
+    // Assert
+    ASSERT_TRUE(read.ok);
+    EXPECT_EQ(batched, whole);
+    EXPECT_EQ(preview[0], whole[0]);
+    EXPECT_EQ(preview[PREVIEW_RUN_PARTICLES - 1], whole[PREVIEW_RUN_PARTICLES - 1]);
+}
+
+TEST_F(ElementCodecTest, OpenFrameSource_Float64Option_OpensRecenteredDoubleSource)
+{
+    // Arrange
+    writeDoubleDataset();
+    FrameReadOptions options;
+    options.element_type = ElementType::Float64;
+    options.recenter = true;
+    options.read_threads = 2; // ignored: doubles are always mapped
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(doublePath, PARTICLES, options);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->frameCount(), FRAMES);
+    EXPECT_EQ(source->storedFrameBytes(0), 2 * PARTICLES * sizeof(glm::dvec4));
+    EXPECT_NE(source->positionOrigin(), glm::dvec3(0.0));
+}
+
+TEST_F(ElementCodecTest, ConvertLegacyDataset_Float64_WritesFloatContainer)
+{
+    // Arrange
+    writeDoubleDataset();
+
+    // Act
+    const ConversionResult result =
+        convertLegacyDataset(doublePath, PARTICLES, containerPath, container::Encoding::Raw, 0.0f,
+                             container::DEFAULT_KEYFRAME_INTERVAL, container::StreamLayout::FrameInterleaved,
+                             ElementType::Float64);
+
+    // Assert
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.frames, FRAMES);
+    std::unique_ptr<FrameSource> container = openFrameSource(containerPath, 0);
+    ASSERT_NE(container, nullptr);
+    std::vector<glm::vec4> velocities(PARTICLES);
+    ASSERT_TRUE(container->readVelocities(1, velocities.data()));
+    EXPECT_EQ(container->mappedPositions(1)[3], glm::vec4(position(1, 3)));
+    EXPECT_EQ(velocities[3], glm::vec4(velocity(1, 3)));
+}
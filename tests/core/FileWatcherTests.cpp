@@ -0,0 +1,77 @@
+/*
+ * FileWatcherTests.cpp
+ *
+ * Unit tests for the follow-mode file change watcher.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "data/file_watcher.hpp"
+
+class FileWatcherTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::ofstream out(filePath, std::ios::binary);
+        out << "frame0";
+    }
+
+    void TearDown() override
+    {
+        std::remove(filePath.c_str());
+    }
+
+    const std::string filePath = "/tmp/test_FileWatcher";
+};
+
+TEST_F(FileWatcherTest, Poll_AfterAppend_ReportsChange)
+{
+    // Arrange
+    FileWatcher watcher(filePath);
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::app);
+        out << "frame1";
+    }
+
+    // Act
+    bool changed = watcher.poll();
+
+    // Assert
+    EXPECT_TRUE(changed);
+}
+
+#ifdef __linux__
+TEST_F(FileWatcherTest, Poll_Untouched_ReportsNoChange)
+{
+    // Arrange
+    FileWatcher watcher(filePath);
+
+    // Act
+    bool changed = watcher.poll();
+
+    // Assert
+    EXPECT_FALSE(changed);
+}
+
+TEST_F(FileWatcherTest, Poll_Twice_DrainsEvents)
+{
+    // Arrange
+    FileWatcher watcher(filePath);
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::app);
+        out << "frame1";
+    }
+    watcher.poll();
+
+    // Act
+    bool changed = watcher.poll();
+
+    // Assert
+    EXPECT_FALSE(changed);
+}
+#endif
@@ -0,0 +1,137 @@
+/*
+ * FrameCacheTests.cpp
+ *
+ * Unit tests for the compressed in-RAM frame cache.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_cache.hpp"
+
+namespace
+{
+
+constexpr long PARTICLES = 1000;
+constexpr std::uint64_t RAW_FRAME_BYTES = sizeof(glm::vec4) * PARTICLES;
+
+/*
+ * Slowly drifting particles, so neighbouring frames share most of their bits.
+ */
+std::vector<glm::vec4> makeFrame(long frame)
+{
+    std::vector<glm::vec4> positions(PARTICLES);
+    for (long i = 0; i < PARTICLES; i++) {
+        const float base = static_cast<float>(i % 97) + 100.0f;
+        positions[i] = glm::vec4(base + frame * 1e-5f, -base - frame * 2e-5f, base * 0.5f, static_cast<float>(i % 4));
+    }
+    return positions;
+}
+
+} // namespace
+
+TEST(FrameCacheTest, Lookup_Empty_IsMiss)
+{
+    // Arrange
+    FrameCache cache(PARTICLES, 64 * RAW_FRAME_BYTES);
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool hit = cache.lookup(3, destination.data());
+
+    // Assert
+    EXPECT_FALSE(hit);
+    EXPECT_EQ(cache.stats().misses, 1u);
+    EXPECT_EQ(cache.stats().hits, 0u);
+}
+
+TEST(FrameCacheTest, InsertThenLookup_IsBitExact)
+{
+    // Arrange
+    FrameCache cache(PARTICLES, 64 * RAW_FRAME_BYTES);
+    std::vector<glm::vec4> destination(PARTICLES);
+    for (long frame = 0; frame < 5; frame++) {
+        cache.insert(frame, makeFrame(frame).data());
+    }
+
+    // Act & Assert
+    for (long frame = 4; frame >= 0; frame--) {
+        ASSERT_TRUE(cache.lookup(frame, destination.data())) << "frame " << frame;
+        EXPECT_EQ(destination, makeFrame(frame)) << "frame " << frame;
+    }
+    EXPECT_EQ(cache.stats().hits, 5u);
+}
+
+TEST(FrameCacheTest, Insert_NaNPosition_RoundTrips)
+{
+    // Arrange
+    FrameCache cache(PARTICLES, 64 * RAW_FRAME_BYTES);
+    std::vector<glm::vec4> frame = makeFrame(0);
+    cache.insert(0, frame.data());
+    frame[7].y = std::numeric_limits<float>::quiet_NaN();
+    cache.insert(1, frame.data());
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    ASSERT_TRUE(cache.lookup(1, destination.data()));
+
+    // Assert
+    EXPECT_TRUE(std::isnan(destination[7].y));
+    EXPECT_EQ(destination[8], frame[8]);
+}
+
+TEST(FrameCacheTest, NearbyFrames_HoldFarLessThanRaw)
+{
+    // Arrange
+    FrameCache cache(PARTICLES, 64 * RAW_FRAME_BYTES);
+
+    // Act
+    for (long frame = 0; frame < 20; frame++) {
+        cache.insert(frame, makeFrame(frame).data());
+    }
+
+    // Assert - one raw anchor plus 20 residual frames, well under 20 raw frames
+    FrameCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.frames_held, 20);
+    EXPECT_LT(stats.bytes_held, 5 * RAW_FRAME_BYTES);
+}
+
+TEST(FrameCacheTest, Insert_OverBudget_EvictsLeastRecentlyUsed)
+{
+    // Arrange - every frame becomes its own anchor, so each costs a raw frame plus a small residual header
+    FrameCache cache(PARTICLES, 3 * RAW_FRAME_BYTES + 1024);
+    std::vector<glm::vec4> destination(PARTICLES);
+    for (long frame = 0; frame < 3; frame++) {
+        cache.insert(frame, makeFrame(frame * 100000).data());
+    }
+
+    // Act
+    ASSERT_TRUE(cache.lookup(0, destination.data()));
+    cache.insert(3, makeFrame(300000).data());
+
+    // Assert
+    FrameCacheStats stats = cache.stats();
+    EXPECT_LE(stats.bytes_held, stats.budget_bytes);
+    EXPECT_TRUE(cache.lookup(3, destination.data()));
+    EXPECT_TRUE(cache.lookup(0, destination.data()));
+    EXPECT_FALSE(cache.lookup(1, destination.data()));
+}
+
+TEST(FrameCacheTest, Insert_BudgetBelowTwoFrames_CachesNothing)
+{
+    // Arrange
+    FrameCache cache(PARTICLES, RAW_FRAME_BYTES);
+
+    // Act
+    cache.insert(0, makeFrame(0).data());
+
+    // Assert
+    EXPECT_EQ(cache.stats().frames_held, 0);
+    EXPECT_EQ(cache.stats().bytes_held, 0u);
+}
@@ -0,0 +1,400 @@
+/*
+ * FramePrefetcherTests.cpp
+ *
+ * Unit tests for the background frame prefetch ring.
+ * Frames are synthesized by the reader callback, so no files are involved.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_prefetcher.hpp"
+
+namespace
+{
+
+constexpr long TEST_PARTICLES = 4;
+constexpr long TEST_FRAMES = 20;
+
+/*
+ * Fills every particle of `frame` with the frame number.
+ */
+bool fillWithFrameNumber(long frame, glm::vec4* destination)
+{
+    for (long i = 0; i < TEST_PARTICLES; i++) {
+        destination[i] = glm::vec4(static_cast<float>(frame));
+    }
+    return true;
+}
+
+/*
+ * Polls acquire() until the frame is resident or the timeout expires.
+ */
+const glm::vec4* waitForFrame(FramePrefetcher& prefetcher, long frame)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (const glm::vec4* data = prefetcher.acquire(frame)) {
+            return data;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(FramePrefetcherTest, RingCapacity_WithinBudget_UsesRingDepth)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 6;
+    config.memory_budget_bytes = 1024;
+
+    // Act
+    int capacity = FramePrefetcher::ringCapacity(config, 16);
+
+    // Assert
+    EXPECT_EQ(capacity, 6);
+}
+
+TEST(FramePrefetcherTest, RingCapacity_OverBudget_ShrinksRing)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 8;
+    config.memory_budget_bytes = 64;
+
+    // Act
+    int capacity = FramePrefetcher::ringCapacity(config, 16);
+
+    // Assert
+    EXPECT_EQ(capacity, 4);
+}
+
+TEST(FramePrefetcherTest, RingCapacity_TinyBudget_KeepsMinimumDepth)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 8;
+    config.memory_budget_bytes = 1;
+
+    // Act
+    int capacity = FramePrefetcher::ringCapacity(config, 16);
+
+    // Assert
+    EXPECT_EQ(capacity, PrefetchConfig::MIN_RING_DEPTH);
+}
+
+TEST(FramePrefetcherTest, FitsBudget_BelowMinimumDepth_ReportsOverrun)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.memory_budget_bytes = 31;
+
+    // Act & Assert
+    EXPECT_FALSE(FramePrefetcher::fitsBudget(config, 16));
+    config.memory_budget_bytes = 32;
+    EXPECT_TRUE(FramePrefetcher::fitsBudget(config, 16));
+}
+
+TEST(FramePrefetcherTest, Share_TwoRings_SplitBudgetByFrameSize)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.memory_budget_bytes = 1000;
+
+    // Act
+    PrefetchConfig full = config.share(300, 400);
+    PrefetchConfig preview = config.share(100, 400);
+
+    // Assert
+    EXPECT_EQ(full.memory_budget_bytes, 750u);
+    EXPECT_EQ(preview.memory_budget_bytes, 250u);
+    EXPECT_EQ(full.ring_depth, config.ring_depth);
+}
+
+TEST(FramePrefetcherTest, Acquire_AfterLoad_ReturnsFrameData)
+{
+    // Arrange
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, fillWithFrameNumber);
+
+    // Act
+    prefetcher.setPlayhead(3, 1);
+    const glm::vec4* data = waitForFrame(prefetcher, 3);
+
+    // Assert
+    ASSERT_NE(data, nullptr);
+    EXPECT_FLOAT_EQ(data[0].x, 3.0f);
+    EXPECT_FLOAT_EQ(data[TEST_PARTICLES - 1].w, 3.0f);
+}
+
+TEST(FramePrefetcherTest, SetPlayhead_Forward_PrefetchesFollowingFrames)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 4;
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, fillWithFrameNumber, config);
+
+    // Act
+    prefetcher.setPlayhead(10, 1);
+    ASSERT_NE(waitForFrame(prefetcher, 10), nullptr);
+    const glm::vec4* ahead = waitForFrame(prefetcher, 12);
+
+    // Assert
+    ASSERT_NE(ahead, nullptr);
+    EXPECT_FLOAT_EQ(ahead[0].x, 12.0f);
+}
+
+TEST(FramePrefetcherTest, SetPlayhead_Backward_PrefetchesPreviousFrames)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 4;
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, fillWithFrameNumber, config);
+
+    // Act
+    prefetcher.setPlayhead(10, -1);
+    ASSERT_NE(waitForFrame(prefetcher, 10), nullptr);
+    const glm::vec4* behind = waitForFrame(prefetcher, 8);
+
+    // Assert
+    ASSERT_NE(behind, nullptr);
+    EXPECT_FLOAT_EQ(behind[0].x, 8.0f);
+}
+
+TEST(FramePrefetcherTest, Acquire_FailedRead_NeverReady)
+{
+    // Arrange
+    std::atomic<int> attempts{0};
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, [&](long, glm::vec4*) {
+        attempts++;
+        return false;
+    });
+
+    // Act
+    prefetcher.setPlayhead(0, 1);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (attempts == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Assert
+    EXPECT_GT(attempts.load(), 0);
+    EXPECT_EQ(prefetcher.acquire(0), nullptr);
+}
+
+TEST(FramePrefetcherTest, Acquire_ReadFailsOnce_RetriesFrame)
+{
+    // Arrange - the first read of frame 0 fails, every later one succeeds
+    std::atomic<bool> first_read{true};
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, [&](long frame, glm::vec4* destination) {
+        if (frame == 0 && first_read.exchange(false)) {
+            return false;
+        }
+        return fillWithFrameNumber(frame, destination);
+    });
+
+    // Act
+    prefetcher.setPlayhead(0, 1);
+    const glm::vec4* data = waitForFrame(prefetcher, 0);
+
+    // Assert
+    ASSERT_NE(data, nullptr);
+    EXPECT_FLOAT_EQ(data[0].x, 0.0f);
+    EXPECT_EQ(prefetcher.failedReads(), 1u);
+    EXPECT_FALSE(prefetcher.hasFailed(0));
+}
+
+TEST(FramePrefetcherTest, HasFailed_ReadAlwaysFails_GivesUpAfterBoundedAttempts)
+{
+    // Arrange
+    std::atomic<int> attempts{0};
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, [&](long frame, glm::vec4* destination) {
+        if (frame == 0) {
+            attempts++;
+            return false;
+        }
+        return fillWithFrameNumber(frame, destination);
+    });
+
+    // Act
+    prefetcher.setPlayhead(0, 1);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!prefetcher.hasFailed(0) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // Assert - the neighbours still load, and frame 0 is not read again
+    EXPECT_TRUE(prefetcher.hasFailed(0));
+    EXPECT_EQ(attempts.load(), 3);
+    EXPECT_EQ(prefetcher.acquire(0), nullptr);
+    EXPECT_NE(waitForFrame(prefetcher, 1), nullptr);
+}
+
+TEST(FramePrefetcherTest, ReadyCount_NeverExceedsCapacity)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 3;
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, fillWithFrameNumber, config);
+
+    // Act
+    for (long frame = 0; frame < 6; frame++) {
+        prefetcher.setPlayhead(frame, 1);
+        ASSERT_NE(waitForFrame(prefetcher, frame), nullptr);
+    }
+
+    // Assert
+    EXPECT_LE(prefetcher.readyCount(), prefetcher.capacity());
+    EXPECT_EQ(prefetcher.capacity(), 3);
+}
+
+TEST(FramePrefetcherTest, Acquire_PinnedFrame_StaysValidWhilePlayheadMoves)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 2;
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, fillWithFrameNumber, config);
+    prefetcher.setPlayhead(0, 1);
+    const glm::vec4* shown = waitForFrame(prefetcher, 0);
+    ASSERT_NE(shown, nullptr);
+
+    // Act
+    prefetcher.setPlayhead(15, 1);
+    ASSERT_NE(waitForFrame(prefetcher, 15), nullptr);
+    prefetcher.setPlayhead(16, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // Assert - frame 15 is pinned now, and the pinned slot is never overwritten
+    const glm::vec4* current = prefetcher.acquire(15);
+    ASSERT_NE(current, nullptr);
+    EXPECT_FLOAT_EQ(current[0].x, 15.0f);
+}
+
+TEST(FramePrefetcherTest, SetFrameCount_ExtendsLoadableRange)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 4;
+    FramePrefetcher prefetcher(TEST_PARTICLES, 3, fillWithFrameNumber, config);
+    prefetcher.setPlayhead(5, 1);
+
+    // Act
+    prefetcher.setFrameCount(8);
+    const glm::vec4* data = waitForFrame(prefetcher, 5);
+
+    // Assert
+    ASSERT_NE(data, nullptr);
+    EXPECT_FLOAT_EQ(data[0].x, 5.0f);
+}
+
+TEST(FramePrefetcherTest, BatchReader_BatchFrames_LoadsSeveralFramesPerCall)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 8;
+    config.batch_frames = 4;
+    std::atomic<int> largest_batch{0};
+    FramePrefetcher prefetcher(
+        TEST_PARTICLES, TEST_FRAMES,
+        FramePrefetcher::BatchReader([&](FrameRead* reads, int count) {
+            largest_batch = std::max(largest_batch.load(), count);
+            for (int i = 0; i < count; i++) {
+                reads[i].ok = fillWithFrameNumber(reads[i].frame, reads[i].destination);
+            }
+        }),
+        config);
+
+    // Act
+    prefetcher.setPlayhead(0, 1);
+    const glm::vec4* data = waitForFrame(prefetcher, 6);
+
+    // Assert
+    ASSERT_NE(data, nullptr);
+    EXPECT_FLOAT_EQ(data[0].x, 6.0f);
+    EXPECT_EQ(largest_batch.load(), 4);
+}
+
+TEST(FramePrefetcherTest, SetPlayhead_SteadyScrub_LoadsAlongScrubStride)
+{
+    // Arrange
+    PrefetchConfig config;
+    config.ring_depth = 4;
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, fillWithFrameNumber, config);
+
+    // Act - three steps of 3 frames, as while E is held
+    prefetcher.setPlayhead(0, 1);
+    prefetcher.setPlayhead(3, 1);
+    prefetcher.setPlayhead(6, 1);
+    ASSERT_NE(waitForFrame(prefetcher, 6), nullptr);
+    const glm::vec4* ahead = waitForFrame(prefetcher, 12);
+
+    // Assert - a window of every frame would end at 8
+    EXPECT_EQ(prefetcher.scrubStride(), 3);
+    ASSERT_NE(ahead, nullptr);
+    EXPECT_FLOAT_EQ(ahead[0].x, 12.0f);
+}
+
+TEST(FramePrefetcherTest, SetPlayhead_StopsMoving_FallsBackToEveryFrame)
+{
+    // Arrange
+    FramePrefetcher prefetcher(TEST_PARTICLES, TEST_FRAMES, fillWithFrameNumber);
+    prefetcher.setPlayhead(0, 1);
+    prefetcher.setPlayhead(3, 1);
+    prefetcher.setPlayhead(6, 1);
+
+    // Act
+    prefetcher.setPlayhead(6, 1);
+
+    // Assert
+    EXPECT_EQ(prefetcher.scrubStride(), 1);
+    EXPECT_NE(waitForFrame(prefetcher, 7), nullptr);
+}
+
+TEST(FramePrefetcherTest, SetPlayhead_PlayheadLeavesLoadingFrame_CancelsItsRead)
+{
+    // Arrange - the first read of frame 5 only returns once it is cancelled
+    std::atomic<bool> first_read{true};
+    std::atomic<bool> blocked{false};
+    std::atomic<bool> saw_cancel{false};
+    FramePrefetcher prefetcher(
+        TEST_PARTICLES, TEST_FRAMES, FramePrefetcher::BatchReader([&](FrameRead* reads, int count) {
+            for (int i = 0; i < count; i++) {
+                if (reads[i].frame == 5 && first_read.exchange(false)) {
+                    blocked = true;
+                    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                    while (!isCancelled(reads[i]) && std::chrono::steady_clock::now() < deadline) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    saw_cancel = isCancelled(reads[i]);
+                    reads[i].ok = false;
+                    continue;
+                }
+                reads[i].ok = fillWithFrameNumber(reads[i].frame, reads[i].destination);
+            }
+        }));
+    prefetcher.setPlayhead(5, 1);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!blocked && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Act
+    prefetcher.setPlayhead(15, 1);
+    const glm::vec4* data = waitForFrame(prefetcher, 15);
+
+    // Assert - the new frame arrives, and the cancelled one is not remembered as a failed read
+    EXPECT_TRUE(saw_cancel.load());
+    ASSERT_NE(data, nullptr);
+    EXPECT_FLOAT_EQ(data[0].x, 15.0f);
+    prefetcher.setPlayhead(5, 1);
+    EXPECT_NE(waitForFrame(prefetcher, 5), nullptr);
+}
@@ -0,0 +1,198 @@
+/*
+ * FramePreviewTests.cpp
+ *
+ * Unit tests for scrub-preview reads: the runs a preview keeps, and
+ * readPreviewPositions() on the mapped, pread, io_uring and container sources.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/container_writer.hpp"
+#include "data/frame_source.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/pread_frame_source.hpp"
+#include "data/uring_file_reader.hpp"
+#include "data/uring_frame_source.hpp"
+
+namespace
+{
+
+// Three full runs and a partial one
+constexpr std::int64_t PARTICLES = 3 * PREVIEW_RUN_PARTICLES + 100;
+constexpr std::int64_t FRAMES = 3;
+constexpr int STRIDE = 2;
+
+glm::vec4 position(std::int64_t frame, std::int64_t i)
+{
+    return glm::vec4(static_cast<float>(i), static_cast<float>(frame), 0.0f, static_cast<float>(i % 3));
+}
+
+/*
+ * The preview of `frame` worked out particle by particle.
+ */
+std::vector<glm::vec4> expectedPreview(std::int64_t frame, int stride)
+{
+    std::vector<glm::vec4> preview;
+    for (std::int64_t i = 0; i < PARTICLES; i++) {
+        if ((i / PREVIEW_RUN_PARTICLES) % stride == 0) {
+            preview.push_back(position(frame, i));
+        }
+    }
+    return preview;
+}
+
+} // namespace
+
+class FramePreviewTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::ofstream out(legacyPath, std::ios::binary);
+        std::vector<glm::vec4> positions(PARTICLES);
+        std::vector<glm::vec4> velocities(PARTICLES, glm::vec4(1.0f));
+        for (std::int64_t frame = 0; frame < FRAMES; frame++) {
+            for (std::int64_t i = 0; i < PARTICLES; i++) {
+                positions[i] = position(frame, i);
+            }
+            out.write(reinterpret_cast<const char*>(positions.data()), sizeof(glm::vec4) * PARTICLES);
+            out.write(reinterpret_cast<const char*>(velocities.data()), sizeof(glm::vec4) * PARTICLES);
+        }
+    }
+
+    void TearDown() override
+    {
+        std::remove(legacyPath.c_str());
+        std::remove(containerPath.c_str());
+    }
+
+    /*
+     * Reads the preview of `frame` and checks it particle by particle.
+     */
+    static void expectPreview(const FrameSource& source, std::int64_t frame)
+    {
+        std::vector<glm::vec4> preview(previewParticleCount(PARTICLES, STRIDE));
+        ASSERT_TRUE(source.readPreviewPositions(frame, STRIDE, preview.data()));
+        EXPECT_EQ(preview, expectedPreview(frame, STRIDE));
+    }
+
+    const std::string legacyPath = "/tmp/test_FramePreview_PosAndVel";
+    const std::string containerPath = "/tmp/test_FramePreview.pv2";
+};
+
+TEST_F(FramePreviewTest, PreviewParticleCount_KeepsEveryStrideRun)
+{
+    // Assert - runs 0 and 2 are kept; stride 1 keeps everything, a huge stride only the first run
+    EXPECT_EQ(previewParticleCount(PARTICLES, STRIDE), 2 * PREVIEW_RUN_PARTICLES);
+    EXPECT_EQ(previewParticleCount(PARTICLES, 3), PREVIEW_RUN_PARTICLES + 100);
+    EXPECT_EQ(previewParticleCount(PARTICLES, 1), PARTICLES);
+    EXPECT_EQ(previewParticleCount(PARTICLES, 1000), PREVIEW_RUN_PARTICLES);
+    EXPECT_EQ(previewParticleCount(0, STRIDE), 0);
+}
+
+TEST_F(FramePreviewTest, ReadPreviewPositions_MappedSource_KeepsRunsAndTypeCodes)
+{
+    // Arrange
+    std::unique_ptr<FrameSource> source = openFrameSource(legacyPath, PARTICLES);
+    ASSERT_NE(source, nullptr);
+
+    // Act / Assert
+    expectPreview(*source, 1);
+}
+
+TEST_F(FramePreviewTest, ReadPreviewPositions_PreadSource_MatchesMappedPreview)
+{
+    // Arrange
+    PreadFrameSource source(legacyPath, PARTICLES, 3);
+    ASSERT_TRUE(source.isOpen());
+
+    // Act / Assert
+    expectPreview(source, 2);
+}
+
+TEST_F(FramePreviewTest, ReadPreviewPositions_UringSource_MatchesMappedPreview)
+{
+    if (!UringFileReader::isSupported()) {
+        GTEST_SKIP() << "io_uring unavailable";
+    }
+
+    // Arrange
+    UringFrameSource source(legacyPath, PARTICLES);
+    ASSERT_TRUE(source.isOpen());
+
+    // Act / Assert
+    expectPreview(source, 0);
+}
+
+TEST_F(FramePreviewTest, ReadPreviewPositions_EncodedContainer_DecodesThenKeepsRuns)
+{
+    // Arrange - residual frames have no mapped positions, so the default path decodes them
+    ContainerWriter writer;
+    ASSERT_TRUE(writer.open(containerPath, PARTICLES, false, container::Encoding::PredictiveResidual));
+    std::vector<glm::vec4> positions(PARTICLES);
+    for (std::int64_t frame = 0; frame < FRAMES; frame++) {
+        for (std::int64_t i = 0; i < PARTICLES; i++) {
+            positions[i] = position(frame, i);
+        }
+        ASSERT_TRUE(writer.appendFrame(positions.data(), nullptr));
+    }
+    ASSERT_TRUE(writer.finish());
+    std::unique_ptr<FrameSource> source = openFrameSource(containerPath, 0);
+    ASSERT_NE(source, nullptr);
+    ASSERT_EQ(source->mappedPositions(1), nullptr);
+
+    // Act / Assert
+    expectPreview(*source, 1);
+}
+
+TEST_F(FramePreviewTest, ReadPreviewPositions_QuantizedContainer_DecodesOnlyKeptRuns)
+{
+    // Arrange
+    ContainerWriter writer;
+    ASSERT_TRUE(writer.open(containerPath, PARTICLES, false, container::Encoding::Quantized16));
+    std::vector<glm::vec4> positions(PARTICLES);
+    for (std::int64_t frame = 0; frame < FRAMES; frame++) {
+        for (std::int64_t i = 0; i < PARTICLES; i++) {
+            positions[i] = position(frame, i);
+        }
+        ASSERT_TRUE(writer.appendFrame(positions.data(), nullptr));
+    }
+    ASSERT_TRUE(writer.finish());
+    std::unique_ptr<FrameSource> source = openFrameSource(containerPath, 0);
+    ASSERT_NE(source, nullptr);
+    std::vector<glm::vec4> whole(PARTICLES);
+    ASSERT_TRUE(source->readPositions(2, whole.data()));
+    std::vector<glm::vec4> preview(previewParticleCount(PARTICLES, STRIDE));
+
+    // Act
+    const bool ok = source->readPreviewPositions(2, STRIDE, preview.data());
+
+    // Assert - the kept runs decode exactly as they do in the whole frame
+    ASSERT_TRUE(ok);
+    std::vector<glm::vec4> expected;
+    forEachPreviewRun(PARTICLES, STRIDE, [&](std::int64_t first, std::int64_t count, std::int64_t) {
+        expected.insert(expected.end(), whole.begin() + first, whole.begin() + first + count);
+    });
+    EXPECT_EQ(preview, expected);
+}
+
+TEST_F(FramePreviewTest, ReadPreviewPositions_FramePastEnd_Fails)
+{
+    // Arrange
+    std::unique_ptr<FrameSource> source = openFrameSource(legacyPath, PARTICLES);
+    PreadFrameSource pread_source(legacyPath, PARTICLES, 1);
+    std::vector<glm::vec4> preview(previewParticleCount(PARTICLES, STRIDE));
+
+    // Act / Assert
+    EXPECT_FALSE(source->readPreviewPositions(FRAMES, STRIDE, preview.data()));
+    EXPECT_FALSE(pread_source.readPreviewPositions(FRAMES, STRIDE, preview.data()));
+}
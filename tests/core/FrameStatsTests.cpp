@@ -0,0 +1,203 @@
+/*
+ * FrameStatsTests.cpp
+ *
+ * Unit tests for per-frame statistics and the FrameStatsIndex sidecar.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_stats.hpp"
+#include "data/mapped_file.hpp"
+#include "data/raw_frame_source.hpp"
+
+class FrameStatsTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override
+    {
+        std::remove(dataPath.c_str());
+        std::remove((dataPath + frame_stats::SIDECAR_SUFFIX).c_str());
+    }
+
+    /*
+     * Frame f: particle i at (i + f, 2f, -i), type i % 3; velocities zero.
+     */
+    void writeData(long frames)
+    {
+        FILE* file = fopen(dataPath.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        for (long frame = 0; frame < frames; frame++) {
+            for (long i = 0; i < PARTICLES; i++) {
+                glm::vec4 pos(static_cast<float>(i + frame), 2.0f * frame, -static_cast<float>(i),
+                              static_cast<float>(i % 3));
+                fwrite(&pos, sizeof(pos), 1, file);
+            }
+            const glm::vec4 zero(0.0f);
+            for (long i = 0; i < PARTICLES; i++) {
+                fwrite(&zero, sizeof(zero), 1, file);
+            }
+        }
+        fclose(file);
+    }
+
+    static void waitReady(const FrameStatsIndex& index)
+    {
+        while (!index.isReady()) {
+            std::this_thread::yield();
+        }
+    }
+
+    static constexpr long PARTICLES = 6;
+    const std::string dataPath = "/tmp/test_FrameStats_PosAndVel";
+};
+
+TEST_F(FrameStatsTest, Compute_Frame_ReportsBoundsCentroidAndTypes)
+{
+    // Arrange
+    std::vector<glm::vec4> positions = {
+        {0.0f, 0.0f, 0.0f, 0.0f}, {2.0f, 4.0f, -2.0f, 1.0f}, {4.0f, 2.0f, 2.0f, 1.0f}, {2.0f, 2.0f, 0.0f, 500.0f}};
+
+    // Act
+    FrameStats stats = frame_stats::compute(positions.data(), static_cast<std::int64_t>(positions.size()));
+
+    // Assert
+    EXPECT_EQ(stats.bounds_min, glm::vec3(0.0f, 0.0f, -2.0f));
+    EXPECT_EQ(stats.bounds_max, glm::vec3(4.0f, 4.0f, 2.0f));
+    EXPECT_EQ(stats.centroid, glm::vec3(2.0f, 2.0f, 0.0f));
+    EXPECT_EQ(stats.type_counts[0], 1);
+    EXPECT_EQ(stats.type_counts[1], 2);
+    EXPECT_EQ(stats.type_counts[frame_stats::TYPE_SLOTS - 1], 1); // the default-cube marker
+    EXPECT_EQ(stats.non_finite, 0);
+}
+
+TEST_F(FrameStatsTest, Compute_NonFiniteParticles_AreCountedAndLeftOutOfBounds)
+{
+    // Arrange
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<glm::vec4> positions = {{1.0f, 1.0f, 1.0f, 0.0f}, {nan, 0.0f, 0.0f, 0.0f}, {0.0f, inf, 0.0f, nan}};
+
+    // Act
+    FrameStats stats = frame_stats::compute(positions.data(), static_cast<std::int64_t>(positions.size()));
+
+    // Assert
+    EXPECT_EQ(stats.non_finite, 2);
+    EXPECT_EQ(stats.bounds_min, glm::vec3(1.0f));
+    EXPECT_EQ(stats.bounds_max, glm::vec3(1.0f));
+    EXPECT_EQ(stats.type_counts[frame_stats::TYPE_SLOTS - 1], 1);
+}
+
+TEST_F(FrameStatsTest, ActivityProfile_SingleBusyFrame_ShowsInItsBucket)
+{
+    // Arrange - a still run with one jump between frames 60 and 61
+    std::vector<glm::vec4> still = {{0.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 0.0f}};
+    std::vector<glm::vec4> moved = {{10.0f, 0.0f, 0.0f, 0.0f}, {11.0f, 1.0f, 1.0f, 0.0f}};
+    std::vector<FrameStats> frames(101, frame_stats::compute(still.data(), 2));
+    for (int frame = 61; frame < 101; frame++) {
+        frames[frame] = frame_stats::compute(moved.data(), 2);
+    }
+
+    // Act
+    std::vector<float> profile = frame_stats::activityProfile(frames, 10);
+
+    // Assert
+    ASSERT_EQ(profile.size(), 10u);
+    for (int bucket = 0; bucket < 10; bucket++) {
+        EXPECT_FLOAT_EQ(profile[bucket], bucket == 6 ? 10.0f : 0.0f);
+    }
+}
+
+TEST_F(FrameStatsTest, Index_NoSidecar_ComputesEveryFrameAndSavesSidecar)
+{
+    // Arrange
+    writeData(40);
+    RawFrameSource source{MappedFile(dataPath), PARTICLES};
+
+    // Act
+    FrameStatsIndex index(&source, dataPath, 2);
+    waitReady(index);
+
+    // Assert
+    EXPECT_FALSE(index.loadedFromSidecar());
+    ASSERT_EQ(index.frameCount(), 40);
+    ASSERT_NE(index.frame(37), nullptr);
+    EXPECT_EQ(index.frame(37)->bounds_min, glm::vec3(37.0f, 74.0f, -5.0f));
+    EXPECT_EQ(index.frame(37)->bounds_max, glm::vec3(42.0f, 74.0f, 0.0f));
+    EXPECT_EQ(index.frame(37)->type_counts[2], 2);
+    FILE* sidecar = fopen((dataPath + frame_stats::SIDECAR_SUFFIX).c_str(), "rb");
+    EXPECT_NE(sidecar, nullptr);
+    if (sidecar != nullptr) {
+        fclose(sidecar);
+    }
+}
+
+TEST_F(FrameStatsTest, Index_SecondOpen_LoadsSidecar)
+{
+    // Arrange
+    writeData(20);
+    RawFrameSource source{MappedFile(dataPath), PARTICLES};
+    {
+        FrameStatsIndex first(&source, dataPath, 2);
+        waitReady(first);
+    }
+
+    // Act
+    FrameStatsIndex second(&source, dataPath, 2);
+
+    // Assert - ready straight away, without reading a frame
+    EXPECT_TRUE(second.isReady());
+    EXPECT_TRUE(second.loadedFromSidecar());
+    ASSERT_NE(second.frame(19), nullptr);
+    EXPECT_EQ(second.frame(19)->centroid, glm::vec3(21.5f, 38.0f, -2.5f));
+}
+
+TEST_F(FrameStatsTest, Index_DataFileChanged_IgnoresSidecar)
+{
+    // Arrange
+    writeData(20);
+    {
+        RawFrameSource source{MappedFile(dataPath), PARTICLES};
+        FrameStatsIndex first(&source, dataPath, 2);
+        waitReady(first);
+    }
+    writeData(24);
+    RawFrameSource source{MappedFile(dataPath), PARTICLES};
+
+    // Act
+    FrameStatsIndex second(&source, dataPath, 2);
+    waitReady(second);
+
+    // Assert
+    EXPECT_FALSE(second.loadedFromSidecar());
+    EXPECT_EQ(second.frameCount(), 24);
+}
+
+TEST_F(FrameStatsTest, Index_NonFiniteFrames_AreCounted)
+{
+    // Arrange
+    writeData(3);
+    FILE* file = fopen(dataPath.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    fseek(file, static_cast<long>(2 * 2 * PARTICLES * sizeof(glm::vec4)), SEEK_SET); // frame 2, particle 0, x
+    fwrite(&nan, sizeof(nan), 1, file);
+    fclose(file);
+    RawFrameSource source{MappedFile(dataPath), PARTICLES};
+
+    // Act
+    FrameStatsIndex index(&source, dataPath, 1);
+    waitReady(index);
+
+    // Assert
+    EXPECT_EQ(index.nonFiniteFrames(), 1);
+    EXPECT_EQ(index.frame(2)->non_finite, 1);
+}
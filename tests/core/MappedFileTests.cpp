@@ -0,0 +1,174 @@
+/*
+ * MappedFileTests.cpp
+ *
+ * Unit tests for the MappedFile read-only mapping wrapper.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "data/mapped_file.hpp"
+
+class MappedFileTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::ofstream out(filePath, std::ios::binary);
+        out << "particle";
+    }
+
+    void TearDown() override
+    {
+        std::remove(filePath.c_str());
+        std::remove(emptyPath.c_str());
+    }
+
+    const std::string filePath = "/tmp/test_MappedFile";
+    const std::string emptyPath = "/tmp/test_MappedFile_empty";
+};
+
+TEST_F(MappedFileTest, DefaultConstructor_IsNotOpen)
+{
+    // Act
+    MappedFile file;
+
+    // Assert
+    EXPECT_FALSE(file.isOpen());
+}
+
+TEST_F(MappedFileTest, Open_ExistingFile_ReportsFileSize)
+{
+    // Arrange
+    std::uint64_t expected_size = 8;
+
+    // Act
+    MappedFile file(filePath);
+
+    // Assert
+    EXPECT_EQ(file.size(), expected_size);
+}
+
+TEST_F(MappedFileTest, Open_ExistingFile_MapsContents)
+{
+    // Act
+    MappedFile file(filePath);
+
+    // Assert
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(file.data()), file.size()), "particle");
+}
+
+TEST_F(MappedFileTest, Open_MissingFile_ReturnsFalse)
+{
+    // Arrange
+    MappedFile file;
+
+    // Act
+    bool opened = file.open("/tmp/nonexistent_mapped_file");
+
+    // Assert
+    EXPECT_FALSE(opened);
+}
+
+TEST_F(MappedFileTest, Open_EmptyFile_OpensWithNoData)
+{
+    // Arrange
+    std::ofstream(emptyPath).close();
+
+    // Act
+    MappedFile file(emptyPath);
+
+    // Assert
+    EXPECT_TRUE(file.isOpen());
+    EXPECT_EQ(file.data(), nullptr);
+}
+
+TEST_F(MappedFileTest, Close_ResetsState)
+{
+    // Arrange
+    MappedFile file(filePath);
+
+    // Act
+    file.close();
+
+    // Assert
+    EXPECT_FALSE(file.isOpen());
+    EXPECT_EQ(file.size(), 0u);
+}
+
+TEST_F(MappedFileTest, MoveConstructor_TransfersMapping)
+{
+    // Arrange
+    MappedFile source(filePath);
+
+    // Act
+    MappedFile target(std::move(source));
+
+    // Assert
+    EXPECT_TRUE(target.isOpen());
+    EXPECT_FALSE(source.isOpen());
+}
+
+TEST_F(MappedFileTest, OpenGrowable_AppendedBytes_AppearAfterRefresh)
+{
+    // Arrange
+    MappedFile file;
+    ASSERT_TRUE(file.openGrowable(filePath, 1 << 20));
+    const unsigned char* before = file.data();
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::app);
+        out << "viewer";
+    }
+
+    // Act
+    std::uint64_t size = file.refreshSize();
+
+    // Assert
+    EXPECT_EQ(size, 14u);
+    EXPECT_EQ(file.data(), before);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(file.data()), 14), "particleviewer");
+}
+
+TEST_F(MappedFileTest, Refresh_PlainMapping_KeepsOriginalSize)
+{
+    // Arrange
+    MappedFile file(filePath);
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::app);
+        out << "viewer";
+    }
+
+    // Act
+    std::uint64_t size = file.refreshSize();
+
+    // Assert
+    EXPECT_EQ(size, 8u);
+}
+
+TEST_F(MappedFileTest, Advise_DontNeedThenWillNeed_ContentsStillReadable)
+{
+    // Arrange - several pages, so whole pages really are dropped
+    std::string contents;
+    for (int i = 0; i < 8192; i++) {
+        contents += "particle";
+    }
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+        out << contents;
+    }
+    MappedFile file(filePath);
+    ASSERT_EQ(file.size(), contents.size());
+    ASSERT_EQ(std::string(reinterpret_cast<const char*>(file.data()), file.size()), contents);
+
+    // Act
+    file.advise(0, file.size(), PageAdvice::DontNeed);
+    file.advise(100, 20000, PageAdvice::WillNeed);
+    file.advise(file.size() - 10, 1ull << 40, PageAdvice::DontNeed); // clipped to the file
+
+    // Assert
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(file.data()), file.size()), contents);
+}
@@ -0,0 +1,214 @@
+/*
+ * PageCachePolicyTests.cpp
+ *
+ * Unit tests for the sequential-playback page-cache policy. A recording
+ * FrameSource stands in for a data file, so the tests see exactly which
+ * hints are issued.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source.hpp"
+#include "data/page_cache_policy.hpp"
+
+namespace
+{
+
+constexpr std::int64_t FRAMES = 100;
+constexpr std::uint64_t FRAME_BYTES = 1024;
+
+struct Hint
+{
+    std::int64_t first;
+    std::int64_t count;
+    PageAdvice advice;
+
+    bool operator==(const Hint& other) const
+    {
+        return first == other.first && count == other.count && advice == other.advice;
+    }
+};
+
+/*
+ * Frame source that only records the hints it receives.
+ */
+class RecordingSource : public FrameSource
+{
+  public:
+    std::int64_t particleCount() const override
+    {
+        return 1;
+    }
+
+    std::int64_t frameCount() const override
+    {
+        return FRAMES;
+    }
+
+    bool readPositions(std::int64_t, glm::vec4*) const override
+    {
+        return true;
+    }
+
+    bool readVelocities(std::int64_t, glm::vec4*) const override
+    {
+        return true;
+    }
+
+    void adviseFrames(std::int64_t first, std::int64_t count, PageAdvice advice) const override
+    {
+        hints.push_back({first, count, advice});
+    }
+
+    std::uint64_t storedFrameBytes(std::int64_t) const override
+    {
+        return FRAME_BYTES;
+    }
+
+    mutable std::vector<Hint> hints;
+};
+
+/*
+ * Synchronous hints, four frames of readahead, two frames kept behind.
+ */
+PageCachePolicyConfig testConfig()
+{
+    PageCachePolicyConfig config;
+    config.readahead_bytes = 4 * FRAME_BYTES;
+    config.keep_behind_frames = 2;
+    config.max_step = 3;
+    config.streaming_after = 3;
+    config.background = false;
+    return config;
+}
+
+} // namespace
+
+TEST(PageCachePolicyTest, Update_FirstSteps_IssueNoHints)
+{
+    // Arrange
+    RecordingSource source;
+    PageCachePolicy policy(&source, testConfig());
+
+    // Act
+    for (std::int64_t frame = 10; frame <= 12; frame++) {
+        policy.update(frame);
+    }
+
+    // Assert - two sequential steps are not yet enough to call it playback
+    EXPECT_FALSE(policy.isStreaming());
+    EXPECT_TRUE(source.hints.empty());
+}
+
+TEST(PageCachePolicyTest, Update_SequentialPlayback_ReadsAheadAndDropsPlayedFrames)
+{
+    // Arrange
+    RecordingSource source;
+    PageCachePolicy policy(&source, testConfig());
+
+    // Act
+    for (std::int64_t frame = 10; frame <= 14; frame++) {
+        policy.update(frame);
+    }
+
+    // Assert
+    ASSERT_TRUE(policy.isStreaming());
+    std::vector<Hint> expected = {
+        {14, 4, PageAdvice::WillNeed}, // streaming starts at 13: frames 14-17 ahead
+        {10, 1, PageAdvice::DontNeed}, // 10 played, 11 and 12 kept behind
+        {18, 1, PageAdvice::WillNeed}, // at 14 the window moves on by one frame
+        {11, 1, PageAdvice::DontNeed},
+    };
+    EXPECT_EQ(source.hints, expected);
+    EXPECT_EQ(policy.stats().readahead_bytes, 5 * FRAME_BYTES);
+    EXPECT_EQ(policy.stats().dropped_bytes, 2 * FRAME_BYTES);
+}
+
+TEST(PageCachePolicyTest, Update_Jump_SwitchesToScrubbing)
+{
+    // Arrange
+    RecordingSource source;
+    PageCachePolicy policy(&source, testConfig());
+    for (std::int64_t frame = 10; frame <= 14; frame++) {
+        policy.update(frame);
+    }
+    const std::size_t hints_before = source.hints.size();
+
+    // Act
+    policy.update(60);
+    policy.update(61);
+
+    // Assert
+    EXPECT_FALSE(policy.isStreaming());
+    EXPECT_EQ(source.hints.size(), hints_before);
+}
+
+TEST(PageCachePolicyTest, Update_StreamingAgainAfterJump_NeverDropsFramesBeforeTheJump)
+{
+    // Arrange
+    RecordingSource source;
+    PageCachePolicy policy(&source, testConfig());
+    for (std::int64_t frame = 10; frame <= 14; frame++) {
+        policy.update(frame);
+    }
+    policy.update(60);
+    source.hints.clear();
+
+    // Act
+    for (std::int64_t frame = 61; frame <= 66; frame++) {
+        policy.update(frame);
+    }
+
+    // Assert - only frames played since the jump are dropped
+    ASSERT_TRUE(policy.isStreaming());
+    for (const Hint& hint : source.hints) {
+        if (hint.advice == PageAdvice::DontNeed) {
+            EXPECT_GE(hint.first, 60);
+            EXPECT_LE(hint.first + hint.count, 66 - 2);
+        }
+    }
+}
+
+TEST(PageCachePolicyTest, Update_ReversePlayback_ReadsBehindAndDropsFramesAhead)
+{
+    // Arrange
+    RecordingSource source;
+    PageCachePolicy policy(&source, testConfig());
+
+    // Act
+    for (std::int64_t frame = 50; frame >= 46; frame--) {
+        policy.update(frame);
+    }
+
+    // Assert
+    std::vector<Hint> expected = {
+        {43, 4, PageAdvice::WillNeed}, // streaming starts at 47: frames 43-46 behind it
+        {50, 1, PageAdvice::DontNeed}, // 50 played, 49 and 48 kept
+        {42, 1, PageAdvice::WillNeed},
+        {49, 1, PageAdvice::DontNeed},
+    };
+    EXPECT_EQ(source.hints, expected);
+}
+
+TEST(PageCachePolicyTest, Update_NearLastFrame_ClipsReadahead)
+{
+    // Arrange
+    RecordingSource source;
+    PageCachePolicy policy(&source, testConfig());
+
+    // Act
+    for (std::int64_t frame = FRAMES - 6; frame < FRAMES; frame++) {
+        policy.update(frame);
+    }
+
+    // Assert
+    for (const Hint& hint : source.hints) {
+        EXPECT_LE(hint.first + hint.count, FRAMES);
+    }
+    EXPECT_EQ(policy.stats().readahead_bytes, 2 * FRAME_BYTES); // only frames 98 and 99 exist ahead of 97
+}
@@ -0,0 +1,190 @@
+/*
+ * ParallelFileReaderTests.cpp
+ *
+ * Unit tests for chunked parallel positional reads and the PosAndVel frame
+ * source built on them.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source_factory.hpp"
+#include "data/parallel_file_reader.hpp"
+#include "data/pread_frame_source.hpp"
+#include "data/thread_pool.hpp"
+
+namespace
+{
+
+constexpr std::int64_t PARTICLES = 3000; // 48000 bytes per stream: many 4 KiB chunks, none aligned to the frame
+constexpr std::int64_t FRAMES = 5;
+constexpr std::uint64_t SMALL_CHUNK_BYTES = 4096;
+
+glm::vec4 valueAt(std::int64_t frame, int stream, std::int64_t i)
+{
+    return glm::vec4(frame * 1000.0f + i, stream, -static_cast<float>(i), static_cast<float>(i % 4));
+}
+
+std::vector<glm::vec4> expectedStream(std::int64_t frame, int stream)
+{
+    std::vector<glm::vec4> values(PARTICLES);
+    for (std::int64_t i = 0; i < PARTICLES; i++) {
+        values[i] = valueAt(frame, stream, i);
+    }
+    return values;
+}
+
+} // namespace
+
+class ParallelFileReaderTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::ofstream out(filePath, std::ios::binary);
+        for (std::int64_t frame = 0; frame < FRAMES; frame++) {
+            for (int stream = 0; stream < 2; stream++) {
+                std::vector<glm::vec4> values = expectedStream(frame, stream);
+                out.write(reinterpret_cast<const char*>(values.data()), sizeof(glm::vec4) * PARTICLES);
+            }
+        }
+    }
+
+    void TearDown() override
+    {
+        std::remove(filePath.c_str());
+    }
+
+    const std::string filePath = "/tmp/test_ParallelFileReader_PosAndVel";
+};
+
+TEST_F(ParallelFileReaderTest, Open_MissingFile_Fails)
+{
+    // Arrange
+    ParallelFileReader file;
+
+    // Act
+    bool opened = file.open("/tmp/test_ParallelFileReader_missing");
+
+    // Assert
+    EXPECT_FALSE(opened);
+    EXPECT_FALSE(file.isOpen());
+}
+
+TEST_F(ParallelFileReaderTest, Read_UnalignedRangeOverManyChunks_MatchesFile)
+{
+    // Arrange - velocities of frame 2 start mid-chunk and span a dozen chunks
+    ParallelFileReader file(SMALL_CHUNK_BYTES);
+    ASSERT_TRUE(file.open(filePath));
+    ThreadPool pool(4);
+    std::vector<glm::vec4> destination(PARTICLES);
+    const std::uint64_t offset = (2 * 2 + 1) * sizeof(glm::vec4) * PARTICLES;
+
+    // Act
+    bool ok = file.read(offset, sizeof(glm::vec4) * PARTICLES, destination.data(), &pool);
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(destination, expectedStream(2, 1));
+}
+
+TEST_F(ParallelFileReaderTest, Read_PastEndOfFile_Fails)
+{
+    // Arrange
+    ParallelFileReader file(SMALL_CHUNK_BYTES);
+    ASSERT_TRUE(file.open(filePath));
+    ThreadPool pool(2);
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    bool ok = file.read(file.size() - 16, sizeof(glm::vec4) * PARTICLES, destination.data(), &pool);
+
+    // Assert
+    EXPECT_FALSE(ok);
+}
+
+TEST_F(ParallelFileReaderTest, PreadSource_ReadsSameFramesAsMappedSource)
+{
+    // Arrange
+    PreadFrameSource pread_source(filePath, PARTICLES, 4, SMALL_CHUNK_BYTES);
+    std::unique_ptr<FrameSource> mapped_source = openFrameSource(filePath, PARTICLES);
+    ASSERT_TRUE(pread_source.isOpen());
+    ASSERT_NE(mapped_source, nullptr);
+    std::vector<glm::vec4> from_pread(PARTICLES);
+    std::vector<glm::vec4> from_mapping(PARTICLES);
+
+    // Act & Assert
+    EXPECT_EQ(pread_source.frameCount(), FRAMES);
+    EXPECT_EQ(pread_source.readThreads(), 4u);
+    for (std::int64_t frame = 0; frame < FRAMES; frame++) {
+        ASSERT_TRUE(pread_source.readPositions(frame, from_pread.data()));
+        ASSERT_TRUE(mapped_source->readPositions(frame, from_mapping.data()));
+        EXPECT_EQ(from_pread, from_mapping) << "frame " << frame;
+        ASSERT_TRUE(pread_source.readVelocities(frame, from_pread.data()));
+        EXPECT_EQ(from_pread, expectedStream(frame, 1)) << "frame " << frame;
+    }
+    EXPECT_FALSE(pread_source.readPositions(FRAMES, from_pread.data()));
+}
+
+TEST_F(ParallelFileReaderTest, OpenFrameSource_WithReadThreads_UsesPositionalReads)
+{
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(filePath, PARTICLES, FrameReadOptions{2});
+
+    // Assert - nothing is mapped, frames are read into the caller's buffer
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->mappedPositions(0), nullptr);
+    std::vector<glm::vec4> positions(PARTICLES);
+    ASSERT_TRUE(source->readPositions(4, positions.data()));
+    EXPECT_EQ(positions, expectedStream(4, 0));
+}
+
+TEST_F(ParallelFileReaderTest, PreadSource_AppendedFrame_AppearsAfterRefresh)
+{
+    // Arrange
+    PreadFrameSource source(filePath, PARTICLES, 2);
+    std::ofstream out(filePath, std::ios::binary | std::ios::app);
+    std::vector<glm::vec4> frame(2 * PARTICLES, glm::vec4(7.0f));
+    out.write(reinterpret_cast<const char*>(frame.data()), sizeof(glm::vec4) * frame.size());
+    out.close();
+
+    // Act
+    std::int64_t count = source.refreshFrameCount();
+
+    // Assert
+    EXPECT_EQ(count, FRAMES + 1);
+}
+
+TEST_F(ParallelFileReaderTest, ReadPositionsBatch_CancelledRead_IsSkipped)
+{
+    // Arrange
+    PreadFrameSource pread_source(filePath, PARTICLES, 2, SMALL_CHUNK_BYTES);
+    std::unique_ptr<FrameSource> mapped_source = openFrameSource(filePath, PARTICLES);
+    ASSERT_NE(mapped_source, nullptr);
+    std::atomic<bool> cancelled{true};
+    std::atomic<bool> wanted{false};
+    std::vector<glm::vec4> first(PARTICLES);
+    std::vector<glm::vec4> second(PARTICLES);
+
+    const std::vector<const FrameSource*> sources = {&pread_source, mapped_source.get()};
+    for (const FrameSource* source : sources) {
+        FrameRead reads[] = {{1, first.data(), false, &cancelled}, {2, second.data(), false, &wanted}};
+
+        // Act
+        source->readPositionsBatch(reads, 2);
+
+        // Assert
+        EXPECT_FALSE(reads[0].ok);
+        ASSERT_TRUE(reads[1].ok);
+        EXPECT_EQ(second, expectedStream(2, 0));
+    }
+}
@@ -6,6 +6,7 @@
  */
 
 // Include glad first to avoid OpenGL header conflicts
+#include <cstdint>
 #include <vector>
 
 #include <glad/glad.h>
@@ -125,6 +126,19 @@ TEST_F(ParticleTest, CustomConstructor_CopiesTranslationData)
     EXPECT_EQ(p.translations[0], glm::vec4(1.0f, 2.0f, 3.0f, 4.0f));
 }
 
+TEST_F(ParticleTest, CustomConstructor_DoesNotAllocateVelocities)
+{
+    // Arrange
+    long N = 5;
+    std::vector<glm::vec4> trans(N);
+
+    // Act
+    Particle p(N, trans.data());
+
+    // Assert - velocities are loaded on demand
+    EXPECT_TRUE(p.velocities.empty());
+}
+
 // ============================================
 // changeTranslations Tests
 // ============================================
@@ -548,3 +562,258 @@ TEST_F(ParticleTest, DefaultCube_CubeIsNotEmpty)
     EXPECT_TRUE(has_varying_y) << "All particles have the same Y coordinate";
     EXPECT_TRUE(has_varying_z) << "All particles have the same Z coordinate";
 }
+
+// ============================================
+// viewTranslations Tests
+// ============================================
+
+TEST_F(ParticleTest, ViewTranslations_UsesExternalDataWithoutCopy)
+{
+    // Arrange
+    Particle p;
+    std::vector<glm::vec4> external(10, glm::vec4(1.0f, 2.0f, 3.0f, 0.0f));
+
+    // Act
+    p.viewTranslations(10, external.data());
+
+    // Assert
+    EXPECT_EQ(p.translationData(), external.data());
+}
+
+TEST_F(ParticleTest, ViewTranslations_UpdatesCount)
+{
+    // Arrange
+    Particle p;
+    std::vector<glm::vec4> external(10);
+
+    // Act
+    p.viewTranslations(10, external.data());
+
+    // Assert
+    EXPECT_EQ(p.n, 10);
+}
+
+TEST_F(ParticleTest, ChangeTranslations_AfterView_SwitchesBackToInternalStorage)
+{
+    // Arrange
+    Particle p;
+    std::vector<glm::vec4> external(10);
+    std::vector<glm::vec4> copied(5);
+    p.viewTranslations(10, external.data());
+
+    // Act
+    p.changeTranslations(5, copied.data());
+
+    // Assert
+    EXPECT_EQ(p.translationData(), p.translations.data());
+}
+
+TEST_F(ParticleTest, DetachTranslations_CopiesExternalData)
+{
+    // Arrange
+    Particle p;
+    glm::vec4 expected(4.0f, 5.0f, 6.0f, 1.0f);
+    std::vector<glm::vec4> external(3, expected);
+    p.viewTranslations(3, external.data());
+
+    // Act
+    p.detachTranslations();
+    external.assign(3, glm::vec4(0.0f));
+
+    // Assert
+    EXPECT_EQ(p.translations[2], expected);
+}
+
+TEST_F(ParticleTest, DrawInstances_WithinLimit_IssuesOneDraw)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+
+    // Act
+    p.drawInstances();
+
+    // Assert
+    EXPECT_EQ(MockOpenGL::drawInstanceCounts, std::vector<GLsizei>({7}));
+    EXPECT_EQ(MockOpenGL::attribPointerOffsets, std::vector<std::uintptr_t>({0}));
+}
+
+TEST_F(ParticleTest, DrawInstances_AboveLimit_SplitsIntoSlices)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+
+    // Act
+    p.drawInstances(3);
+
+    // Assert - each draw starts its attribute at its own slice of the instance buffer
+    EXPECT_EQ(MockOpenGL::drawInstanceCounts, std::vector<GLsizei>({3, 3, 1}));
+    EXPECT_EQ(MockOpenGL::attribPointerOffsets,
+              std::vector<std::uintptr_t>({0, 3 * sizeof(glm::vec4), 6 * sizeof(glm::vec4)}));
+}
+
+// ============================================
+// Instance Upload Tests
+// ============================================
+
+TEST_F(ParticleTest, PushVBO_UnchangedTranslations_UploadsOnce)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+
+    // Act
+    p.pushVBO();
+    p.pushVBO();
+
+    // Assert
+    EXPECT_EQ(MockOpenGL::bufferSubDataCalls, 1);
+}
+
+TEST_F(ParticleTest, ChangeTranslations_SameOrSmallerCount_KeepsInstanceBuffer)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+    p.pushVBO();
+    const GLuint buffer = p.instanceVBO;
+
+    // Act
+    p.changeTranslations(7, positions.data());
+    p.pushVBO();
+    p.changeTranslations(5, positions.data());
+    p.pushVBO();
+
+    // Assert - uploaded each time into the buffer the constructor allocated
+    EXPECT_EQ(MockOpenGL::genBuffersCalls, 1);
+    EXPECT_EQ(p.instanceVBO, buffer);
+    EXPECT_EQ(MockOpenGL::bufferSubDataCalls, 3);
+}
+
+TEST_F(ParticleTest, ViewTranslations_LargerCount_GrowsInstanceBufferOnPush)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(10);
+    Particle p(7, positions.data());
+    p.pushVBO();
+
+    // Act
+    p.viewTranslations(10, positions.data());
+    p.pushVBO();
+
+    // Assert
+    EXPECT_EQ(MockOpenGL::genBuffersCalls, 2);
+}
+
+// ============================================
+// Persistently Mapped Ring Tests
+// ============================================
+
+class PersistentParticleTest : public ParticleTest
+{
+  protected:
+    void SetUp() override
+    {
+        ParticleTest::SetUp();
+        MockOpenGL::enableBufferStorage();
+    }
+
+    /*
+     * The positions of `region` in the mapped ring of a 7-particle buffer.
+     */
+    static const glm::vec4* regionData(int region)
+    {
+        return reinterpret_cast<const glm::vec4*>(MockOpenGL::mappedStorage.data()) + region * 7;
+    }
+
+    static constexpr std::uintptr_t REGION_BYTES = 7 * sizeof(glm::vec4);
+};
+
+TEST_F(PersistentParticleTest, PushVBO_ChangedTranslations_WriteTheNextRegion)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+
+    // Act - four uploads, each followed by a draw
+    for (int frame = 1; frame <= 4; frame++) {
+        positions.assign(7, glm::vec4(static_cast<float>(frame)));
+        p.changeTranslations(7, positions.data());
+        p.pushVBO();
+        p.drawInstances();
+    }
+
+    // Assert - regions 1, 2, 0, 1 in turn, copied into the mapping rather than uploaded
+    EXPECT_EQ(MockOpenGL::bufferStorageCalls, 1);
+    EXPECT_EQ(MockOpenGL::mappedStorage.size(), 3 * REGION_BYTES);
+    EXPECT_EQ(MockOpenGL::bufferDataCalls, 0);
+    EXPECT_EQ(MockOpenGL::bufferSubDataCalls, 0);
+    EXPECT_EQ(MockOpenGL::attribPointerOffsets,
+              std::vector<std::uintptr_t>({REGION_BYTES, 2 * REGION_BYTES, 0, REGION_BYTES}));
+    EXPECT_EQ(regionData(2)[6], glm::vec4(2.0f));
+    EXPECT_EQ(regionData(0)[6], glm::vec4(3.0f));
+    EXPECT_EQ(regionData(1)[6], glm::vec4(4.0f));
+}
+
+TEST_F(PersistentParticleTest, DrawInstances_FencesRegion_WaitedOnOnlyWhenReused)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+
+    // Act - the first three uploads find their regions unfenced; the fourth reuses the first's
+    for (int frame = 0; frame < 4; frame++) {
+        p.changeTranslations(7, positions.data());
+        p.pushVBO();
+        p.drawInstances();
+    }
+
+    // Assert - one fence per draw, and the waited one is deleted
+    EXPECT_EQ(MockOpenGL::fenceSyncCalls, 4);
+    EXPECT_EQ(MockOpenGL::clientWaitSyncCalls, 1);
+    EXPECT_EQ(MockOpenGL::liveFences.size(), 3u);
+}
+
+TEST_F(PersistentParticleTest, PushVBO_UnchangedTranslations_CopiesOnce)
+{
+    // Arrange
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+
+    // Act
+    p.pushVBO();
+    p.drawInstances();
+    p.pushVBO();
+    p.drawInstances();
+
+    // Assert - both draws read the region written by the first push
+    EXPECT_EQ(MockOpenGL::attribPointerOffsets, std::vector<std::uintptr_t>({REGION_BYTES, REGION_BYTES}));
+}
+
+TEST_F(PersistentParticleTest, PushVBO_FenceWaitFails_FallsBackToOrphaning)
+{
+    // Arrange - three draws fence every region
+    std::vector<glm::vec4> positions(7);
+    Particle p(7, positions.data());
+    for (int frame = 0; frame < 3; frame++) {
+        p.changeTranslations(7, positions.data());
+        p.pushVBO();
+        p.drawInstances();
+    }
+    MockOpenGL::mockClientWaitStatus = GL_WAIT_FAILED;
+    MockOpenGL::attribPointerOffsets.clear();
+
+    // Act
+    p.changeTranslations(7, positions.data());
+    p.pushVBO();
+    p.drawInstances();
+    p.changeTranslations(7, positions.data());
+    p.pushVBO();
+
+    // Assert - uploads go through fresh orphaned storage and the ring is not rebuilt
+    EXPECT_EQ(MockOpenGL::bufferStorageCalls, 1);
+    EXPECT_EQ(MockOpenGL::bufferSubDataCalls, 2);
+    EXPECT_EQ(MockOpenGL::attribPointerOffsets, std::vector<std::uintptr_t>({0}));
+    EXPECT_TRUE(MockOpenGL::liveFences.empty());
+}
@@ -0,0 +1,196 @@
+/*
+ * QuantizedCodecTests.cpp
+ *
+ * Unit tests for the 16-bit fixed-point frame encoding.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/quantized_codec.hpp"
+
+namespace
+{
+
+/*
+ * Deterministic frame spanning a few hundred units with every type code the
+ * shader knows. An odd count exercises the scalar tail after the SIMD loop.
+ */
+std::vector<glm::vec4> makeFrame(long n)
+{
+    std::vector<glm::vec4> frame(n);
+    for (long i = 0; i < n; i++) {
+        const float type = (i % 5 == 4) ? 500.0f : static_cast<float>(i % 4);
+        frame[i] = glm::vec4(std::sin(i * 0.37f) * 250.0f, i * 0.813f - 40.0f, std::cos(i * 1.1f) * 3.0f, type);
+    }
+    return frame;
+}
+
+float distance(const glm::vec4& a, const glm::vec4& b)
+{
+    const float dx = a.x - b.x;
+    const float dy = a.y - b.y;
+    const float dz = a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+std::vector<unsigned char> encode(const std::vector<glm::vec4>& frame, bool with_type)
+{
+    const long n = static_cast<long>(frame.size());
+    std::vector<unsigned char> block(quantized::blockBytes(n, with_type));
+    quantized::encodeBlock(frame.data(), n, with_type, block.data());
+    return block;
+}
+
+} // namespace
+
+TEST(QuantizedCodecTest, BlockBytes_IsPaddedAndSmallerThanRaw)
+{
+    // Act
+    std::uint64_t bytes = quantized::blockBytes(1000, true);
+
+    // Assert
+    EXPECT_EQ(bytes % 16, 0u);
+    EXPECT_LT(bytes * 2, sizeof(glm::vec4) * 1000);
+}
+
+TEST(QuantizedCodecTest, RoundTrip_StaysWithinDocumentedBound)
+{
+    // Arrange
+    const long n = 1003;
+    std::vector<glm::vec4> frame = makeFrame(n);
+    std::vector<unsigned char> block = encode(frame, true);
+    std::vector<glm::vec4> decoded(n);
+
+    // Act
+    ASSERT_TRUE(quantized::decodeBlock(block.data(), block.size(), n, true, decoded.data()));
+
+    // Assert
+    const float bound = quantized::maxPositionError(block.data());
+    for (long i = 0; i < n; i++) {
+        ASSERT_LE(distance(decoded[i], frame[i]), bound) << "particle " << i;
+    }
+}
+
+TEST(QuantizedCodecTest, RoundTrip_BoxFarFromOrigin_StaysWithinBound)
+{
+    // Arrange - at 3 * 10^4 float32 spacing (0.002) is coarser than the 16-bit step of a 100-unit box
+    const long n = 1003;
+    std::vector<glm::vec4> frame = makeFrame(n);
+    for (glm::vec4& p : frame) {
+        p = glm::vec4(3.0e4f + p.x * 0.2f, -3.0e4f + p.y * 0.2f, 1.5e4f + p.z * 0.2f, p.w);
+    }
+    std::vector<unsigned char> block = encode(frame, true);
+    std::vector<glm::vec4> decoded(n);
+
+    // Act
+    ASSERT_TRUE(quantized::decodeBlock(block.data(), block.size(), n, true, decoded.data()));
+
+    // Assert - the half-step grid alone would not cover the rounding of origin + q * step
+    const float bound = quantized::maxPositionError(block.data());
+    float worst = 0.0f;
+    for (long i = 0; i < n; i++) {
+        worst = std::max(worst, distance(decoded[i], frame[i]));
+    }
+    EXPECT_LE(worst, bound);
+    EXPECT_LT(bound, 0.01f);
+}
+
+TEST(QuantizedCodecTest, RoundTrip_PreservesTypeCodes)
+{
+    // Arrange
+    const long n = 11;
+    std::vector<glm::vec4> frame = makeFrame(n);
+    std::vector<unsigned char> block = encode(frame, true);
+    std::vector<glm::vec4> decoded(n);
+
+    // Act
+    quantized::decodeBlock(block.data(), block.size(), n, true, decoded.data());
+
+    // Assert
+    for (long i = 0; i < n; i++) {
+        EXPECT_EQ(decoded[i].w, frame[i].w) << "particle " << i;
+    }
+}
+
+TEST(QuantizedCodecTest, Decode_WithoutTypePlane_ZeroesW)
+{
+    // Arrange
+    const long n = 8;
+    std::vector<glm::vec4> frame = makeFrame(n);
+    std::vector<unsigned char> block = encode(frame, false);
+    std::vector<glm::vec4> decoded(n, glm::vec4(9.0f));
+
+    // Act
+    quantized::decodeBlock(block.data(), block.size(), n, false, decoded.data());
+
+    // Assert
+    for (const auto& value : decoded) {
+        EXPECT_EQ(value.w, 0.0f);
+    }
+}
+
+TEST(QuantizedCodecTest, RoundTrip_FlatAxis_IsExact)
+{
+    // Arrange
+    std::vector<glm::vec4> frame(6, glm::vec4(1.0f, 2.5f, -7.0f, 1.0f));
+    frame[3].x = 4.0f;
+    std::vector<unsigned char> block = encode(frame, true);
+    std::vector<glm::vec4> decoded(frame.size());
+
+    // Act
+    quantized::decodeBlock(block.data(), block.size(), static_cast<long>(frame.size()), true, decoded.data());
+
+    // Assert
+    for (const auto& value : decoded) {
+        EXPECT_EQ(value.y, 2.5f);
+        EXPECT_EQ(value.z, -7.0f);
+    }
+}
+
+TEST(QuantizedCodecTest, CanEncodeTypes_FractionalW_ReturnsFalse)
+{
+    // Arrange
+    std::vector<glm::vec4> frame = makeFrame(4);
+    frame[2].w = 1.5f;
+
+    // Act & Assert
+    EXPECT_FALSE(quantized::canEncodeTypes(frame.data(), 4));
+}
+
+TEST(QuantizedCodecTest, CanEncodeTypes_ShaderTypeCodes_ReturnsTrue)
+{
+    // Arrange
+    std::vector<glm::vec4> frame = makeFrame(10);
+
+    // Act & Assert
+    EXPECT_TRUE(quantized::canEncodeTypes(frame.data(), 10));
+}
+
+TEST(QuantizedCodecTest, AllFinite_InfiniteCoordinate_ReturnsFalse)
+{
+    // Arrange
+    std::vector<glm::vec4> frame = makeFrame(4);
+    frame[3].x = std::numeric_limits<float>::infinity();
+
+    // Act & Assert
+    EXPECT_FALSE(quantized::allFinite(frame.data(), 4));
+    EXPECT_TRUE(quantized::allFinite(frame.data(), 3));
+}
+
+TEST(QuantizedCodecTest, Decode_TruncatedBlock_ReturnsFalse)
+{
+    // Arrange
+    std::vector<glm::vec4> frame = makeFrame(16);
+    std::vector<unsigned char> block = encode(frame, true);
+    std::vector<glm::vec4> decoded(16);
+
+    // Act & Assert
+    EXPECT_FALSE(quantized::decodeBlock(block.data(), block.size() - 16, 16, true, decoded.data()));
+}
@@ -0,0 +1,152 @@
+/*
+ * ResidualCodecTests.cpp
+ *
+ * Unit tests for the lossless velocity-predictive frame codec.
+ */
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/residual_codec.hpp"
+#include "data/thread_pool.hpp"
+
+namespace
+{
+
+constexpr float DT = 0.05f;
+
+/*
+ * Particles on circular orbits; velocities are the exact derivative, so the
+ * prediction is close but not bit-identical to the next frame.
+ */
+void makeFrame(long frame, long n, std::vector<glm::vec4>& positions, std::vector<glm::vec4>& velocities)
+{
+    positions.resize(n);
+    velocities.resize(n);
+    for (long i = 0; i < n; i++) {
+        // Double precision keeps the synthetic orbits themselves smooth
+        const double radius = 10.0 + static_cast<double>(i % 97);
+        const double omega = 0.02 + 0.001 * static_cast<double>(i % 13);
+        const double angle = omega * DT * static_cast<double>(frame) + static_cast<double>(i);
+        const float type = static_cast<float>(i % 4);
+        positions[i] = glm::vec4(static_cast<float>(radius * std::cos(angle)),
+                                 static_cast<float>(radius * std::sin(angle)), 0.01f * i, type);
+        velocities[i] = glm::vec4(static_cast<float>(-radius * omega * std::sin(angle)),
+                                  static_cast<float>(radius * omega * std::cos(angle)), 0.0f, 0.0f);
+    }
+}
+
+} // namespace
+
+TEST(ResidualCodecTest, OrderedBits_PreservesFloatOrdering)
+{
+    // Arrange
+    const float values[] = {-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 3.0f, 1e30f};
+
+    // Act & Assert
+    for (int k = 0; k + 1 < 7; k++) {
+        EXPECT_LE(residual::orderedBits(values[k]), residual::orderedBits(values[k + 1]));
+        EXPECT_EQ(residual::fromOrderedBits(residual::orderedBits(values[k])), values[k]);
+    }
+}
+
+TEST(ResidualCodecTest, Zigzag_SmallDifferences_HaveFewBits)
+{
+    // Act & Assert
+    EXPECT_EQ(residual::zigzag(0u), 0u);
+    EXPECT_EQ(residual::zigzag(static_cast<std::uint32_t>(-1)), 1u);
+    EXPECT_EQ(residual::zigzag(1u), 2u);
+    EXPECT_EQ(residual::unzigzag(residual::zigzag(0x80000000u)), 0x80000000u);
+}
+
+TEST(ResidualCodecTest, RoundTrip_FirstFrame_IsBitExact)
+{
+    // Arrange
+    const long n = 301;
+    std::vector<glm::vec4> positions;
+    std::vector<glm::vec4> velocities;
+    makeFrame(0, n, positions, velocities);
+    std::vector<unsigned char> frame = residual::encodeFrame({}, positions.data(), velocities.data(), n);
+    std::vector<glm::vec4> decoded_positions(n);
+    std::vector<glm::vec4> decoded_velocities(n);
+
+    // Act
+    bool ok = residual::decodeFrame(frame.data(), frame.size(), {}, n, decoded_positions.data(),
+                                    decoded_velocities.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(decoded_positions, positions);
+    EXPECT_EQ(decoded_velocities, velocities);
+}
+
+TEST(ResidualCodecTest, RoundTrip_PredictedFrameWithPool_IsBitExact)
+{
+    // Arrange
+    const long n = 2000;
+    std::vector<glm::vec4> previous_positions;
+    std::vector<glm::vec4> previous_velocities;
+    std::vector<glm::vec4> positions;
+    std::vector<glm::vec4> velocities;
+    makeFrame(6, n, previous_positions, previous_velocities);
+    makeFrame(7, n, positions, velocities);
+    positions[5].x = std::numeric_limits<float>::quiet_NaN();
+    const residual::PredictionBase base{previous_positions.data(), previous_velocities.data(), DT};
+    std::vector<unsigned char> frame = residual::encodeFrame(base, positions.data(), velocities.data(), n);
+    std::vector<glm::vec4> decoded_positions(n);
+    std::vector<glm::vec4> decoded_velocities(n);
+    ThreadPool pool(3);
+
+    // Act
+    bool ok = residual::decodeFrame(frame.data(), frame.size(), base, n, decoded_positions.data(),
+                                    decoded_velocities.data(), &pool);
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_TRUE(std::isnan(decoded_positions[5].x));
+    decoded_positions[5].x = 0.0f;
+    positions[5].x = 0.0f;
+    EXPECT_EQ(decoded_positions, positions);
+    EXPECT_EQ(decoded_velocities, velocities);
+}
+
+TEST(ResidualCodecTest, Encode_SmoothMotion_IsMuchSmallerThanRaw)
+{
+    // Arrange
+    const long n = 4096;
+    std::vector<glm::vec4> previous_positions;
+    std::vector<glm::vec4> previous_velocities;
+    std::vector<glm::vec4> positions;
+    std::vector<glm::vec4> velocities;
+    makeFrame(10, n, previous_positions, previous_velocities);
+    makeFrame(11, n, positions, velocities);
+    const residual::PredictionBase base{previous_positions.data(), previous_velocities.data(), DT};
+
+    // Act
+    std::vector<unsigned char> frame = residual::encodeFrame(base, positions.data(), velocities.data(), n);
+
+    // Assert
+    EXPECT_LT(frame.size() * 2, 2 * n * sizeof(glm::vec4));
+}
+
+TEST(ResidualCodecTest, Decode_MalformedFrame_ReturnsFalse)
+{
+    // Arrange
+    const long n = 64;
+    std::vector<glm::vec4> positions;
+    std::vector<glm::vec4> velocities;
+    makeFrame(0, n, positions, velocities);
+    std::vector<unsigned char> frame = residual::encodeFrame({}, positions.data(), velocities.data(), n);
+    std::vector<glm::vec4> decoded_positions(n);
+    std::vector<glm::vec4> decoded_velocities(n);
+
+    // Act & Assert
+    EXPECT_FALSE(residual::decodeFrame(frame.data(), frame.size() - 1, {}, n, decoded_positions.data(),
+                                       decoded_velocities.data()));
+    EXPECT_FALSE(residual::decodeFrame(frame.data(), frame.size(), {}, n, decoded_positions.data(), nullptr));
+}
@@ -0,0 +1,149 @@
+/*
+ * RunSetupTests.cpp
+ *
+ * Unit tests for the GL-free RunSetup reader and the files of a run folder
+ * that the command-line tools open.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/container_format.hpp"
+#include "data/run_setup.hpp"
+
+class RunSetupTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    /*
+     * A RunSetup with every entry 1, except N, Dt and the body masses.
+     */
+    void writeRunSetup()
+    {
+        std::ofstream out(dir + "/RunSetup");
+        for (int entry = 0; entry < 20; entry++) {
+            out << "Entry" << entry << "=1\n";
+        }
+        out << "FractionEarthMassOfBody1=0.5\nFractionEarthMassOfBody2=0.8\n";
+        out << "FractionFeBody1=0.3\nFractionSiBody1=0.7\nFractionFeBody2=0.4\nFractionSiBody2=0.6\n";
+        out << "DampRateBody1=1\nDampRateBody2=1\nEnergyTargetBody1=1\nEnergyTargetBody2=1\n";
+        out << "N= 250000\n";
+        for (int entry = 0; entry < 6; entry++) {
+            out << "Time" << entry << "=1\n";
+        }
+        out << "Dt=0.002\nWriteToFile=1\nRecordRate=20\n";
+    }
+
+    const std::string dir = (std::filesystem::temp_directory_path() / "pv_run_setup_test").string();
+};
+
+TEST_F(RunSetupTest, Load_ValidFile_ReadsValuesInOrder)
+{
+    // Arrange
+    writeRunSetup();
+    RunSetup setup;
+
+    // Act
+    const bool loaded = setup.load(dir + "/RunSetup");
+
+    // Assert
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(setup.N, 250000);
+    EXPECT_FLOAT_EQ(setup.Dt, 0.002f);
+    EXPECT_EQ(setup.RecordRate, 20);
+    EXPECT_FLOAT_EQ(setup.InitialSpin2.w, 1.0f);
+}
+
+TEST_F(RunSetupTest, Load_MissingFile_KeepsPlaceholders)
+{
+    // Arrange
+    RunSetup setup;
+
+    // Act
+    const bool loaded = setup.load(dir + "/RunSetup");
+
+    // Assert
+    EXPECT_FALSE(loaded);
+    EXPECT_EQ(setup.N, 100);
+}
+
+TEST_F(RunSetupTest, TypeMasses_ScaleBodyMassByFraction)
+{
+    // Arrange
+    writeRunSetup();
+    RunSetup setup;
+    setup.load(dir + "/RunSetup");
+
+    // Act
+    const auto masses = setup.typeMasses();
+
+    // Assert
+    EXPECT_DOUBLE_EQ(masses[0], 0.5 * 0.3);
+    EXPECT_DOUBLE_EQ(masses[3], 0.8 * 0.6);
+    EXPECT_DOUBLE_EQ(masses[com_track::TYPE_SLOTS - 1], 0.0);
+}
+
+TEST_F(RunSetupTest, FilesFor_Folder_PrefersContainerOverPosAndVel)
+{
+    // Arrange
+    std::ofstream(dir + "/PosAndVel").put('x');
+    std::ofstream(dir + container::DEFAULT_FILE_NAME).put('x');
+
+    // Act
+    const run_setup::RunFiles files = run_setup::filesFor(dir);
+
+    // Assert
+    EXPECT_EQ(files.data, dir + container::DEFAULT_FILE_NAME);
+    EXPECT_EQ(files.setup, dir + "/RunSetup");
+    EXPECT_EQ(files.com, dir + "/COMFile");
+}
+
+TEST_F(RunSetupTest, FilesFor_FolderInFollowMode_PrefersGrowingPosAndVel)
+{
+    // Arrange
+    std::ofstream(dir + "/PosAndVel").put('x');
+    std::ofstream(dir + container::DEFAULT_FILE_NAME).put('x');
+
+    // Act
+    const run_setup::RunFiles files = run_setup::filesFor(dir, true);
+
+    // Assert
+    EXPECT_EQ(files.data, dir + "/PosAndVel");
+}
+
+TEST_F(RunSetupTest, FilesFor_FolderInFollowMode_KeepsContainerWithoutPosAndVel)
+{
+    // Arrange
+    std::ofstream(dir + container::DEFAULT_FILE_NAME).put('x');
+
+    // Act
+    const run_setup::RunFiles files = run_setup::filesFor(dir, true);
+
+    // Assert
+    EXPECT_EQ(files.data, dir + container::DEFAULT_FILE_NAME);
+}
+
+TEST_F(RunSetupTest, FilesFor_DataFile_UsesFilesNextToIt)
+{
+    // Act
+    const run_setup::RunFiles files = run_setup::filesFor(dir + "/PosAndVel.3");
+
+    // Assert
+    EXPECT_EQ(files.data, dir + "/PosAndVel.3");
+    EXPECT_EQ(files.setup, dir + "/RunSetup");
+}
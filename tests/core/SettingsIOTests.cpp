@@ -8,6 +8,7 @@
 // Include glad first to avoid OpenGL header conflicts
 #include <cstdio>
 #include <fstream>
+#include <vector>
 
 #include <glad/glad.h>
 #include <gtest/gtest.h>
@@ -15,6 +16,7 @@
 #include <glm/glm.hpp>
 
 #include "MockOpenGL.hpp"
+#include "data/container_writer.hpp"
 #include "particle.hpp"
 #include "settingsIO.hpp"
 
@@ -332,6 +334,101 @@ TEST_F(SettingsIOTest, GetFrames_WithInvalidFile_ReturnsOne)
     EXPECT_EQ(frames, 1);
 }
 
+// ============================================
+// Follow Mode Tests
+// ============================================
+
+TEST_F(SettingsIOTest, PollFollow_AppendedFrames_ExtendFrameCount)
+{
+    // Arrange
+    FrameReadOptions options;
+    options.follow = true;
+    SettingsIO settings(validPosPath, validStatsPath, validComPath, options);
+    settings.setFollow(true);
+    FILE* posFile = fopen(validPosPath, "ab");
+    ASSERT_NE(posFile, nullptr);
+    glm::vec4 value(7.0f);
+    for (int i = 0; i < 2 * 200; i++) {
+        fwrite(&value, sizeof(glm::vec4), 1, posFile);
+    }
+    fclose(posFile);
+
+    // Act
+    bool grew = settings.pollFollow();
+
+    // Assert
+    EXPECT_TRUE(grew);
+    EXPECT_EQ(settings.frames, 5);
+    ASSERT_NE(settings.getFramePositions(4), nullptr);
+    EXPECT_FLOAT_EQ(settings.getFramePositions(4)[0].x, 7.0f);
+}
+
+TEST_F(SettingsIOTest, PollFollow_PartialTrailingFrame_IsNotCounted)
+{
+    // Arrange
+    FrameReadOptions options;
+    options.follow = true;
+    SettingsIO settings(validPosPath, validStatsPath, validComPath, options);
+    settings.setFollow(true);
+    FILE* posFile = fopen(validPosPath, "ab");
+    ASSERT_NE(posFile, nullptr);
+    glm::vec4 value(7.0f);
+    for (int i = 0; i < 150; i++) { // positions and half of the velocities
+        fwrite(&value, sizeof(glm::vec4), 1, posFile);
+    }
+    fclose(posFile);
+
+    // Act
+    bool grew = settings.pollFollow();
+
+    // Assert
+    EXPECT_FALSE(grew);
+    EXPECT_EQ(settings.frames, 3);
+}
+
+TEST_F(SettingsIOTest, PollFollow_NotFollowing_IgnoresAppendedFrames)
+{
+    // Arrange
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+    FILE* posFile = fopen(validPosPath, "ab");
+    ASSERT_NE(posFile, nullptr);
+    glm::vec4 value(7.0f);
+    for (int i = 0; i < 200; i++) {
+        fwrite(&value, sizeof(glm::vec4), 1, posFile);
+    }
+    fclose(posFile);
+
+    // Act
+    bool grew = settings.pollFollow();
+
+    // Assert
+    EXPECT_FALSE(settings.isFollowing());
+    EXPECT_FALSE(grew);
+    EXPECT_EQ(settings.frames, 3);
+}
+
+TEST_F(SettingsIOTest, SetFollow_ConvertedContainer_DoesNotWatchIt)
+{
+    // Arrange - a container is complete once written, so there is nothing to follow
+    const std::string containerPath = "/tmp/test_SettingsIO_follow.pv2";
+    std::vector<glm::vec4> frame(100, glm::vec4(1.0f));
+    ContainerWriter writer;
+    ASSERT_TRUE(writer.open(containerPath, 100, false));
+    ASSERT_TRUE(writer.appendFrame(frame.data(), nullptr));
+    ASSERT_TRUE(writer.finish());
+    FrameReadOptions options;
+    options.follow = true;
+    SettingsIO settings(containerPath, validStatsPath, validComPath, options);
+
+    // Act
+    settings.setFollow(true);
+
+    // Assert
+    EXPECT_EQ(settings.frames, 1);
+    EXPECT_FALSE(settings.isFollowing());
+    std::remove(containerPath.c_str());
+}
+
 // ============================================
 // readPosVelFile Tests
 // ============================================
@@ -436,6 +533,120 @@ TEST_F(SettingsIOTest, ReadPosVelFile_WithMissingFile_HandlesGracefully)
     EXPECT_GT(settings.errorCount, initialErrorCount);
 }
 
+TEST_F(SettingsIOTest, GetFramePositions_ReturnsPointerIntoRequestedFrame)
+{
+    // Arrange
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+
+    // Act
+    const glm::vec4* pos = settings.getFramePositions(2);
+
+    // Assert - First particle in frame 2 should be (0, 2, 4, 1)
+    ASSERT_NE(pos, nullptr);
+    EXPECT_FLOAT_EQ(pos[0].y, 2.0f);
+    EXPECT_FLOAT_EQ(pos[0].z, 4.0f);
+}
+
+TEST_F(SettingsIOTest, GetFramePositions_VelocitiesFollowPositions)
+{
+    // Arrange
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+
+    // Act
+    const glm::vec4* pos = settings.getFramePositions(0);
+
+    // Assert - Velocity of particle 10 is (1.0, 2.0, 3.0)
+    ASSERT_NE(pos, nullptr);
+    EXPECT_FLOAT_EQ(pos[settings.N + 10].y, 2.0f);
+}
+
+TEST_F(SettingsIOTest, GetFramePositions_ClampsFrameToMax)
+{
+    // Arrange
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+    const glm::vec4* last = settings.getFramePositions(2);
+
+    // Act
+    const glm::vec4* clamped = settings.getFramePositions(10);
+
+    // Assert
+    EXPECT_EQ(clamped, last);
+}
+
+TEST_F(SettingsIOTest, GetFramePositions_WithMissingFile_ReturnsNull)
+{
+    // Arrange
+    SettingsIO settings(invalidPath, validStatsPath, validComPath);
+
+    // Act
+    const glm::vec4* pos = settings.getFramePositions(0);
+
+    // Assert
+    EXPECT_EQ(pos, nullptr);
+}
+
+// ============================================
+// streamPosFrame Tests
+// ============================================
+
+TEST_F(SettingsIOTest, StreamPosFrame_PointsParticleAtMappedFrame)
+{
+    // Arrange
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+    Particle part;
+
+    // Act
+    settings.streamPosFrame(1, &part);
+
+    // Assert
+    EXPECT_EQ(part.translationData(), settings.getFramePositions(1));
+}
+
+TEST_F(SettingsIOTest, StreamPosFrame_SetsParticleCount)
+{
+    // Arrange
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+    Particle part;
+
+    // Act
+    settings.streamPosFrame(1, &part);
+
+    // Assert
+    EXPECT_EQ(part.n, 100);
+}
+
+TEST_F(SettingsIOTest, StreamPosFrame_FrameAlreadyShown_IsNotUploadedAgain)
+{
+    // Arrange
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+    Particle part;
+    settings.streamPosFrame(1, &part);
+    part.pushVBO();
+    MockOpenGL::bufferSubDataCalls = 0;
+
+    // Act
+    settings.streamPosFrame(1, &part);
+    part.pushVBO();
+    settings.streamPosFrame(2, &part);
+    part.pushVBO();
+
+    // Assert - only the frame change reached the instance buffer
+    EXPECT_EQ(MockOpenGL::bufferSubDataCalls, 1);
+}
+
+TEST_F(SettingsIOTest, StreamPosFrame_WithMissingFile_IncrementsErrorCount)
+{
+    // Arrange
+    SettingsIO settings(invalidPath, validStatsPath, validComPath);
+    Particle part;
+
+    // Act
+    settings.streamPosFrame(0, &part);
+
+    // Assert
+    EXPECT_EQ(settings.errorCount, 1);
+}
+
 // ============================================
 // Getter Method Tests
 // ============================================
@@ -592,3 +803,36 @@ TEST_F(SettingsIOTest, GetFrames_MultipleCallsReturnSameValue)
     // Assert
     EXPECT_EQ(frames1, frames2);
 }
+
+TEST_F(SettingsIOTest, GetCOM_EmptyComFile_UsesFramePositions)
+{
+    // Arrange - every test particle is type 1, so RunSetup's masses do not shift the centre
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+    glm::vec3 com(0.0f);
+
+    // Act
+    settings.getCOM(2, com);
+
+    // Assert - frame 2 averages (49.5, 51.5, 53.5), drawn at a quarter scale
+    EXPECT_FLOAT_EQ(com.x, 49.5f * 0.25f);
+    EXPECT_FLOAT_EQ(com.y, 51.5f * 0.25f);
+    EXPECT_FLOAT_EQ(com.z, 53.5f * 0.25f);
+}
+
+TEST_F(SettingsIOTest, GetCOM_ComFileEntry_IsUsedAsStored)
+{
+    // Arrange
+    std::ofstream comFile(validComPath, std::ios::binary);
+    const glm::vec4 entries[2] = {{4.0f, 8.0f, 12.0f, 0.0f}, {16.0f, 20.0f, 24.0f, 1.0f}};
+    comFile.write(reinterpret_cast<const char*>(entries), sizeof(entries));
+    comFile.close();
+    SettingsIO settings(validPosPath, validStatsPath, validComPath);
+    glm::vec3 com(0.0f);
+
+    // Act
+    settings.getCOM(1, com);
+
+    // Assert
+    EXPECT_TRUE(settings.checkCOM());
+    EXPECT_EQ(com, glm::vec3(4.0f, 5.0f, 6.0f));
+}
@@ -0,0 +1,348 @@
+/*
+ * ShardedFrameSourceTests.cpp
+ *
+ * Unit tests for shard manifests and ShardedFrameSource: time-sharded and
+ * particle-sharded datasets opened through openFrameSource() and SettingsIO.
+ */
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source_factory.hpp"
+#include "data/shard_manifest.hpp"
+#include "data/sharded_frame_source.hpp"
+#include "settingsIO.hpp"
+
+class ShardedFrameSourceTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    /*
+     * Particle `i` of frame `frame` on the dataset's timeline and particle
+     * range, so a value read back shows where it came from.
+     */
+    static glm::vec4 position(long frame, long i)
+    {
+        return glm::vec4(static_cast<float>(i), static_cast<float>(frame), 0.5f, 1.0f);
+    }
+
+    static glm::vec4 velocity(long frame, long i)
+    {
+        return glm::vec4(-static_cast<float>(i), static_cast<float>(frame) * 0.1f, 0.0f, 0.0f);
+    }
+
+    /*
+     * Writes a raw PosAndVel shard holding particles [first_particle,
+     * first_particle + particles) of frames [first_frame, first_frame + frames).
+     */
+    void writeShard(const std::string& name, long first_frame, long frames, long first_particle, long particles,
+                    bool append = false)
+    {
+        FILE* file = fopen((dir + "/" + name).c_str(), append ? "ab" : "wb");
+        ASSERT_NE(file, nullptr);
+        for (long frame = first_frame; frame < first_frame + frames; frame++) {
+            for (long i = first_particle; i < first_particle + particles; i++) {
+                glm::vec4 pos = position(frame, i);
+                fwrite(&pos, sizeof(pos), 1, file);
+            }
+            for (long i = first_particle; i < first_particle + particles; i++) {
+                glm::vec4 vel = velocity(frame, i);
+                fwrite(&vel, sizeof(vel), 1, file);
+            }
+        }
+        fclose(file);
+    }
+
+    void writeManifest(const std::string& text)
+    {
+        std::ofstream(manifestPath) << text;
+    }
+
+    static constexpr long PARTICLES = 6;
+    const std::string dir = "/tmp/test_Shards";
+    const std::string manifestPath = dir + "/PosAndVel.shards";
+};
+
+TEST_F(ShardedFrameSourceTest, ManifestParse_ValidText_ReadsLayoutAndResolvesPaths)
+{
+    // Arrange
+    const std::string text = "PVSHARDS 1\n"
+                             "# two GPUs\n"
+                             "layout particles\n"
+                             "shard gpu0/PosAndVel 100\n"
+                             "\n"
+                             "shard /data/gpu1/PosAndVel   # absolute\n";
+    shard_manifest::Manifest manifest;
+    std::string error;
+
+    // Act
+    bool ok = shard_manifest::parse(text, "/runs/a", manifest, error);
+
+    // Assert
+    ASSERT_TRUE(ok) << error;
+    EXPECT_EQ(manifest.layout, shard_manifest::Layout::Particles);
+    ASSERT_EQ(manifest.shards.size(), 2u);
+    EXPECT_EQ(manifest.shards[0].path, "/runs/a/gpu0/PosAndVel");
+    EXPECT_EQ(manifest.shards[0].particle_count, 100);
+    EXPECT_EQ(manifest.shards[1].path, "/data/gpu1/PosAndVel");
+    EXPECT_EQ(manifest.shards[1].particle_count, 0);
+}
+
+TEST_F(ShardedFrameSourceTest, ManifestParse_MalformedText_FailsWithMessage)
+{
+    // Arrange
+    const std::vector<std::string> texts = {
+        "shard PosAndVel\n",                 // no magic line
+        "PVSHARDS 2\nshard PosAndVel\n",     // unknown version
+        "PVSHARDS 1\nlayout sideways\n",     // unknown layout
+        "PVSHARDS 1\nshard PosAndVel 12x\n", // bad particle count
+        "PVSHARDS 1\nlayout time\n",         // no shards
+        "PVSHARDS 1\nsegment PosAndVel\n",   // unknown keyword
+    };
+
+    for (const std::string& text : texts) {
+        shard_manifest::Manifest manifest;
+        std::string error;
+
+        // Act
+        bool ok = shard_manifest::parse(text, dir, manifest, error);
+
+        // Assert
+        EXPECT_FALSE(ok) << text;
+        EXPECT_FALSE(error.empty()) << text;
+    }
+}
+
+TEST_F(ShardedFrameSourceTest, TimeShards_Open_JoinFramesIntoOneTimeline)
+{
+    // Arrange - a restart after frame 3 wrote a second segment
+    writeShard("PosAndVel.0", 0, 4, 0, PARTICLES);
+    writeShard("PosAndVel.1", 4, 3, 0, PARTICLES);
+    writeManifest("PVSHARDS 1\nlayout time\nshard PosAndVel.0\nshard PosAndVel.1\n");
+    std::vector<glm::vec4> destination(PARTICLES);
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, PARTICLES);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->particleCount(), PARTICLES);
+    EXPECT_EQ(source->frameCount(), 7);
+    for (long frame : {0L, 3L, 4L, 6L}) {
+        ASSERT_TRUE(source->readPositions(frame, destination.data())) << frame;
+        EXPECT_EQ(destination[2], position(frame, 2)) << frame;
+        const glm::vec4* mapped = source->mappedPositions(frame);
+        ASSERT_NE(mapped, nullptr) << frame;
+        EXPECT_EQ(mapped[5], position(frame, 5)) << frame;
+    }
+    ASSERT_TRUE(source->readVelocities(5, destination.data()));
+    EXPECT_EQ(destination[1], velocity(5, 1));
+    EXPECT_FALSE(source->readPositions(7, destination.data()));
+}
+
+TEST_F(ShardedFrameSourceTest, TimeShards_DifferentParticleCounts_AreRefused)
+{
+    // Arrange
+    writeShard("PosAndVel.0", 0, 2, 0, PARTICLES);
+    writeShard("PosAndVel.1", 2, 2, 0, PARTICLES + 1);
+    writeManifest("PVSHARDS 1\nshard PosAndVel.0\nshard PosAndVel.1 " + std::to_string(PARTICLES + 1) + "\n");
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, PARTICLES);
+
+    // Assert
+    EXPECT_EQ(source, nullptr);
+}
+
+TEST_F(ShardedFrameSourceTest, TimeShards_LastShardGrows_RefreshExtendsTimeline)
+{
+    // Arrange
+    writeShard("PosAndVel.0", 0, 3, 0, PARTICLES);
+    writeShard("PosAndVel.1", 3, 1, 0, PARTICLES);
+    writeManifest("PVSHARDS 1\nshard PosAndVel.0\nshard PosAndVel.1\n");
+    FrameReadOptions options;
+    options.follow = true;
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, PARTICLES, options);
+    ASSERT_NE(source, nullptr);
+    writeShard("PosAndVel.1", 4, 2, 0, PARTICLES, true);
+
+    // Act
+    std::int64_t frames = source->refreshFrameCount();
+
+    // Assert
+    EXPECT_EQ(frames, 6);
+    EXPECT_EQ(source->followPath(), dir + "/PosAndVel.1");
+    std::vector<glm::vec4> destination(PARTICLES);
+    ASSERT_TRUE(source->readPositions(5, destination.data()));
+    EXPECT_EQ(destination[0], position(5, 0));
+}
+
+TEST_F(ShardedFrameSourceTest, ParticleShards_ReadPositions_AssembleSlicesInPlace)
+{
+    // Arrange - three GPUs with uneven particle ranges
+    writeShard("gpu0", 0, 3, 0, 2);
+    writeShard("gpu1", 0, 3, 2, 3);
+    writeShard("gpu2", 0, 3, 5, 1);
+    writeManifest("PVSHARDS 1\nlayout particles\nshard gpu0 2\nshard gpu1 3\nshard gpu2 1\n");
+    std::vector<glm::vec4> positions(PARTICLES);
+    std::vector<glm::vec4> velocities(PARTICLES);
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, 0);
+    ASSERT_NE(source, nullptr);
+    bool positions_ok = source->readPositions(2, positions.data());
+    bool velocities_ok = source->readVelocities(2, velocities.data());
+
+    // Assert
+    EXPECT_EQ(source->particleCount(), PARTICLES);
+    EXPECT_EQ(source->frameCount(), 3);
+    ASSERT_TRUE(positions_ok);
+    ASSERT_TRUE(velocities_ok);
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_EQ(positions[i], position(2, i)) << i;
+        EXPECT_EQ(velocities[i], velocity(2, i)) << i;
+    }
+    EXPECT_EQ(source->mappedPositions(2), nullptr);
+    EXPECT_EQ(source->storedFrameBytes(0), 2 * sizeof(glm::vec4) * PARTICLES);
+}
+
+TEST_F(ShardedFrameSourceTest, ParticleShards_OneShardBehind_FrameCountIsShortestShard)
+{
+    // Arrange
+    writeShard("gpu0", 0, 5, 0, 3);
+    writeShard("gpu1", 0, 4, 3, 3);
+    writeManifest("PVSHARDS 1\nlayout particles\nshard gpu0 3\nshard gpu1 3\n");
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, 0);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->frameCount(), 4);
+    std::vector<glm::vec4> destination(PARTICLES);
+    EXPECT_FALSE(source->readPositions(4, destination.data()));
+}
+
+TEST_F(ShardedFrameSourceTest, ParticleShards_ReadPreviewPositions_RunCrossesShards)
+{
+    // Arrange - one preview run holds every particle, so it spans all three shards
+    writeShard("gpu0", 0, 3, 0, 2);
+    writeShard("gpu1", 0, 3, 2, 3);
+    writeShard("gpu2", 0, 3, 5, 1);
+    writeManifest("PVSHARDS 1\nlayout particles\nshard gpu0 2\nshard gpu1 3\nshard gpu2 1\n");
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, 0);
+    ASSERT_NE(source, nullptr);
+    std::vector<glm::vec4> preview(previewParticleCount(PARTICLES, 2));
+
+    // Act
+    const bool ok = source->readPreviewPositions(1, 2, preview.data());
+
+    // Assert
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(preview.size(), static_cast<std::size_t>(PARTICLES));
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_EQ(preview[i], position(1, i)) << i;
+    }
+}
+
+TEST_F(ShardedFrameSourceTest, ParticleShards_DifferentOrigins_AreRefused)
+{
+    // Arrange - two recentred double shards, each far from (0, 0, 0) in its own place
+    std::vector<std::unique_ptr<FrameSource>> shards;
+    std::vector<std::string> paths;
+    for (int s = 0; s < 2; s++) {
+        const std::string path = dir + "/gpu" + std::to_string(s);
+        const double centre = 1.0e6 * (s + 1);
+        std::vector<double> frame(4 * 2 * 3, 0.0);
+        for (int i = 0; i < 3; i++) {
+            frame[4 * i] = centre + i;
+        }
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size() * 8));
+        MappedFile mapping;
+        ASSERT_TRUE(mapping.open(path));
+        shards.push_back(makeRawFrameSource(std::move(mapping), 3, ElementType::Float64, true));
+        paths.push_back(path);
+    }
+    ASSERT_NE(shards[0]->positionOrigin(), shards[1]->positionOrigin());
+
+    // Act
+    ShardedFrameSource source(shard_manifest::Layout::Particles, std::move(shards), paths);
+
+    // Assert
+    EXPECT_FALSE(source.isValid());
+}
+
+TEST_F(ShardedFrameSourceTest, ParticleShards_ReadPositionsBatch_AssemblesEveryFrame)
+{
+    // Arrange
+    writeShard("gpu0", 0, 4, 0, 4);
+    writeShard("gpu1", 0, 4, 4, 2);
+    writeManifest("PVSHARDS 1\nlayout particles\nshard gpu0 4\nshard gpu1 2\n");
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, 0);
+    ASSERT_NE(source, nullptr);
+    std::vector<std::vector<glm::vec4>> buffers(3, std::vector<glm::vec4>(PARTICLES));
+    std::vector<FrameRead> reads = {{3, buffers[0].data()}, {1, buffers[1].data()}, {9, buffers[2].data()}};
+
+    // Act
+    source->readPositionsBatch(reads.data(), static_cast<int>(reads.size()));
+
+    // Assert
+    ASSERT_TRUE(reads[0].ok);
+    ASSERT_TRUE(reads[1].ok);
+    EXPECT_FALSE(reads[2].ok); // past the last frame
+    for (long i = 0; i < PARTICLES; i++) {
+        EXPECT_EQ(buffers[0][i], position(3, i)) << i;
+        EXPECT_EQ(buffers[1][i], position(1, i)) << i;
+    }
+}
+
+TEST_F(ShardedFrameSourceTest, Manifest_ListingAnotherManifest_IsRefused)
+{
+    // Arrange
+    writeManifest("PVSHARDS 1\nshard PosAndVel.shards\n");
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(manifestPath, PARTICLES);
+
+    // Assert
+    EXPECT_EQ(source, nullptr);
+}
+
+TEST_F(ShardedFrameSourceTest, SettingsIO_FolderWithManifest_OpensOneTimeline)
+{
+    // Arrange
+    writeShard("PosAndVel", 0, 2, 0, PARTICLES);
+    writeShard("PosAndVel.1", 2, 2, 0, PARTICLES);
+    const std::string count = " " + std::to_string(PARTICLES);
+    writeManifest("PVSHARDS 1\nshard PosAndVel" + count + "\nshard PosAndVel.1" + count + "\n");
+
+    // Act
+    const std::string pos_name = run_setup::dataFileIn(dir);
+    SettingsIO settings(pos_name, dir + "/RunSetup", dir + "/COMFile");
+    const glm::vec4* positions = settings.getFramePositions(3);
+
+    // Assert
+    EXPECT_EQ(pos_name, manifestPath);
+    EXPECT_EQ(settings.N, PARTICLES);
+    EXPECT_EQ(settings.frames, 4);
+    ASSERT_NE(positions, nullptr);
+    EXPECT_EQ(positions[4], position(3, 4));
+}
@@ -0,0 +1,161 @@
+/*
+ * ShmFeedTests.cpp
+ *
+ * Unit tests for the shared-memory live feed: ShmFeedWriter publishing into
+ * the ring and ShmFrameSource reading it back.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source_factory.hpp"
+#include "data/shm_feed_writer.hpp"
+#include "data/shm_frame_source.hpp"
+
+namespace
+{
+
+constexpr long PARTICLES = 500;
+
+// Unique per test process, so parallel test runs do not share a feed
+std::string feedName(const std::string& test)
+{
+    return "pv_test_" + test + "_" + std::to_string(getpid());
+}
+
+std::vector<glm::vec4> makeFrame(long frame, float sign)
+{
+    std::vector<glm::vec4> values(PARTICLES);
+    for (long i = 0; i < PARTICLES; i++) {
+        values[i] = glm::vec4(sign * (i + frame * 0.5f), sign * i * 2.0f, sign * frame, static_cast<float>(i % 4));
+    }
+    return values;
+}
+
+} // namespace
+
+TEST(ShmFeedTest, Open_MissingFeed_Fails)
+{
+    // Arrange
+    ShmFrameSource source;
+
+    // Act
+    bool opened = source.open(feedName("missing"));
+
+    // Assert
+    EXPECT_FALSE(opened);
+    EXPECT_FALSE(source.isOpen());
+}
+
+TEST(ShmFeedTest, Publish_ThenRead_RoundTripsPositionsAndVelocities)
+{
+    // Arrange
+    ShmFeedWriter feed;
+    ASSERT_TRUE(feed.create(feedName("roundtrip"), PARTICLES, 4, true));
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(feedName("roundtrip")));
+    std::vector<glm::vec4> positions(PARTICLES);
+    std::vector<glm::vec4> velocities(PARTICLES);
+
+    // Act
+    long frame = feed.publish(makeFrame(0, 1.0f).data(), makeFrame(0, -1.0f).data());
+
+    // Assert
+    EXPECT_EQ(frame, 0);
+    EXPECT_EQ(source.particleCount(), PARTICLES);
+    EXPECT_EQ(source.frameCount(), 0); // not seen until refreshed
+    EXPECT_EQ(source.refreshFrameCount(), 1);
+    ASSERT_TRUE(source.readPositions(0, positions.data()));
+    ASSERT_TRUE(source.readVelocities(0, velocities.data()));
+    EXPECT_EQ(positions, makeFrame(0, 1.0f));
+    EXPECT_EQ(velocities, makeFrame(0, -1.0f));
+    EXPECT_TRUE(source.isLive());
+}
+
+TEST(ShmFeedTest, MappedPositions_PointsIntoSharedSlot)
+{
+    // Arrange
+    ShmFeedWriter feed;
+    ASSERT_TRUE(feed.create(feedName("mapped"), PARTICLES, 4, true));
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(feedName("mapped")));
+    feed.publish(makeFrame(0, 1.0f).data(), makeFrame(0, -1.0f).data());
+
+    // Act
+    const glm::vec4* first = source.mappedPositions(0);
+    feed.publish(makeFrame(1, 1.0f).data(), makeFrame(1, -1.0f).data());
+    const glm::vec4* second = source.mappedPositions(1);
+
+    // Assert - zero-copy, and velocities follow the positions as in a PosAndVel frame
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(std::vector<glm::vec4>(first, first + PARTICLES), makeFrame(0, 1.0f));
+    EXPECT_EQ(std::vector<glm::vec4>(second + PARTICLES, second + 2 * PARTICLES), makeFrame(1, -1.0f));
+}
+
+TEST(ShmFeedTest, Read_OverwrittenOrUnpublishedFrame_Fails)
+{
+    // Arrange
+    ShmFeedWriter feed;
+    ASSERT_TRUE(feed.create(feedName("lapped"), PARTICLES, 3, false));
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(feedName("lapped")));
+    for (long frame = 0; frame < 5; frame++) {
+        feed.publish(makeFrame(frame, 1.0f).data(), nullptr);
+    }
+    std::vector<glm::vec4> positions(PARTICLES);
+
+    // Act & Assert - only the newest three frames are still in the ring
+    EXPECT_FALSE(source.readPositions(1, positions.data()));
+    EXPECT_EQ(source.mappedPositions(1), nullptr);
+    EXPECT_FALSE(source.readPositions(5, positions.data()));
+    ASSERT_TRUE(source.readPositions(2, positions.data()));
+    EXPECT_EQ(positions, makeFrame(2, 1.0f));
+    EXPECT_FALSE(source.readVelocities(4, positions.data())); // published without velocities
+}
+
+TEST(ShmFeedTest, OpenFrameSource_ShmPath_OpensLiveFeed)
+{
+    // Arrange
+    ShmFeedWriter feed;
+    ASSERT_TRUE(feed.create(feedName("factory"), PARTICLES, 4, true));
+    feed.publish(makeFrame(0, 1.0f).data(), nullptr);
+    feed.publish(makeFrame(1, 1.0f).data(), nullptr);
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(shm_feed::PATH_PREFIX + feedName("factory"), 0);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_TRUE(source->isLive());
+    EXPECT_EQ(source->particleCount(), PARTICLES);
+    EXPECT_EQ(source->frameCount(), 2);
+}
+
+TEST(ShmFeedTest, Close_UnlinksFeed_ExistingReaderKeepsData)
+{
+    // Arrange
+    ShmFeedWriter feed;
+    ASSERT_TRUE(feed.create(feedName("unlink"), PARTICLES, 4, true));
+    feed.publish(makeFrame(0, 1.0f).data(), nullptr);
+    ShmFrameSource reader;
+    ASSERT_TRUE(reader.open(feedName("unlink")));
+
+    // Act
+    feed.close();
+
+    // Assert
+    ShmFrameSource late_reader;
+    EXPECT_FALSE(late_reader.open(feedName("unlink")));
+    std::vector<glm::vec4> positions(PARTICLES);
+    ASSERT_TRUE(reader.readPositions(0, positions.data()));
+    EXPECT_EQ(positions, makeFrame(0, 1.0f));
+}
@@ -0,0 +1,272 @@
+/*
+ * SubsetExporterTests.cpp
+ *
+ * Unit tests for exporting part of a dataset: the frame window, type and box
+ * filters, the rewritten RunSetup and COMFile, and the requests that are
+ * refused before anything is written.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/mapped_file.hpp"
+#include "data/raw_frame_source.hpp"
+#include "data/subset_exporter.hpp"
+#include "data/thread_pool.hpp"
+
+class SubsetExporterTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::filesystem::create_directories(sourceDir);
+        writeRunSetup();
+        writeData();
+        writeComFile({{10.0f, 20.0f, 30.0f, 0.0f}, {11.0f, 21.0f, 31.0f, 1.0f}});
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(sourceDir);
+        std::filesystem::remove_all(outputDir);
+    }
+
+    /*
+     * Every entry SettingsIO parses, in order; only N matters here.
+     */
+    void writeRunSetup()
+    {
+        std::ofstream out(sourceDir + "/RunSetup");
+        for (int entry = 0; entry < subset_export::RUN_SETUP_N_ENTRY; entry++) {
+            out << "Entry" << entry << "=1\n";
+        }
+        out << "N= " << PARTICLES << "\n";
+        out << "TotalRunTime=1000.0\nDt=0.001\n";
+    }
+
+    /*
+     * Frame f: particle i at (i, f, 0) of type i % 3, moving at (0, i, f).
+     */
+    void writeData()
+    {
+        FILE* file = fopen((sourceDir + "/PosAndVel").c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        for (int frame = 0; frame < FRAMES; frame++) {
+            for (int i = 0; i < PARTICLES; i++) {
+                const glm::vec4 pos(static_cast<float>(i), static_cast<float>(frame), 0.0f, static_cast<float>(i % 3));
+                fwrite(&pos, sizeof(pos), 1, file);
+            }
+            for (int i = 0; i < PARTICLES; i++) {
+                const glm::vec4 vel(0.0f, static_cast<float>(i), static_cast<float>(frame), 0.0f);
+                fwrite(&vel, sizeof(vel), 1, file);
+            }
+        }
+        fclose(file);
+    }
+
+    void writeComFile(const std::vector<glm::vec4>& entries)
+    {
+        FILE* file = fopen((sourceDir + "/COMFile").c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(entries.data(), sizeof(glm::vec4), entries.size(), file);
+        fclose(file);
+    }
+
+    ExportResult exportFrom(const ExportSelection& selection, ThreadPool* pool = nullptr)
+    {
+        RawFrameSource source(MappedFile(sourceDir + "/PosAndVel"), PARTICLES);
+        return exportSubset(source, sourceDir + "/RunSetup", sourceDir + "/COMFile", outputDir, selection, pool);
+    }
+
+    static std::string readText(const std::string& path)
+    {
+        std::ifstream in(path);
+        std::stringstream text;
+        text << in.rdbuf();
+        return text.str();
+    }
+
+    static constexpr int PARTICLES = 6;
+    static constexpr int FRAMES = 5;
+    const std::string sourceDir = "/tmp/test_SubsetExporter_run";
+    const std::string outputDir = "/tmp/test_SubsetExporter_out";
+};
+
+TEST_F(SubsetExporterTest, Export_FramesAndTypes_WritesMatchingRun)
+{
+    // Arrange - types 0 and 2 are particles 0, 2, 3 and 5
+    ExportSelection selection;
+    selection.first_frame = 1;
+    selection.last_frame = 3;
+    selection.type_mask = (1u << 0) | (1u << 2);
+    ThreadPool pool(2);
+
+    // Act
+    const ExportResult result = exportFrom(selection, &pool);
+
+    // Assert
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.frames, 3);
+    EXPECT_EQ(result.particles, 4);
+    EXPECT_EQ(result.bytes, 3u * 2u * 4u * sizeof(glm::vec4));
+    RawFrameSource exported(MappedFile(outputDir + "/PosAndVel"), 4);
+    ASSERT_EQ(exported.frameCount(), 3);
+    std::vector<glm::vec4> positions(4);
+    std::vector<glm::vec4> velocities(4);
+    ASSERT_TRUE(exported.readPositions(2, positions.data()));
+    ASSERT_TRUE(exported.readVelocities(2, velocities.data()));
+    EXPECT_EQ(positions[1], glm::vec4(2.0f, 3.0f, 0.0f, 2.0f));
+    EXPECT_EQ(positions[3], glm::vec4(5.0f, 3.0f, 0.0f, 2.0f));
+    EXPECT_EQ(velocities[2], glm::vec4(0.0f, 3.0f, 3.0f, 0.0f));
+    const std::string run_setup = readText(outputDir + "/RunSetup");
+    EXPECT_NE(run_setup.find("N= 4\n"), std::string::npos);
+    EXPECT_NE(run_setup.find("Dt=0.001\n"), std::string::npos);
+}
+
+TEST_F(SubsetExporterTest, Export_Box_KeepsParticlesInsideAtFirstFrame)
+{
+    // Arrange - only particles 2 and 3 start inside; every frame moves them out along y
+    ExportSelection selection;
+    selection.use_box = true;
+    selection.box_min = glm::vec3(1.5f, -0.5f, -1.0f);
+    selection.box_max = glm::vec3(3.5f, 0.5f, 1.0f);
+
+    // Act
+    const ExportResult result = exportFrom(selection);
+
+    // Assert
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.particles, 2);
+    RawFrameSource exported(MappedFile(outputDir + "/PosAndVel"), 2);
+    ASSERT_EQ(exported.frameCount(), FRAMES);
+    std::vector<glm::vec4> positions(2);
+    ASSERT_TRUE(exported.readPositions(FRAMES - 1, positions.data()));
+    EXPECT_EQ(positions[0], glm::vec4(2.0f, 4.0f, 0.0f, 2.0f));
+    EXPECT_EQ(positions[1], glm::vec4(3.0f, 4.0f, 0.0f, 0.0f));
+}
+
+TEST_F(SubsetExporterTest, Export_ComFile_KeepsStoredEntriesAndComputesTheRest)
+{
+    // Arrange - the COMFile covers frames 0 and 1
+    ExportSelection selection;
+    selection.first_frame = 1;
+    selection.last_frame = 2;
+    selection.type_mask = 1u << 1;
+
+    // Act
+    const ExportResult result = exportFrom(selection);
+    std::vector<glm::vec4> com;
+    ASSERT_TRUE(com_track::loadFile(outputDir + "/COMFile", com));
+
+    // Assert - renumbered from 0; frame 2's centre is over every particle, not just the exported ones
+    ASSERT_TRUE(result.ok) << result.error;
+    ASSERT_EQ(com.size(), 2u);
+    EXPECT_EQ(com[0], glm::vec4(11.0f, 21.0f, 31.0f, 0.0f));
+    EXPECT_EQ(com[1], glm::vec4(2.5f, 2.0f, 0.0f, 1.0f));
+}
+
+TEST_F(SubsetExporterTest, Export_InvalidRequests_AreRefusedWithoutWriting)
+{
+    // Arrange
+    ExportSelection past_end;
+    past_end.last_frame = FRAMES;
+    ExportSelection empty_box;
+    empty_box.use_box = true;
+    empty_box.box_min = glm::vec3(100.0f);
+    empty_box.box_max = glm::vec3(200.0f);
+    RawFrameSource source(MappedFile(sourceDir + "/PosAndVel"), PARTICLES);
+
+    // Act
+    const ExportResult range = exportFrom(past_end);
+    const ExportResult nothing = exportFrom(empty_box);
+    const ExportResult in_place =
+        exportSubset(source, sourceDir + "/RunSetup", sourceDir + "/COMFile", sourceDir, ExportSelection(), nullptr);
+    const ExportResult no_run_setup =
+        exportSubset(source, sourceDir + "/Missing", sourceDir + "/COMFile", outputDir, ExportSelection(), nullptr);
+
+    // Assert
+    EXPECT_FALSE(range.ok);
+    EXPECT_FALSE(nothing.ok);
+    EXPECT_FALSE(in_place.ok);
+    EXPECT_FALSE(no_run_setup.ok);
+    EXPECT_EQ(std::filesystem::file_size(sourceDir + "/PosAndVel"),
+              static_cast<std::uintmax_t>(FRAMES) * 2 * PARTICLES * sizeof(glm::vec4));
+    EXPECT_FALSE(std::filesystem::exists(outputDir + "/PosAndVel"));
+    EXPECT_FALSE(std::filesystem::exists(outputDir + "/RunSetup"));
+}
+
+TEST_F(SubsetExporterTest, Cancel_BeforeFirstBatch_LeavesNoOutput)
+{
+    // Arrange
+    RawFrameSource source(MappedFile(sourceDir + "/PosAndVel"), PARTICLES);
+    ExportProgress progress;
+    progress.cancel = true;
+
+    // Act
+    const ExportResult result = exportSubset(source, sourceDir + "/RunSetup", sourceDir + "/COMFile", outputDir,
+                                             ExportSelection(), nullptr, nullptr, &progress);
+
+    // Assert
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.error, "cancelled");
+    EXPECT_FALSE(std::filesystem::exists(outputDir));
+    EXPECT_EQ(progress.frames_total.load(), FRAMES);
+}
+
+TEST_F(SubsetExporterTest, Cancel_OverEarlierExport_KeepsItsFiles)
+{
+    // Arrange
+    std::filesystem::create_directories(outputDir);
+    std::ofstream(outputDir + "/PosAndVel") << "earlier";
+    std::ofstream(outputDir + "/COMFile") << "earlier";
+    RawFrameSource source(MappedFile(sourceDir + "/PosAndVel"), PARTICLES);
+    ExportProgress progress;
+    progress.cancel = true;
+
+    // Act
+    const ExportResult result = exportSubset(source, sourceDir + "/RunSetup", sourceDir + "/COMFile", outputDir,
+                                             ExportSelection(), nullptr, nullptr, &progress);
+
+    // Assert
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(readText(outputDir + "/PosAndVel"), "earlier");
+    EXPECT_EQ(readText(outputDir + "/COMFile"), "earlier");
+    EXPECT_FALSE(std::filesystem::exists(outputDir + "/RunSetup"));
+    EXPECT_FALSE(std::filesystem::exists(outputDir + "/PosAndVel" + subset_export::TEMP_SUFFIX));
+}
+
+TEST_F(SubsetExporterTest, ParseFrameRangeAndBox_Text_IsCheckedAndOrdered)
+{
+    // Arrange
+    std::int64_t first = -7;
+    std::int64_t last = -7;
+    glm::vec3 box_min(0.0f);
+    glm::vec3 box_max(0.0f);
+
+    // Act / Assert
+    EXPECT_TRUE(subset_export::parseFrameRange("2000:3000", first, last));
+    EXPECT_EQ(first, 2000);
+    EXPECT_EQ(last, 3000);
+    EXPECT_TRUE(subset_export::parseFrameRange("50:", first, last));
+    EXPECT_EQ(first, 50);
+    EXPECT_EQ(last, -1);
+    EXPECT_TRUE(subset_export::parseFrameRange("12", first, last));
+    EXPECT_EQ(last, 12);
+    EXPECT_FALSE(subset_export::parseFrameRange("30:20", first, last));
+    EXPECT_FALSE(subset_export::parseFrameRange("a:b", first, last));
+    EXPECT_FALSE(subset_export::parseFrameRange(":", first, last));
+    EXPECT_TRUE(subset_export::parseBox("1,2,3,-1,0,5", box_min, box_max));
+    EXPECT_EQ(box_min, glm::vec3(-1.0f, 0.0f, 3.0f));
+    EXPECT_EQ(box_max, glm::vec3(1.0f, 2.0f, 5.0f));
+    EXPECT_FALSE(subset_export::parseBox("1,2,3,4,5", box_min, box_max));
+    EXPECT_FALSE(subset_export::parseBox("1,2,3,4,5,6,7", box_min, box_max));
+}
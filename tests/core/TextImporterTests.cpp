@@ -0,0 +1,268 @@
+/*
+ * TextImporterTests.cpp
+ *
+ * Unit tests for text snapshot import: column maps, chunked parallel parsing,
+ * TextFrameSource through openFrameSource(), and pv-convert's conversion of
+ * snapshots into a container.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/dataset_converter.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/text_frame_source.hpp"
+#include "data/text_importer.hpp"
+#include "data/thread_pool.hpp"
+
+using text_import::Column;
+
+class TextImporterTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    void writeFile(const std::string& name, const std::string& text)
+    {
+        std::ofstream out(dir + "/" + name, std::ios::binary);
+        out << text;
+    }
+
+    /*
+     * `rows` particles as "x y z type", particle i at (i, -i, 0.5 * i) with type i % 4.
+     */
+    static std::string numberedRows(int rows)
+    {
+        std::string text = "# x y z type\n";
+        for (int i = 0; i < rows; i++) {
+            text += std::to_string(i) + " " + std::to_string(-i) + " " + std::to_string(0.5 * i) + " " +
+                    std::to_string(i % 4) + "\n";
+        }
+        return text;
+    }
+
+    static std::vector<Column> columns(const std::string& spec)
+    {
+        std::vector<Column> parsed;
+        std::string error;
+        EXPECT_TRUE(text_import::parseColumns(spec, parsed, error)) << error;
+        return parsed;
+    }
+
+    static bool parse(const std::string& text, const std::vector<Column>& map, ThreadPool* pool,
+                      text_import::Snapshot& snapshot, std::string& error, std::uint64_t chunk_bytes)
+    {
+        return text_import::parse(text.data(), text.size(), map, pool, snapshot, error, chunk_bytes);
+    }
+
+    const std::string dir = "/tmp/test_TextImporter";
+};
+
+TEST_F(TextImporterTest, ParseColumns_FullMap_FieldsInFileOrder)
+{
+    // Arrange
+    std::vector<Column> map;
+    std::string error;
+
+    // Act
+    const bool ok = text_import::parseColumns("skip, X,y,z,-,type,vx,vy,vz", map, error);
+
+    // Assert
+    ASSERT_TRUE(ok) << error;
+    const std::vector<Column> expected = {Column::Skip,      Column::X,         Column::Y,
+                                          Column::Z,         Column::Skip,      Column::Type,
+                                          Column::VelocityX, Column::VelocityY, Column::VelocityZ};
+    EXPECT_EQ(map, expected);
+    EXPECT_TRUE(text_import::hasVelocities(map));
+}
+
+TEST_F(TextImporterTest, ParseColumns_IncompleteMaps_AreRejected)
+{
+    // Arrange
+    std::vector<Column> map;
+    std::string error;
+
+    // Act / Assert
+    EXPECT_FALSE(text_import::parseColumns("x,y", map, error));
+    EXPECT_FALSE(text_import::parseColumns("x,y,z,vx,vy", map, error));
+    EXPECT_FALSE(text_import::parseColumns("x,y,z,x", map, error));
+    EXPECT_FALSE(text_import::parseColumns("x,y,z,mass", map, error));
+    EXPECT_NE(error.find("mass"), std::string::npos);
+}
+
+TEST_F(TextImporterTest, Parse_WhitespaceAndCsvLines_ReadTheSame)
+{
+    // Arrange - a header, comments, blank lines, CRLF endings, leading '+' and exponents
+    const std::string text = "x,y,z,type\r\n"
+                             "# comment\n"
+                             "1.5 -2 3e1 1\n"
+                             "\n"
+                             "  +1.5,\t-2, 30 ,1\r\n"
+                             ".25,0,0,2";
+    text_import::Snapshot snapshot;
+    std::string error;
+
+    // Act
+    ASSERT_TRUE(parse(text, columns(text_import::DEFAULT_COLUMNS), nullptr, snapshot, error, 1 << 20)) << error;
+
+    // Assert
+    ASSERT_EQ(snapshot.positions.size(), 3u);
+    EXPECT_EQ(snapshot.positions[0], glm::vec4(1.5f, -2.0f, 30.0f, 1.0f));
+    EXPECT_EQ(snapshot.positions[1], snapshot.positions[0]);
+    EXPECT_EQ(snapshot.positions[2], glm::vec4(0.25f, 0.0f, 0.0f, 2.0f));
+    EXPECT_TRUE(snapshot.velocities.empty());
+}
+
+TEST_F(TextImporterTest, Parse_SkippedAndVelocityColumns_LandInTheirLanes)
+{
+    // Arrange - id, then velocities ahead of positions; no type column, and a trailing extra field
+    const std::string text = "7 0.1 0.2 0.3 1 2 3 extra\n";
+    text_import::Snapshot snapshot;
+    std::string error;
+
+    // Act
+    ASSERT_TRUE(parse(text, columns("-,vx,vy,vz,x,y,z"), nullptr, snapshot, error, 1 << 20)) << error;
+
+    // Assert
+    ASSERT_EQ(snapshot.positions.size(), 1u);
+    EXPECT_EQ(snapshot.positions[0], glm::vec4(1.0f, 2.0f, 3.0f, text_import::DEFAULT_TYPE));
+    ASSERT_EQ(snapshot.velocities.size(), 1u);
+    EXPECT_EQ(snapshot.velocities[0], glm::vec4(0.1f, 0.2f, 0.3f, 0.0f));
+}
+
+TEST_F(TextImporterTest, Parse_SmallChunksOnPool_MatchesSerialParse)
+{
+    // Arrange - 64-byte chunks split the text into hundreds of tasks
+    const std::string text = numberedRows(2000);
+    ThreadPool pool(4);
+    text_import::Snapshot serial;
+    text_import::Snapshot parallel;
+    std::string error;
+
+    // Act
+    ASSERT_TRUE(parse(text, columns(text_import::DEFAULT_COLUMNS), nullptr, serial, error, 1 << 20)) << error;
+    ASSERT_TRUE(parse(text, columns(text_import::DEFAULT_COLUMNS), &pool, parallel, error, 64)) << error;
+
+    // Assert
+    ASSERT_EQ(parallel.positions.size(), 2000u);
+    EXPECT_EQ(parallel.positions, serial.positions);
+    EXPECT_EQ(parallel.positions[1234], glm::vec4(1234.0f, -1234.0f, 617.0f, 2.0f));
+}
+
+TEST_F(TextImporterTest, Parse_BadField_ReportsItsLineAcrossChunks)
+{
+    // Arrange - line 1 is the header, so particle 1500 is on line 1502
+    std::string text = numberedRows(2000);
+    const std::string row = "\n1500 -1500 750.000000 0\n";
+    text.replace(text.find(row), row.size(), "\n1500 -1500 oops 0\n");
+    ThreadPool pool(4);
+    text_import::Snapshot snapshot;
+    std::string error;
+
+    // Act
+    const bool ok = parse(text, columns(text_import::DEFAULT_COLUMNS), &pool, snapshot, error, 64);
+
+    // Assert
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(error, "line 1502: field 3 is missing or not a number");
+}
+
+TEST_F(TextImporterTest, Parse_ShortLineOrNoParticles_Fails)
+{
+    // Arrange
+    text_import::Snapshot snapshot;
+    std::string error;
+
+    // Act / Assert
+    EXPECT_FALSE(parse("1 2\n", columns("x,y,z"), nullptr, snapshot, error, 1 << 20));
+    EXPECT_EQ(error, "line 1: field 3 is missing or not a number");
+    EXPECT_FALSE(parse("# only a comment\n\n", columns("x,y,z"), nullptr, snapshot, error, 1 << 20));
+}
+
+TEST_F(TextImporterTest, OpenFrameSource_CsvSnapshot_IsOneMappedFrame)
+{
+    // Arrange
+    writeFile("snapshot.csv", "id,x,y,z,vx,vy,vz\n0,1,2,3,4,5,6\n1,7,8,9,10,11,12\n");
+    FrameReadOptions options;
+    options.text_columns = "-,x,y,z,vx,vy,vz";
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(dir + "/snapshot.csv", 0, options);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->particleCount(), 2);
+    EXPECT_EQ(source->frameCount(), 1);
+    const glm::vec4* positions = source->mappedPositions(0);
+    ASSERT_NE(positions, nullptr);
+    EXPECT_EQ(positions[1], glm::vec4(7.0f, 8.0f, 9.0f, text_import::DEFAULT_TYPE));
+    std::vector<glm::vec4> velocities(2);
+    ASSERT_TRUE(source->readVelocities(0, velocities.data()));
+    EXPECT_EQ(velocities[0], glm::vec4(4.0f, 5.0f, 6.0f, 0.0f));
+    EXPECT_EQ(source->mappedPositions(1), nullptr);
+}
+
+TEST_F(TextImporterTest, OpenFrameSource_MalformedSnapshot_ReturnsNull)
+{
+    // Arrange
+    writeFile("bad.txt", "1 2 nope 0\n");
+
+    // Act / Assert
+    EXPECT_EQ(openFrameSource(dir + "/bad.txt", 0), nullptr);
+    TextFrameSource source(dir + "/bad.txt", columns(text_import::DEFAULT_COLUMNS), 1);
+    EXPECT_FALSE(source.isValid());
+    EXPECT_NE(source.error().find("line 1"), std::string::npos);
+}
+
+TEST_F(TextImporterTest, ConvertTextSnapshots_TwoSnapshots_ContainerHasTwoFrames)
+{
+    // Arrange
+    writeFile("t0.txt", "0 0 0 1\n1 1 1 2\n");
+    writeFile("t1.txt", "0.5 0 0 1\n1.5 1 1 2\n");
+    ThreadPool pool(2);
+
+    // Act
+    const ConversionResult result = convertTextSnapshots(
+        {dir + "/t0.txt", dir + "/t1.txt"}, columns(text_import::DEFAULT_COLUMNS), dir + "/out.pv2", &pool);
+
+    // Assert
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.frames, 2);
+    std::unique_ptr<FrameSource> source = openFrameSource(dir + "/out.pv2", 0);
+    ASSERT_NE(source, nullptr);
+    ASSERT_EQ(source->frameCount(), 2);
+    std::vector<glm::vec4> positions(2);
+    ASSERT_TRUE(source->readPositions(1, positions.data()));
+    EXPECT_EQ(positions[1], glm::vec4(1.5f, 1.0f, 1.0f, 2.0f));
+}
+
+TEST_F(TextImporterTest, ConvertTextSnapshots_ParticleCountChanges_Fails)
+{
+    // Arrange
+    writeFile("t0.txt", "0 0 0 1\n1 1 1 2\n");
+    writeFile("t1.txt", "0 0 0 1\n");
+
+    // Act
+    const ConversionResult result = convertTextSnapshots(
+        {dir + "/t0.txt", dir + "/t1.txt"}, columns(text_import::DEFAULT_COLUMNS), dir + "/out.pv2", nullptr);
+
+    // Assert
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.error.find("t1.txt"), std::string::npos);
+}
@@ -0,0 +1,92 @@
+/*
+ * ThreadPoolTests.cpp
+ *
+ * Unit tests for the ThreadPool used by data conversion and decoding.
+ */
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "data/thread_pool.hpp"
+
+TEST(ThreadPoolTest, Constructor_ZeroThreads_UsesAtLeastOne)
+{
+    // Act
+    ThreadPool pool(0);
+
+    // Assert
+    EXPECT_GE(pool.size(), 1u);
+}
+
+TEST(ThreadPoolTest, Submit_RunsTask)
+{
+    // Arrange
+    ThreadPool pool(2);
+    std::atomic<int> runs{0};
+
+    // Act
+    pool.submit([&] { runs++; }).get();
+
+    // Assert
+    EXPECT_EQ(runs.load(), 1);
+}
+
+TEST(ThreadPoolTest, Submit_ThrowingTask_RethrowsFromFuture)
+{
+    // Arrange
+    ThreadPool pool(1);
+
+    // Act
+    std::future<void> done = pool.submit([] { throw std::runtime_error("boom"); });
+
+    // Assert
+    EXPECT_THROW(done.get(), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, ParallelFor_VisitsEveryIndexOnce)
+{
+    // Arrange
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> visits(100);
+
+    // Act
+    pool.parallelFor(0, 100, [&](long i) { visits[i]++; });
+
+    // Assert
+    for (const auto& count : visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(ThreadPoolTest, ParallelFor_EmptyRange_DoesNothing)
+{
+    // Arrange
+    ThreadPool pool(2);
+    std::atomic<int> runs{0};
+
+    // Act
+    pool.parallelFor(5, 5, [&](long) { runs++; });
+
+    // Assert
+    EXPECT_EQ(runs.load(), 0);
+}
+
+TEST(ThreadPoolTest, Destructor_DrainsQueuedTasks)
+{
+    // Arrange
+    std::atomic<int> runs{0};
+
+    // Act
+    {
+        ThreadPool pool(1);
+        for (int i = 0; i < 20; i++) {
+            pool.submit([&] { runs++; });
+        }
+    }
+
+    // Assert
+    EXPECT_EQ(runs.load(), 20);
+}
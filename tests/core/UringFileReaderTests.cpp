@@ -0,0 +1,206 @@
+/*
+ * UringFileReaderTests.cpp
+ *
+ * Unit tests for batched io_uring reads and the PosAndVel frame source built
+ * on them. Tests that need a ring are skipped where io_uring is unavailable.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "data/frame_source_factory.hpp"
+#include "data/uring_file_reader.hpp"
+#include "data/uring_frame_source.hpp"
+
+namespace
+{
+
+constexpr std::int64_t PARTICLES = 3000; // 48000 bytes per stream: many 4 KiB chunks, none aligned to the frame
+constexpr std::int64_t FRAMES = 5;
+constexpr std::uint64_t SMALL_CHUNK_BYTES = 4096;
+constexpr unsigned SHALLOW_QUEUE = 4; // far fewer entries than chunks, so the queue is refilled many times
+
+glm::vec4 valueAt(std::int64_t frame, int stream, std::int64_t i)
+{
+    return glm::vec4(frame * 1000.0f + i, stream, -static_cast<float>(i), static_cast<float>(i % 4));
+}
+
+std::vector<glm::vec4> expectedStream(std::int64_t frame, int stream)
+{
+    std::vector<glm::vec4> values(PARTICLES);
+    for (std::int64_t i = 0; i < PARTICLES; i++) {
+        values[i] = valueAt(frame, stream, i);
+    }
+    return values;
+}
+
+std::uint64_t streamOffset(std::int64_t frame, int stream)
+{
+    return (frame * 2 + stream) * sizeof(glm::vec4) * PARTICLES;
+}
+
+} // namespace
+
+class UringFileReaderTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::ofstream out(filePath, std::ios::binary);
+        for (std::int64_t frame = 0; frame < FRAMES; frame++) {
+            for (int stream = 0; stream < 2; stream++) {
+                std::vector<glm::vec4> values = expectedStream(frame, stream);
+                out.write(reinterpret_cast<const char*>(values.data()), sizeof(glm::vec4) * PARTICLES);
+            }
+        }
+    }
+
+    void TearDown() override
+    {
+        std::remove(filePath.c_str());
+    }
+
+    const std::string filePath = "/tmp/test_UringFileReader_PosAndVel";
+};
+
+TEST_F(UringFileReaderTest, ReadBatch_SeveralFramesThroughShallowQueue_MatchesFile)
+{
+    if (!UringFileReader::isSupported()) {
+        GTEST_SKIP() << "io_uring unavailable";
+    }
+
+    // Arrange
+    UringFileReader file(SMALL_CHUNK_BYTES, SHALLOW_QUEUE);
+    ASSERT_TRUE(file.open(filePath));
+    std::vector<glm::vec4> velocities(PARTICLES);
+    std::vector<glm::vec4> positions(PARTICLES);
+    UringFileReader::Range ranges[2] = {{streamOffset(3, 1), sizeof(glm::vec4) * PARTICLES, velocities.data()},
+                                        {streamOffset(1, 0), sizeof(glm::vec4) * PARTICLES, positions.data()}};
+
+    // Act
+    bool ok = file.readBatch(ranges, 2);
+
+    // Assert
+    ASSERT_TRUE(ok);
+    EXPECT_TRUE(ranges[0].ok);
+    EXPECT_TRUE(ranges[1].ok);
+    EXPECT_EQ(velocities, expectedStream(3, 1));
+    EXPECT_EQ(positions, expectedStream(1, 0));
+}
+
+TEST_F(UringFileReaderTest, ReadBatch_RangePastEndOfFile_FailsOnlyThatRange)
+{
+    if (!UringFileReader::isSupported()) {
+        GTEST_SKIP() << "io_uring unavailable";
+    }
+
+    // Arrange
+    UringFileReader file(SMALL_CHUNK_BYTES, SHALLOW_QUEUE);
+    ASSERT_TRUE(file.open(filePath));
+    std::vector<glm::vec4> tail(PARTICLES);
+    std::vector<glm::vec4> positions(PARTICLES);
+    UringFileReader::Range ranges[2] = {{file.size() - 16, sizeof(glm::vec4) * PARTICLES, tail.data()},
+                                        {streamOffset(0, 0), sizeof(glm::vec4) * PARTICLES, positions.data()}};
+
+    // Act
+    bool ok = file.readBatch(ranges, 2);
+
+    // Assert
+    EXPECT_FALSE(ok);
+    EXPECT_FALSE(ranges[0].ok);
+    EXPECT_TRUE(ranges[1].ok);
+    EXPECT_EQ(positions, expectedStream(0, 0));
+}
+
+TEST_F(UringFileReaderTest, UringSource_ReadPositionsBatch_MatchesMappedSource)
+{
+    if (!UringFileReader::isSupported()) {
+        GTEST_SKIP() << "io_uring unavailable";
+    }
+
+    // Arrange
+    UringFrameSource uring_source(filePath, PARTICLES, SMALL_CHUNK_BYTES, SHALLOW_QUEUE);
+    std::unique_ptr<FrameSource> mapped_source = openFrameSource(filePath, PARTICLES);
+    ASSERT_TRUE(uring_source.isOpen());
+    ASSERT_NE(mapped_source, nullptr);
+    std::vector<glm::vec4> destinations(PARTICLES * 4);
+    FrameRead reads[4] = {{4, destinations.data()},
+                          {0, destinations.data() + PARTICLES},
+                          {FRAMES, destinations.data() + 2 * PARTICLES},
+                          {2, destinations.data() + 3 * PARTICLES}};
+
+    // Act
+    uring_source.readPositionsBatch(reads, 4);
+
+    // Assert
+    EXPECT_EQ(uring_source.frameCount(), FRAMES);
+    EXPECT_FALSE(reads[2].ok); // out of range
+    std::vector<glm::vec4> from_mapping(PARTICLES);
+    for (int i : {0, 1, 3}) {
+        ASSERT_TRUE(reads[i].ok) << "read " << i;
+        ASSERT_TRUE(mapped_source->readPositions(reads[i].frame, from_mapping.data()));
+        std::vector<glm::vec4> from_uring(reads[i].destination, reads[i].destination + PARTICLES);
+        EXPECT_EQ(from_uring, from_mapping) << "frame " << reads[i].frame;
+    }
+}
+
+TEST_F(UringFileReaderTest, UringSource_CancelledMidBatch_StopsBetweenChunks)
+{
+    if (!UringFileReader::isSupported()) {
+        GTEST_SKIP() << "io_uring unavailable";
+    }
+
+    // Arrange - one 16-byte chunk in flight at a time, so a frame takes thousands of round trips
+    UringFrameSource source(filePath, PARTICLES, sizeof(glm::vec4), 1);
+    ASSERT_TRUE(source.isOpen());
+    const glm::vec4 unread(-1.0f);
+    std::vector<glm::vec4> destinations(PARTICLES * 2, unread);
+    std::atomic<bool> cancelled{false};
+    FrameRead reads[2] = {{1, destinations.data(), false, &cancelled}, {3, destinations.data() + PARTICLES}};
+    std::thread canceller([&] {
+        // Give frame 1 up as soon as its first chunk has landed
+        std::atomic_ref<float> first(destinations[0].x);
+        while (first.load() == unread.x) {
+            std::this_thread::yield();
+        }
+        cancelled = true;
+    });
+
+    // Act
+    source.readPositionsBatch(reads, 2);
+    canceller.join();
+
+    // Assert - frame 1 stopped partway, the other frame of the batch still arrived
+    EXPECT_FALSE(reads[0].ok);
+    EXPECT_EQ(destinations[PARTICLES - 1], unread);
+    ASSERT_TRUE(reads[1].ok);
+    std::vector<glm::vec4> frame3(destinations.begin() + PARTICLES, destinations.end());
+    EXPECT_EQ(frame3, expectedStream(3, 0));
+}
+
+TEST_F(UringFileReaderTest, OpenFrameSource_WithIoUring_ReadsFramesOrFallsBack)
+{
+    // Arrange
+    FrameReadOptions options;
+    options.io_uring = true;
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(filePath, PARTICLES, options);
+
+    // Assert - io_uring reads into the caller's buffer; the fallback is the mapped source
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->mappedPositions(0) == nullptr, UringFileReader::isSupported());
+    std::vector<glm::vec4> velocities(PARTICLES);
+    ASSERT_TRUE(source->readVelocities(4, velocities.data()));
+    EXPECT_EQ(velocities, expectedStream(4, 1));
+}
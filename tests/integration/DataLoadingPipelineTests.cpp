@@ -19,6 +19,7 @@
 #include <glm/glm.hpp>
 
 #include "MockOpenGL.hpp"
+#include "data/dataset_converter.hpp"
 #include "particle.hpp"
 #include "settingsIO.hpp"
 
@@ -143,6 +144,7 @@ class DataLoadingPipelineTest : public ::testing::Test
         std::remove("/tmp/integration_RunSetup");
         std::remove("/tmp/integration_PosAndVel");
         std::remove("/tmp/integration_COMFile");
+        std::remove("/tmp/integration_PosAndVel.pv2");
     }
 
     // Test constants - using enum as a C++11 workaround for static const int
@@ -158,6 +160,7 @@ class DataLoadingPipelineTest : public ::testing::Test
     const char* posPath = "/tmp/integration_PosAndVel";
     const char* statsPath = "/tmp/integration_RunSetup";
     const char* comPath = "/tmp/integration_COMFile";
+    const char* containerPath = "/tmp/integration_PosAndVel.pv2";
 };
 
 // ============================================
@@ -423,3 +426,57 @@ TEST_F(DataLoadingPipelineTest, ParticleCount_MatchesSettingsN)
     EXPECT_EQ(part.n, settings.N);
     EXPECT_EQ(settings.N, NUM_PARTICLES);
 }
+
+// ============================================
+// v2 Container Integration
+// ============================================
+
+TEST_F(DataLoadingPipelineTest, ConvertedContainer_ReadFrame_MatchesLegacyData)
+{
+    // Arrange
+    ASSERT_TRUE(convertLegacyDataset(posPath, NUM_PARTICLES, containerPath).ok);
+    SettingsIO legacy(posPath, statsPath, comPath);
+    SettingsIO converted(containerPath, statsPath, comPath);
+    Particle legacy_part;
+    Particle converted_part;
+
+    // Act
+    legacy.readPosVelFile(3, &legacy_part, true);
+    converted.readPosVelFile(3, &converted_part, true);
+
+    // Assert
+    ASSERT_EQ(converted_part.n, legacy_part.n);
+    EXPECT_EQ(converted_part.translations, legacy_part.translations);
+    EXPECT_EQ(converted_part.velocities, legacy_part.velocities);
+}
+
+TEST_F(DataLoadingPipelineTest, ConvertedContainer_WithoutRunSetup_TakesCountsFromHeader)
+{
+    // Arrange
+    ASSERT_TRUE(convertLegacyDataset(posPath, NUM_PARTICLES, containerPath).ok);
+
+    // Act
+    SettingsIO settings(containerPath, "/tmp/nonexistent_RunSetup", comPath);
+
+    // Assert
+    EXPECT_EQ(settings.N, NUM_PARTICLES);
+    EXPECT_EQ(settings.frames, NUM_FRAMES);
+}
+
+TEST_F(DataLoadingPipelineTest, QuantizedContainer_ReadFrame_IsCloseToLegacyData)
+{
+    // Arrange
+    ASSERT_TRUE(convertLegacyDataset(posPath, NUM_PARTICLES, containerPath, container::Encoding::Quantized16).ok);
+    SettingsIO settings(containerPath, statsPath, comPath);
+    Particle part;
+
+    // Act
+    settings.readPosVelFile(2, &part, false);
+
+    // Assert: frame 2, particle 10 was written as (102, 54, 21, 1)
+    ASSERT_EQ(part.n, NUM_PARTICLES);
+    EXPECT_NEAR(part.translations[10].x, 102.0f, 0.01f);
+    EXPECT_NEAR(part.translations[10].y, 54.0f, 0.01f);
+    EXPECT_NEAR(part.translations[10].z, 21.0f, 0.01f);
+    EXPECT_EQ(part.translations[10].w, 1.0f);
+}
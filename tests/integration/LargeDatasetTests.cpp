@@ -0,0 +1,141 @@
+/*
+ * LargeDatasetTests.cpp
+ *
+ * Integration tests for datasets past the 32-bit limits: frame offsets beyond
+ * 4 GiB and particle counts beyond INT32_MAX. The files are sparse, so they
+ * take almost no disk space; only the few bytes the tests check are written.
+ * Skipped where sparse files cannot be created (including Windows).
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include <glad/glad.h>
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include "MockOpenGL.hpp"
+#include "benchmarks/SyntheticDataset.hpp"
+#include "data/container_writer.hpp"
+#include "data/frame_source_factory.hpp"
+#include "data/residual_codec.hpp"
+#include "settingsIO.hpp"
+
+namespace
+{
+
+const std::string LARGE_POS_AND_VEL = "/tmp/large_dataset_PosAndVel";
+const std::string LARGE_RUN_SETUP = "/tmp/large_dataset_RunSetup";
+
+/*
+ * Creates a sparse file of `size` bytes with `value` written at each of
+ * `offsets`. Returns false if the filesystem refuses a file that large.
+ */
+bool writeSparseFile(const std::string& path, std::uint64_t size, const std::vector<std::uint64_t>& offsets,
+                     const glm::vec4& value)
+{
+#ifdef _WIN32
+    (void)path;
+    (void)size;
+    (void)offsets;
+    (void)value;
+    return false;
+#else
+    const int fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ftruncate(fd, static_cast<off_t>(size)) == 0;
+    for (std::uint64_t offset : offsets) {
+        ok = ok && pwrite(fd, &value, sizeof(value), static_cast<off_t>(offset)) == sizeof(value);
+    }
+    ::close(fd);
+    return ok;
+#endif
+}
+
+} // namespace
+
+class LargeDatasetTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        MockOpenGL::reset();
+        MockOpenGL::initGLAD();
+    }
+
+    void TearDown() override
+    {
+        std::remove(LARGE_POS_AND_VEL.c_str());
+        std::remove(LARGE_RUN_SETUP.c_str());
+    }
+};
+
+TEST_F(LargeDatasetTest, RawSource_FramePast4GiB_ReadsFromItsOffset)
+{
+    // Arrange - 1Mi particles is 32 MiB per frame, so frame 150 starts at 4.7 GiB
+    constexpr std::int64_t n = 1 << 20;
+    constexpr std::uint64_t frame_bytes = 2 * sizeof(glm::vec4) * n;
+    const glm::vec4 marker(1.0f, 2.0f, 3.0f, 4.0f);
+    if (!writeSparseFile(LARGE_POS_AND_VEL, 160 * frame_bytes, {150 * frame_bytes + 7 * sizeof(glm::vec4)}, marker)) {
+        GTEST_SKIP() << "filesystem does not support a 5 GiB sparse file";
+    }
+    std::vector<glm::vec4> positions(n);
+
+    // Act
+    std::unique_ptr<FrameSource> source = openFrameSource(LARGE_POS_AND_VEL, n);
+
+    // Assert
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->frameCount(), 160);
+    ASSERT_TRUE(source->readPositions(150, positions.data()));
+    EXPECT_EQ(positions[7], marker);
+    EXPECT_EQ(positions[8], glm::vec4(0.0f));
+}
+
+TEST_F(LargeDatasetTest, SettingsIO_ParticleCountAboveInt32_MapsWholeFrame)
+{
+    // Arrange - 3 billion particles: one frame is 96 GB, its velocities start past 4 GiB
+    constexpr std::int64_t n = 3000000000ll;
+    const std::uint64_t last_position = sizeof(glm::vec4) * static_cast<std::uint64_t>(n - 1);
+    const std::uint64_t last_velocity = sizeof(glm::vec4) * static_cast<std::uint64_t>(2 * n - 1);
+    const glm::vec4 marker(5.0f, 6.0f, 7.0f, 1.0f);
+    if (!writeSparseFile(LARGE_POS_AND_VEL, 2 * sizeof(glm::vec4) * n, {last_position, last_velocity}, marker)) {
+        GTEST_SKIP() << "filesystem does not support a 96 GB sparse file";
+    }
+    writeSyntheticRunSetup(LARGE_RUN_SETUP, n);
+
+    // Act
+    SettingsIO settings(LARGE_POS_AND_VEL, LARGE_RUN_SETUP, "/tmp/large_dataset_COMFile");
+    const glm::vec4* frame = settings.getFramePositions(0);
+
+    // Assert
+    EXPECT_EQ(settings.N, n);
+    EXPECT_EQ(settings.frames, 1);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame[n - 1], marker);
+    EXPECT_EQ(frame[2 * n - 1], marker);
+}
+
+TEST_F(LargeDatasetTest, ContainerWriter_PredictiveAboveFrameLimit_Refuses)
+{
+    // Arrange
+    ContainerWriter writer;
+
+    // Act
+    bool opened = writer.open(LARGE_POS_AND_VEL, residual::maxParticles(true) + 1, true,
+                              container::Encoding::PredictiveResidual, 1.0f);
+
+    // Assert
+    EXPECT_FALSE(opened);
+}
@@ -26,17 +26,28 @@ int MockOpenGL::shaderSourceCalls = 0;
 int MockOpenGL::getShaderivCalls = 0;
 int MockOpenGL::getProgramivCalls = 0;
 int MockOpenGL::genVertexArraysCalls = 0;
+int MockOpenGL::genBuffersCalls = 0;
+int MockOpenGL::bufferDataCalls = 0;
+int MockOpenGL::bufferSubDataCalls = 0;
+int MockOpenGL::bufferStorageCalls = 0;
+int MockOpenGL::fenceSyncCalls = 0;
+int MockOpenGL::clientWaitSyncCalls = 0;
 
 GLuint MockOpenGL::nextProgramId = 1;
 GLuint MockOpenGL::nextShaderId = 1;
 GLint MockOpenGL::nextUniformLocation = 0;
 GLint MockOpenGL::mockCompileStatus = GL_TRUE;
 GLint MockOpenGL::mockLinkStatus = GL_TRUE;
+GLenum MockOpenGL::mockClientWaitStatus = GL_ALREADY_SIGNALED;
 
 GLuint MockOpenGL::lastUsedProgram = 0;
 std::vector<GLuint> MockOpenGL::createdPrograms;
 std::vector<GLuint> MockOpenGL::createdShaders;
 std::map<std::string, GLint> MockOpenGL::uniformLocations;
+std::vector<GLsizei> MockOpenGL::drawInstanceCounts;
+std::vector<std::uintptr_t> MockOpenGL::attribPointerOffsets;
+std::vector<unsigned char> MockOpenGL::mappedStorage;
+std::vector<GLsync> MockOpenGL::liveFences;
 
 // ============================================
 // Mock Function Implementations
@@ -172,6 +183,12 @@ void MockOpenGL::reset()
     getShaderivCalls = 0;
     getProgramivCalls = 0;
     genVertexArraysCalls = 0;
+    genBuffersCalls = 0;
+    bufferDataCalls = 0;
+    bufferSubDataCalls = 0;
+    bufferStorageCalls = 0;
+    fenceSyncCalls = 0;
+    clientWaitSyncCalls = 0;
 
     // Reset return values
     nextProgramId = 1;
@@ -179,12 +196,19 @@ void MockOpenGL::reset()
     nextUniformLocation = 0;
     mockCompileStatus = GL_TRUE;
     mockLinkStatus = GL_TRUE;
+    mockClientWaitStatus = GL_ALREADY_SIGNALED;
 
     // Reset state
     lastUsedProgram = 0;
     createdPrograms.clear();
     createdShaders.clear();
     uniformLocations.clear();
+    drawInstanceCounts.clear();
+    attribPointerOffsets.clear();
+    mappedStorage.clear();
+    liveFences.clear();
+    GLAD_GL_VERSION_4_4 = 0;
+    GLAD_GL_ARB_buffer_storage = 0;
 }
 
 void MockOpenGL::setCompileStatus(GLint status)
@@ -224,6 +248,7 @@ bool MockOpenGL::wasProgramCreated(GLuint program)
 static void APIENTRY mock_glGenBuffers(GLsizei n, GLuint* buffers)
 {
     static GLuint nextBufferId = 1;
+    MockOpenGL::genBuffersCalls++;
     for (GLsizei i = 0; i < n; i++) {
         buffers[i] = nextBufferId++;
     }
@@ -241,13 +266,54 @@ static void APIENTRY mock_glBindBuffer(GLenum target, GLuint buffer)
 
 static void APIENTRY mock_glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
 {
-    // No-op for testing
+    MockOpenGL::bufferDataCalls++;
+}
+
+static void APIENTRY mock_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    MockOpenGL::bufferSubDataCalls++;
+}
+
+static void APIENTRY mock_glBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    MockOpenGL::bufferStorageCalls++;
+}
+
+static void* APIENTRY mock_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    MockOpenGL::mappedStorage.assign(static_cast<std::size_t>(length), 0);
+    return MockOpenGL::mappedStorage.data();
+}
+
+static GLsync APIENTRY mock_glFenceSync(GLenum condition, GLbitfield flags)
+{
+    static std::uintptr_t nextFence = 1;
+    MockOpenGL::fenceSyncCalls++;
+    GLsync fence = reinterpret_cast<GLsync>(nextFence++);
+    MockOpenGL::liveFences.push_back(fence);
+    return fence;
+}
+
+static GLenum APIENTRY mock_glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    MockOpenGL::clientWaitSyncCalls++;
+    return MockOpenGL::mockClientWaitStatus;
+}
+
+static void APIENTRY mock_glDeleteSync(GLsync sync)
+{
+    std::erase(MockOpenGL::liveFences, sync);
 }
 
 static void APIENTRY mock_glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
                                                 GLsizei stride, const void* pointer)
 {
-    // No-op for testing
+    MockOpenGL::attribPointerOffsets.push_back(reinterpret_cast<std::uintptr_t>(pointer));
+}
+
+static void APIENTRY mock_glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+{
+    MockOpenGL::drawInstanceCounts.push_back(instancecount);
 }
 
 static void APIENTRY mock_glVertexAttribDivisor(GLuint index, GLuint divisor)
@@ -336,8 +402,10 @@ void MockOpenGL::initGLAD()
     glDeleteBuffers = mock_glDeleteBuffers;
     glBindBuffer = mock_glBindBuffer;
     glBufferData = mock_glBufferData;
+    glBufferSubData = mock_glBufferSubData;
     glVertexAttribPointer = mock_glVertexAttribPointer;
     glVertexAttribDivisor = mock_glVertexAttribDivisor;
+    glDrawArraysInstanced = mock_glDrawArraysInstanced;
 
     // Shader functions (using APIENTRY for Windows compatibility)
     glCreateProgram = mock_glCreateProgram;
@@ -353,3 +421,13 @@ void MockOpenGL::initGLAD()
     glDeleteShader = mock_glDeleteShader;
     glUseProgram = mock_glUseProgram;
 }
+
+void MockOpenGL::enableBufferStorage()
+{
+    GLAD_GL_VERSION_4_4 = 1;
+    glBufferStorage = mock_glBufferStorage;
+    glMapBufferRange = mock_glMapBufferRange;
+    glFenceSync = mock_glFenceSync;
+    glClientWaitSync = mock_glClientWaitSync;
+    glDeleteSync = mock_glDeleteSync;
+}
@@ -8,6 +8,7 @@
 #ifndef MOCK_OPENGL_HPP
 #define MOCK_OPENGL_HPP
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -41,6 +42,12 @@ class MockOpenGL
     static int getShaderivCalls;
     static int getProgramivCalls;
     static int genVertexArraysCalls;
+    static int genBuffersCalls;
+    static int bufferDataCalls;
+    static int bufferSubDataCalls;
+    static int bufferStorageCalls;
+    static int fenceSyncCalls;
+    static int clientWaitSyncCalls;
 
     // ============================================
     // Return Values
@@ -50,6 +57,7 @@ class MockOpenGL
     static GLint nextUniformLocation;
     static GLint mockCompileStatus;
     static GLint mockLinkStatus;
+    static GLenum mockClientWaitStatus; // what glClientWaitSync returns
 
     // ============================================
     // State Tracking
@@ -58,6 +66,10 @@ class MockOpenGL
     static std::vector<GLuint> createdPrograms;
     static std::vector<GLuint> createdShaders;
     static std::map<std::string, GLint> uniformLocations;
+    static std::vector<GLsizei> drawInstanceCounts;          // instance count of each glDrawArraysInstanced call
+    static std::vector<std::uintptr_t> attribPointerOffsets; // offset passed to each glVertexAttribPointer call
+    static std::vector<unsigned char> mappedStorage;         // memory handed out by glMapBufferRange
+    static std::vector<GLsync> liveFences;                   // fences created and not yet deleted
 
     // ============================================
     // Mock Functions
@@ -96,6 +108,13 @@ class MockOpenGL
      */
     static void initGLAD();
 
+    /*
+     * Reports GL 4.4 and points glBufferStorage, glMapBufferRange and the
+     * sync functions at mocks, so Particle takes its persistently mapped path.
+     * reset() turns it off again.
+     */
+    static void enableBufferStorage();
+
     /*
      * Set the compile status that will be returned by mockGetShaderiv.
      * Use GL_TRUE for success, GL_FALSE for failure.